@@ -32,6 +32,7 @@
 #import "ORKAccelerometerRecorder.h"
 #import "ORKDataLogger.h"
 #import "CMAccelerometerData+ORKJSONDictionary.h"
+#import "ORKMotionHub.h"
 #import <CoreMotion/CoreMotion.h>
 #import "ORKRecorder_Internal.h"
 #import "ORKRecorder_Private.h"
@@ -41,11 +42,12 @@
 @interface ORKAccelerometerRecorder () {
     ORKDataLogger *_logger;
     NSError *_recordingError;
+    ORKMotionHubSubscription *_subscription;
 }
 
-@property (nonatomic, strong) CMMotionManager *motionManager;
+@property (nonatomic, strong) ORKMotionHub *motionHub;
 
-@property (nonatomic) NSTimeInterval uptime;
+@property (atomic) BOOL armed;
 
 @end
 
@@ -62,6 +64,9 @@
 }
 
 - (void)dealloc {
+    if (_subscription) {
+        [_motionHub removeSubscription:_subscription];
+    }
     [_logger finishCurrentLog];
 }
 
@@ -77,15 +82,45 @@
     }
 }
 
+// Subclasses may return a dedicated motion manager (for instance, for testing).
+// By default, the recorder shares the process-wide motion hub.
 - (CMMotionManager *)createMotionManager {
-    return [[CMMotionManager alloc] init];
+    return nil;
+}
+
+- (ORKMotionHub *)createMotionHub {
+    CMMotionManager *motionManager = [self createMotionManager];
+    if (motionManager) {
+        return [[ORKMotionHub alloc] initWithSampleSource:[[ORKMotionManagerSampleSource alloc] initWithMotionManager:motionManager]];
+    }
+    return [ORKMotionHub sharedHub];
+}
+
+- (void)prepare {
+    [super prepare];
+    
+    if (! _logger) {
+        NSError *error = nil;
+        _logger = [self makePreparedJSONDataLoggerWithError:&error];
+        if (! _logger) {
+            // Not fatal yet; -start tries again and reports the error.
+            ORK_Log_Debug(@"Could not prepare %@: %@", self, error);
+            return;
+        }
+    }
+    
+    // Start sensor delivery now; samples are discarded until -start arms the recorder.
+    if (! _subscription) {
+        self.motionHub = [self createMotionHub];
+        if ([self.motionHub isSensorAvailable:ORKMotionSensorAccelerometer]) {
+            [self subscribeWithError:nil];
+        }
+    }
 }
 
 - (void)start {
     [super start];
     
-    self.motionManager = [self createMotionManager];
-    
     if (! _logger) {
         NSError *err = nil;
         _logger = [self makeJSONDataLoggerWithError:&err];
@@ -95,37 +130,57 @@
         }
     }
     
-    if (! self.motionManager || ! self.motionManager.accelerometerAvailable) {
-        NSError *error = [NSError errorWithDomain:NSCocoaErrorDomain
-                                             code:NSFeatureUnsupportedError
-                                         userInfo:@{@"recorder" : self}];
-        [self finishRecordingWithError:error];
-        return;
+    if (! _subscription) {
+        self.motionHub = [self createMotionHub];
+        
+        if (! [self.motionHub isSensorAvailable:ORKMotionSensorAccelerometer]) {
+            NSError *error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                                 code:NSFeatureUnsupportedError
+                                             userInfo:@{@"recorder" : self}];
+            [self finishRecordingWithError:error];
+            return;
+        }
+        
+        NSError *subscriptionError = nil;
+        if (! [self subscribeWithError:&subscriptionError]) {
+            [self finishRecordingWithError:subscriptionError];
+            return;
+        }
     }
     
-    self.motionManager.accelerometerUpdateInterval = 1.0/_frequency;
-    
-    self.uptime = [NSProcessInfo processInfo].systemUptime;
-    
-    [self.motionManager stopAccelerometerUpdates];
-    
-    [self.motionManager
-     startAccelerometerUpdatesToQueue:[[NSOperationQueue alloc] init]
-     withHandler:^(CMAccelerometerData *data, NSError *error)
-     {
-         BOOL success = NO;
-         if (data)
-         {
-             success = [_logger append:[data ork_JSONDictionary] error:&error];
-         }
-         if (!success)
-         {
-             dispatch_async(dispatch_get_main_queue(), ^{
-                 _recordingError = error;
-                 [self stop];
-             });
-         }
-     }];
+    _subscription.countsDroppedSamples = self.countsDroppedSamples;
+    self.armed = YES;
+}
+
+// Samples delivered before the recorder is armed are discarded.
+- (BOOL)subscribeWithError:(NSError * __autoreleasing *)error {
+    ORKDataLogger *logger = _logger;
+    __weak ORKAccelerometerRecorder *weakSelf = self;
+    _subscription = [self.motionHub
+                     subscribeToSensor:ORKMotionSensorAccelerometer
+                     frequency:_frequency
+                     handler:^(CMLogItem *data, NSError *error)
+                     {
+                         ORKAccelerometerRecorder *strongSelf = weakSelf;
+                         if (! strongSelf.armed) {
+                             return;
+                         }
+                         BOOL success = NO;
+                         if (data)
+                         {
+                             success = [logger append:[(CMAccelerometerData *)data ork_JSONDictionary] error:&error];
+                         }
+                         if (success) {
+                             [strongSelf noteSamplePersisted];
+                         } else {
+                             dispatch_async(dispatch_get_main_queue(), ^{
+                                 strongSelf->_recordingError = error;
+                                 [strongSelf stop];
+                             });
+                         }
+                     }
+                     error:error];
+    return (_subscription != nil);
 }
 
 - (NSDictionary *)userInfo {
@@ -134,25 +189,32 @@
 
 - (void)stop {
     [self doStopRecording];
-    [_logger finishCurrentLog];
     
     NSError *error = _recordingError;
     _recordingError = nil;
-    __block NSURL *fileUrl = nil;
-    [_logger enumerateLogs:^(NSURL *logFileUrl, BOOL *stop) {
-        fileUrl = logFileUrl;
-    } error:&error];
-    
-    [self reportFileResultWithFile:fileUrl error:error];
+    [self finishJSONLogger:_logger recordingError:error];
     
     [super stop];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    [self doStopRecording];
+    
+    NSError *error = _recordingError;
+    _recordingError = nil;
+    [self finishJSONLogger:_logger recordingError:error completion:completion];
+}
+
 - (void)doStopRecording {
-    if (self.isRecording) {
-        [self.motionManager stopAccelerometerUpdates];
-        self.motionManager = nil;
+    self.armed = NO;
+    if (_subscription) {
+        if (_subscription.countsDroppedSamples) {
+            self.droppedSampleCount = @(_subscription.droppedSampleCount);
+        }
+        [self.motionHub removeSubscription:_subscription];
+        _subscription = nil;
     }
+    self.motionHub = nil;
 }
 
 - (void)finishRecordingWithError:(NSError *)error {
@@ -160,6 +222,10 @@
     [super finishRecordingWithError:nil];
 }
 
+- (ORKDataLogger *)dataLogger {
+    return _logger;
+}
+
 - (void)reset {
     [super reset];
     
@@ -167,7 +233,7 @@
 }
 
 - (BOOL)isRecording {
-    return self.motionManager.accelerometerActive;
+    return (self.armed && _subscription != nil);
 }
 
 - (NSString *)mimeType {
@@ -47,6 +47,9 @@
 #import "ORKAccessibility.h"
 #import "ORKStepHeaderView_Internal.h"
 #import "ORKActiveStepView.h"
+#import "ORKPerformanceMetrics.h"
+#import "ORKPerformanceMetricsCollector.h"
+#import "ORKTraceBuffer_Internal.h"
 
 
 @interface ORKActiveStepViewController () {
@@ -54,6 +57,7 @@
     ORKActiveStepTimer *_activeStepTimer;
 
     NSArray *_recorderResults;
+    dispatch_group_t _recorderStopGroup;
     
     SystemSoundID _alertSound;
     NSURL *_alertSoundURL;
@@ -209,24 +213,65 @@
 - (void)recordersWillStop {
 }
 
+// Recorders can be kept if they were made for the current configurations and directory and have not started.
+- (BOOL)canReuseRecorders:(NSArray *)recorders {
+    if (recorders.count == 0 || self.started) {
+        return NO;
+    }
+    if (! [[recorders valueForKey:@"configuration"] isEqualToArray:self.activeStep.recorderConfigurations]) {
+        return NO;
+    }
+    for (ORKRecorder *recorder in recorders) {
+        if (recorder.isRecording || ! ORKEqualObjects(recorder.outputDirectory, self.outputDirectory)) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
 - (void)prepareRecorders {
+    // Prefer recorders handed over by the task view controller, then our own unstarted
+    // recorders, so the work done in -[ORKRecorder prepare] is not thrown away.
+    NSArray *reusableRecorders = nil;
+    NSArray *preparedRecorders = self.preparedRecorders;
+    self.preparedRecorders = nil;
+    if ([self canReuseRecorders:preparedRecorders]) {
+        reusableRecorders = preparedRecorders;
+    } else if ([self canReuseRecorders:self.recorders]) {
+        reusableRecorders = self.recorders;
+    }
+    
     // Stop any existing recorders
     [self recordersWillStop];
-    for (ORKRecorder *recorder in self.recorders) {
+    for (ORKRecorder *recorder in [self.recorders arrayByAddingObjectsFromArray:preparedRecorders ? : @[]]) {
+        if ([reusableRecorders containsObject:recorder]) {
+            continue;
+        }
         recorder.delegate = nil;
         [recorder stop];
     }
     NSMutableArray *recorders = [NSMutableArray array];
     
-    for (ORKRecorderConfiguration * provider in self.activeStep.recorderConfigurations) {
-        // If the outputDirectory is nil, recorders which require one will generate an error.
-        // We start them anyway, because we don't know which recorders will require an outputDirectory.
-        ORKRecorder *recorder = [provider recorderForStep:self.step
-                                          outputDirectory:self.outputDirectory];
-        recorder.configuration = provider;
+    if (reusableRecorders) {
+        [recorders addObjectsFromArray:reusableRecorders];
+    } else {
+        for (ORKRecorderConfiguration * provider in self.activeStep.recorderConfigurations) {
+            // If the outputDirectory is nil, recorders which require one will generate an error.
+            // We start them anyway, because we don't know which recorders will require an outputDirectory.
+            ORKRecorder *recorder = [provider recorderForStep:self.step
+                                              outputDirectory:self.outputDirectory];
+            recorder.configuration = provider;
+            [recorders addObject:recorder];
+        }
+    }
+    for (ORKRecorder *recorder in recorders) {
         recorder.delegate = self;
-        
-        [recorders addObject:recorder];
+        if (self.clock) {
+            recorder.clock = self.clock;
+        }
+        if (self.outputDirectory) {
+            [recorder prepare];
+        }
     }
     self.recorders = recorders;
     
@@ -258,22 +303,89 @@
     [_activeStepView.activeCustomView resetStep:self];
     [self resetTimer];
     
-    [self prepareRecorders];
+    // Recorders are made once the view controller is taken for presentation, when the
+    // output directory is set again.
+    if (! self.preparedAheadOfPresentation) {
+        [self prepareRecorders];
+    }
 }
 
 - (void)startRecorders {
+    ORKPerformanceMetricsCollector *collector = self.performanceMetricsCollector;
+    NSTimeInterval startUptime = collector ? [NSProcessInfo processInfo].systemUptime : 0;
+    
     [self recordersWillStart];
     // Start recorders
+    ORK_TRACE_BEGIN("recorder", "start");
     for (ORKRecorder *recorder in self.recorders) {
+        recorder.countsDroppedSamples = (collector != nil);
         [recorder viewController:self willStartStepWithView:self.customViewContainer];
         [recorder start];
     }
+    ORK_TRACE_END_VALUE("recorder", "start", self.recorders.count);
+    
+    if (collector) {
+        [collector addValue:[NSProcessInfo processInfo].systemUptime - startUptime forMetric:ORKPerformanceMetricRecorderStartDurationKey stepIdentifier:self.step.identifier];
+    }
 }
 
 - (void)stopRecorders {
     [self recordersWillStop];
-    for (ORKRecorder *recorder in self.recorders) {
-        [recorder stop];
+    NSArray *recorders = self.recorders;
+    if (recorders.count == 0) {
+        return;
+    }
+    
+    // Recorders finish their files concurrently in the background; the results are
+    // delivered together, in recorder order, once all of them are done.
+    NSTimeInterval stopUptime = [NSProcessInfo processInfo].systemUptime;
+    ORK_TRACE_BEGIN("recorder", "stop");
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:recorders.count];
+    [recorders enumerateObjectsUsingBlock:^(ORKRecorder *recorder, NSUInteger idx, BOOL *stop) {
+        [results addObject:[NSNull null]];
+        dispatch_group_enter(group);
+        [recorder stopWithCompletion:^(ORKResult *result, NSError *error) {
+            if (result) {
+                results[idx] = result;
+            }
+            dispatch_group_leave(group);
+        }];
+    }];
+    ORK_TRACE_END_VALUE("recorder", "stop", recorders.count);
+    NSTimeInterval stopDuration = [NSProcessInfo processInfo].systemUptime - stopUptime;
+    ORK_Log_Debug(@"Stopped %lu recorders in %.1f ms", (unsigned long)recorders.count, stopDuration * 1000.0);
+    [self.performanceMetricsCollector addValue:stopDuration forMetric:ORKPerformanceMetricRecorderStopDurationKey stepIdentifier:self.step.identifier];
+    
+    _recorderStopGroup = group;
+    NSString *stepIdentifier = self.step.identifier;
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        NSTimeInterval stopLatency = [NSProcessInfo processInfo].systemUptime - stopUptime;
+        ORK_Log_Debug(@"Recorder results ready after %.1f ms", stopLatency * 1000.0);
+        ORK_TRACE_INSTANT("recorder", "resultsReady");
+        if (_recorderStopGroup == group) {
+            _recorderStopGroup = nil;
+        }
+        [results removeObjectIdenticalTo:[NSNull null]];
+        [self.performanceMetricsCollector addValue:stopLatency forMetric:ORKPerformanceMetricRecorderStopLatencyKey stepIdentifier:stepIdentifier];
+        [self.performanceMetricsCollector addMetricsFromRecorderResults:results stepIdentifier:stepIdentifier];
+        [self recordersDidStopWithResults:results];
+    });
+}
+
+- (void)recordersDidStopWithResults:(NSArray *)results {
+    if (results.count == 0) {
+        return;
+    }
+    _recorderResults = [_recorderResults arrayByAddingObjectsFromArray:results];
+    [self notifyDelegateOnResultChange];
+}
+
+- (void)waitForRecorderResultsWithCompletion:(dispatch_block_t)completion {
+    if (_recorderStopGroup) {
+        dispatch_group_notify(_recorderStopGroup, dispatch_get_main_queue(), completion);
+    } else {
+        completion();
     }
 }
 
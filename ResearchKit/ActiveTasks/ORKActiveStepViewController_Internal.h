@@ -36,6 +36,7 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class ORKActiveStepView;
+@class ORKPerformanceMetricsCollector;
 
 @interface ORKActiveStepViewController ()
 
@@ -54,8 +55,18 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, assign, getter=isStarted) BOOL started;
 
+// Recorders created and prepared ahead of this step, typically by the task view controller while the
+// previous step was on screen. They replace new recorders on the next -prepareRecorders if they match.
+@property (nonatomic, copy, nullable) NSArray *preparedRecorders;
+
+// Set by the task view controller when it collects performance metrics; recorder start and stop are timed into it.
+@property (nonatomic, strong, nullable) ORKPerformanceMetricsCollector *performanceMetricsCollector;
+
 - (void)countDownTimerFired:(ORKActiveStepTimer *)timer finished:(BOOL)finished; // Let subclass receive timer fires
 
+// Calls `completion` on the main queue once recorders that are stopping have delivered their results.
+- (void)waitForRecorderResultsWithCompletion:(dispatch_block_t)completion;
+
 - (void)applicationWillResignActive:(NSNotification *)notification;
 - (void)applicationDidBecomeActive:(NSNotification *)notification;
 
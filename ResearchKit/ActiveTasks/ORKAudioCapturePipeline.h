@@ -0,0 +1,176 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <ResearchKit/ORKRecorder.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AVAudioFormat;
+@class AVAudioPCMBuffer;
+
+/*
+ Streaming sample rate conversion of a mono signal by linear interpolation. When the
+ rate is reduced, a windowed-sinc low-pass filter runs first to limit aliasing.
+ 
+ Not thread safe.
+ */
+@interface ORKAudioSampleRateConverter : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithInputSampleRate:(double)inputSampleRate outputSampleRate:(double)outputSampleRate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) double inputSampleRate;
+
+@property (nonatomic, readonly) double outputSampleRate;
+
+// An upper bound on the number of samples produced for `count` input samples.
+- (NSInteger)maximumOutputCountForInputCount:(NSInteger)count;
+
+// Writes at most `-maximumOutputCountForInputCount:` samples to `output` and returns the number written.
+- (NSInteger)convertSamples:(const float *)samples count:(NSInteger)count output:(float *)output;
+
+@end
+
+
+/*
+ The buffer-level stages behind `ORKAudioRecorder`'s processing options.
+ 
+ Each buffer of input is:
+ 1. optionally downmixed to mono and converted to `outputSampleRate`, and handed to
+    `outputHandler`;
+ 2. downmixed to mono, converted to at most 16 kHz, and fed to voice activity detection
+    (for `ORKAudioProcessingOptionTrimSilence`) and phonation analysis (for
+    `ORKAudioProcessingOptionComputeVoiceFeatures`).
+ 
+ Buffers are processed as they arrive, so the pipeline can run on live input. Where speech
+ starts and ends is only known after -finish; `ORKAudioCaptureWriter` then trims its output.
+ 
+ Not thread safe.
+ */
+@interface ORKAudioCapturePipeline : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// An `outputSampleRate` of 0 keeps the input rate.
+- (instancetype)initWithInputSampleRate:(double)inputSampleRate
+                           channelCount:(NSInteger)channelCount
+                                options:(ORKAudioProcessingOptions)options
+                       outputSampleRate:(double)outputSampleRate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) ORKAudioProcessingOptions options;
+
+@property (nonatomic, readonly) double inputSampleRate;
+
+@property (nonatomic, readonly) double outputSampleRate;
+
+@property (nonatomic, readonly) NSInteger outputChannelCount;
+
+// Whether the output differs from the input in channel count or rate.
+@property (nonatomic, readonly) BOOL convertsFormat;
+
+// Receives each converted buffer, one pointer per output channel.
+@property (nonatomic, copy, nullable) void (^outputHandler)(const float * _Nonnull const * _Nonnull channels, NSInteger frameCount);
+
+- (NSInteger)maximumOutputFrameCountForInputFrameCount:(NSInteger)frameCount;
+
+// `channels` holds one pointer per input channel.
+- (void)processChannels:(const float * _Nonnull const * _Nonnull)channels frameCount:(NSInteger)frameCount;
+
+// Completes the analysis. Call once, after the last buffer.
+- (void)finish;
+
+// The following are valid after -finish.
+
+// YES if speech was found and there is silence around it to remove.
+@property (nonatomic, readonly) BOOL trimsSilence;
+
+// The span to keep, in seconds from the start of the input; the whole input unless trimming.
+@property (nonatomic, readonly) NSTimeInterval speechStartTime;
+@property (nonatomic, readonly) NSTimeInterval speechEndTime;
+
+// Voice features, keyed by the `ORKVoiceFeature...Key` constants; nil unless computed.
+@property (nonatomic, copy, readonly, nullable) NSDictionary *voiceFeatures;
+
+/*
+ Runs a pipeline over the audio file at `inputURL`, in a single pass, and returns it, finished.
+ If the output differs from the input, it is written to `outputURL`, using `settings` with the
+ output rate and channel count, and `wroteOutput` is set to YES.
+ */
++ (nullable ORKAudioCapturePipeline *)processFileAtURL:(NSURL *)inputURL
+                                                 toURL:(NSURL *)outputURL
+                                              settings:(nullable NSDictionary *)settings
+                                               options:(ORKAudioProcessingOptions)options
+                                      outputSampleRate:(double)outputSampleRate
+                                           wroteOutput:(nullable BOOL *)wroteOutput
+                                                 error:(NSError * __autoreleasing *)error;
+
+@end
+
+
+/*
+ Runs an `ORKAudioCapturePipeline` over audio as it is captured and, when the pipeline changes
+ the audio, writes the output to a file as it goes. Finishing only has to trim the output to the
+ span containing speech, if asked to, and close it.
+ 
+ Not thread safe; append buffers and finish from one queue.
+ */
+@interface ORKAudioCaptureWriter : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// `inputFormat` must be the deinterleaved float format of the buffers to append. `settings` are
+// used for the output file, with the pipeline's output rate and channel count.
+- (nullable instancetype)initWithInputFormat:(AVAudioFormat *)inputFormat
+                                   outputURL:(NSURL *)outputURL
+                                    settings:(nullable NSDictionary *)settings
+                                     options:(ORKAudioProcessingOptions)options
+                            outputSampleRate:(double)outputSampleRate
+                                       error:(NSError * __autoreleasing *)error NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, strong, readonly) ORKAudioCapturePipeline *pipeline;
+
+@property (nonatomic, copy, readonly) NSURL *outputURL;
+
+// Whether the output is written: when the pipeline converts the format or may trim silence.
+@property (nonatomic, readonly) BOOL writesOutput;
+
+// Buffers appended after -finishWithError: are ignored.
+- (void)appendBuffer:(AVAudioPCMBuffer *)buffer;
+
+// Finishes the pipeline, then trims and closes the output. Returns NO if the output could not be written.
+- (BOOL)finishWithError:(NSError * __autoreleasing *)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
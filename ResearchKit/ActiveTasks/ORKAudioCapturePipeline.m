@@ -0,0 +1,509 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKAudioCapturePipeline.h"
+#import "ORKVoiceActivityDetector.h"
+#import "ORKPhonationAnalyzer.h"
+#import <AVFoundation/AVFoundation.h>
+
+
+static const NSInteger FilterTapCount = 33;
+
+// Fraction of the output Nyquist frequency passed by the anti-aliasing filter.
+static const double FilterPassband = 0.9;
+
+@implementation ORKAudioSampleRateConverter {
+    double _step;
+    float *_taps;
+    float *_history;
+    NSMutableData *_filtered;
+    double _position;
+    float _previous;
+}
+
+- (instancetype)initWithInputSampleRate:(double)inputSampleRate outputSampleRate:(double)outputSampleRate {
+    NSParameterAssert(inputSampleRate > 0 && outputSampleRate > 0);
+    self = [super init];
+    if (self) {
+        _inputSampleRate = inputSampleRate;
+        _outputSampleRate = outputSampleRate;
+        _step = inputSampleRate / outputSampleRate;
+        _filtered = [NSMutableData data];
+        if (outputSampleRate < inputSampleRate) {
+            _taps = calloc(FilterTapCount, sizeof(float));
+            _history = calloc(FilterTapCount - 1, sizeof(float));
+            if (! _taps || ! _history) {
+                return nil;
+            }
+            [self designFilter];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_taps);
+    free(_history);
+}
+
+- (void)designFilter {
+    // Blackman-windowed sinc, cutoff in cycles per input sample, normalized to unit gain at DC.
+    double cutoff = 0.5 * FilterPassband * _outputSampleRate / _inputSampleRate;
+    double center = (FilterTapCount - 1) / 2.0;
+    double sum = 0;
+    for (NSInteger k = 0; k < FilterTapCount; k++) {
+        double t = k - center;
+        double sinc = (t == 0) ? 2 * cutoff : sin(2 * M_PI * cutoff * t) / (M_PI * t);
+        double phase = 2 * M_PI * k / (FilterTapCount - 1);
+        double window = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2 * phase);
+        _taps[k] = (float)(sinc * window);
+        sum += _taps[k];
+    }
+    for (NSInteger k = 0; k < FilterTapCount; k++) {
+        _taps[k] /= sum;
+    }
+}
+
+- (NSInteger)maximumOutputCountForInputCount:(NSInteger)count {
+    return (NSInteger)ceil((count + 1) / _step) + 1;
+}
+
+- (NSInteger)convertSamples:(const float *)samples count:(NSInteger)count output:(float *)output {
+    if (count <= 0) {
+        return 0;
+    }
+    if (_step == 1) {
+        memcpy(output, samples, count * sizeof(float));
+        return count;
+    }
+    
+    const float *filtered = samples;
+    if (_taps) {
+        [_filtered setLength:count * sizeof(float)];
+        float *buffer = _filtered.mutableBytes;
+        const NSInteger historyCount = FilterTapCount - 1;
+        for (NSInteger i = 0; i < count; i++) {
+            float value = 0;
+            for (NSInteger k = 0; k < FilterTapCount; k++) {
+                NSInteger j = i - k;
+                value += _taps[k] * ((j >= 0) ? samples[j] : _history[historyCount + j]);
+            }
+            buffer[i] = value;
+        }
+        if (count >= historyCount) {
+            memcpy(_history, samples + count - historyCount, historyCount * sizeof(float));
+        } else {
+            memmove(_history, _history + count, (historyCount - count) * sizeof(float));
+            memcpy(_history + historyCount - count, samples, count * sizeof(float));
+        }
+        filtered = buffer;
+    }
+    
+    // Positions are in input samples relative to this buffer; position -1 is the previous buffer's last sample.
+    NSInteger written = 0;
+    while (_position < count - 1) {
+        NSInteger index = (NSInteger)floor(_position);
+        double fraction = _position - index;
+        float left = (index < 0) ? _previous : filtered[index];
+        float right = filtered[index + 1];
+        output[written++] = (float)(left + (right - left) * fraction);
+        _position += _step;
+    }
+    _position -= count;
+    _previous = filtered[count - 1];
+    return written;
+}
+
+@end
+
+
+NSString *const ORKVoiceFeatureFrameIntervalKey = @"frameInterval";
+NSString *const ORKVoiceFeatureFundamentalFrequencyTrackKey = @"fundamentalFrequencyTrack";
+NSString *const ORKVoiceFeatureVoicedFrameCountKey = @"voicedFrameCount";
+NSString *const ORKVoiceFeatureMeanFundamentalFrequencyKey = @"meanFundamentalFrequency";
+NSString *const ORKVoiceFeatureJitterKey = @"jitter";
+NSString *const ORKVoiceFeatureShimmerKey = @"shimmer";
+NSString *const ORKVoiceFeatureHarmonicsToNoiseRatioKey = @"harmonicsToNoiseRatio";
+
+// Voice analysis needs nothing above 8 kHz; analyzing at a lower rate keeps it cheap.
+static const double MaximumAnalysisSampleRate = 16000;
+
+static const AVAudioFrameCount ReadFrameCapacity = 4096;
+
+@implementation ORKAudioCapturePipeline {
+    NSInteger _channelCount;
+    NSArray *_outputConverters;
+    ORKAudioSampleRateConverter *_analysisConverter;
+    ORKVoiceActivityDetector *_detector;
+    ORKPhonationAnalyzer *_analyzer;
+    double _analysisSampleRate;
+    NSInteger _analysisSampleCount;
+    
+    NSMutableData *_mono;
+    NSMutableData *_analysisSamples;
+    NSMutableArray *_convertedChannels;
+}
+
+- (instancetype)initWithInputSampleRate:(double)inputSampleRate
+                           channelCount:(NSInteger)channelCount
+                                options:(ORKAudioProcessingOptions)options
+                       outputSampleRate:(double)outputSampleRate {
+    NSParameterAssert(inputSampleRate > 0);
+    NSParameterAssert(channelCount > 0);
+    self = [super init];
+    if (self) {
+        _inputSampleRate = inputSampleRate;
+        _channelCount = channelCount;
+        _options = options;
+        _outputSampleRate = (outputSampleRate > 0) ? outputSampleRate : inputSampleRate;
+        _outputChannelCount = (options & ORKAudioProcessingOptionDownmixToMono) ? 1 : channelCount;
+        _convertsFormat = (_outputSampleRate != inputSampleRate || _outputChannelCount != channelCount);
+        
+        if (_outputSampleRate != inputSampleRate) {
+            NSMutableArray *converters = [NSMutableArray array];
+            for (NSInteger i = 0; i < _outputChannelCount; i++) {
+                [converters addObject:[[ORKAudioSampleRateConverter alloc] initWithInputSampleRate:inputSampleRate outputSampleRate:_outputSampleRate]];
+            }
+            _outputConverters = [converters copy];
+        }
+        
+        _analysisSampleRate = MIN(inputSampleRate, MaximumAnalysisSampleRate);
+        if (options & (ORKAudioProcessingOptionTrimSilence | ORKAudioProcessingOptionComputeVoiceFeatures)) {
+            if (_analysisSampleRate != inputSampleRate) {
+                _analysisConverter = [[ORKAudioSampleRateConverter alloc] initWithInputSampleRate:inputSampleRate outputSampleRate:_analysisSampleRate];
+            }
+            if (options & ORKAudioProcessingOptionTrimSilence) {
+                _detector = [[ORKVoiceActivityDetector alloc] initWithSampleRate:_analysisSampleRate];
+            }
+            if (options & ORKAudioProcessingOptionComputeVoiceFeatures) {
+                _analyzer = [[ORKPhonationAnalyzer alloc] initWithSampleRate:_analysisSampleRate];
+            }
+        }
+        
+        _mono = [NSMutableData data];
+        _analysisSamples = [NSMutableData data];
+        _convertedChannels = [NSMutableArray array];
+        for (NSInteger i = 0; i < _outputChannelCount; i++) {
+            [_convertedChannels addObject:[NSMutableData data]];
+        }
+    }
+    return self;
+}
+
+- (NSInteger)maximumOutputFrameCountForInputFrameCount:(NSInteger)frameCount {
+    return _outputConverters ? [_outputConverters[0] maximumOutputCountForInputCount:frameCount] : frameCount;
+}
+
+- (const float *)downmixChannels:(const float * const *)channels frameCount:(NSInteger)frameCount {
+    if (_channelCount == 1) {
+        return channels[0];
+    }
+    [_mono setLength:frameCount * sizeof(float)];
+    float *mono = _mono.mutableBytes;
+    float scale = 1.0f / _channelCount;
+    for (NSInteger i = 0; i < frameCount; i++) {
+        float sum = 0;
+        for (NSInteger c = 0; c < _channelCount; c++) {
+            sum += channels[c][i];
+        }
+        mono[i] = sum * scale;
+    }
+    return mono;
+}
+
+- (void)processChannels:(const float * const *)channels frameCount:(NSInteger)frameCount {
+    if (frameCount <= 0) {
+        return;
+    }
+    const float *mono = NULL;
+    if (_outputChannelCount != _channelCount || _detector || _analyzer) {
+        mono = [self downmixChannels:channels frameCount:frameCount];
+    }
+    
+    if (_outputHandler) {
+        const float *sources[_outputChannelCount];
+        for (NSInteger c = 0; c < _outputChannelCount; c++) {
+            sources[c] = (_outputChannelCount == _channelCount) ? channels[c] : mono;
+        }
+        if (_outputConverters) {
+            const float *converted[_outputChannelCount];
+            NSInteger convertedCount = 0;
+            NSInteger capacity = [self maximumOutputFrameCountForInputFrameCount:frameCount];
+            for (NSInteger c = 0; c < _outputChannelCount; c++) {
+                NSMutableData *data = _convertedChannels[c];
+                [data setLength:capacity * sizeof(float)];
+                // Every channel's converter has seen the same number of samples, so all produce the same count.
+                convertedCount = [_outputConverters[c] convertSamples:sources[c] count:frameCount output:data.mutableBytes];
+                converted[c] = data.mutableBytes;
+            }
+            _outputHandler(converted, convertedCount);
+        } else {
+            _outputHandler(sources, frameCount);
+        }
+    }
+    
+    if (_detector || _analyzer) {
+        const float *samples = mono;
+        NSInteger count = frameCount;
+        if (_analysisConverter) {
+            [_analysisSamples setLength:[_analysisConverter maximumOutputCountForInputCount:frameCount] * sizeof(float)];
+            count = [_analysisConverter convertSamples:mono count:frameCount output:_analysisSamples.mutableBytes];
+            samples = _analysisSamples.mutableBytes;
+        }
+        [_detector processSamples:samples count:count];
+        [_analyzer processSamples:samples count:count];
+        _analysisSampleCount += count;
+    }
+}
+
+- (void)finish {
+    [_detector finish];
+    
+    // Without detectable speech, nothing is trimmed rather than everything.
+    _speechStartTime = 0;
+    _speechEndTime = _analysisSampleCount / _analysisSampleRate;
+    _trimsSilence = NO;
+    if (_detector.hasSpeech) {
+        _speechStartTime = _detector.speechStartSample / _analysisSampleRate;
+        _speechEndTime = _detector.speechEndSample / _analysisSampleRate;
+        _trimsSilence = (_detector.speechStartSample > 0 || _detector.speechEndSample < _detector.sampleCount);
+    }
+    
+    if (_analyzer) {
+        _voiceFeatures = @{
+                           ORKVoiceFeatureFrameIntervalKey : @(_analyzer.frameInterval),
+                           ORKVoiceFeatureFundamentalFrequencyTrackKey : _analyzer.fundamentalFrequencyTrack,
+                           ORKVoiceFeatureVoicedFrameCountKey : @(_analyzer.voicedFrameCount),
+                           ORKVoiceFeatureMeanFundamentalFrequencyKey : @(_analyzer.meanFundamentalFrequency),
+                           ORKVoiceFeatureJitterKey : @(_analyzer.jitter),
+                           ORKVoiceFeatureShimmerKey : @(_analyzer.shimmer),
+                           ORKVoiceFeatureHarmonicsToNoiseRatioKey : @(_analyzer.harmonicsToNoiseRatio)
+                           };
+    }
+}
+
+static BOOL ORKReadAudioFile(AVAudioFile *file, NSError * __autoreleasing *error, void (^block)(AVAudioPCMBuffer *buffer)) {
+    AVAudioPCMBuffer *buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:file.processingFormat frameCapacity:ReadFrameCapacity];
+    file.framePosition = 0;
+    while (file.framePosition < file.length) {
+        if (! [file readIntoBuffer:buffer error:error]) {
+            return NO;
+        }
+        if (buffer.frameLength == 0) {
+            break;
+        }
+        block(buffer);
+    }
+    return YES;
+}
+
++ (ORKAudioCapturePipeline *)processFileAtURL:(NSURL *)inputURL
+                                        toURL:(NSURL *)outputURL
+                                     settings:(NSDictionary *)settings
+                                      options:(ORKAudioProcessingOptions)options
+                             outputSampleRate:(double)outputSampleRate
+                                  wroteOutput:(BOOL *)wroteOutput
+                                        error:(NSError * __autoreleasing *)error {
+    if (wroteOutput) {
+        *wroteOutput = NO;
+    }
+    AVAudioFile *input = [[AVAudioFile alloc] initForReading:inputURL error:error];
+    if (! input) {
+        return nil;
+    }
+    ORKAudioCaptureWriter *writer = [[ORKAudioCaptureWriter alloc] initWithInputFormat:input.processingFormat
+                                                                             outputURL:outputURL
+                                                                              settings:settings
+                                                                               options:options
+                                                                      outputSampleRate:outputSampleRate
+                                                                                 error:error];
+    if (! writer) {
+        return nil;
+    }
+    BOOL ok = ORKReadAudioFile(input, error, ^(AVAudioPCMBuffer *buffer) {
+        [writer appendBuffer:buffer];
+    });
+    if (! ok) {
+        [writer finishWithError:NULL];
+    }
+    if (! ok || ! [writer finishWithError:error]) {
+        if (writer.writesOutput) {
+            [[NSFileManager defaultManager] removeItemAtURL:outputURL error:NULL];
+        }
+        return nil;
+    }
+    
+    ORKAudioCapturePipeline *pipeline = writer.pipeline;
+    if (writer.writesOutput) {
+        if (pipeline.convertsFormat || pipeline.trimsSilence) {
+            if (wroteOutput) {
+                *wroteOutput = YES;
+            }
+        } else {
+            // There was no silence to trim, so the output is a copy of the input.
+            [[NSFileManager defaultManager] removeItemAtURL:outputURL error:NULL];
+        }
+    }
+    return pipeline;
+}
+
+@end
+
+
+@implementation ORKAudioCaptureWriter {
+    AVAudioFile *_output;
+    NSDictionary *_outputSettings;
+    AVAudioPCMBuffer *_writeBuffer;
+    NSError *_writeError;
+    BOOL _finished;
+}
+
+- (instancetype)initWithInputFormat:(AVAudioFormat *)inputFormat
+                          outputURL:(NSURL *)outputURL
+                           settings:(NSDictionary *)settings
+                            options:(ORKAudioProcessingOptions)options
+                   outputSampleRate:(double)outputSampleRate
+                              error:(NSError * __autoreleasing *)error {
+    NSParameterAssert(inputFormat.commonFormat == AVAudioPCMFormatFloat32 && ! inputFormat.interleaved);
+    self = [super init];
+    if (self) {
+        _outputURL = [outputURL copy];
+        _pipeline = [[ORKAudioCapturePipeline alloc] initWithInputSampleRate:inputFormat.sampleRate
+                                                                channelCount:inputFormat.channelCount
+                                                                     options:options
+                                                            outputSampleRate:outputSampleRate];
+        _writesOutput = (_pipeline.convertsFormat || (options & ORKAudioProcessingOptionTrimSilence));
+        if (_writesOutput) {
+            NSMutableDictionary *outputSettings = [settings mutableCopy] ? : [NSMutableDictionary dictionary];
+            outputSettings[AVSampleRateKey] = @(_pipeline.outputSampleRate);
+            outputSettings[AVNumberOfChannelsKey] = @(_pipeline.outputChannelCount);
+            _outputSettings = [outputSettings copy];
+            _output = [[AVAudioFile alloc] initForWriting:outputURL settings:_outputSettings error:error];
+            if (! _output) {
+                return nil;
+            }
+            
+            __weak ORKAudioCaptureWriter *weakSelf = self;
+            _pipeline.outputHandler = ^(const float * const *channels, NSInteger frameCount) {
+                [weakSelf writeChannels:channels frameCount:frameCount];
+            };
+        }
+    }
+    return self;
+}
+
+- (void)writeChannels:(const float * const *)channels frameCount:(NSInteger)frameCount {
+    if (_writeError || frameCount <= 0) {
+        return;
+    }
+    if (! _writeBuffer || _writeBuffer.frameCapacity < frameCount) {
+        _writeBuffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:_output.processingFormat frameCapacity:(AVAudioFrameCount)frameCount];
+    }
+    for (NSInteger c = 0; c < _writeBuffer.format.channelCount; c++) {
+        memcpy(_writeBuffer.floatChannelData[c], channels[c], frameCount * sizeof(float));
+    }
+    _writeBuffer.frameLength = (AVAudioFrameCount)frameCount;
+    NSError *error = nil;
+    if (! [_output writeFromBuffer:_writeBuffer error:&error]) {
+        _writeError = error;
+    }
+}
+
+- (void)appendBuffer:(AVAudioPCMBuffer *)buffer {
+    if (_finished) {
+        return;
+    }
+    [_pipeline processChannels:(const float * const *)buffer.floatChannelData frameCount:buffer.frameLength];
+}
+
+- (BOOL)finishWithError:(NSError * __autoreleasing *)error {
+    if (_finished) {
+        return (_writeError == nil);
+    }
+    _finished = YES;
+    [_pipeline finish];
+    
+    // Closing the file flushes it.
+    _pipeline.outputHandler = nil;
+    _output = nil;
+    _writeBuffer = nil;
+    if (_writeError) {
+        if (error) {
+            *error = _writeError;
+        }
+        return NO;
+    }
+    
+    if (_writesOutput && _pipeline.trimsSilence) {
+        return [self trimOutputWithError:error];
+    }
+    return YES;
+}
+
+// Replaces the output with the frames between the start and the end of speech.
+- (BOOL)trimOutputWithError:(NSError * __autoreleasing *)error {
+    NSURL *trimmedURL = [[_outputURL URLByDeletingPathExtension] URLByAppendingPathExtension:[@"trimming." stringByAppendingString:_outputURL.pathExtension]];
+    AVAudioFile *input = [[AVAudioFile alloc] initForReading:_outputURL error:error];
+    if (! input) {
+        return NO;
+    }
+    AVAudioFile *output = [[AVAudioFile alloc] initForWriting:trimmedURL settings:_outputSettings error:error];
+    if (! output) {
+        return NO;
+    }
+    
+    double sampleRate = input.processingFormat.sampleRate;
+    AVAudioFramePosition keepStart = (AVAudioFramePosition)round(_pipeline.speechStartTime * sampleRate);
+    AVAudioFramePosition keepEnd = MIN((AVAudioFramePosition)round(_pipeline.speechEndTime * sampleRate), input.length);
+    AVAudioPCMBuffer *buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:input.processingFormat frameCapacity:ReadFrameCapacity];
+    BOOL ok = YES;
+    input.framePosition = keepStart;
+    while (ok && input.framePosition < keepEnd) {
+        AVAudioFrameCount frameCount = (AVAudioFrameCount)MIN((AVAudioFramePosition)ReadFrameCapacity, keepEnd - input.framePosition);
+        ok = [input readIntoBuffer:buffer frameCount:frameCount error:error];
+        if (! ok || buffer.frameLength == 0) {
+            break;
+        }
+        ok = [output writeFromBuffer:buffer error:error];
+    }
+    output = nil;
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (ok) {
+        ok = [fileManager replaceItemAtURL:_outputURL withItemAtURL:trimmedURL backupItemName:nil options:0 resultingItemURL:NULL error:error];
+    }
+    if (! ok) {
+        [fileManager removeItemAtURL:trimmedURL error:NULL];
+    }
+    return ok;
+}
+
+@end
@@ -50,10 +50,11 @@
  */
 
 #import "ORKAudioGenerator.h"
+#import "ORKAudioSessionCoordinator.h"
 
 @import AudioToolbox;
 
-@interface ORKAudioGenerator () {
+@interface ORKAudioGenerator () <ORKAudioSessionClient> {
     @public
     AudioComponentInstance _toneUnit;
 
@@ -69,7 +70,6 @@
 - (void)setupAudioSession;
 - (void)createToneUnit;
 - (void)play;
-- (void)handleInterruption:(id)sender;
 
 @end
 
@@ -132,8 +132,6 @@ OSStatus ORKAudioGeneratorRenderTone(void *inRefCon,
 - (instancetype)init {
     self = [super init];
     if (self) {
-        [self setupAudioSession];
-        
         // Automatically stop and then restart audio playback when the app resigns active.
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(applicationDidBecomeActive:) name:UIApplicationDidBecomeActiveNotification object:nil];
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(applicationWillResignActive:) name:UIApplicationWillResignActiveNotification object:nil];
@@ -144,6 +142,12 @@ OSStatus ORKAudioGeneratorRenderTone(void *inRefCon,
 - (void)dealloc {
     [self stop];
     
+    // The coordinator no longer sees this generator; let it drop the session if nothing else uses it.
+    ORKAudioSessionCoordinator *coordinator = [ORKAudioSessionCoordinator sharedCoordinator];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [coordinator endUsingSessionForDeallocatedClients];
+    });
+    
     [[NSNotificationCenter defaultCenter] removeObserver:self];
 }
 
@@ -192,6 +196,7 @@ OSStatus ORKAudioGeneratorRenderTone(void *inRefCon,
 
 - (void)play {
     if (!_toneUnit) {
+        [self setupAudioSession];
         [self createToneUnit];
 
         // Stop changing parameters on the unit
@@ -210,19 +215,17 @@ OSStatus ORKAudioGeneratorRenderTone(void *inRefCon,
         AudioUnitUninitialize(_toneUnit);
         AudioComponentInstanceDispose(_toneUnit);
         _toneUnit = nil;
+        [[ORKAudioSessionCoordinator sharedCoordinator] endUsingSessionForClient:self];
     }
 }
 
 - (void)setupAudioSession {
-    AVAudioSession *audioSession = [AVAudioSession sharedInstance];
     BOOL ok;
-    NSError *setCategoryError = nil;
-    ok = [audioSession setCategory:AVAudioSessionCategoryPlayback error:&setCategoryError];
-    NSAssert1(ok, @"Audio error %@", setCategoryError);
-    [[NSNotificationCenter defaultCenter] addObserver:self
-                                             selector:@selector(handleInterruption:)
-                                                 name:AVAudioSessionInterruptionNotification
-                                               object:audioSession];
+    NSError *sessionError = nil;
+    ok = [[ORKAudioSessionCoordinator sharedCoordinator] beginUsingSessionForClient:self
+                                                                            needs:ORKAudioSessionNeedsTonePlayback
+                                                                            error:&sessionError];
+    NSAssert1(ok, @"Audio error %@", sessionError);
 }
 
 - (void)createToneUnit {
@@ -277,7 +280,7 @@ OSStatus ORKAudioGeneratorRenderTone(void *inRefCon,
     NSAssert1(err == noErr, @"Error setting stream format: %hd", err);
 }
 
-- (void)handleInterruption:(id)sender {
+- (void)audioSessionCoordinatorInterruptionDidBegin:(ORKAudioSessionCoordinator *)coordinator {
     [self stop];
 }
 
@@ -62,6 +62,18 @@ ORK_CLASS_AVAILABLE
  */
 @property (nonatomic, copy, readonly) NSDictionary *recorderSettings;
 
+/**
+ The processing applied to the audio as it is recorded.
+ 
+ See `ORKAudioRecorderConfiguration`.
+ */
+@property (nonatomic) ORKAudioProcessingOptions processingOptions;
+
+/**
+ The sample rate of the processed recording, in Hz, or 0 to keep the recorded rate.
+ */
+@property (nonatomic) double processedSampleRate;
+
 /**
  Returns an initialized audio recorder using the specified settings, step, and output directory.
  
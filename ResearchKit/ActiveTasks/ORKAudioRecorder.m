@@ -34,9 +34,11 @@
 #import "ORKRecorder_Internal.h"
 #import "ORKRecorder_Private.h"
 #import "ORKDefines_Private.h"
+#import "ORKAudioSessionCoordinator.h"
+#import "ORKAudioCapturePipeline.h"
 
 
-@interface ORKAudioRecorder ()
+@interface ORKAudioRecorder () <ORKAudioSessionClient>
 
 @property (nonatomic, strong) AVAudioRecorder *audioRecorder;
 
@@ -45,12 +47,30 @@
 @end
 
 
-@implementation ORKAudioRecorder
+// Frames per buffer delivered by the input tap that feeds the capture pipeline.
+static const AVAudioFrameCount CaptureTapBufferSize = 4096;
+
+@implementation ORKAudioRecorder {
+    // With processing options, an input tap feeds the capture pipeline while AVAudioRecorder records.
+    AVAudioEngine *_captureEngine;
+    ORKAudioCaptureWriter *_captureWriter;
+    dispatch_queue_t _captureQueue;
+    
+    // Added to the result's userInfo while a processed recording is reported.
+    NSDictionary *_processingUserInfo;
+}
 
 - (void)dealloc {
     ORK_Log_Debug(@"Remove audiorecorder %p", self);
     [_audioRecorder stop];
     _audioRecorder = nil;
+    [self stopCaptureEngine];
+    
+    // Normally ended when recording stops; the coordinator no longer sees this recorder here.
+    ORKAudioSessionCoordinator *coordinator = [ORKAudioSessionCoordinator sharedCoordinator];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [coordinator endUsingSessionForDeallocatedClients];
+    });
 }
 
 + (NSDictionary *)defaultRecorderSettings {
@@ -75,10 +95,15 @@
             @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"recorderSettings should be a dictionary" userInfo:recorderSettings];
         }
         self.recorderSettings = recorderSettings;
+        _captureQueue = dispatch_queue_create("org.researchkit.audiorecorder.capture", DISPATCH_QUEUE_SERIAL);
     }
     return self;
 }
 
+- (BOOL)processesRecording {
+    return (_processingOptions != ORKAudioProcessingOptionNone || _processedSampleRate > 0);
+}
+
 - (void)start {
     if (self.outputDirectory == nil) {
         @throw [NSException exceptionWithName:NSDestinationInvalidException reason:@"audioRecorder requires an output directory" userInfo:nil];
@@ -94,8 +119,10 @@
         }
         
         
-        AVAudioSession *audioSession = [AVAudioSession sharedInstance];
-        if (! [audioSession setCategory:AVAudioSessionCategoryPlayAndRecord error:&error]) {
+        // Normally a no-op: the task view controller configures the session for recording up front.
+        if (! [[ORKAudioSessionCoordinator sharedCoordinator] beginUsingSessionForClient:self
+                                                                                  needs:ORKAudioSessionNeedsRecording
+                                                                                  error:&error]) {
             [self finishRecordingWithError:error];
             return;
         }
@@ -122,11 +149,84 @@
         [_audioRecorder prepareToRecord];
         [_audioRecorder record];
     }
+    
+    if ([self processesRecording] && ! _captureEngine) {
+        NSError *error = nil;
+        if (! [self startCaptureWithError:&error]) {
+            [self finishRecordingWithError:error];
+            return;
+        }
+    }
 #endif
     [super start];
     
 }
 
+// The processed recording is written next to the recording, and moved over it when recording stops.
+- (NSURL *)processedFileURL {
+    NSURL *fileURL = [self recordingFileURL];
+    return [[fileURL URLByDeletingPathExtension] URLByAppendingPathExtension:[@"processing." stringByAppendingString:fileURL.pathExtension]];
+}
+
+- (BOOL)startCaptureWithError:(NSError * __autoreleasing *)error {
+    AVAudioEngine *engine = [[AVAudioEngine alloc] init];
+    AVAudioInputNode *inputNode = engine.inputNode;
+    AVAudioFormat *format = [inputNode outputFormatForBus:0];
+    NSURL *processedURL = [self processedFileURL];
+    ORKAudioCaptureWriter *writer = [[ORKAudioCaptureWriter alloc] initWithInputFormat:format
+                                                                             outputURL:processedURL
+                                                                              settings:self.recorderSettings
+                                                                               options:_processingOptions
+                                                                      outputSampleRate:_processedSampleRate
+                                                                                 error:error];
+    if (! writer) {
+        return NO;
+    }
+    if (writer.writesOutput) {
+        [self applyFileProtection:ORKFileProtectionCompleteUnlessOpen toFileAtURL:processedURL];
+    }
+    
+    // The tap's buffers are only valid during the block, so they are processed before it returns.
+    dispatch_queue_t queue = _captureQueue;
+    [inputNode installTapOnBus:0 bufferSize:CaptureTapBufferSize format:format block:^(AVAudioPCMBuffer *buffer, AVAudioTime *when) {
+        dispatch_sync(queue, ^{
+            [writer appendBuffer:buffer];
+        });
+    }];
+    if (! [engine startAndReturnError:error]) {
+        [inputNode removeTapOnBus:0];
+        [[NSFileManager defaultManager] removeItemAtURL:processedURL error:NULL];
+        return NO;
+    }
+    _captureEngine = engine;
+    _captureWriter = writer;
+    return YES;
+}
+
+- (void)stopCaptureEngine {
+    if (_captureEngine) {
+        [_captureEngine.inputNode removeTapOnBus:0];
+        [_captureEngine stop];
+        _captureEngine = nil;
+    }
+}
+
+// Takes the capture writer, leaving the recorder free to record again. Buffers still in flight are
+// ignored once the writer is finished on the capture queue.
+- (ORKAudioCaptureWriter *)takeCaptureWriter {
+    ORKAudioCaptureWriter *writer = _captureWriter;
+    _captureWriter = nil;
+    return writer;
+}
+
+// Drops the capture of a recording that failed, with its output.
+- (void)discardCaptureWriter:(ORKAudioCaptureWriter *)writer {
+    dispatch_async(_captureQueue, ^{
+        [writer finishWithError:NULL];
+        [[NSFileManager defaultManager] removeItemAtURL:writer.outputURL error:NULL];
+    });
+}
+
 - (void)stop {
     if (! _audioRecorder) {
         // Error has already been returned.
@@ -140,7 +240,20 @@
         fileUrl = nil;
     }
     
+    // Processing ran during recording, so finishing it here only trims and closes the file.
+    ORKAudioCaptureWriter *writer = [self takeCaptureWriter];
+    if (writer && fileUrl) {
+        __block NSDictionary *processingUserInfo = nil;
+        dispatch_sync(_captureQueue, ^{
+            processingUserInfo = [ORKAudioRecorder finishCaptureWriter:writer replacingFileAtURL:fileUrl];
+        });
+        _processingUserInfo = processingUserInfo;
+    } else if (writer) {
+        [self discardCaptureWriter:writer];
+    }
+    
     [self reportFileResultWithFile:fileUrl error:nil];
+    _processingUserInfo = nil;
     
     [super stop];
 }
@@ -192,14 +305,117 @@
         [self applyFileProtection:ORKFileProtectionComplete toFileAtURL:[self recordingFileURL]];
 #endif
     }
+    [self stopCaptureEngine];
+    [[ORKAudioSessionCoordinator sharedCoordinator] endUsingSessionForClient:self];
 }
 
 - (void)finishRecordingWithError:(NSError *)error {
     [self doStopRecording];
+    ORKAudioCaptureWriter *writer = [self takeCaptureWriter];
+    if (writer) {
+        [self discardCaptureWriter:writer];
+    }
     
     [super finishRecordingWithError:error];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    if (! _captureWriter) {
+        [super stopWithCompletion:completion];
+        return;
+    }
+    
+    [self doStopRecording];
+    ORKAudioCaptureWriter *writer = [self takeCaptureWriter];
+    
+    NSURL *fileURL = [self recordingFileURL];
+    ORKFileResult *result = [[ORKFileResult alloc] initWithIdentifier:self.identifier];
+    result.contentType = [self mimeType];
+    result.userInfo = [self resultUserInfo];
+    result.startDate = self.startDate;
+    result.endDate = [NSDate date];
+    
+    // Point future recording at a new directory now; the capture is finished in the background.
+    [self finishRecordingWithError:nil];
+    [self reset];
+    
+    // Buffers already delivered by the tap are processed first, on the same queue.
+    dispatch_async(_captureQueue, ^{
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        BOOL fileExists = [fileManager fileExistsAtPath:[fileURL path]];
+        NSDictionary *userInfo = nil;
+        if (fileExists) {
+            userInfo = [ORKAudioRecorder finishCaptureWriter:writer replacingFileAtURL:fileURL];
+        } else {
+            [writer finishWithError:NULL];
+            [fileManager removeItemAtURL:writer.outputURL error:NULL];
+        }
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (! fileExists) {
+                NSError *error = [self noDataError];
+                id<ORKRecorderDelegate> localDelegate = self.delegate;
+                if (localDelegate && [localDelegate respondsToSelector:@selector(recorder:didFailWithError:)]) {
+                    [localDelegate recorder:self didFailWithError:error];
+                }
+                if (completion) {
+                    completion(nil, error);
+                }
+                return;
+            }
+            
+            NSMutableDictionary *resultUserInfo = [result.userInfo mutableCopy];
+            [resultUserInfo addEntriesFromDictionary:userInfo];
+            result.userInfo = resultUserInfo;
+            result.fileURL = fileURL;
+            if (completion) {
+                completion(result, nil);
+            }
+        });
+    });
+}
+
+// Finishes the capture that ran during recording and, if it wrote output, moves that over the
+// recording. Returns the entries to add to the result's userInfo. On failure the recording is
+// left as recorded.
++ (NSDictionary *)finishCaptureWriter:(ORKAudioCaptureWriter *)writer replacingFileAtURL:(NSURL *)fileURL {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSError *error = nil;
+    if (! [writer finishWithError:&error]) {
+        ORK_Log_Debug(@"Could not process audio recording %@: %@", fileURL, error);
+        [fileManager removeItemAtURL:writer.outputURL error:NULL];
+        return @{};
+    }
+    
+    ORKAudioCapturePipeline *pipeline = writer.pipeline;
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
+    if (writer.writesOutput) {
+        if (! [fileManager replaceItemAtURL:fileURL withItemAtURL:writer.outputURL backupItemName:nil options:0 resultingItemURL:NULL error:&error]) {
+            ORK_Log_Debug(@"Could not replace audio recording %@: %@", fileURL, error);
+            [fileManager removeItemAtURL:writer.outputURL error:NULL];
+        } else {
+            [fileManager setAttributes:@{NSFileProtectionKey : ORKFileProtectionFromMode(ORKFileProtectionComplete)} ofItemAtPath:[fileURL path] error:NULL];
+            if (pipeline.trimsSilence) {
+                userInfo[ORKAudioRecorderTrimmedLeadingDurationKey] = @(pipeline.speechStartTime);
+            }
+        }
+    }
+    if (pipeline.voiceFeatures) {
+        userInfo[ORKAudioRecorderVoiceFeaturesKey] = pipeline.voiceFeatures;
+    }
+    return userInfo;
+}
+
+- (NSDictionary *)resultUserInfo {
+    NSDictionary *userInfo = [super resultUserInfo];
+    if (_processingUserInfo.count > 0) {
+        NSMutableDictionary *mutableUserInfo = [userInfo mutableCopy];
+        [mutableUserInfo addEntriesFromDictionary:_processingUserInfo];
+        userInfo = [mutableUserInfo copy];
+    }
+    return userInfo;
+}
+
 - (NSString *)extension {
     NSDictionary *recorderSettings = [self recorderSettings];
     unsigned int recorderFormat = [recorderSettings[AVFormatIDKey] unsignedIntValue];
@@ -260,6 +476,7 @@
 - (void)reset {
     [_audioRecorder stop];
     _audioRecorder = nil;
+    [self stopCaptureEngine];
     [super reset];
 }
 
@@ -294,16 +511,21 @@
 
 - (ORKRecorder *)recorderForStep:(ORKStep *)step
                  outputDirectory:(NSURL *)outputDirectory {
-    return [[ORKAudioRecorder alloc] initWithIdentifier:self.identifier
-                                       recorderSettings:self.recorderSettings
-                                                   step:step
-                                        outputDirectory:outputDirectory];
+    ORKAudioRecorder *recorder = [[ORKAudioRecorder alloc] initWithIdentifier:self.identifier
+                                                             recorderSettings:self.recorderSettings
+                                                                         step:step
+                                                              outputDirectory:outputDirectory];
+    recorder.processingOptions = self.processingOptions;
+    recorder.processedSampleRate = self.processedSampleRate;
+    return recorder;
 }
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
     self = [super initWithCoder:aDecoder];
     if (self) {
         ORK_DECODE_OBJ_CLASS(aDecoder, recorderSettings, NSDictionary);
+        ORK_DECODE_INTEGER(aDecoder, processingOptions);
+        ORK_DECODE_DOUBLE(aDecoder, processedSampleRate);
     }
     return self;
 }
@@ -311,6 +533,8 @@
 - (void)encodeWithCoder:(NSCoder *)aCoder {
     [super encodeWithCoder:aCoder];
     ORK_ENCODE_OBJ(aCoder, recorderSettings);
+    ORK_ENCODE_INTEGER(aCoder, processingOptions);
+    ORK_ENCODE_DOUBLE(aCoder, processedSampleRate);
 }
 
 + (BOOL)supportsSecureCoding {
@@ -322,7 +546,9 @@
     
     __typeof(self) castObject = object;
     return (isParentSame &&
-            ORKEqualObjects(self.recorderSettings, castObject.recorderSettings));
+            ORKEqualObjects(self.recorderSettings, castObject.recorderSettings) &&
+            self.processingOptions == castObject.processingOptions &&
+            self.processedSampleRate == castObject.processedSampleRate);
 }
 
 - (ORKPermissionMask)requestedPermissionMask {
@@ -0,0 +1,94 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ORKClock;
+@class ORKContinuousRecordingSession;
+@class ORKFileResult;
+@class ORKRecorder;
+@class ORKStep;
+
+@protocol ORKContinuousRecordingSessionDelegate <NSObject>
+
+// Called once per step in the range of a recorder, when that recorder stops.
+- (void)continuousRecordingSession:(ORKContinuousRecordingSession *)session didProduceResult:(ORKFileResult *)result forStepIdentifier:(NSString *)stepIdentifier;
+
+- (void)continuousRecordingSession:(ORKContinuousRecordingSession *)session didFailWithError:(NSError *)error;
+
+@end
+
+
+/*
+ Runs the continuous recorders of a task (see `ORKContinuousRecorderConfiguration`).
+ 
+ The task view controller reports each step transition. A recorder is started on the
+ first step in its range and keeps running, with boundary markers written at each
+ transition, until a step outside its range is presented or the session is finished.
+ The single log is then reported back as one virtual slice per step.
+ */
+@interface ORKContinuousRecordingSession : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithConfigurations:(NSArray *)configurations outputDirectory:(nullable NSURL *)outputDirectory NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, copy, readonly) NSArray *configurations;
+
+@property (nonatomic, copy, readonly, nullable) NSURL *outputDirectory;
+
+@property (nonatomic, weak, nullable) id<ORKContinuousRecordingSessionDelegate> delegate;
+
+// Shared with the recorders, and used for slice boundaries. Defaults to a clock anchored at creation.
+@property (nonatomic, strong, null_resettable) ORKClock *clock;
+
+// Recorders that are currently running.
+@property (nonatomic, copy, readonly) NSArray *recorders;
+
+// Passed on to recorders as they start; see `-[ORKRecorder countsDroppedSamples]`.
+@property (nonatomic) BOOL countsDroppedSamples;
+
+- (void)stepWillStart:(ORKStep *)step;
+
+- (void)stepDidFinish:(ORKStep *)step;
+
+/*
+ Stops all recorders. The session can be reused afterwards. `completion` is called on the main
+ queue once the stopped recorders have finished their files and their results have been reported.
+ */
+- (void)finishWithCompletion:(nullable dispatch_block_t)completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
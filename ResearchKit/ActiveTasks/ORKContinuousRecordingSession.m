@@ -0,0 +1,288 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKContinuousRecordingSession.h"
+#import "ORKRecorder_Internal.h"
+#import "ORKRecorder_Private.h"
+#import "ORKResult.h"
+#import "ORKStep.h"
+#import "ORKHelpers.h"
+#import "ORKDefines_Private.h"
+#import "ORKClock.h"
+
+
+static NSString *const ORKStepBoundaryStart = @"start";
+static NSString *const ORKStepBoundaryEnd = @"end";
+
+
+@interface ORKContinuousRecordingSlice : NSObject
+
+@property (nonatomic, copy) NSString *stepIdentifier;
+@property (nonatomic, copy) NSDate *startDate;
+@property (nonatomic, copy, nullable) NSDate *endDate;
+@property (nonatomic) NSTimeInterval startUptime;
+@property (nonatomic) NSTimeInterval endUptime;
+
+@end
+
+
+@implementation ORKContinuousRecordingSlice
+
+@end
+
+
+@interface ORKContinuousRecordingEntry : NSObject
+
+@property (nonatomic, strong) ORKContinuousRecorderConfiguration *configuration;
+@property (nonatomic, strong, nullable) ORKRecorder *recorder;
+@property (nonatomic, strong) NSMutableArray *slices;
+@property (nonatomic, strong, nullable) ORKContinuousRecordingSlice *currentSlice;
+
+@end
+
+
+@implementation ORKContinuousRecordingEntry
+
+@end
+
+
+@interface ORKContinuousRecordingSession () <ORKRecorderDelegate>
+
+@end
+
+
+@implementation ORKContinuousRecordingSession {
+    NSArray *_entries;
+}
+
+- (instancetype)initWithConfigurations:(NSArray *)configurations outputDirectory:(NSURL *)outputDirectory {
+    self = [super init];
+    if (self) {
+        _configurations = [configurations copy];
+        _outputDirectory = [outputDirectory copy];
+        
+        NSMutableArray *entries = [NSMutableArray arrayWithCapacity:configurations.count];
+        for (ORKContinuousRecorderConfiguration *configuration in configurations) {
+            ORKContinuousRecordingEntry *entry = [ORKContinuousRecordingEntry new];
+            entry.configuration = configuration;
+            entry.slices = [NSMutableArray array];
+            [entries addObject:entry];
+        }
+        _entries = [entries copy];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (ORKContinuousRecordingEntry *entry in _entries) {
+        entry.recorder.delegate = nil;
+        [entry.recorder stop];
+    }
+}
+
+- (ORKClock *)clock {
+    if (! _clock) {
+        _clock = [ORKClock new];
+    }
+    return _clock;
+}
+
+- (NSArray *)recorders {
+    NSMutableArray *recorders = [NSMutableArray array];
+    for (ORKContinuousRecordingEntry *entry in _entries) {
+        if (entry.recorder) {
+            [recorders addObject:entry.recorder];
+        }
+    }
+    return [recorders copy];
+}
+
+- (void)stepWillStart:(ORKStep *)step {
+    NSString *stepIdentifier = step.identifier;
+    NSTimeInterval uptime = [self.clock currentUptime];
+    NSDate *date = [NSDate date];
+    
+    for (ORKContinuousRecordingEntry *entry in _entries) {
+        if (! [entry.configuration includesStepWithIdentifier:stepIdentifier]) {
+            [self stopEntry:entry group:nil];
+            continue;
+        }
+        
+        if (entry.currentSlice) {
+            [self closeSliceOfEntry:entry uptime:uptime date:date];
+        }
+        
+        ORKContinuousRecordingSlice *slice = [ORKContinuousRecordingSlice new];
+        slice.stepIdentifier = stepIdentifier;
+        slice.startUptime = uptime;
+        slice.startDate = date;
+        [entry.slices addObject:slice];
+        entry.currentSlice = slice;
+        
+        if (! entry.recorder) {
+            ORKRecorderConfiguration *recorderConfiguration = entry.configuration.recorderConfiguration;
+            ORKRecorder *recorder = [recorderConfiguration recorderForStep:step outputDirectory:_outputDirectory];
+            recorder.configuration = recorderConfiguration;
+            recorder.clock = self.clock;
+            recorder.delegate = self;
+            recorder.countsDroppedSamples = _countsDroppedSamples;
+            entry.recorder = recorder;
+            [recorder start];
+        }
+        
+        NSError *error = nil;
+        if (! [entry.recorder appendStepBoundary:ORKStepBoundaryStart stepIdentifier:stepIdentifier uptime:uptime error:&error]) {
+            ORK_Log_Debug(@"Could not mark start of step %@: %@", stepIdentifier, error);
+        }
+    }
+}
+
+- (void)stepDidFinish:(ORKStep *)step {
+    NSTimeInterval uptime = [self.clock currentUptime];
+    NSDate *date = [NSDate date];
+    
+    for (ORKContinuousRecordingEntry *entry in _entries) {
+        if ([entry.currentSlice.stepIdentifier isEqualToString:step.identifier]) {
+            [self closeSliceOfEntry:entry uptime:uptime date:date];
+        }
+    }
+}
+
+- (void)finishWithCompletion:(dispatch_block_t)completion {
+    dispatch_group_t group = dispatch_group_create();
+    for (ORKContinuousRecordingEntry *entry in _entries) {
+        [self stopEntry:entry group:group];
+    }
+    if (completion) {
+        dispatch_group_notify(group, dispatch_get_main_queue(), completion);
+    }
+}
+
+- (void)closeSliceOfEntry:(ORKContinuousRecordingEntry *)entry uptime:(NSTimeInterval)uptime date:(NSDate *)date {
+    ORKContinuousRecordingSlice *slice = entry.currentSlice;
+    slice.endUptime = uptime;
+    slice.endDate = date;
+    entry.currentSlice = nil;
+    
+    NSError *error = nil;
+    if (! [entry.recorder appendStepBoundary:ORKStepBoundaryEnd stepIdentifier:slice.stepIdentifier uptime:uptime error:&error]) {
+        ORK_Log_Debug(@"Could not mark end of step %@: %@", slice.stepIdentifier, error);
+    }
+}
+
+- (void)stopEntry:(ORKContinuousRecordingEntry *)entry group:(dispatch_group_t)group {
+    ORKRecorder *recorder = entry.recorder;
+    if (! recorder) {
+        return;
+    }
+    if (entry.currentSlice) {
+        NSTimeInterval uptime = [self.clock currentUptime];
+        [self closeSliceOfEntry:entry uptime:uptime date:[NSDate date]];
+    }
+    
+    // Recorders that stop synchronously report through the delegate before this returns, while the
+    // entry still knows them. The others finish their files in the background and report here.
+    NSArray *slices = [entry.slices copy];
+    if (group) {
+        dispatch_group_enter(group);
+    }
+    [recorder stopWithCompletion:^(ORKResult *result, NSError *error) {
+        recorder.delegate = nil;
+        ORKFileResult *fileResult = ORKDynamicCast(result, ORKFileResult);
+        if (fileResult) {
+            [self reportResult:fileResult forSlices:slices];
+        } else if (error) {
+            STRONGTYPE(self.delegate) strongDelegate = self.delegate;
+            [strongDelegate continuousRecordingSession:self didFailWithError:error];
+        }
+        if (group) {
+            dispatch_group_leave(group);
+        }
+    }];
+    if (entry.recorder == recorder) {
+        entry.recorder = nil;
+    }
+    [entry.slices removeAllObjects];
+}
+
+- (void)reportResult:(ORKFileResult *)fileResult forSlices:(NSArray *)slices {
+    STRONGTYPE(self.delegate) strongDelegate = self.delegate;
+    for (ORKContinuousRecordingSlice *slice in slices) {
+        ORKFileResult *sliceResult = [fileResult copy];
+        sliceResult.startDate = slice.startDate;
+        sliceResult.endDate = slice.endDate;
+        
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:fileResult.userInfo ? : @{}];
+        userInfo[ORKContinuousRecorderStepIdentifierKey] = slice.stepIdentifier;
+        userInfo[ORKContinuousRecorderSliceStartUptimeKey] = @(slice.startUptime);
+        userInfo[ORKContinuousRecorderSliceEndUptimeKey] = @(slice.endUptime);
+        sliceResult.userInfo = userInfo;
+        
+        [strongDelegate continuousRecordingSession:self didProduceResult:sliceResult forStepIdentifier:slice.stepIdentifier];
+    }
+}
+
+- (ORKContinuousRecordingEntry *)entryForRecorder:(ORKRecorder *)recorder {
+    for (ORKContinuousRecordingEntry *entry in _entries) {
+        if (entry.recorder == recorder) {
+            return entry;
+        }
+    }
+    return nil;
+}
+
+#pragma mark - ORKRecorderDelegate
+
+- (void)recorder:(ORKRecorder *)recorder didCompleteWithResult:(ORKResult *)result {
+    ORKContinuousRecordingEntry *entry = [self entryForRecorder:recorder];
+    ORKFileResult *fileResult = ORKDynamicCast(result, ORKFileResult);
+    if (! entry || ! fileResult) {
+        return;
+    }
+    
+    [self reportResult:fileResult forSlices:entry.slices];
+    [entry.slices removeAllObjects];
+}
+
+- (void)recorder:(ORKRecorder *)recorder didFailWithError:(NSError *)error {
+    ORKContinuousRecordingEntry *entry = [self entryForRecorder:recorder];
+    if (! entry) {
+        return;
+    }
+    entry.recorder = nil;
+    entry.currentSlice = nil;
+    [entry.slices removeAllObjects];
+    
+    STRONGTYPE(self.delegate) strongDelegate = self.delegate;
+    [strongDelegate continuousRecordingSession:self didFailWithError:error];
+}
+
+@end
@@ -149,6 +149,37 @@ ORK_CLASS_AVAILABLE
 /// Forces a roll-over now.
 - (void)finishCurrentLog;
 
+/**
+ Forces a roll-over now, and returns the URL of the file that was finished.
+ 
+ @param error   Any error that occurred while finishing the file.
+ 
+ @return The URL of the finished log file, or `nil` if the current log was empty or could not be finished.
+ */
+- (nullable NSURL *)finishCurrentLogWithError:(NSError * __autoreleasing *)error;
+
+/**
+ Forces a roll-over without blocking the caller.
+ 
+ The completion handler is called on the logger's internal queue once the file has been
+ synchronized and renamed. All data appended before this call is included in the file.
+ 
+ @param completion  The block to call with the URL of the finished log file, or `nil` and an error.
+ */
+- (void)finishCurrentLogWithCompletion:(void (^)(NSURL * __nullable fileUrl, NSError * __nullable error))completion;
+
+/**
+ Creates and opens the current log file ahead of the first append.
+ 
+ Use this method to move file creation and file protection setup out of the first call
+ to `append:error:`. An opened log that receives no objects is discarded when it is finished.
+ 
+ @param error   Any error that occurred while creating the file.
+ 
+ @return `YES` if the current log file is open; otherwise, `NO`.
+ */
+- (BOOL)openCurrentLogWithError:(NSError * __autoreleasing *)error;
+
 /// The current log file's location.
 - (NSURL *)currentLogFileURL;
 
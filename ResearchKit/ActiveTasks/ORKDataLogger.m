@@ -37,6 +37,7 @@
 #import "HKSample+ORKJSONDictionary.h"
 #import "CMMotionActivity+ORKJSONDictionary.h"
 #import "ORKDefines_Private.h"
+#import "ORKTraceBuffer_Internal.h"
 
 
 static const char * kORKDataLoggerUploadedAttr = "com.apple.ResearchKit.uploaded";
@@ -394,6 +395,7 @@ static NSInteger _ORKJSON_terminatorLength = 0;
     // Serialize each object separately to the buffer, pending a single write, so the
     // objects form part of a single array.
     __block BOOL success = YES;
+    ORK_TRACE_BEGIN("logger", "serialize");
     [objects enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop) {
         NSData *data = [NSJSONSerialization dataWithJSONObject:obj options:(NSJSONWritingOptions)0 error:error];
         if (!data) {
@@ -406,6 +408,7 @@ static NSInteger _ORKJSON_terminatorLength = 0;
             }
         }
     }];
+    ORK_TRACE_END_VALUE("logger", "serialize", outputData.length);
     if (! success) {
         return success;
     }
@@ -551,6 +554,40 @@ static NSInteger _ORKJSON_terminatorLength = 0;
     });
 }
 
+- (NSURL *)finishCurrentLogWithError:(NSError * __autoreleasing *)error {
+    __block NSURL *fileUrl = nil;
+    dispatch_sync(_queue, ^{
+        fileUrl = [self queue_closeAndRenameLogWithError:error];
+    });
+    return fileUrl;
+}
+
+- (void)finishCurrentLogWithCompletion:(void (^)(NSURL *fileUrl, NSError *error))completion {
+    if (!completion) {
+        @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Completion parameter is required" userInfo:nil];
+    }
+    
+    dispatch_async(_queue, ^{
+        ORK_TRACE_BEGIN("logger", "finish");
+        NSError *error = nil;
+        NSURL *fileUrl = [self queue_closeAndRenameLogWithError:&error];
+        ORK_TRACE_END("logger", "finish");
+        completion(fileUrl, error);
+    });
+}
+
+- (BOOL)openCurrentLogWithError:(NSError * __autoreleasing *)error {
+    __block BOOL success = NO;
+    dispatch_sync(_queue, ^{
+        if (! _currentFileHandle) {
+            _currentFileHandle = [self queue_makeFileHandleWritingHeader:NO error:error];
+            [_currentFileHandle seekToEndOfFile];
+        }
+        success = (_currentFileHandle != nil);
+    });
+    return success;
+}
+
 - (NSURL *)currentLogFileURL {
     return [_url URLByAppendingPathComponent:_logName];
 }
@@ -687,6 +724,7 @@ static NSInteger _ORKJSON_terminatorLength = 0;
         keys = @[NSURLFileSizeKey, NSURLPathKey, NSURLIsRegularFileKey];
     });
     
+    ORK_TRACE_BEGIN("logger", "scan");
     NSFileManager *manager = [NSFileManager defaultManager];
     NSEnumerator *enumerator = [manager enumeratorAtURL:_url
                              includingPropertiesForKeys:@[]
@@ -715,6 +753,7 @@ static NSInteger _ORKJSON_terminatorLength = 0;
         }
         [urls addObject:url];
     }
+    ORK_TRACE_END_VALUE("logger", "scan", urls.count);
     
     if (! errorOut) {
         // Sort the URLs before beginning enumeration for the caller
@@ -753,6 +792,11 @@ static NSInteger _ORKJSON_terminatorLength = 0;
 }
 
 - (NSFileHandle *)queue_makeFileHandleWithError:(NSError * __autoreleasing *)error {
+    return [self queue_makeFileHandleWritingHeader:YES error:error];
+}
+
+// Without the header, a new file stays empty until the first append, so it is still discarded if nothing is logged.
+- (NSFileHandle *)queue_makeFileHandleWritingHeader:(BOOL)writeHeader error:(NSError * __autoreleasing *)error {
     NSFileManager *fileManager = [NSFileManager defaultManager];
     NSURL *url = [self currentLogFileURL];
     
@@ -796,7 +840,9 @@ static NSInteger _ORKJSON_terminatorLength = 0;
         BOOL success = [fileManager setAttributes:@{NSFileProtectionKey : ORKFileProtectionFromMode(self.fileProtectionMode)} ofItemAtPath:[url path] error:error];
         
         // Allow formatter to initialize the log file with header content
-        success = success && [self.logFormatter beginLogWithFileHandle:fileHandle error:error];
+        if (writeHeader) {
+            success = success && [self.logFormatter beginLogWithFileHandle:fileHandle error:error];
+        }
         
         if (!success) {
             [fileHandle closeFile];
@@ -841,12 +887,20 @@ static NSInteger _ORKJSON_terminatorLength = 0;
 }
 
 - (void)queue_closeAndRenameLog {
+    [self queue_closeAndRenameLogWithError:nil];
+}
+
+// Returns the URL the log was renamed to, or nil if there was nothing to finish.
+- (NSURL *)queue_closeAndRenameLogWithError:(NSError * __autoreleasing *)error {
     NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSURL *finishedUrl = nil;
     NSURL *url = [self currentLogFileURL];
     
     // Close any existing file handle
     if (_currentFileHandle) {
+        ORK_TRACE_BEGIN("logger", "sync");
         [_currentFileHandle synchronizeFile];
+        ORK_TRACE_END("logger", "sync");
         [_currentFileHandle closeFile];
         _currentFileHandle = nil;
     }
@@ -858,13 +912,16 @@ static NSInteger _ORKJSON_terminatorLength = 0;
         if ([params[NSURLFileSizeKey] intValue] > 0) {
             NSURL *destinationUrl = [ORKDataLogger nextUrlForDirectoryUrl:_url logName:_logName];
             ORK_Log_Debug(@"Rollover: %@ to %@", [url lastPathComponent], [destinationUrl lastPathComponent]);
-            [fileManager moveItemAtURL:url toURL:destinationUrl error:nil];
+            if (! [fileManager moveItemAtURL:url toURL:destinationUrl error:error]) {
+                return nil;
+            }
+            finishedUrl = destinationUrl;
             if (self.fileProtectionMode == ORKFileProtectionCompleteUnlessOpen) {
                 // Upgrade to complete file protection after roll-over
-                NSError *error = nil;
+                NSError *protectionError = nil;
                 if (! [fileManager setAttributes:@{NSFileProtectionKey : NSFileProtectionComplete}
-                           ofItemAtPath:[destinationUrl path] error:&error]) {
-                    ORK_Log_Debug(@"Error setting NSFileProtectionComplete on %@: %@", destinationUrl, error);
+                           ofItemAtPath:[destinationUrl path] error:&protectionError]) {
+                    ORK_Log_Debug(@"Error setting NSFileProtectionComplete on %@: %@", destinationUrl, protectionError);
                 }
             }
             
@@ -877,6 +934,7 @@ static NSInteger _ORKJSON_terminatorLength = 0;
             [fileManager removeItemAtURL:url error:nil];
         }
     }
+    return finishedUrl;
 }
 
 - (void)queue_rolloverIfNeeded {
@@ -898,7 +956,9 @@ static NSInteger _ORKJSON_terminatorLength = 0;
 }
 
 - (void)queue_rollover {
+    ORK_TRACE_BEGIN("logger", "rollover");
     [self queue_closeAndRenameLog];
+    ORK_TRACE_END("logger", "rollover");
 }
 
 - (BOOL)queue_append:(id)object error:(NSError * __autoreleasing *)error {
@@ -909,7 +969,9 @@ static NSInteger _ORKJSON_terminatorLength = 0;
         return NO;
     }
     
+    ORK_TRACE_BEGIN("logger", "append");
     BOOL result = [self.logFormatter appendObject:object fileHandle:_currentFileHandle error:error];
+    ORK_TRACE_END_VALUE("logger", "append", 1);
     
     // Quick check to see if we've run over the maximum log file size
     if ((self.maximumCurrentLogFileSize > 0) && ([_currentFileHandle offsetInFile] >= self.maximumCurrentLogFileSize)) {
@@ -927,7 +989,9 @@ static NSInteger _ORKJSON_terminatorLength = 0;
         return NO;
     }
     
+    ORK_TRACE_BEGIN("logger", "append");
     BOOL result = [self.logFormatter appendObjects:objects fileHandle:_currentFileHandle error:error];
+    ORK_TRACE_END_VALUE("logger", "append", objects.count);
     
     // Quick check to see if we've run over the maximum log file size
     if ((self.maximumCurrentLogFileSize > 0) && ([_currentFileHandle offsetInFile] >= self.maximumCurrentLogFileSize)) {
@@ -1339,6 +1403,7 @@ static NSInteger _ORKJSON_terminatorLength = 0;
 }
 
 - (void)queue_updateBytes {
+    ORK_TRACE_INSTANT("loggerManager", "updateBytes");
     unsigned long long pending = 0;
     unsigned long long uploaded = 0;
     for (ORKDataLogger *logger in [_records allValues]) {
@@ -34,17 +34,27 @@
 #import "ORKActiveStepView.h"
 #import "ORKDeviceMotionReactionTimeContentView.h"
 #import "ORKDeviceMotionReactionTimeStep.h"
+#import "ORKDeviceMotionRecorder.h"
+#import "ORKMotionHub.h"
+#import "ORKMotionThresholdDetector.h"
+#import "ORKHelpers.h"
+#import "ORKStimulusScheduler.h"
 #import <CoreMotion/CMDeviceMotion.h>
 #import <AudioToolbox/AudioServices.h>
+#import <QuartzCore/QuartzCore.h>
 
 
 @implementation ORKDeviceMotionReactionTimeViewController {
     
     ORKDeviceMotionReactionTimeContentView *_reactionTimeContentView;
     NSMutableArray *_results;
-    NSTimer *_stimulusTimer;
+    ORKStimulusScheduler *_stimulusScheduler;
     NSTimer *_timeoutTimer;
     NSTimeInterval _stimulusTimestamp;
+    NSTimeInterval _stimulusTimestampUncertainty;
+    ORKMotionThresholdDetector *_detector;
+    ORKMotionHubSubscription *_detectionSubscription;
+    ORKMotionThresholdDetection *_detection;
     BOOL _validResult;
     BOOL _timedOut;
     BOOL _shouldIndicateFailure;
@@ -52,12 +62,20 @@
 
 static const NSTimeInterval OutcomeAnimationDuration = 0.3;
 
+static const double DefaultDetectionFrequency = 100;
+
+- (void)dealloc {
+    [self stopMotionDetection];
+    [_stimulusScheduler cancelAllStimuli];
+}
+
 #pragma mark - UIViewController
 
 - (void)viewDidLoad {
     [super viewDidLoad];
     // Do any additional setup after loading the view.
     _results = [@[] mutableCopy];
+    _stimulusScheduler = [ORKStimulusScheduler new];
     _reactionTimeContentView = [ORKDeviceMotionReactionTimeContentView new];
     self.activeStepView.activeCustomView = _reactionTimeContentView;
     [_reactionTimeContentView setStimulusHidden:true];
@@ -73,12 +91,15 @@ static const NSTimeInterval OutcomeAnimationDuration = 0.3;
 - (void)viewWillDisappear:(BOOL)animated {
     [super viewWillDisappear:animated];
     _shouldIndicateFailure = false;
+    [self stopMotionDetection];
+    [_stimulusScheduler cancelAllStimuli];
 }
 
 #pragma mark - ORKActiveStepViewController
 
 - (void) start {
     [super start];
+    [self startMotionDetection];
     [self startStimulusTimer];
 }
 
@@ -91,8 +112,9 @@ static const NSTimeInterval OutcomeAnimationDuration = 0.3;
 - (void)applicationWillResignActive:(NSNotification *)notification {
     [super applicationWillResignActive:notification];
     _validResult = false;
-    [_stimulusTimer invalidate];
+    [_stimulusScheduler cancelAllStimuli];
     [_timeoutTimer invalidate];
+    [self stopMotionDetection];
 }
 
 - (void)applicationDidBecomeActive:(NSNotification *)notification {
@@ -103,25 +125,86 @@ static const NSTimeInterval OutcomeAnimationDuration = 0.3;
 #pragma mark - ORKRecorderDelegate
 
 - (void)recorder:(ORKRecorder *)recorder didCompleteWithResult:(ORKResult *)result {
-    if (_validResult) {
+    NSTimeInterval reactionTime = _detection.crossingUptime - _stimulusTimestamp;
+    if (_validResult && _detection && reactionTime < 0) {
+        // Movement started before the stimulus reached the screen.
+        _validResult = false;
+    }
+    if (_validResult && _detection) {
         ORKDeviceMotionReactionTimeResult *rtResult = [[ORKDeviceMotionReactionTimeResult alloc] initWithIdentifier: self.step.identifier];
         rtResult.timestamp = _stimulusTimestamp;
+        rtResult.reactionTime = reactionTime;
+        rtResult.reactionTimeUncertainty = _detection.uncertainty + _stimulusTimestampUncertainty;
         rtResult.fileResult = (ORKFileResult *) result;
         [_results addObject: rtResult];
     }
     [self attemptDidFinish];
 }
 
-#pragma mark - ORKDeviceMotionRecorderDelegate
+#pragma mark - Motion detection
 
-- (void)deviceMotionRecorderDidUpdateWithMotion:(CMDeviceMotion *)motion {
-    CMAcceleration ua = motion.userAcceleration;
-    double vectormag = sqrt(((ua.x * ua.x) + (ua.y * ua.y) + (ua.z * ua.z)));
-    if (vectormag > [self reactionTimeStep].thresholdAcceleration) {
-        for (ORKRecorder *r in self.recorders) {
-            [r stop];
+- (double)detectionFrequency {
+    for (ORKRecorder *recorder in self.recorders) {
+        if ([recorder isKindOfClass:[ORKDeviceMotionRecorder class]]) {
+            return [(ORKDeviceMotionRecorder *)recorder frequency];
         }
     }
+    return DefaultDetectionFrequency;
+}
+
+/*
+ Threshold detection runs on the motion hub's delivery queue, next to the sensor, instead of
+ waiting for the recorder's main-queue delegate callbacks. Only the single detection per
+ attempt hops to the main queue.
+ */
+- (void)startMotionDetection {
+    [self stopMotionDetection];
+    _detection = nil;
+    
+    double frequency = [self detectionFrequency];
+    ORKMotionThresholdDetector *detector = [[ORKMotionThresholdDetector alloc] initWithThreshold:[self reactionTimeStep].thresholdAcceleration
+                                                                                  sampleInterval:1.0 / frequency];
+    _detector = detector;
+    
+    __weak __typeof(self) weakSelf = self;
+    NSError *error = nil;
+    _detectionSubscription = [[ORKMotionHub sharedHub] subscribeToSensor:ORKMotionSensorDeviceMotion
+                                                               frequency:frequency
+                                                                 handler:^(CMLogItem *sample, NSError *sampleError) {
+        if (! sample || detector.detected) {
+            return;
+        }
+        CMDeviceMotion *motion = (CMDeviceMotion *)sample;
+        ORKMotionThresholdDetection *detection = [detector processAcceleration:motion.userAcceleration timestamp:motion.timestamp];
+        if (detection) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [weakSelf detector:detector didDetect:detection];
+            });
+        }
+    } error:&error];
+    
+    if (! _detectionSubscription) {
+        ORK_Log_Debug(@"Reaction time motion detection unavailable: %@", error);
+    }
+}
+
+- (void)stopMotionDetection {
+    if (_detectionSubscription) {
+        [[ORKMotionHub sharedHub] removeSubscription:_detectionSubscription];
+        _detectionSubscription = nil;
+    }
+}
+
+- (void)detector:(ORKMotionThresholdDetector *)detector didDetect:(ORKMotionThresholdDetection *)detection {
+    // Ignore detections from an earlier attempt that were already in flight.
+    if (detector != _detector || _detection) {
+        return;
+    }
+    _detection = detection;
+    [self stopMotionDetection];
+    for (ORKRecorder *r in self.recorders) {
+        [r stop];
+    }
 }
 
 #pragma mark - ORKReactionTimeStepViewController
@@ -143,8 +226,10 @@ static const NSTimeInterval OutcomeAnimationDuration = 0.3;
     _validResult ? [self indicateSuccess:completion] : [self indicateFailure:completion];
     _validResult = false;
     _timedOut = false;
-    [_stimulusTimer invalidate];
+    [_stimulusScheduler cancelAllStimuli];
     [_timeoutTimer invalidate];
+    [self stopMotionDetection];
+    _detector = nil;
 }
 
 - (void)indicateSuccess:(void(^)(void)) completion {
@@ -170,12 +255,17 @@ static const NSTimeInterval OutcomeAnimationDuration = 0.3;
 }
 
 - (void)startStimulusTimer {
-    _stimulusTimer = [NSTimer scheduledTimerWithTimeInterval: [self stimulusInterval] target:self selector:@selector(stimulusTimerDidFire) userInfo:nil repeats:NO];
+    __weak __typeof(self) weakSelf = self;
+    [_stimulusScheduler scheduleStimulusAtTime:CACurrentMediaTime() + [self stimulusInterval] handler:^(CFTimeInterval presentationTime, CFTimeInterval frameDuration) {
+        [weakSelf stimulusDidPresentAtTime:presentationTime frameDuration:frameDuration];
+    }];
 }
 
-- (void)stimulusTimerDidFire {
-    _stimulusTimestamp = [NSProcessInfo processInfo].systemUptime;
+- (void)stimulusDidPresentAtTime:(CFTimeInterval)presentationTime frameDuration:(CFTimeInterval)frameDuration {
+    // Committed on this refresh, so visible when the frame completes; one frame bounds the error.
     [_reactionTimeContentView setStimulusHidden:false];
+    _stimulusTimestamp = presentationTime;
+    _stimulusTimestampUncertainty = frameDuration;
     _validResult = true;
     [self startTimeoutTimer];
 }
@@ -34,17 +34,19 @@
 #import "ORKRecorder_Internal.h"
 #import "ORKRecorder_Private.h"
 #import "ORKDataLogger.h"
+#import "ORKMotionHub.h"
 #import <CoreMotion/CoreMotion.h>
 #import "CMDeviceMotion+ORKJSONDictionary.h"
 
 
 @interface ORKDeviceMotionRecorder () {
     ORKDataLogger *_logger;
+    ORKMotionHubSubscription *_subscription;
 }
 
-@property (nonatomic, strong) CMMotionManager *motionManager;
+@property (nonatomic, strong) ORKMotionHub *motionHub;
 
-@property (nonatomic) NSTimeInterval uptime;
+@property (atomic) BOOL armed;
 
 @end
 
@@ -66,6 +68,9 @@
 }
 
 - (void)dealloc {
+    if (_subscription) {
+        [_motionHub removeSubscription:_subscription];
+    }
     [_logger finishCurrentLog];
 }
 
@@ -77,8 +82,38 @@
     }
 }
 
+// Subclasses may return a dedicated motion manager (for instance, for testing).
+// By default, the recorder shares the process-wide motion hub.
 - (CMMotionManager *)createMotionManager {
-    return [[CMMotionManager alloc] init];
+    return nil;
+}
+
+- (ORKMotionHub *)createMotionHub {
+    CMMotionManager *motionManager = [self createMotionManager];
+    if (motionManager) {
+        return [[ORKMotionHub alloc] initWithSampleSource:[[ORKMotionManagerSampleSource alloc] initWithMotionManager:motionManager]];
+    }
+    return [ORKMotionHub sharedHub];
+}
+
+- (void)prepare {
+    [super prepare];
+    
+    if (! _logger) {
+        NSError *error = nil;
+        _logger = [self makePreparedJSONDataLoggerWithError:&error];
+        if (! _logger) {
+            // Not fatal yet; -start tries again and reports the error.
+            ORK_Log_Debug(@"Could not prepare %@: %@", self, error);
+            return;
+        }
+    }
+    
+    // Start sensor delivery now; samples are discarded until -start arms the recorder.
+    if (! _subscription) {
+        self.motionHub = [self createMotionHub];
+        [self subscribeWithError:nil];
+    }
 }
 
 - (void)start {
@@ -93,33 +128,61 @@
         }
     }
     
-    self.motionManager = [self createMotionManager];
-    self.motionManager.deviceMotionUpdateInterval = 1.0/_frequency;
-    
-    self.uptime = [NSProcessInfo processInfo].systemUptime;
-    
-    [self.motionManager stopDeviceMotionUpdates];
+    if (! _subscription) {
+        self.motionHub = [self createMotionHub];
+        
+        NSError *subscriptionError = nil;
+        if (! [self subscribeWithError:&subscriptionError]) {
+            [self finishRecordingWithError:subscriptionError];
+            return;
+        }
+    }
     
-    [self.motionManager
-     startDeviceMotionUpdatesToQueue:[NSOperationQueue mainQueue]
-     withHandler:^(CMDeviceMotion *data, NSError *error)
-     {
-         BOOL success = NO;
-         if (data)
-         {
-             success = [_logger append:[data ork_JSONDictionary] error:&error];
-             id delegate = self.delegate;
-             if ([delegate respondsToSelector:@selector(deviceMotionRecorderDidUpdateWithMotion:)]) {
-                 [delegate deviceMotionRecorderDidUpdateWithMotion:data];
-             }
-         }
-         if (!success)
-         {
-             dispatch_async(dispatch_get_main_queue(), ^{
-                 [self finishRecordingWithError:error];
-             });
-         }
-     }];
+    _subscription.countsDroppedSamples = self.countsDroppedSamples;
+    self.armed = YES;
+}
+
+// Samples delivered before the recorder is armed are discarded.
+- (BOOL)subscribeWithError:(NSError * __autoreleasing *)error {
+    ORKDataLogger *logger = _logger;
+    __weak ORKDeviceMotionRecorder *weakSelf = self;
+    _subscription = [self.motionHub
+                     subscribeToSensor:ORKMotionSensorDeviceMotion
+                     frequency:_frequency
+                     handler:^(CMLogItem *data, NSError *error)
+                     {
+                         ORKDeviceMotionRecorder *strongSelf = weakSelf;
+                         if (! strongSelf.armed) {
+                             return;
+                         }
+                         BOOL success = NO;
+                         if (data)
+                         {
+                             CMDeviceMotion *motion = (CMDeviceMotion *)data;
+                             success = [logger append:[motion ork_JSONDictionary] error:&error];
+                             if (success) {
+                                 [strongSelf noteSamplePersisted];
+                             }
+                             // The hub delivers off the main queue; delegates still expect main queue callbacks.
+                             dispatch_async(dispatch_get_main_queue(), ^{
+                                 if (! strongSelf.isRecording) {
+                                     return;
+                                 }
+                                 id delegate = strongSelf.delegate;
+                                 if ([delegate respondsToSelector:@selector(deviceMotionRecorderDidUpdateWithMotion:)]) {
+                                     [delegate deviceMotionRecorderDidUpdateWithMotion:motion];
+                                 }
+                             });
+                         }
+                         if (!success)
+                         {
+                             dispatch_async(dispatch_get_main_queue(), ^{
+                                 [strongSelf finishRecordingWithError:error];
+                             });
+                         }
+                     }
+                     error:error];
+    return (_subscription != nil);
 }
 
 - (NSString *)recorderType {
@@ -128,24 +191,26 @@
 
 - (void)stop {
     [self doStopRecording];
-    [_logger finishCurrentLog];
-    
-    NSError *error = nil;
-    __block NSURL *fileUrl = nil;
-    [_logger enumerateLogs:^(NSURL *logFileUrl, BOOL *stop) {
-        fileUrl = logFileUrl;
-    } error:&error];
-    
-    [self reportFileResultWithFile:fileUrl error:error];
+    [self finishJSONLogger:_logger recordingError:nil];
     
     [super stop];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    [self doStopRecording];
+    [self finishJSONLogger:_logger recordingError:nil completion:completion];
+}
+
 - (void)doStopRecording {
-    if (self.isRecording) {
-        [self.motionManager stopDeviceMotionUpdates];
-        self.motionManager = nil;
+    self.armed = NO;
+    if (_subscription) {
+        if (_subscription.countsDroppedSamples) {
+            self.droppedSampleCount = @(_subscription.droppedSampleCount);
+        }
+        [self.motionHub removeSubscription:_subscription];
+        _subscription = nil;
     }
+    self.motionHub = nil;
 }
 
 - (void)finishRecordingWithError:(NSError *)error {
@@ -154,13 +219,17 @@
 }
 
 - (BOOL)isRecording {
-    return self.motionManager.deviceMotionActive;
+    return (self.armed && _subscription != nil);
 }
 
 - (NSString *)mimeType {
     return @"application/json";
 }
 
+- (ORKDataLogger *)dataLogger {
+    return _logger;
+}
+
 - (void)reset {
     [super reset];
     
@@ -111,6 +111,7 @@ static const NSInteger _HealthAnchoredQueryLimit = 100;
             [self finishRecordingWithError:error];
             return;
         }
+        [self noteSamplePersisted];
         
         _anchor = newAnchor;
         
@@ -148,6 +149,15 @@ static const NSInteger _HealthAnchoredQueryLimit = 100;
     [_healthStore executeQuery:anchoredQuery];
 }
 
+- (void)prepare {
+    [super prepare];
+    
+    if (! _logger) {
+        // Failure is reported when -start tries again.
+        _logger = [self makePreparedJSONDataLoggerWithError:nil];
+    }
+}
+
 - (void)start {
     [super start];
     
@@ -227,19 +237,23 @@ static const NSInteger _HealthAnchoredQueryLimit = 100;
     }
     
     [self doStopRecording];
-    [_logger finishCurrentLog];
-    
-    NSError *error = nil;
-    __block NSURL *fileUrl = nil;
-    [_logger enumerateLogs:^(NSURL *logFileUrl, BOOL *stop) {
-        fileUrl = logFileUrl;
-    } error:&error];
-    
-    [self reportFileResultWithFile:fileUrl error:error];
+    [self finishJSONLogger:_logger recordingError:nil];
     
     [super stop];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    if (! _isRecording) {
+        if (completion) {
+            completion(nil, nil);
+        }
+        return;
+    }
+    
+    [self doStopRecording];
+    [self finishJSONLogger:_logger recordingError:nil completion:completion];
+}
+
 - (void)doStopRecording {
     if (_isRecording) {
         NSAssert(_observerQuery != nil, @"Observer query should be non-nil when recording");
@@ -266,6 +280,10 @@ static const NSInteger _HealthAnchoredQueryLimit = 100;
     return @"application/json";
 }
 
+- (ORKDataLogger *)dataLogger {
+    return _logger;
+}
+
 - (void)reset {
     [super reset];
     
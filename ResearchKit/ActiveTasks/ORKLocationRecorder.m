@@ -45,8 +45,6 @@
 
 @property (nonatomic, strong) CLLocationManager *locationManager;
 
-@property (nonatomic) NSTimeInterval uptime;
-
 @end
 
 
@@ -72,6 +70,15 @@
     return [[CLLocationManager alloc] init];
 }
 
+- (void)prepare {
+    [super prepare];
+    
+    if (! _logger) {
+        // Failure is reported when -start tries again.
+        _logger = [self makePreparedJSONDataLoggerWithError:nil];
+    }
+}
+
 - (void)start {
     [super start];
     
@@ -99,7 +106,6 @@
         return;
     }
     
-    self.uptime = [NSProcessInfo processInfo].systemUptime;
     [self.locationManager startUpdatingLocation];
 }
 
@@ -111,20 +117,22 @@
 
 - (void)stop {
     [self doStopRecording];
-    [_logger finishCurrentLog];
     
     NSError *error = _recordingError;
     _recordingError = nil;
-    __block NSURL *fileUrl = nil;
-    [_logger enumerateLogs:^(NSURL *logFileUrl, BOOL *stop) {
-        fileUrl = logFileUrl;
-    } error:&error];
-    
-    [self reportFileResultWithFile:fileUrl error:error];
+    [self finishJSONLogger:_logger recordingError:error];
     
     [super stop];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    [self doStopRecording];
+    
+    NSError *error = _recordingError;
+    _recordingError = nil;
+    [self finishJSONLogger:_logger recordingError:error completion:completion];
+}
+
 - (void)locationManager:(CLLocationManager *)manager
      didUpdateLocations:(NSArray *)locations {
     BOOL success = YES;
@@ -138,6 +146,9 @@
         }];
         
         success = [_logger appendObjects:dictionaries error:&error];
+        if (success) {
+            [self noteSamplePersisted];
+        }
     }
     if (!success) {
         dispatch_async(dispatch_get_main_queue(), ^{
@@ -156,6 +167,10 @@
     return [CLLocationManager locationServicesEnabled] && (self.locationManager != nil) && ([CLLocationManager authorizationStatus] > kCLAuthorizationStatusDenied);
 }
 
+- (ORKDataLogger *)dataLogger {
+    return _logger;
+}
+
 - (void)reset {
     [super reset];
     
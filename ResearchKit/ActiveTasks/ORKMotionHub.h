@@ -0,0 +1,145 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <CoreMotion/CoreMotion.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, ORKMotionSensor) {
+    ORKMotionSensorAccelerometer = 0,
+    ORKMotionSensorDeviceMotion,
+    ORKMotionSensorCount
+};
+
+typedef void (^ORKMotionSampleHandler)(CMLogItem * _Nullable sample, NSError * _Nullable error);
+
+/*
+ A sample source produces raw samples for the motion hub. The default source is
+ backed by `CMMotionManager`; tests inject a fake source and push samples directly.
+
+ The hub calls these methods with its own lock held, and never concurrently.
+ */
+@protocol ORKMotionSampleSource <NSObject>
+
+- (BOOL)isSensorAvailable:(ORKMotionSensor)sensor;
+
+- (void)startSensor:(ORKMotionSensor)sensor updateInterval:(NSTimeInterval)updateInterval queue:(NSOperationQueue *)queue handler:(ORKMotionSampleHandler)handler;
+
+- (void)setUpdateInterval:(NSTimeInterval)updateInterval forSensor:(ORKMotionSensor)sensor;
+
+- (void)stopSensor:(ORKMotionSensor)sensor;
+
+@end
+
+
+/*
+ Sample source backed by CoreMotion. By default, it owns one `CMMotionManager`
+ per sensor type; alternatively, a single existing manager can be supplied.
+ */
+@interface ORKMotionManagerSampleSource : NSObject <ORKMotionSampleSource>
+
+- (instancetype)init;
+
+- (instancetype)initWithMotionManager:(CMMotionManager *)motionManager;
+
+@end
+
+
+@interface ORKMotionHubSubscription : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) ORKMotionSensor sensor;
+
+// Requested delivery rate in Hz.
+@property (nonatomic, readonly) double frequency;
+
+/*
+ Whether to track gaps in the sensor timestamps, at a small cost on every sample. NO by default;
+ counting starts with the next sample after it is set.
+ */
+@property (atomic) BOOL countsDroppedSamples;
+
+/*
+ Estimated number of samples this subscriber missed while counting, inferred from gaps in the
+ sensor timestamps larger than the sensor's update interval. Scaled to the subscriber's rate.
+ */
+@property (atomic, readonly) NSUInteger droppedSampleCount;
+
+@end
+
+
+/*
+ The motion hub multiplexes motion sensors across any number of subscribers.
+
+ Each sensor is started when its first subscriber arrives and stopped when the last
+ one leaves. The sensor runs at the highest frequency requested; subscribers that
+ asked for a lower rate receive a decimated stream.
+
+ Handlers are called serially on the hub's delivery queue, never on the main queue.
+ */
+@interface ORKMotionHub : NSObject
+
++ (ORKMotionHub *)sharedHub;
+
+- (instancetype)init;
+
+- (instancetype)initWithSampleSource:(id<ORKMotionSampleSource>)sampleSource NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, strong, readonly) id<ORKMotionSampleSource> sampleSource;
+
+@property (nonatomic, strong, readonly) NSOperationQueue *deliveryQueue;
+
+- (BOOL)isSensorAvailable:(ORKMotionSensor)sensor;
+
+- (BOOL)isSensorActive:(ORKMotionSensor)sensor;
+
+// Current sensor rate in Hz, or 0 if the sensor is not active.
+- (double)frequencyForSensor:(ORKMotionSensor)sensor;
+
+/*
+ Returns nil and sets `error` if the sensor is not available.
+
+ The handler is retained until the subscription is removed.
+ */
+- (nullable ORKMotionHubSubscription *)subscribeToSensor:(ORKMotionSensor)sensor
+                                               frequency:(double)frequency
+                                                 handler:(ORKMotionSampleHandler)handler
+                                                   error:(NSError * __autoreleasing *)error;
+
+// Safe to call from any queue, including from within a handler.
+- (void)removeSubscription:(ORKMotionHubSubscription *)subscription;
+
+@end
+
+NS_ASSUME_NONNULL_END
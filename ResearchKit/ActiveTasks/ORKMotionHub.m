@@ -0,0 +1,367 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKMotionHub.h"
+#import "ORKHelpers.h"
+#import "ORKTraceBuffer_Internal.h"
+
+
+// Tolerance for the decimation accumulator, so ratios such as 1/3 do not drift.
+static const double ORKMotionHubPhaseEpsilon = 1e-9;
+
+// A timestamp gap must exceed this many update intervals before samples are counted as dropped.
+static const double ORKMotionHubDropTolerance = 1.5;
+
+
+@implementation ORKMotionManagerSampleSource {
+    CMMotionManager *_motionManager;
+    NSMutableDictionary *_motionManagers;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _motionManagers = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (instancetype)initWithMotionManager:(CMMotionManager *)motionManager {
+    self = [super init];
+    if (self) {
+        _motionManager = motionManager;
+    }
+    return self;
+}
+
+- (CMMotionManager *)motionManagerForSensor:(ORKMotionSensor)sensor {
+    if (_motionManager) {
+        return _motionManager;
+    }
+    CMMotionManager *motionManager = _motionManagers[@(sensor)];
+    if (! motionManager) {
+        motionManager = [[CMMotionManager alloc] init];
+        _motionManagers[@(sensor)] = motionManager;
+    }
+    return motionManager;
+}
+
+- (BOOL)isSensorAvailable:(ORKMotionSensor)sensor {
+    CMMotionManager *motionManager = [self motionManagerForSensor:sensor];
+    switch (sensor) {
+        case ORKMotionSensorAccelerometer:
+            return motionManager.accelerometerAvailable;
+        case ORKMotionSensorDeviceMotion:
+            return motionManager.deviceMotionAvailable;
+        default:
+            return NO;
+    }
+}
+
+- (void)startSensor:(ORKMotionSensor)sensor updateInterval:(NSTimeInterval)updateInterval queue:(NSOperationQueue *)queue handler:(ORKMotionSampleHandler)handler {
+    CMMotionManager *motionManager = [self motionManagerForSensor:sensor];
+    switch (sensor) {
+        case ORKMotionSensorAccelerometer: {
+            motionManager.accelerometerUpdateInterval = updateInterval;
+            [motionManager stopAccelerometerUpdates];
+            [motionManager startAccelerometerUpdatesToQueue:queue withHandler:^(CMAccelerometerData *data, NSError *error) {
+                handler(data, error);
+            }];
+            break;
+        }
+        case ORKMotionSensorDeviceMotion: {
+            motionManager.deviceMotionUpdateInterval = updateInterval;
+            [motionManager stopDeviceMotionUpdates];
+            [motionManager startDeviceMotionUpdatesToQueue:queue withHandler:^(CMDeviceMotion *motion, NSError *error) {
+                handler(motion, error);
+            }];
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+- (void)setUpdateInterval:(NSTimeInterval)updateInterval forSensor:(ORKMotionSensor)sensor {
+    CMMotionManager *motionManager = [self motionManagerForSensor:sensor];
+    switch (sensor) {
+        case ORKMotionSensorAccelerometer:
+            motionManager.accelerometerUpdateInterval = updateInterval;
+            break;
+        case ORKMotionSensorDeviceMotion:
+            motionManager.deviceMotionUpdateInterval = updateInterval;
+            break;
+        default:
+            break;
+    }
+}
+
+- (void)stopSensor:(ORKMotionSensor)sensor {
+    CMMotionManager *motionManager = [self motionManagerForSensor:sensor];
+    switch (sensor) {
+        case ORKMotionSensorAccelerometer:
+            [motionManager stopAccelerometerUpdates];
+            break;
+        case ORKMotionSensorDeviceMotion:
+            [motionManager stopDeviceMotionUpdates];
+            break;
+        default:
+            break;
+    }
+}
+
+@end
+
+
+@interface ORKMotionHubSubscription ()
+
+@property (nonatomic, copy, readonly) ORKMotionSampleHandler handler;
+
+@property (atomic, getter=isCancelled) BOOL cancelled;
+
+@property (atomic, readwrite) NSUInteger droppedSampleCount;
+
+@end
+
+
+@implementation ORKMotionHubSubscription {
+    // Only touched on the delivery queue.
+    double _phase;
+    NSTimeInterval _lastSampleTimestamp;
+    double _lastSourceFrequency;
+    double _droppedSamples;
+}
+
+- (instancetype)initWithSensor:(ORKMotionSensor)sensor frequency:(double)frequency handler:(ORKMotionSampleHandler)handler {
+    self = [super init];
+    if (self) {
+        _sensor = sensor;
+        _frequency = frequency;
+        _handler = [handler copy];
+        // Start with a full accumulator so the first sample is always delivered.
+        _phase = 1.0;
+    }
+    return self;
+}
+
+- (void)deliverSample:(CMLogItem *)sample sourceFrequency:(double)sourceFrequency {
+    if (self.cancelled) {
+        return;
+    }
+    if (self.countsDroppedSamples) {
+        [self noteSampleTimestamp:sample.timestamp sourceFrequency:sourceFrequency];
+    } else {
+        _lastSampleTimestamp = 0;
+    }
+    BOOL deliver = (_phase >= 1.0 - ORKMotionHubPhaseEpsilon);
+    if (deliver) {
+        _phase -= 1.0;
+    }
+    _phase += (sourceFrequency > 0) ? MIN(1.0, _frequency / sourceFrequency) : 1.0;
+    if (deliver) {
+        _handler(sample, nil);
+    }
+}
+
+- (void)noteSampleTimestamp:(NSTimeInterval)timestamp sourceFrequency:(double)sourceFrequency {
+    // Gaps are only meaningful while the sensor rate is unchanged.
+    if (_lastSampleTimestamp > 0 && sourceFrequency > 0 && sourceFrequency == _lastSourceFrequency) {
+        double intervals = (timestamp - _lastSampleTimestamp) * sourceFrequency;
+        if (intervals > ORKMotionHubDropTolerance) {
+            _droppedSamples += (round(intervals) - 1) * MIN(1.0, _frequency / sourceFrequency);
+            self.droppedSampleCount = (NSUInteger)round(_droppedSamples);
+        }
+    }
+    _lastSampleTimestamp = timestamp;
+    _lastSourceFrequency = sourceFrequency;
+}
+
+- (void)deliverError:(NSError *)error {
+    if (self.cancelled) {
+        return;
+    }
+    _handler(nil, error);
+}
+
+@end
+
+
+@implementation ORKMotionHub {
+    NSArray *_subscriptions[ORKMotionSensorCount];
+    double _frequencies[ORKMotionSensorCount];
+}
+
++ (ORKMotionHub *)sharedHub {
+    static ORKMotionHub *shared;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        shared = [ORKMotionHub new];
+    });
+    return shared;
+}
+
+- (instancetype)init {
+    return [self initWithSampleSource:[ORKMotionManagerSampleSource new]];
+}
+
+- (instancetype)initWithSampleSource:(id<ORKMotionSampleSource>)sampleSource {
+    self = [super init];
+    if (self) {
+        ORKThrowInvalidArgumentExceptionIfNil(sampleSource);
+        _sampleSource = sampleSource;
+        _deliveryQueue = [[NSOperationQueue alloc] init];
+        _deliveryQueue.maxConcurrentOperationCount = 1;
+        _deliveryQueue.name = @"org.researchkit.motionhub";
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSInteger sensor = 0; sensor < ORKMotionSensorCount; sensor++) {
+        if (_frequencies[sensor] > 0) {
+            [_sampleSource stopSensor:sensor];
+        }
+    }
+}
+
+- (BOOL)isSensorAvailable:(ORKMotionSensor)sensor {
+    if (sensor < 0 || sensor >= ORKMotionSensorCount) {
+        return NO;
+    }
+    @synchronized (self) {
+        return [_sampleSource isSensorAvailable:sensor];
+    }
+}
+
+- (BOOL)isSensorActive:(ORKMotionSensor)sensor {
+    return [self frequencyForSensor:sensor] > 0;
+}
+
+- (double)frequencyForSensor:(ORKMotionSensor)sensor {
+    if (sensor < 0 || sensor >= ORKMotionSensorCount) {
+        return 0;
+    }
+    @synchronized (self) {
+        return _frequencies[sensor];
+    }
+}
+
+- (ORKMotionHubSubscription *)subscribeToSensor:(ORKMotionSensor)sensor
+                                      frequency:(double)frequency
+                                        handler:(ORKMotionSampleHandler)handler
+                                          error:(NSError * __autoreleasing *)error {
+    ORKThrowInvalidArgumentExceptionIfNil(handler);
+    if (! [self isSensorAvailable:sensor]) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFeatureUnsupportedError userInfo:nil];
+        }
+        return nil;
+    }
+    
+    ORKMotionHubSubscription *subscription = [[ORKMotionHubSubscription alloc] initWithSensor:sensor
+                                                                                    frequency:(frequency > 0 ? frequency : 1)
+                                                                                      handler:handler];
+    @synchronized (self) {
+        NSArray *subscriptions = _subscriptions[sensor];
+        // Copy on write, so delivery can iterate a snapshot without holding the lock.
+        _subscriptions[sensor] = subscriptions ? [subscriptions arrayByAddingObject:subscription] : @[subscription];
+        [self updateSensorLocked:sensor];
+    }
+    return subscription;
+}
+
+- (void)removeSubscription:(ORKMotionHubSubscription *)subscription {
+    if (! subscription) {
+        return;
+    }
+    subscription.cancelled = YES;
+    
+    ORKMotionSensor sensor = subscription.sensor;
+    @synchronized (self) {
+        NSArray *subscriptions = _subscriptions[sensor];
+        if (! [subscriptions containsObject:subscription]) {
+            return;
+        }
+        NSMutableArray *remaining = [subscriptions mutableCopy];
+        [remaining removeObjectIdenticalTo:subscription];
+        _subscriptions[sensor] = [remaining copy];
+        [self updateSensorLocked:sensor];
+    }
+}
+
+// Reference counting of sensor activation: the sensor runs while it has subscribers,
+// at the highest frequency any of them requested.
+- (void)updateSensorLocked:(ORKMotionSensor)sensor {
+    double frequency = 0;
+    for (ORKMotionHubSubscription *subscription in _subscriptions[sensor]) {
+        frequency = MAX(frequency, subscription.frequency);
+    }
+    
+    double previousFrequency = _frequencies[sensor];
+    _frequencies[sensor] = frequency;
+    
+    if (frequency == 0) {
+        if (previousFrequency > 0) {
+            [_sampleSource stopSensor:sensor];
+        }
+    } else if (previousFrequency == 0) {
+        __weak ORKMotionHub *weakSelf = self;
+        [_sampleSource startSensor:sensor
+                    updateInterval:1.0 / frequency
+                             queue:_deliveryQueue
+                           handler:^(CMLogItem *sample, NSError *error) {
+                               [weakSelf deliverSample:sample error:error sensor:sensor];
+                           }];
+    } else if (frequency != previousFrequency) {
+        [_sampleSource setUpdateInterval:1.0 / frequency forSensor:sensor];
+    }
+}
+
+- (void)deliverSample:(CMLogItem *)sample error:(NSError *)error sensor:(ORKMotionSensor)sensor {
+    NSArray *subscriptions = nil;
+    double frequency = 0;
+    @synchronized (self) {
+        subscriptions = _subscriptions[sensor];
+        frequency = _frequencies[sensor];
+    }
+    
+    ORK_TRACE_BEGIN("motion", "deliver");
+    for (ORKMotionHubSubscription *subscription in subscriptions) {
+        if (sample) {
+            [subscription deliverSample:sample sourceFrequency:frequency];
+        } else if (error) {
+            [subscription deliverError:error];
+        }
+    }
+    ORK_TRACE_END_VALUE("motion", "deliver", subscriptions.count);
+}
+
+@end
@@ -0,0 +1,82 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <CoreMotion/CoreMotion.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface ORKMotionThresholdDetection : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithCrossingUptime:(NSTimeInterval)crossingUptime uncertainty:(NSTimeInterval)uncertainty NS_DESIGNATED_INITIALIZER;
+
+// Estimated system uptime at which the acceleration magnitude reached the threshold.
+@property (nonatomic, readonly) NSTimeInterval crossingUptime;
+
+// Maximum error of `crossingUptime`, in seconds.
+@property (nonatomic, readonly) NSTimeInterval uncertainty;
+
+@end
+
+
+/*
+ Detects the first time the magnitude of an acceleration stream exceeds a threshold.
+ 
+ The detector is meant to run directly on the sensor delivery queue: each sample costs a
+ squared-magnitude comparison, and square roots are only taken once, to interpolate the
+ crossing between the last sample at or below the threshold and the first sample that exceeds it.
+ 
+ Not thread safe; feed samples serially, in timestamp order.
+ */
+@interface ORKMotionThresholdDetector : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// `sampleInterval` is the nominal spacing of samples, used to bound a crossing on the very first sample.
+- (instancetype)initWithThreshold:(double)threshold sampleInterval:(NSTimeInterval)sampleInterval NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) double threshold;
+
+@property (nonatomic, readonly) NSTimeInterval sampleInterval;
+
+@property (nonatomic, readonly, getter=hasDetected) BOOL detected;
+
+// Returns a detection for the first sample that exceeds the threshold, and nil for all other samples.
+- (nullable ORKMotionThresholdDetection *)processAcceleration:(CMAcceleration)acceleration timestamp:(NSTimeInterval)timestamp;
+
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
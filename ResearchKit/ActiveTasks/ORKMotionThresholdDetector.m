@@ -0,0 +1,108 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKMotionThresholdDetector.h"
+
+
+@implementation ORKMotionThresholdDetection
+
+- (instancetype)initWithCrossingUptime:(NSTimeInterval)crossingUptime uncertainty:(NSTimeInterval)uncertainty {
+    self = [super init];
+    if (self) {
+        _crossingUptime = crossingUptime;
+        _uncertainty = uncertainty;
+    }
+    return self;
+}
+
+@end
+
+
+@implementation ORKMotionThresholdDetector {
+    double _thresholdSquared;
+    double _previousSquared;
+    NSTimeInterval _previousTimestamp;
+    BOOL _hasPrevious;
+}
+
+- (instancetype)initWithThreshold:(double)threshold sampleInterval:(NSTimeInterval)sampleInterval {
+    self = [super init];
+    if (self) {
+        _threshold = MAX(threshold, 0);
+        _thresholdSquared = _threshold * _threshold;
+        _sampleInterval = MAX(sampleInterval, 0);
+    }
+    return self;
+}
+
+- (ORKMotionThresholdDetection *)processAcceleration:(CMAcceleration)acceleration timestamp:(NSTimeInterval)timestamp {
+    if (_detected) {
+        return nil;
+    }
+    
+    double squared = (acceleration.x * acceleration.x) + (acceleration.y * acceleration.y) + (acceleration.z * acceleration.z);
+    if (squared <= _thresholdSquared) {
+        _previousSquared = squared;
+        _previousTimestamp = timestamp;
+        _hasPrevious = YES;
+        return nil;
+    }
+    _detected = YES;
+    
+    if (! _hasPrevious || timestamp <= _previousTimestamp) {
+        // Nothing to interpolate from: the crossing happened within the last nominal sample interval.
+        NSTimeInterval halfInterval = _sampleInterval / 2;
+        return [[ORKMotionThresholdDetection alloc] initWithCrossingUptime:(timestamp - halfInterval) uncertainty:halfInterval];
+    }
+    
+    // Interpolate linearly in magnitude between the bracketing samples.
+    double previousMagnitude = sqrt(_previousSquared);
+    double magnitude = sqrt(squared);
+    double fraction = 1;
+    if (magnitude > previousMagnitude) {
+        fraction = (_threshold - previousMagnitude) / (magnitude - previousMagnitude);
+        fraction = MIN(MAX(fraction, 0), 1);
+    }
+    NSTimeInterval crossing = _previousTimestamp + fraction * (timestamp - _previousTimestamp);
+    
+    // The true crossing lies somewhere between the two samples.
+    NSTimeInterval uncertainty = MAX(crossing - _previousTimestamp, timestamp - crossing);
+    return [[ORKMotionThresholdDetection alloc] initWithCrossingUptime:crossing uncertainty:uncertainty];
+}
+
+- (void)reset {
+    _detected = NO;
+    _hasPrevious = NO;
+    _previousSquared = 0;
+    _previousTimestamp = 0;
+}
+
+@end
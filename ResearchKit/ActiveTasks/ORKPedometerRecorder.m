@@ -83,6 +83,15 @@
     return [[CMPedometer alloc] init];
 }
 
+- (void)prepare {
+    [super prepare];
+    
+    if (! _logger) {
+        // Failure is reported when -start tries again.
+        _logger = [self makePreparedJSONDataLoggerWithError:nil];
+    }
+}
+
 - (void)start {
     [super start];
     
@@ -115,6 +124,9 @@
         BOOL success = NO;
         if (pedometerData) {
             success = [_logger append:[pedometerData ork_JSONDictionary] error:&error];
+            if (success) {
+                [weakSelf noteSamplePersisted];
+            }
             dispatch_async(dispatch_get_main_queue(), ^{
                 __typeof(self) strongSelf = weakSelf;
                 [strongSelf updateStatisticsWithData:pedometerData];
@@ -135,20 +147,16 @@
 
 - (void)stop {
     [self doStopRecording];
-    [_logger finishCurrentLog];
-    
-    NSError *error = nil;
-    __block NSURL *fileUrl = nil;
-    [_logger enumerateLogs:^(NSURL *logFileUrl, BOOL *stop) {
-        fileUrl = logFileUrl;
-    }
-                     error:&error];
-    
-    [self reportFileResultWithFile:fileUrl error:error];
+    [self finishJSONLogger:_logger recordingError:nil];
     
     [super stop];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    [self doStopRecording];
+    [self finishJSONLogger:_logger recordingError:nil completion:completion];
+}
+
 - (void)doStopRecording {
     if (_isRecording) {
         [self.pedometer stopPedometerUpdates];
@@ -170,6 +178,10 @@
     return @"application/json";
 }
 
+- (ORKDataLogger *)dataLogger {
+    return _logger;
+}
+
 - (void)reset {
     [super reset];
     
@@ -0,0 +1,88 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Streaming phonation analysis of a mono signal: a fundamental frequency track, and
+ jitter, shimmer and harmonics-to-noise ratio over the voiced frames.
+ 
+ Every 10 ms, a window of two longest periods is analyzed by normalized autocorrelation.
+ The strongest periodicity within the allowed F0 range is refined by parabolic
+ interpolation; the frame is voiced if that correlation is at least 0.45. The correlation
+ also gives the frame's harmonics-to-noise ratio, 10 log10(r / (1 - r)).
+ 
+ Jitter and shimmer are the mean absolute difference between the periods (respectively
+ peak-to-peak amplitudes) of consecutive voiced frames, relative to their mean. They are
+ frame-level approximations of the cycle-to-cycle measures and read lower than them on
+ strongly perturbed voices.
+ 
+ Memory use is bounded by one window plus the F0 track. Not thread safe.
+ */
+@interface ORKPhonationAnalyzer : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// Analyzes F0 between 75 and 600 Hz.
+- (instancetype)initWithSampleRate:(double)sampleRate;
+
+- (instancetype)initWithSampleRate:(double)sampleRate
+                  minimumFrequency:(double)minimumFrequency
+                  maximumFrequency:(double)maximumFrequency NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) double sampleRate;
+
+@property (nonatomic, readonly) NSTimeInterval frameInterval;
+
+- (void)processSamples:(const float *)samples count:(NSInteger)count;
+
+// F0 in Hz for each frame analyzed so far, 0 for unvoiced frames.
+@property (nonatomic, copy, readonly) NSArray *fundamentalFrequencyTrack;
+
+@property (nonatomic, readonly) NSInteger voicedFrameCount;
+
+// The following are 0 if no frame is voiced.
+
+@property (nonatomic, readonly) double meanFundamentalFrequency;
+
+@property (nonatomic, readonly) double jitter;
+
+@property (nonatomic, readonly) double shimmer;
+
+// In dB, averaged over voiced frames.
+@property (nonatomic, readonly) double harmonicsToNoiseRatio;
+
+@end
+
+NS_ASSUME_NONNULL_END
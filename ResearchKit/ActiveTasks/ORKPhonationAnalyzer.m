@@ -0,0 +1,265 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKPhonationAnalyzer.h"
+
+
+static const NSTimeInterval FrameInterval = 0.01;
+
+static const double DefaultMinimumFrequency = 75;
+
+static const double DefaultMaximumFrequency = 600;
+
+static const double VoicingThreshold = 0.45;
+
+// Frames quieter than this (about -60 dBFS RMS) are unvoiced.
+static const double SilenceRMS = 0.001;
+
+// Among peaks at least this fraction of the strongest, the shortest period wins; this avoids
+// reporting a multiple of the period, which correlates almost as well.
+static const double OctaveTolerance = 0.9;
+
+// Keeps the harmonics-to-noise ratio finite for a perfectly periodic frame.
+static const double MaximumCorrelation = 0.999999;
+
+@implementation ORKPhonationAnalyzer {
+    NSInteger _minimumLag;
+    NSInteger _maximumLag;
+    NSInteger _windowLength;
+    NSInteger _hopLength;
+    
+    float *_buffer;
+    NSInteger _bufferCount;
+    double *_window;
+    double *_correlation;
+    
+    NSMutableArray *_track;
+    
+    double _frequencySum;
+    double _hnrSum;
+    double _periodDifferenceSum;
+    double _amplitudeDifferenceSum;
+    NSInteger _voicedPairCount;
+    double _periodPairSum;
+    double _amplitudePairSum;
+    
+    BOOL _previousFrameVoiced;
+    double _previousPeriod;
+    double _previousAmplitude;
+}
+
+- (instancetype)initWithSampleRate:(double)sampleRate {
+    return [self initWithSampleRate:sampleRate minimumFrequency:DefaultMinimumFrequency maximumFrequency:DefaultMaximumFrequency];
+}
+
+- (instancetype)initWithSampleRate:(double)sampleRate
+                  minimumFrequency:(double)minimumFrequency
+                  maximumFrequency:(double)maximumFrequency {
+    NSParameterAssert(sampleRate > 0);
+    NSParameterAssert(minimumFrequency > 0 && minimumFrequency < maximumFrequency);
+    self = [super init];
+    if (self) {
+        _sampleRate = sampleRate;
+        _frameInterval = FrameInterval;
+        _minimumLag = MAX((NSInteger)floor(sampleRate / maximumFrequency), 2);
+        _maximumLag = MAX((NSInteger)ceil(sampleRate / minimumFrequency), _minimumLag + 2);
+        _windowLength = 2 * _maximumLag;
+        _hopLength = MAX((NSInteger)round(sampleRate * FrameInterval), 1);
+        
+        _buffer = calloc(_windowLength + _hopLength, sizeof(float));
+        _window = calloc(_windowLength, sizeof(double));
+        _correlation = calloc(_maximumLag + 2, sizeof(double));
+        if (! _buffer || ! _window || ! _correlation) {
+            return nil;
+        }
+        _track = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_buffer);
+    free(_window);
+    free(_correlation);
+}
+
+- (void)processSamples:(const float *)samples count:(NSInteger)count {
+    NSInteger capacity = _windowLength + _hopLength;
+    while (count > 0) {
+        NSInteger chunk = MIN(count, capacity - _bufferCount);
+        memcpy(_buffer + _bufferCount, samples, chunk * sizeof(float));
+        _bufferCount += chunk;
+        samples += chunk;
+        count -= chunk;
+        
+        while (_bufferCount >= _windowLength) {
+            [self analyzeFrame];
+            _bufferCount -= _hopLength;
+            memmove(_buffer, _buffer + _hopLength, _bufferCount * sizeof(float));
+        }
+    }
+}
+
+- (void)analyzeFrame {
+    const NSInteger length = _windowLength;
+    const NSInteger span = _maximumLag;
+    double *x = _window;
+    
+    double mean = 0;
+    for (NSInteger i = 0; i < length; i++) {
+        mean += _buffer[i];
+    }
+    mean /= length;
+    double energy = 0;
+    for (NSInteger i = 0; i < length; i++) {
+        x[i] = _buffer[i] - mean;
+        energy += x[i] * x[i];
+    }
+    if (sqrt(energy / length) < SilenceRMS) {
+        [self appendUnvoicedFrame];
+        return;
+    }
+    
+    // Correlate the first `span` samples against the same length at each lag, normalized by
+    // both segments' energies; the lagged energy is updated as the segment slides.
+    double leadingEnergy = 0;
+    for (NSInteger i = 0; i < span; i++) {
+        leadingEnergy += x[i] * x[i];
+    }
+    NSInteger firstLag = _minimumLag - 1;
+    double laggedEnergy = 0;
+    for (NSInteger i = firstLag; i < firstLag + span; i++) {
+        laggedEnergy += x[i] * x[i];
+    }
+    for (NSInteger lag = firstLag; lag <= _maximumLag; lag++) {
+        if (lag > firstLag) {
+            laggedEnergy += x[lag + span - 1] * x[lag + span - 1] - x[lag - 1] * x[lag - 1];
+        }
+        double product = 0;
+        for (NSInteger i = 0; i < span; i++) {
+            product += x[i] * x[i + lag];
+        }
+        double norm = sqrt(leadingEnergy * MAX(laggedEnergy, 0));
+        _correlation[lag] = (norm > 0) ? product / norm : 0;
+    }
+    
+    double best = 0;
+    for (NSInteger lag = _minimumLag; lag < _maximumLag; lag++) {
+        double r = _correlation[lag];
+        if (r > _correlation[lag - 1] && r >= _correlation[lag + 1] && r > best) {
+            best = r;
+        }
+    }
+    if (best < VoicingThreshold) {
+        [self appendUnvoicedFrame];
+        return;
+    }
+    
+    NSInteger peakLag = 0;
+    for (NSInteger lag = _minimumLag; lag < _maximumLag; lag++) {
+        double r = _correlation[lag];
+        if (r > _correlation[lag - 1] && r >= _correlation[lag + 1] && r >= OctaveTolerance * best) {
+            peakLag = lag;
+            break;
+        }
+    }
+    
+    double left = _correlation[peakLag - 1];
+    double center = _correlation[peakLag];
+    double right = _correlation[peakLag + 1];
+    double curvature = left - 2 * center + right;
+    double offset = (curvature < 0) ? 0.5 * (left - right) / curvature : 0;
+    double period = (peakLag + offset) / _sampleRate;
+    double peak = MIN(center - 0.25 * (left - right) * offset, MaximumCorrelation);
+    if (peak < VoicingThreshold) {
+        [self appendUnvoicedFrame];
+        return;
+    }
+    
+    double minimum = x[0];
+    double maximum = x[0];
+    NSInteger cycleLength = MIN((NSInteger)ceil(period * _sampleRate), length);
+    for (NSInteger i = 1; i < cycleLength; i++) {
+        minimum = MIN(minimum, x[i]);
+        maximum = MAX(maximum, x[i]);
+    }
+    double amplitude = maximum - minimum;
+    
+    [_track addObject:@(1.0 / period)];
+    _voicedFrameCount++;
+    _frequencySum += 1.0 / period;
+    _hnrSum += 10 * log10(peak / (1 - peak));
+    
+    if (_previousFrameVoiced) {
+        _periodDifferenceSum += fabs(period - _previousPeriod);
+        _amplitudeDifferenceSum += fabs(amplitude - _previousAmplitude);
+        _periodPairSum += period + _previousPeriod;
+        _amplitudePairSum += amplitude + _previousAmplitude;
+        _voicedPairCount++;
+    }
+    _previousFrameVoiced = YES;
+    _previousPeriod = period;
+    _previousAmplitude = amplitude;
+}
+
+- (void)appendUnvoicedFrame {
+    [_track addObject:@0];
+    _previousFrameVoiced = NO;
+}
+
+- (NSArray *)fundamentalFrequencyTrack {
+    return [_track copy];
+}
+
+- (double)meanFundamentalFrequency {
+    return _voicedFrameCount > 0 ? _frequencySum / _voicedFrameCount : 0;
+}
+
+- (double)harmonicsToNoiseRatio {
+    return _voicedFrameCount > 0 ? _hnrSum / _voicedFrameCount : 0;
+}
+
+- (double)jitter {
+    // Relative to the mean period of the frames that took part in the differences.
+    if (_voicedPairCount == 0 || _periodPairSum <= 0) {
+        return 0;
+    }
+    return (_periodDifferenceSum / _voicedPairCount) / (_periodPairSum / (2 * _voicedPairCount));
+}
+
+- (double)shimmer {
+    if (_voicedPairCount == 0 || _amplitudePairSum <= 0) {
+        return 0;
+    }
+    return (_amplitudeDifferenceSum / _voicedPairCount) / (_amplitudePairSum / (2 * _voicedPairCount));
+}
+
+@end
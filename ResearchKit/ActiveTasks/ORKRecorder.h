@@ -176,6 +176,24 @@ ORK_CLASS_AVAILABLE
  */
 @property (nonatomic, readonly, nullable) NSDictionary *recorderSettings;
 
+/**
+ The processing applied to the audio as it is recorded.
+ 
+ Processing runs alongside the recording, and its output replaces the recording when the
+ recorder stops; only trimming silence is left until then. Voice features are returned in the
+ result's `userInfo` under `ORKAudioRecorderVoiceFeaturesKey`. The default value is
+ `ORKAudioProcessingOptionNone`.
+ */
+@property (nonatomic) ORKAudioProcessingOptions processingOptions;
+
+/**
+ The sample rate of the processed recording, in Hz.
+ 
+ The default value of 0 keeps the recorded sample rate. Any other value causes the audio to
+ be resampled as it is recorded.
+ */
+@property (nonatomic) double processedSampleRate;
+
 /**
  Returns an initialized audio recorder configuration using the specified settings.
  
@@ -391,6 +409,132 @@ ORK_CLASS_AVAILABLE
 @end
 
 
+/**
+ The `ORKContinuousRecorderConfiguration` class wraps a recorder configuration so that it records
+ one continuous stream across a range of steps in an `ORKOrderedTask` object, rather than
+ restarting the recorder on every step.
+ 
+ The recorder starts when the first step in the range is presented, and stops when the task
+ moves to a step outside the range or finishes. Step boundary markers are written into JSON
+ logs as each step starts and ends, so that no samples are lost at transitions.
+ 
+ Each step in the range receives its own `ORKFileResult` object, which points at the shared
+ file. The `userInfo` of that result contains the keys `ORKContinuousRecorderStepIdentifierKey`,
+ `ORKContinuousRecorderSliceStartUptimeKey`, and `ORKContinuousRecorderSliceEndUptimeKey`,
+ which identify the part of the log that belongs to the step.
+ 
+ To use a continuous recorder, include its configuration in the `continuousRecorderConfigurations`
+ property of an `ORKOrderedTask` object. Don't also include the wrapped configuration in the
+ `recorderConfigurations` property of the steps in the range.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKContinuousRecorderConfiguration : NSObject <NSSecureCoding, NSCopying>
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Returns an initialized continuous recorder configuration.
+ 
+ This method is the designated initializer.
+ 
+ @param recorderConfiguration   The configuration of the recorder that should run across the steps.
+ @param stepIdentifiers         The identifiers of the steps during which the recorder should run.
+ 
+ @return An initialized continuous recorder configuration.
+ */
+- (instancetype)initWithRecorderConfiguration:(ORKRecorderConfiguration *)recorderConfiguration
+                              stepIdentifiers:(NSArray *)stepIdentifiers NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns a new continuous recorder configuration initialized from data in the given unarchiver.
+ 
+ @param aDecoder    Coder from which to initialize the continuous recorder configuration.
+ 
+ @return A new continuous recorder configuration.
+ */
+- (instancetype)initWithCoder:(NSCoder *)aDecoder NS_DESIGNATED_INITIALIZER;
+
+/**
+ The configuration of the wrapped recorder. (read-only)
+ */
+@property (nonatomic, strong, readonly) ORKRecorderConfiguration *recorderConfiguration;
+
+/**
+ The identifiers of the steps during which the recorder runs. (read-only)
+ */
+@property (nonatomic, copy, readonly) NSArray *stepIdentifiers;
+
+/**
+ Returns whether the recorder runs during the step with the specified identifier.
+ 
+ @param stepIdentifier  The identifier of a step in the task.
+ 
+ @return `YES` if the step is in range; otherwise, `NO`.
+ */
+- (BOOL)includesStepWithIdentifier:(NSString *)stepIdentifier;
+
+@end
+
+
+/// The `userInfo` key for the identifier of the step a continuous recorder result belongs to.
+ORK_EXTERN NSString *const ORKContinuousRecorderStepIdentifierKey ORK_AVAILABLE_DECL;
+
+/// The `userInfo` key for the system uptime at which the step started, in seconds.
+ORK_EXTERN NSString *const ORKContinuousRecorderSliceStartUptimeKey ORK_AVAILABLE_DECL;
+
+/// The `userInfo` key for the system uptime at which the step ended, in seconds.
+ORK_EXTERN NSString *const ORKContinuousRecorderSliceEndUptimeKey ORK_AVAILABLE_DECL;
+
+/**
+ The `userInfo` key for a recorder's start latency: the time in seconds between the call to
+ `start` and the first sample being written to the output file.
+ */
+ORK_EXTERN NSString *const ORKRecorderStartLatencyKey ORK_AVAILABLE_DECL;
+
+/**
+ The `userInfo` key for the estimated number of sensor samples a motion recorder missed,
+ inferred from gaps in the sample timestamps.
+ 
+ Only present when the task view controller collects performance metrics.
+ */
+ORK_EXTERN NSString *const ORKRecorderDroppedSampleCountKey ORK_AVAILABLE_DECL;
+
+/**
+ The `userInfo` key for the duration in seconds of the silence an audio recorder removed from
+ the start of its recording; present only when silence was trimmed.
+ */
+ORK_EXTERN NSString *const ORKAudioRecorderTrimmedLeadingDurationKey ORK_AVAILABLE_DECL;
+
+/**
+ The `userInfo` key for the voice features an audio recorder computed from its recording: a
+ dictionary keyed by the `ORKVoiceFeature` keys below. Times are relative to the start of the
+ recording, before any trimming.
+ */
+ORK_EXTERN NSString *const ORKAudioRecorderVoiceFeaturesKey ORK_AVAILABLE_DECL;
+
+/// The interval in seconds between the frames of the fundamental frequency track.
+ORK_EXTERN NSString *const ORKVoiceFeatureFrameIntervalKey ORK_AVAILABLE_DECL;
+
+/// The fundamental frequency in Hz of each frame, or 0 for frames without voicing.
+ORK_EXTERN NSString *const ORKVoiceFeatureFundamentalFrequencyTrackKey ORK_AVAILABLE_DECL;
+
+/// The number of voiced frames.
+ORK_EXTERN NSString *const ORKVoiceFeatureVoicedFrameCountKey ORK_AVAILABLE_DECL;
+
+/// The mean fundamental frequency in Hz over the voiced frames.
+ORK_EXTERN NSString *const ORKVoiceFeatureMeanFundamentalFrequencyKey ORK_AVAILABLE_DECL;
+
+/// The mean absolute difference between the periods of consecutive voiced frames, relative to the mean period.
+ORK_EXTERN NSString *const ORKVoiceFeatureJitterKey ORK_AVAILABLE_DECL;
+
+/// The mean absolute difference between the amplitudes of consecutive voiced frames, relative to the mean amplitude.
+ORK_EXTERN NSString *const ORKVoiceFeatureShimmerKey ORK_AVAILABLE_DECL;
+
+/// The mean harmonics-to-noise ratio in dB over the voiced frames.
+ORK_EXTERN NSString *const ORKVoiceFeatureHarmonicsToNoiseRatioKey ORK_AVAILABLE_DECL;
+
+
 /**
  The `ORKRecorderDelegate` protocol defines methods that the delegate of an `ORKRecorder` object should use to handle errors and log the
  completed results.
@@ -492,6 +636,21 @@ ORK_CLASS_AVAILABLE
 
 /// @name Runtime Life Cycle
 
+/**
+ Prepares the recorder to start.
+ 
+ Recorders that need time to spin up, such as those that create output files or start
+ sensors, do that work here, so that a later call to `start` begins recording immediately.
+ Data produced before `start` is called is discarded. Calling this method more than once,
+ or not at all, is allowed. A prepared recorder that is not needed is released by calling `stop`.
+ 
+ The active step view controller prepares its recorders before the step starts. The task
+ view controller also prepares the recorders of an upcoming active step while the step
+ before it, such as an instruction or countdown step, is on screen.
+ The default implementation does nothing.
+ */
+- (void)prepare;
+
 /**
  Starts data recording.
  
@@ -35,7 +35,10 @@
 #import "ORKRecorder_Private.h"
 #import "ORKHelpers.h"
 #import "ORKDataLogger.h"
+#import "ORKClock.h"
 #import "ORKDefines_Private.h"
+#import "ORKTraceBuffer_Internal.h"
+#import <pthread.h>
 
 
 @implementation ORKRecorderConfiguration
@@ -92,9 +95,79 @@
 @end
 
 
+NSString *const ORKContinuousRecorderStepIdentifierKey = @"stepIdentifier";
+NSString *const ORKContinuousRecorderSliceStartUptimeKey = @"sliceStartUptime";
+NSString *const ORKContinuousRecorderSliceEndUptimeKey = @"sliceEndUptime";
+NSString *const ORKRecorderStartLatencyKey = @"startLatency";
+NSString *const ORKRecorderDroppedSampleCountKey = @"droppedSampleCount";
+NSString *const ORKAudioRecorderTrimmedLeadingDurationKey = @"trimmedLeadingDuration";
+NSString *const ORKAudioRecorderVoiceFeaturesKey = @"voiceFeatures";
+
+
+@implementation ORKContinuousRecorderConfiguration
+
+- (instancetype)initWithRecorderConfiguration:(ORKRecorderConfiguration *)recorderConfiguration
+                              stepIdentifiers:(NSArray *)stepIdentifiers {
+    self = [super init];
+    if (self) {
+        ORKThrowInvalidArgumentExceptionIfNil(recorderConfiguration);
+        ORKThrowInvalidArgumentExceptionIfNil(stepIdentifiers);
+        _recorderConfiguration = recorderConfiguration;
+        _stepIdentifiers = [stepIdentifiers copy];
+    }
+    return self;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    self = [super init];
+    if (self) {
+        ORK_DECODE_OBJ_CLASS(aDecoder, recorderConfiguration, ORKRecorderConfiguration);
+        ORK_DECODE_OBJ_ARRAY(aDecoder, stepIdentifiers, NSString);
+    }
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    ORK_ENCODE_OBJ(aCoder, recorderConfiguration);
+    ORK_ENCODE_OBJ(aCoder, stepIdentifiers);
+}
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    // Immutable
+    return self;
+}
+
+- (BOOL)isEqual:(id)object {
+    if ([self class] != [object class]) {
+        return NO;
+    }
+    
+    __typeof(self) castObject = object;
+    return (ORKEqualObjects(self.recorderConfiguration, castObject.recorderConfiguration)
+            && ORKEqualObjects(self.stepIdentifiers, castObject.stepIdentifiers));
+}
+
+- (NSUInteger)hash {
+    return [_recorderConfiguration hash] ^ [_stepIdentifiers hash];
+}
+
+- (BOOL)includesStepWithIdentifier:(NSString *)stepIdentifier {
+    return (stepIdentifier != nil && [_stepIdentifiers containsObject:stepIdentifier]);
+}
+
+@end
+
+
 @implementation ORKRecorder {
     UIBackgroundTaskIdentifier _backgroundTask;
     NSUUID *_recorderUUID;
+    
+    // Samples are persisted on the loggers' queues; the first one to report sets firstSampleUptime.
+    pthread_mutex_t _firstSampleLock;
 }
 
 - (instancetype)init {
@@ -113,13 +186,21 @@
         self.step = step;
         _backgroundTask = NSNotFound;
         _recorderUUID = [NSUUID UUID];
+        pthread_mutex_init(&_firstSampleLock, NULL);
     }
     return self;
 }
 
+- (void)dealloc {
+    pthread_mutex_destroy(&_firstSampleLock);
+}
+
 - (void)viewController:(UIViewController *)viewController willStartStepWithView:(UIView *)view {
 }
 
+- (void)prepare {
+}
+
 - (void)start {
     if (self.continuesInBackground) {
         UIApplication *app = [UIApplication sharedApplication];
@@ -133,6 +214,16 @@
         }
     }
     self.startDate = [NSDate date];
+    self.firstSampleUptime = 0;
+    self.droppedSampleCount = nil;
+    self.startUptime = [self.clock currentUptime];
+}
+
+- (ORKClock *)clock {
+    if (! _clock) {
+        _clock = [ORKClock new];
+    }
+    return _clock;
 }
 
 - (void)stop {
@@ -140,6 +231,13 @@
     [self reset];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    [self stop];
+    if (completion) {
+        completion(nil, nil);
+    }
+}
+
 - (void)finishRecordingWithError:(NSError *)error {
     // NOTE. This method may be called multiple times (once when someone tries
     // to finish, and another time with -stop is actually called.
@@ -205,6 +303,45 @@
 
 - (void)reset {
     _recorderUUID = [NSUUID UUID];
+    self.startUptime = 0;
+    self.firstSampleUptime = 0;
+    self.droppedSampleCount = nil;
+}
+
+- (void)noteSamplePersisted {
+    BOOL first = NO;
+    pthread_mutex_lock(&_firstSampleLock);
+    if (self.firstSampleUptime == 0) {
+        self.firstSampleUptime = [_clock currentUptime];
+        first = YES;
+    }
+    pthread_mutex_unlock(&_firstSampleLock);
+    if (first) {
+        ORK_TRACE_INSTANT("recorder", "firstSample");
+    }
+}
+
+- (ORKDataLogger *)makePreparedJSONDataLoggerWithError:(NSError * __autoreleasing *)error {
+    ORKDataLogger *logger = [self makeJSONDataLoggerWithError:error];
+    if (logger && ! [logger openCurrentLogWithError:error]) {
+        return nil;
+    }
+    return logger;
+}
+
+- (ORKDataLogger *)dataLogger {
+    return nil;
+}
+
+- (BOOL)appendStepBoundary:(NSString *)boundary stepIdentifier:(NSString *)stepIdentifier uptime:(NSTimeInterval)uptime error:(NSError * __autoreleasing *)error {
+    ORKDataLogger *logger = [self dataLogger];
+    if (! logger) {
+        return YES;
+    }
+    return [logger append:@{ @"stepBoundary" : boundary,
+                             @"stepIdentifier" : stepIdentifier,
+                             @"timestamp" : @(uptime) }
+                    error:error];
 }
 
 - (NSString *)mimeType {
@@ -215,6 +352,77 @@
     return nil;
 }
 
+- (NSDictionary *)resultUserInfo {
+    NSMutableDictionary *resultUserInfo = [NSMutableDictionary dictionaryWithDictionary:[self userInfo] ? : @{}];
+    resultUserInfo[ORKResultTimeBaseKey] = [self.clock timeBase];
+    
+    NSTimeInterval startUptime = self.startUptime;
+    NSTimeInterval firstSampleUptime = self.firstSampleUptime;
+    if (startUptime > 0 && firstSampleUptime > 0) {
+        resultUserInfo[ORKRecorderStartLatencyKey] = @(MAX(firstSampleUptime - startUptime, 0));
+    }
+    NSNumber *droppedSampleCount = self.droppedSampleCount;
+    if (droppedSampleCount) {
+        resultUserInfo[ORKRecorderDroppedSampleCountKey] = droppedSampleCount;
+    }
+    return [resultUserInfo copy];
+}
+
+- (NSError *)noDataError {
+    return [NSError errorWithDomain:NSCocoaErrorDomain
+                               code:NSFileReadNoSuchFileError
+                           userInfo:@{NSLocalizedDescriptionKey:ORKLocalizedString(@"ERROR_RECORDER_NO_DATA", nil)}];
+}
+
+- (void)finishJSONLogger:(ORKDataLogger *)logger recordingError:(NSError *)recordingError {
+    NSError *error = nil;
+    NSURL *fileUrl = [logger finishCurrentLogWithError:&error];
+    [self reportFileResultWithFile:fileUrl error:recordingError ? : error];
+}
+
+- (void)finishJSONLogger:(ORKDataLogger *)logger recordingError:(NSError *)recordingError completion:(ORKRecorderStopCompletion)completion {
+    ORKFileResult *result = [[ORKFileResult alloc] initWithIdentifier:self.identifier];
+    result.contentType = [self mimeType];
+    result.userInfo = [self resultUserInfo];
+    result.startDate = self.startDate;
+    result.endDate = [NSDate date];
+    
+    // Point future recording at a new directory now; the old log is finished in the background.
+    [self finishRecordingWithError:nil];
+    [self reset];
+    
+    void (^reportBlock)(NSURL *, NSError *) = ^(NSURL *fileUrl, NSError *error) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            NSError *finalError = recordingError ? : error;
+            if (fileUrl && ! finalError) {
+                result.fileURL = fileUrl;
+                if (completion) {
+                    completion(result, nil);
+                }
+                return;
+            }
+            
+            if (! finalError) {
+                finalError = [self noDataError];
+            }
+            // Only notify; the recorder may already have been restarted.
+            id<ORKRecorderDelegate> localDelegate = self.delegate;
+            if (localDelegate && [localDelegate respondsToSelector:@selector(recorder:didFailWithError:)]) {
+                [localDelegate recorder:self didFailWithError:finalError];
+            }
+            if (completion) {
+                completion(nil, finalError);
+            }
+        });
+    };
+    
+    if (logger) {
+        [logger finishCurrentLogWithCompletion:reportBlock];
+    } else {
+        reportBlock(nil, nil);
+    }
+}
+
 - (void)applyFileProtection:(ORKFileProtectionMode)fileProtection toFileAtURL:(NSURL *)url {
     NSFileManager *fileManager = [NSFileManager defaultManager];
     NSError *error = nil;
@@ -231,8 +439,9 @@
             ORKFileResult *result = [[ORKFileResult alloc] initWithIdentifier:self.identifier];
             result.contentType = [self mimeType];
             result.fileURL = fileUrl;
-            result.userInfo = [self userInfo];
+            result.userInfo = [self resultUserInfo];
             result.startDate = self.startDate;
+            result.endDate = [NSDate date];
             
             [localDelegate recorder:self didCompleteWithResult:result];
             
@@ -241,9 +450,7 @@
         }
     } else {
         if (! error) {
-            error = [NSError errorWithDomain:NSCocoaErrorDomain
-                                        code:NSFileReadNoSuchFileError
-                                    userInfo:@{NSLocalizedDescriptionKey:ORKLocalizedString(@"ERROR_RECORDER_NO_DATA", nil)}];
+            error = [self noDataError];
         }
         [self finishRecordingWithError:error];
     }
@@ -35,6 +35,9 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class ORKDataLogger;
+@class ORKClock;
+
+typedef void (^ORKRecorderStopCompletion)(ORKResult * _Nullable result, NSError * _Nullable error);
 
 @interface ORKRecorderConfiguration ()
 
@@ -51,16 +54,67 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, copy, nullable) NSDate *startDate;
 
+// Usually the task's clock; a recorder without one creates its own on first use.
+@property (nonatomic, strong, null_resettable) ORKClock *clock;
+
+// System uptime at the last call to -start, and at the first sample written after it; 0 if unset.
+@property (atomic) NSTimeInterval startUptime;
+@property (atomic) NSTimeInterval firstSampleUptime;
+
+// Set before -start when performance metrics are collected. Recorders that can tell then estimate
+// the samples the sensor dropped; otherwise their results carry no dropped sample count.
+@property (nonatomic) BOOL countsDroppedSamples;
+
+// Samples the sensor is estimated to have dropped since -start; nil unless counted.
+@property (atomic, copy, nullable) NSNumber *droppedSampleCount;
+
 - (NSString *)recorderType;
 
 - (nullable ORKDataLogger *)makeJSONDataLoggerWithError:(NSError * __autoreleasing *)error NS_REQUIRES_SUPER;
 
+// Makes a JSON logger whose output file is already created, for use from -prepare.
+- (nullable ORKDataLogger *)makePreparedJSONDataLoggerWithError:(NSError * __autoreleasing *)error;
+
 - (void)reset NS_REQUIRES_SUPER;
 
+// Call from any queue after a sample has been written; records the start latency once.
+- (void)noteSamplePersisted;
+
+// The result's userInfo: -userInfo plus the clock's time base, the start latency if a sample was written,
+// and the dropped sample count if known.
+- (NSDictionary *)resultUserInfo;
+
 - (void)reportFileResultWithFile:(NSURL *)fileUrl error:(nullable NSError *)error;
 
+- (NSError *)noDataError;
+
+/*
+ Stops recording without blocking the caller on file I/O.
+ 
+ Data collection stops, and the recorder is reset so it can be started again, before this
+ method returns. The output is finalized in the background and `completion` is called on
+ the main queue. A successful result goes to `completion` instead of the delegate; errors
+ are reported to both.
+ 
+ The default implementation calls -stop, so the delegate receives the result, and then
+ calls `completion` with neither a result nor an error.
+ */
+- (void)stopWithCompletion:(nullable ORKRecorderStopCompletion)completion;
+
+// Finishes a JSON log and reports its file to the delegate, synchronously.
+- (void)finishJSONLogger:(nullable ORKDataLogger *)logger recordingError:(nullable NSError *)recordingError;
+
+// Resets the recorder, then finishes the JSON log on the logger's queue; see -stopWithCompletion:.
+- (void)finishJSONLogger:(nullable ORKDataLogger *)logger recordingError:(nullable NSError *)recordingError completion:(nullable ORKRecorderStopCompletion)completion;
+
 - (nullable NSURL *)recordingDirectoryURL;
 
+// Recorders that log JSON return their current logger; others return nil.
+- (nullable ORKDataLogger *)dataLogger;
+
+// Writes a step boundary marker into the JSON log, if the recorder has one.
+- (BOOL)appendStepBoundary:(NSString *)boundary stepIdentifier:(NSString *)stepIdentifier uptime:(NSTimeInterval)uptime error:(NSError * __autoreleasing *)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
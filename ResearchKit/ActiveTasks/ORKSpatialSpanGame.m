@@ -30,6 +30,7 @@
 
 
 #import "ORKSpatialSpanGame.h"
+#import "ORKRandomNumberGenerator.h"
 
 
 @implementation ORKSpatialSpanGame {
@@ -45,15 +46,11 @@
         _sequence[i] = i;
     }
     
-    // Knuth algorithm: swap each with a random element elsewhere in the array.
-    // Note: we will only use the first _sequenceLength elements of this array
-    srandom(_seed);
-    for (NSInteger i = 0; i < _gameSize; i++) {
-        NSInteger rand_i = random() % _gameSize;
-        NSInteger tmp = _sequence[i];
-        _sequence[i] = _sequence[rand_i];
-        _sequence[rand_i] = tmp;
-    }
+    // Shuffle the whole permutation with a generator private to this game, so the seed alone
+    // determines the sequence. Only the first _sequenceLength elements of this array are used,
+    // so games with the same seed and size share a prefix regardless of their length.
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:_seed];
+    [generator shuffleIntegers:_sequence count:_gameSize];
 }
 
 - (void)dealloc {
@@ -90,7 +87,7 @@
 - (void)enumerateSequenceWithHandler:(void(^)(NSInteger step, NSInteger tileIndex, BOOL isLastStep, BOOL *stop))handler {
     BOOL stop = NO;
     for (NSInteger i = 0; i < _sequenceLength; i++) {
-        handler(i, _sequence[i], (i == _sequenceLength), &stop);
+        handler(i, _sequence[i], (i == _sequenceLength - 1), &stop);
         if (stop) break;
     }
 }
@@ -0,0 +1,88 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+#import "ORKResult.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Builds an `ORKSpatialSpanMemoryGameRecord` while a game is played.
+ 
+ Touches are appended to packed storage in amortized O(1), and the derived metrics are
+ updated with each touch, so nothing is rescanned or copied per touch. The record itself
+ is built once, on first request after the last change, and cached.
+ 
+ Not thread safe.
+ */
+@interface ORKSpatialSpanMemoryGameRecordBuilder : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+// `sequence` holds the tile indexes to be tapped, as `NSNumber` objects.
+- (instancetype)initWithSeed:(uint32_t)seed gameSize:(NSInteger)gameSize sequence:(NSArray *)sequence NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, copy, nullable) NSArray *targetRects;
+
+@property (nonatomic) ORKSpatialSpanMemoryGameStatus gameStatus;
+
+@property (nonatomic) NSInteger score;
+
+@property (nonatomic, readonly) NSUInteger touchCount;
+
+@property (nonatomic, readonly) NSInteger correctSequenceLength;
+
+@property (nonatomic, readonly) NSInteger numberOfErrors;
+
+@property (nonatomic, readonly) NSTimeInterval meanTimePerTarget;
+
+/*
+ Uptime of the first gameplay frame. Touch timestamps are already relative to it; stimulus
+ onsets are converted when the record is built.
+ */
+@property (nonatomic) NSTimeInterval timestampOriginUptime;
+
+// Records when a highlighted target reached the screen, as a `CACurrentMediaTime()` value.
+- (void)addStimulusOnsetUptime:(NSTimeInterval)uptime;
+
+/*
+ Records a touch; `targetIndex` is -1 for a touch outside all targets. Returns whether the
+ touch hit the next target in the sequence.
+ */
+- (BOOL)addTouchWithTimestamp:(NSTimeInterval)timestamp location:(CGPoint)location targetIndex:(NSInteger)targetIndex;
+
+- (ORKSpatialSpanMemoryGameRecord *)record;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,142 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKSpatialSpanMemoryGameRecordBuilder.h"
+#import "ORKResult_Private.h"
+#import "ORKPackedSampleStore.h"
+
+
+@implementation ORKSpatialSpanMemoryGameRecordBuilder {
+    uint32_t _seed;
+    NSInteger _gameSize;
+    NSArray *_sequence;
+    NSMutableData *_sequenceIndexes;
+    
+    ORKSpatialSpanMemoryGameTouchSampleStore *_touchSampleStore;
+    NSTimeInterval _lastCorrectTimestamp;
+    NSMutableArray *_stimulusOnsetUptimes;
+    
+    ORKSpatialSpanMemoryGameRecord *_record;
+}
+
+- (instancetype)initWithSeed:(uint32_t)seed gameSize:(NSInteger)gameSize sequence:(NSArray *)sequence {
+    self = [super init];
+    if (self) {
+        _seed = seed;
+        _gameSize = gameSize;
+        _sequence = [sequence copy];
+        
+        // Unboxed once, so checking a touch is a single array lookup.
+        _sequenceIndexes = [NSMutableData dataWithLength:_sequence.count * sizeof(NSInteger)];
+        NSInteger *indexes = (NSInteger *)_sequenceIndexes.mutableBytes;
+        [_sequence enumerateObjectsUsingBlock:^(NSNumber *tileIndex, NSUInteger idx, BOOL *stop) {
+            indexes[idx] = tileIndex.integerValue;
+        }];
+        
+        _touchSampleStore = [ORKSpatialSpanMemoryGameTouchSampleStore new];
+        _stimulusOnsetUptimes = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)setTargetRects:(NSArray *)targetRects {
+    _targetRects = [targetRects copy];
+    _record = nil;
+}
+
+- (void)setGameStatus:(ORKSpatialSpanMemoryGameStatus)gameStatus {
+    _gameStatus = gameStatus;
+    _record = nil;
+}
+
+- (void)setScore:(NSInteger)score {
+    _score = score;
+    _record = nil;
+}
+
+- (void)setTimestampOriginUptime:(NSTimeInterval)timestampOriginUptime {
+    _timestampOriginUptime = timestampOriginUptime;
+    _record = nil;
+}
+
+- (void)addStimulusOnsetUptime:(NSTimeInterval)uptime {
+    [_stimulusOnsetUptimes addObject:@(uptime)];
+    _record = nil;
+}
+
+- (NSUInteger)touchCount {
+    return _touchSampleStore.count;
+}
+
+- (NSTimeInterval)meanTimePerTarget {
+    return _correctSequenceLength > 0 ? _lastCorrectTimestamp / _correctSequenceLength : 0;
+}
+
+- (BOOL)addTouchWithTimestamp:(NSTimeInterval)timestamp location:(CGPoint)location targetIndex:(NSInteger)targetIndex {
+    const NSInteger *indexes = (const NSInteger *)_sequenceIndexes.bytes;
+    BOOL correct = (_correctSequenceLength < (NSInteger)_sequence.count && targetIndex == indexes[_correctSequenceLength]);
+    
+    [_touchSampleStore appendSampleWithTimestamp:timestamp location:location targetIndex:targetIndex correct:correct];
+    if (correct) {
+        _correctSequenceLength++;
+        _lastCorrectTimestamp = timestamp;
+    } else {
+        _numberOfErrors++;
+    }
+    _record = nil;
+    return correct;
+}
+
+- (ORKSpatialSpanMemoryGameRecord *)record {
+    if (! _record) {
+        ORKSpatialSpanMemoryGameRecord *record = [ORKSpatialSpanMemoryGameRecord new];
+        record.seed = _seed;
+        record.gameSize = _gameSize;
+        record.sequence = _sequence;
+        record.targetRects = _targetRects;
+        record.touchSampleStore = _touchSampleStore;
+        record.gameStatus = _gameStatus;
+        record.score = _score;
+        record.correctSequenceLength = _correctSequenceLength;
+        record.numberOfErrors = _numberOfErrors;
+        record.meanTimePerTarget = self.meanTimePerTarget;
+        
+        NSMutableArray *onsets = [NSMutableArray arrayWithCapacity:_stimulusOnsetUptimes.count];
+        for (NSNumber *uptime in _stimulusOnsetUptimes) {
+            [onsets addObject:@(uptime.doubleValue - _timestampOriginUptime)];
+        }
+        record.stimulusOnsetTimestamps = onsets;
+        _record = record;
+    }
+    return _record;
+}
+
+@end
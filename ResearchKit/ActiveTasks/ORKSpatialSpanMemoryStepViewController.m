@@ -45,6 +45,8 @@
 #import <QuartzCore/CABase.h>
 #import "ORKSpatialSpanMemoryStep.h"
 #import "ORKActiveStepView.h"
+#import "ORKSpatialSpanMemoryGameRecordBuilder.h"
+#import "ORKStimulusScheduler.h"
 
 
 static const NSTimeInterval kMemoryGameActivityTimeout = 20;
@@ -113,12 +115,15 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
     
     ORKSpatialSpanGameState *_currentGameState;
     
-    // ORKSpatialSpanMemoryGameRecord
+    // ORKSpatialSpanMemoryGameRecord, one for each finished game
     NSMutableArray *_gameRecords;
+    ORKSpatialSpanMemoryGameRecordBuilder *_gameRecordBuilder;
     NSTimeInterval _gameStartTime;
     NSInteger _lastRoundScore;
     
-    NSInteger _playbackIndex;
+    // Playback is presented on display frame boundaries
+    ORKStimulusScheduler *_stimulusScheduler;
+    NSTimeInterval _gameplayOnsetTime;
     
     NSInteger _score;
     NSInteger _numberOfItems;
@@ -127,7 +132,6 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
     NSInteger _consecutiveGamesFailed;
     NSInteger _nextGameSequenceLength;
     
-    NSTimer *_playbackTimer;
     NSTimer *_activityTimer;
 }
 
@@ -158,6 +162,8 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
     
     [self resetUI];
     
+    _stimulusScheduler = [ORKStimulusScheduler new];
+    
     UITapGestureRecognizer *tapGestureRecognizer = [[UITapGestureRecognizer alloc] initWithTarget:self action:@selector(handleUserTap:)];
     [self.activeStepView addGestureRecognizer:tapGestureRecognizer];
 }
@@ -215,10 +221,15 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
     
     NSMutableArray *records = [NSMutableArray new];
     
+    NSMutableArray *allRecords = [NSMutableArray arrayWithArray:_gameRecords];
+    if (_gameRecordBuilder) {
+        [allRecords addObject:[_gameRecordBuilder record]];
+    }
+    
     __block NSInteger numberOfFailures = 0;
     __block NSInteger score = 0;
     // Only include valid records
-    [_gameRecords enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop) {
+    [allRecords enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop) {
         ORKSpatialSpanMemoryGameRecord *record = (ORKSpatialSpanMemoryGameRecord *)obj;
         if (record.gameStatus != ORKSpatialSpanMemoryGameStatusUnknown) {
             [records addObject:record];
@@ -244,43 +255,41 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
 
 #pragma mark UpdateGameRecord
 
-- (ORKSpatialSpanMemoryGameRecord *)currentGameRecord {
-    return _gameRecords? [_gameRecords lastObject] : nil;
-}
-
 - (void)createGameRecord {
     if (_gameRecords == nil) {
         _gameRecords = [NSMutableArray new];
     }
     
-    ORKSpatialSpanMemoryGameRecord *gameRecord = [ORKSpatialSpanMemoryGameRecord new];
-    gameRecord.seed = _currentGameState.game.seed;
-    gameRecord.gameSize = _currentGameState.game.gameSize;
+    // The previous game is over; freeze its record.
+    if (_gameRecordBuilder) {
+        [_gameRecords addObject:[_gameRecordBuilder record]];
+    }
     
     NSMutableArray *targetSequence = [NSMutableArray new];
     [_currentGameState.game enumerateSequenceWithHandler:^(NSInteger step, NSInteger tileIndex, BOOL isLastStep, BOOL *stop) {
         [targetSequence addObject:@(tileIndex)];
     }];
-    gameRecord.sequence = [targetSequence copy];
-    [_gameRecords addObject:gameRecord];
+    _gameRecordBuilder = [[ORKSpatialSpanMemoryGameRecordBuilder alloc] initWithSeed:_currentGameState.game.seed
+                                                                             gameSize:_currentGameState.game.gameSize
+                                                                             sequence:targetSequence];
     
     _lastRoundScore = _score;
 }
 
 - (void)updateGameRecordTargetRects {
-    ORKSpatialSpanMemoryGameRecord *record = [self currentGameRecord];
     NSArray *tileViews = _contentView.gameView.tileViews;
     NSMutableArray *targetRects = [NSMutableArray new];
     for (UIView *tileView in tileViews) {
         CGRect rect = [self.view convertRect:tileView.frame fromView:tileView.superview];
         [targetRects addObject:[NSValue valueWithCGRect:rect]];
     }
-    record.targetRects = [targetRects copy];
-    NSAssert(tileViews.count == 0 || tileViews.count == record.gameSize, nil);
+    _gameRecordBuilder.targetRects = targetRects;
+    NSAssert(tileViews.count == 0 || tileViews.count == _currentGameState.game.gameSize, nil);
 }
 
 - (void)updateGameRecordOnStartingGamePlay {
-    _gameStartTime = CACurrentMediaTime();
+    _gameStartTime = (_gameplayOnsetTime > 0) ? _gameplayOnsetTime : CACurrentMediaTime();
+    _gameRecordBuilder.timestampOriginUptime = _gameStartTime;
 }
 
 - (void)handleUserTap:(UITapGestureRecognizer *)tapRecognizer {
@@ -291,51 +300,28 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
 }
 
 - (void)updateGameRecordOnTouch:(NSInteger)targetIndex location:(CGPoint)location {
-    ORKSpatialSpanMemoryGameTouchSample *sample = [ORKSpatialSpanMemoryGameTouchSample new];
-    
-    sample.timestamp = CACurrentMediaTime() - _gameStartTime;
-    sample.location = location;
-    sample.targetIndex = targetIndex;
-    
-    ORKSpatialSpanMemoryGameRecord *record = [self currentGameRecord];
-    
-    NSAssert(record, nil);
-    
-    NSInteger currentStep = 0;
-    
-    for (ORKSpatialSpanMemoryGameTouchSample *aSample in record.touchSamples) {
-        if (aSample.isCorrect) {
-            currentStep++;
-        }
-    }
-    
-    sample.correct = (targetIndex == [_currentGameState.game tileIndexForStep:currentStep]);
-    
-    NSMutableArray *sampleArray = [NSMutableArray arrayWithArray:record.touchSamples];
-    
-    [sampleArray addObject:sample];
-    
-    record.touchSamples = [sampleArray copy];
+    NSAssert(_gameRecordBuilder, nil);
+    [_gameRecordBuilder addTouchWithTimestamp:CACurrentMediaTime() - _gameStartTime location:location targetIndex:targetIndex];
 }
 
 - (void)updateGameRecordOnSuccess {
-    [self currentGameRecord].gameStatus = ORKSpatialSpanMemoryGameStatusSuccess;
+    _gameRecordBuilder.gameStatus = ORKSpatialSpanMemoryGameStatusSuccess;
 }
 
 - (void)updateGameRecordOnFailure {
-    [self currentGameRecord].gameStatus = ORKSpatialSpanMemoryGameStatusFailure;
+    _gameRecordBuilder.gameStatus = ORKSpatialSpanMemoryGameStatusFailure;
 }
 
 - (void)updateGameRecordOnTimeout {
-    [self currentGameRecord].gameStatus = ORKSpatialSpanMemoryGameStatusTimeout;
+    _gameRecordBuilder.gameStatus = ORKSpatialSpanMemoryGameStatusTimeout;
 }
 
 - (void)updateGameRecordScore {
-    [self currentGameRecord].score = _score - _lastRoundScore;
+    _gameRecordBuilder.score = _score - _lastRoundScore;
 }
 
 - (void)updateGameRecordOnPause {
-    [self currentGameRecord].gameStatus = ORKSpatialSpanMemoryGameStatusUnknown;
+    _gameRecordBuilder.gameStatus = ORKSpatialSpanMemoryGameStatusUnknown;
 }
 
 #pragma mark ORKSpatialSpanStepStateInitial
@@ -389,50 +375,61 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
 
 #pragma mark ORKSpatialSpanStepStatePlayback
 
-- (void)applyTargetState:(ORKSpatialSpanTargetState)targetState toSequenceIndex:(NSInteger)index duration:(NSTimeInterval)duration {
+- (void)applyTargetState:(ORKSpatialSpanTargetState)targetState toSequenceIndex:(NSInteger)index {
     ORKSpatialSpanGame *game = _currentGameState.game;
     if (index == NSNotFound || index < 0 || index >= game.sequenceLength ) {
         return;
     }
     
+    // Not animated, so the highlight appears in full on its scheduled frame.
     NSInteger tileIndex = [game tileIndexForStep:index];
     ORKSpatialSpanMemoryGameView *gameView = _contentView.gameView;
-    [gameView setState:targetState forTileIndex:tileIndex animated:YES];
-    if (duration > 0 && targetState != ORKSpatialSpanTargetStateQuiescent) {
-        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(duration * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
-            [self applyTargetState:ORKSpatialSpanTargetStateQuiescent toSequenceIndex:index duration:0];
-        });
-    }
+    [gameView setState:targetState forTileIndex:tileIndex animated:NO];
 }
 
-- (void)playbackNextItem {
+- (void)schedulePlayback {
+    ORKSpatialSpanMemoryStep *step = [self spatialSpanStep];
     const NSInteger sequenceLength = _currentGameState.game.sequenceLength;
-    if (_playbackIndex >= sequenceLength) {
-        [self transitionToState:ORKSpatialSpanStepStateGameplay];
-    } else {
-        ORKSpatialSpanMemoryStep *step = [self spatialSpanStep];
-        
-        NSInteger index = _playbackIndex;
-        NSInteger previousIndex = index-1;
+    const NSTimeInterval playSpeed = step.playSpeed;
+    CFTimeInterval start = CACurrentMediaTime() + playSpeed;
+    
+    __weak __typeof(self) weakSelf = self;
+    for (NSInteger sequenceStep = 0; sequenceStep < sequenceLength; sequenceStep++) {
+        NSInteger index = sequenceStep;
         if (step.requireReversal) {
             // Play the indexes in reverse order when we require reversal. The participant
             // is then required to tap the sequence in the forward direction, which
             // appears as a reversal to them.
             index = sequenceLength - 1 - index;
-            previousIndex = sequenceLength - 1 - previousIndex;
         }
         
-        // Make sure the previous step *is *cleared
-        [self applyTargetState:ORKSpatialSpanTargetStateQuiescent toSequenceIndex:previousIndex duration:0];
-        
-        // The active display should be visible for half the timer interval
-        [self applyTargetState:ORKSpatialSpanTargetStateActive toSequenceIndex:index duration:step.playSpeed/2];
+        // Each target is active for half the interval.
+        CFTimeInterval onset = start + sequenceStep * playSpeed;
+        [_stimulusScheduler scheduleStimulusAtTime:onset handler:^(CFTimeInterval presentationTime, CFTimeInterval frameDuration) {
+            [weakSelf playbackDidPresentSequenceIndex:index presentationTime:presentationTime];
+        }];
+        [_stimulusScheduler scheduleStimulusAtTime:onset + playSpeed / 2 handler:^(CFTimeInterval presentationTime, CFTimeInterval frameDuration) {
+            [weakSelf applyTargetState:ORKSpatialSpanTargetStateQuiescent toSequenceIndex:index];
+        }];
     }
-    _playbackIndex++;
+    
+    [_stimulusScheduler scheduleStimulusAtTime:start + sequenceLength * playSpeed handler:^(CFTimeInterval presentationTime, CFTimeInterval frameDuration) {
+        [weakSelf playbackDidFinishWithPresentationTime:presentationTime];
+    }];
+}
+
+- (void)playbackDidPresentSequenceIndex:(NSInteger)index presentationTime:(CFTimeInterval)presentationTime {
+    [self applyTargetState:ORKSpatialSpanTargetStateActive toSequenceIndex:index];
+    [_gameRecordBuilder addStimulusOnsetUptime:presentationTime];
+}
+
+- (void)playbackDidFinishWithPresentationTime:(CFTimeInterval)presentationTime {
+    _gameplayOnsetTime = presentationTime;
+    [self transitionToState:ORKSpatialSpanStepStateGameplay];
+    _gameplayOnsetTime = 0;
 }
 
 - (void)startPlayback {
-    _playbackIndex = 0;
     _contentView.footerHidden = YES;
     _contentView.buttonItem = nil;
     ORKSpatialSpanMemoryStep *step = [self spatialSpanStep];
@@ -442,12 +439,11 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
     
     [_contentView.gameView resetTilesAnimated:NO];
     
-    _playbackTimer = [NSTimer scheduledTimerWithTimeInterval:step.playSpeed target:self selector:@selector(playbackNextItem) userInfo:nil repeats:YES];
+    [self schedulePlayback];
 }
 
 - (void)finishPlayback {
-    [_playbackTimer invalidate];
-    _playbackTimer = nil;
+    [_stimulusScheduler cancelAllStimuli];
 }
 
 #pragma mark ORKSpatialSpanStepStateGameplay
@@ -653,7 +649,7 @@ typedef void (^_ORKStateHandler)(ORKState *fromState, ORKState *_toState, id con
     // Do not update game counters - doesn't count as a game.
     
     [_activityTimer invalidate]; _activityTimer = nil;
-    [_playbackTimer invalidate]; _playbackTimer = nil;
+    [_stimulusScheduler cancelAllStimuli];
     
     [self resetForNewGame];
     [self.activeStepView updateTitle:ORKLocalizedString(@"MEMORY_GAME_PAUSED_TITLE", nil) text:ORKLocalizedString(@"MEMORY_GAME_PAUSED_MESSAGE", nil)];
@@ -35,6 +35,7 @@
 #import "ORKTintedImageView.h"
 #import "ORKAccessibility.h"
 #import "ORKDefines_Private.h"
+#import <QuartzCore/QuartzCore.h>
 
 
 static const UIEdgeInsets _ORKFlowerMargins = (UIEdgeInsets){12,12,12,12};
@@ -107,6 +108,10 @@ static UIBezierPath *ORKErrorBezierPath() {
     return bezier3Path;
 }
 
+/*
+ Renders a path with a `CAShapeLayer`, so state changes that recolor or rescale the path
+ update layer properties instead of redrawing a bitmap.
+ */
 @interface ORKPathView : UIView
 
 - (instancetype)initWithBezierPath:(UIBezierPath *)path canvasSize:(CGSize)canvasSize canvasMargins:(UIEdgeInsets)margins color:(UIColor *)color;
@@ -121,6 +126,14 @@ static UIBezierPath *ORKErrorBezierPath() {
 
 @implementation ORKPathView
 
++ (Class)layerClass {
+    return [CAShapeLayer class];
+}
+
+- (CAShapeLayer *)shapeLayer {
+    return (CAShapeLayer *)self.layer;
+}
+
 - (instancetype)initWithBezierPath:(UIBezierPath *)path canvasSize:(CGSize)canvasSize canvasMargins:(UIEdgeInsets)margins color:(UIColor *)color {
     CGRect canvasRect = (CGRect){CGPointZero, canvasSize};
     CGRect outsetRect = UIEdgeInsetsInsetRect(canvasRect, (UIEdgeInsets){.top=-margins.top, .left=-margins.left, .right=-margins.right, .bottom=-margins.bottom});
@@ -132,7 +145,8 @@ static UIBezierPath *ORKErrorBezierPath() {
         _color = color;
         self.tintColor = color;
         self.opaque = NO;
-        [self setNeedsDisplay];
+        [self updateShapePath];
+        [self updateFillColor];
     }
     return self;
 }
@@ -140,34 +154,35 @@ static UIBezierPath *ORKErrorBezierPath() {
 - (void)setColor:(UIColor *)color {
     _color = color;
     self.tintColor = color;
-    [self setNeedsDisplay];
 }
 
-- (void)drawRect:(CGRect)rect {
+- (void)updateShapePath {
     CGRect bounds = [self bounds];
     
-    CGContextRef ctx = UIGraphicsGetCurrentContext();
-    [[UIColor clearColor] setFill];
-    CGContextFillRect(ctx, bounds);
-    
     CGFloat baseWidth = _canvasSize.width + _canvasMargins.left + _canvasMargins.right;
     CGFloat baseHeight = _canvasSize.height + _canvasMargins.top + _canvasMargins.bottom;
     
     CGFloat aspectRatio = MIN( bounds.size.width / baseWidth, bounds.size.height / baseHeight);
     
-    CGContextSaveGState(ctx);
-    
-    CGContextScaleCTM(ctx, aspectRatio, aspectRatio);
-    CGContextTranslateCTM(ctx, _canvasMargins.left, _canvasMargins.top);
+    CGAffineTransform transform = CGAffineTransformMakeScale(aspectRatio, aspectRatio);
+    transform = CGAffineTransformTranslate(transform, _canvasMargins.left, _canvasMargins.top);
     
-    [self.tintColor setFill];
-    [_path fill];
-    
-    CGContextRestoreGState(ctx);
+    CGPathRef path = CGPathCreateCopyByTransformingPath(_path.CGPath, &transform);
+    [self shapeLayer].path = path;
+    CGPathRelease(path);
+}
+
+- (void)updateFillColor {
+    [self shapeLayer].fillColor = self.tintColor.CGColor;
+}
+
+- (void)layoutSubviews {
+    [super layoutSubviews];
+    [self updateShapePath];
 }
 
 - (void)tintColorDidChange {
-    [self setNeedsDisplay];
+    [self updateFillColor];
 }
 
 @end
@@ -37,6 +37,14 @@ NS_ASSUME_NONNULL_BEGIN
 ORK_CLASS_AVAILABLE
 @interface ORKTappingIntervalStepViewController : ORKActiveStepViewController
 
+/**
+ Tapping statistics for the taps so far, or `nil` before the first tap.
+ 
+ The value is replaced after every tap and every release of a button, and is key-value observable,
+ so it can drive live feedback while the step runs.
+ */
+@property (nonatomic, copy, readonly, nullable) ORKTappingIntervalStatistics *statistics;
+
 @end
 
 NS_ASSUME_NONNULL_END
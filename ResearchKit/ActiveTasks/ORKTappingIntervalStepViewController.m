@@ -38,11 +38,17 @@
 #import "ORKResult.h"
 #import "ORKHelpers.h"
 #import "ORKActiveStepView.h"
+#import "ORKClock.h"
+#import "ORKResult_Private.h"
+#import "ORKPackedSampleStore.h"
+#import "ORKTappingStatisticsEngine.h"
 
 
 @interface ORKTappingIntervalStepViewController () <UIGestureRecognizerDelegate>
 
-@property (nonatomic, strong) NSMutableArray *samples;
+@property (nonatomic, strong) ORKTappingSampleStore *samples;
+
+@property (nonatomic, copy, nullable) ORKTappingIntervalStatistics *statistics;
 
 @end
 
@@ -58,6 +64,11 @@
     
     NSUInteger _hitButtonCount;
     
+    ORKTappingStatisticsEngine *_statisticsEngine;
+    
+    // Touch-down event times, indexed by button identifier, for dwell time.
+    NSTimeInterval _touchDownTimestamps[3];
+    
     UIGestureRecognizer *_touchDownRecognizer;
 }
 
@@ -97,6 +108,10 @@
     
     [_tappingContentView.tapButton1 addTarget:self action:@selector(buttonPressed:forEvent:) forControlEvents:UIControlEventTouchDown];
     [_tappingContentView.tapButton2 addTarget:self action:@selector(buttonPressed:forEvent:) forControlEvents:UIControlEventTouchDown];
+    
+    UIControlEvents releaseEvents = UIControlEventTouchUpInside | UIControlEventTouchUpOutside | UIControlEventTouchCancel;
+    [_tappingContentView.tapButton1 addTarget:self action:@selector(buttonReleased:forEvent:) forControlEvents:releaseEvents];
+    [_tappingContentView.tapButton2 addTarget:self action:@selector(buttonReleased:forEvent:) forControlEvents:releaseEvents];
 }
 
 - (void)viewDidAppear:(BOOL)animated {
@@ -123,7 +138,18 @@
     tappingResult.buttonRect2 = _buttonRect2;
     tappingResult.stepViewSize = _viewSize;
     
-    tappingResult.samples = _samples;
+    tappingResult.sampleStore = _samples;
+    tappingResult.statistics = [_statisticsEngine statistics];
+    
+    // Sample timestamps count from the first tap, on the same monotonic clock as the task's time base.
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
+    if (self.clock) {
+        userInfo[ORKResultTimeBaseKey] = [self.clock timeBase];
+    }
+    if (_tappingStart > 0) {
+        userInfo[ORKResultTimestampOriginUptimeKey] = @(_tappingStart);
+    }
+    tappingResult.userInfo = userInfo.count > 0 ? [userInfo copy] : nil;
     
     [results addObject:tappingResult];
     sResult.results = [results copy];
@@ -148,18 +174,15 @@
     // Add new sample
     mediaTime = mediaTime-_tappingStart;
     
-    ORKTappingSample *sample = [[ORKTappingSample alloc] init];
-    sample.buttonIdentifier = buttonIdentifier;
-    sample.location = location;
-    sample.timestamp = mediaTime;
-
-    [self.samples addObject:sample];
+    [self.samples appendSampleWithTimestamp:mediaTime location:location buttonIdentifier:buttonIdentifier];
+    [_statisticsEngine addTapWithTimestamp:mediaTime buttonIdentifier:buttonIdentifier];
     
     if (buttonIdentifier == ORKTappingButtonIdentifierLeft || buttonIdentifier == ORKTappingButtonIdentifierRight) {
         _hitButtonCount++;
     }
     // Update label
     [_tappingContentView setTapCount:_hitButtonCount];
+    self.statistics = [_statisticsEngine statistics];
 }
 
 - (void)stepDidFinish {
@@ -187,14 +210,32 @@
     
     if (self.samples == nil) {
         // Start timer on first touch event on button
-        _samples = [NSMutableArray array];
+        _samples = [ORKTappingSampleStore new];
+        _statisticsEngine = [ORKTappingStatisticsEngine new];
         _hitButtonCount = 0;
         [self start];
     }
     
     NSInteger index = (button == _tappingContentView.tapButton1) ? ORKTappingButtonIdentifierLeft : ORKTappingButtonIdentifierRight;
     
-    [self receiveTouch:[[event touchesForView:button] anyObject] onButton:index];
+    UITouch *touch = [[event touchesForView:button] anyObject];
+    _touchDownTimestamps[index] = touch.timestamp;
+    [self receiveTouch:touch onButton:index];
+}
+
+- (IBAction)buttonReleased:(id)button forEvent:(UIEvent *)event {
+    NSInteger index = (button == _tappingContentView.tapButton1) ? ORKTappingButtonIdentifierLeft : ORKTappingButtonIdentifierRight;
+    NSTimeInterval touchDown = _touchDownTimestamps[index];
+    _touchDownTimestamps[index] = 0;
+    if (_expired || touchDown == 0) {
+        return;
+    }
+    
+    UITouch *touch = [[event touchesForView:button] anyObject];
+    if (touch) {
+        [_statisticsEngine addDwellTime:touch.timestamp - touchDown];
+        self.statistics = [_statisticsEngine statistics];
+    }
 }
 
 #pragma mark UIGestureRecognizerDelegate
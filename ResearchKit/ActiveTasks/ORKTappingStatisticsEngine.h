@@ -0,0 +1,64 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import "ORKResult.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Accumulates tapping performance statistics one tap at a time.
+ 
+ Every update is O(1) in time and memory. Means, variances and the drift regression use
+ Welford-style running updates, which stay accurate over long sessions where the naive
+ sum-of-squares formulas lose precision.
+ 
+ Not thread safe.
+ */
+@interface ORKTappingStatisticsEngine : NSObject
+
+// Taps with `ORKTappingButtonIdentifierNone` are ignored. Timestamps must not decrease.
+- (void)addTapWithTimestamp:(NSTimeInterval)timestamp buttonIdentifier:(ORKTappingButtonIdentifier)buttonIdentifier;
+
+// Time between touch down and touch up on a button.
+- (void)addDwellTime:(NSTimeInterval)dwellTime;
+
+- (void)reset;
+
+@property (nonatomic, readonly) NSInteger tapCount;
+
+// A snapshot of the current values.
+- (ORKTappingIntervalStatistics *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,133 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKTappingStatisticsEngine.h"
+
+
+typedef struct {
+    NSUInteger count;
+    double mean;
+    double sumOfSquaredDeviations;
+} ORKRunningMoments;
+
+static void ORKRunningMomentsAdd(ORKRunningMoments *moments, double value) {
+    moments->count++;
+    double delta = value - moments->mean;
+    moments->mean += delta / moments->count;
+    moments->sumOfSquaredDeviations += delta * (value - moments->mean);
+}
+
+static double ORKRunningMomentsStandardDeviation(const ORKRunningMoments *moments) {
+    if (moments->count < 2) {
+        return 0;
+    }
+    return sqrt(moments->sumOfSquaredDeviations / (moments->count - 1));
+}
+
+
+@implementation ORKTappingStatisticsEngine {
+    ORKRunningMoments _intervals;
+    ORKRunningMoments _dwellTimes;
+    
+    // Time of the tap that ends each interval, for the drift regression.
+    ORKRunningMoments _intervalTimes;
+    double _intervalTimeCoMoment;
+    
+    NSUInteger _alternations;
+    
+    BOOL _hasPreviousTap;
+    NSTimeInterval _previousTimestamp;
+    ORKTappingButtonIdentifier _previousButtonIdentifier;
+}
+
+- (void)reset {
+    _tapCount = 0;
+    _intervals = (ORKRunningMoments){0};
+    _dwellTimes = (ORKRunningMoments){0};
+    _intervalTimes = (ORKRunningMoments){0};
+    _intervalTimeCoMoment = 0;
+    _alternations = 0;
+    _hasPreviousTap = NO;
+    _previousTimestamp = 0;
+    _previousButtonIdentifier = ORKTappingButtonIdentifierNone;
+}
+
+- (void)addTapWithTimestamp:(NSTimeInterval)timestamp buttonIdentifier:(ORKTappingButtonIdentifier)buttonIdentifier {
+    if (buttonIdentifier == ORKTappingButtonIdentifierNone) {
+        return;
+    }
+    _tapCount++;
+    
+    if (_hasPreviousTap) {
+        NSTimeInterval interval = timestamp - _previousTimestamp;
+        
+        // Co-moment of (time, interval), updated with the time mean before and after the new point.
+        double timeDelta = timestamp - _intervalTimes.mean;
+        ORKRunningMomentsAdd(&_intervalTimes, timestamp);
+        ORKRunningMomentsAdd(&_intervals, interval);
+        _intervalTimeCoMoment += timeDelta * (interval - _intervals.mean);
+        
+        if (buttonIdentifier != _previousButtonIdentifier) {
+            _alternations++;
+        }
+    }
+    
+    _hasPreviousTap = YES;
+    _previousTimestamp = timestamp;
+    _previousButtonIdentifier = buttonIdentifier;
+}
+
+- (void)addDwellTime:(NSTimeInterval)dwellTime {
+    ORKRunningMomentsAdd(&_dwellTimes, dwellTime);
+}
+
+- (ORKTappingIntervalStatistics *)statistics {
+    ORKTappingIntervalStatistics *statistics = [ORKTappingIntervalStatistics new];
+    statistics.tapCount = _tapCount;
+    
+    statistics.meanInterTapInterval = _intervals.mean;
+    statistics.interTapIntervalStandardDeviation = ORKRunningMomentsStandardDeviation(&_intervals);
+    if (_intervals.mean > 0) {
+        statistics.interTapIntervalCoefficientOfVariation = statistics.interTapIntervalStandardDeviation / _intervals.mean;
+    }
+    if (_intervals.count > 0) {
+        statistics.alternationAccuracy = (double)_alternations / _intervals.count;
+    }
+    if (_intervalTimes.count > 1 && _intervalTimes.sumOfSquaredDeviations > 0) {
+        statistics.interTapIntervalDrift = _intervalTimeCoMoment / _intervalTimes.sumOfSquaredDeviations;
+    }
+    
+    statistics.meanDwellTime = _dwellTimes.mean;
+    statistics.dwellTimeStandardDeviation = ORKRunningMomentsStandardDeviation(&_dwellTimes);
+    return statistics;
+}
+
+@end
@@ -93,8 +93,6 @@
 
 @property (nonatomic, strong) NSMutableArray *touchArray;
 
-@property (nonatomic) NSTimeInterval uptime;
-
 @property (nonatomic, strong) NSError *recordingError;
 
 @end
@@ -112,6 +110,15 @@
     }
 }
 
+- (void)prepare {
+    [super prepare];
+    
+    if (! _logger) {
+        // Failure is reported when -start tries again.
+        _logger = [self makePreparedJSONDataLoggerWithError:nil];
+    }
+}
+
 - (void)start {
     if (! _logger) {
         NSError *err = nil;
@@ -128,7 +135,6 @@
         [super start];
         
         self.touchArray = [NSMutableArray array];
-        _uptime = [NSProcessInfo processInfo].systemUptime;
     } else {
         @throw [NSException exceptionWithName:NSGenericException
                                        reason:@"No touch capture view provided"
@@ -146,19 +152,16 @@
 
 - (void)stop {
     [self doStopRecording];
-    [_logger finishCurrentLog];
-    
-    NSError *error = nil;
-    __block NSURL *fileUrl = nil;
-    [_logger enumerateLogs:^(NSURL *logFileUrl, BOOL *stop) {
-        fileUrl = logFileUrl;
-    } error:&error];
-    
-    [self reportFileResultWithFile:fileUrl error:error];
+    [self finishJSONLogger:_logger recordingError:nil];
     
     [super stop];
 }
 
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    [self doStopRecording];
+    [self finishJSONLogger:_logger recordingError:nil completion:completion];
+}
+
 - (void)doStopRecording {
     if (_touchView) {
         [self.touchView removeGestureRecognizer:self.gestureRecognizer];
@@ -179,6 +182,10 @@
     return @"application/json";
 }
 
+- (ORKDataLogger *)dataLogger {
+    return _logger;
+}
+
 - (void)reset {
     [super reset];
     
@@ -197,7 +204,9 @@
     if (![_logger append:[touch ork_JSONDictionaryInView:view allTouches:self.touchArray] error:&err]) {
         assert(err != nil);
         [self finishRecordingWithError:err];
+        return;
     }
+    [self noteSamplePersisted];
 }
 
 @end
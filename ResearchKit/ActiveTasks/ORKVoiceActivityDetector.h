@@ -0,0 +1,80 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Finds the span of a mono recording that contains speech, so that leading and trailing
+ silence can be trimmed.
+ 
+ Samples are summarized in 10 ms frames by their energy and zero-crossing rate as they
+ arrive; only the per-frame summaries are kept. When the stream is finished, the noise
+ floor is estimated from the quietest frames, and a frame counts as speech if it is well
+ above the floor, or moderately above it with the high zero-crossing rate of a fricative.
+ Frames below -50 dBFS are never speech, and isolated frames, such as clicks, are ignored.
+ 
+ Not thread safe.
+ */
+@interface ORKVoiceActivityDetector : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSampleRate:(double)sampleRate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) double sampleRate;
+
+@property (nonatomic, readonly) NSInteger frameLength;
+
+// Margin kept on each side of the detected speech. Defaults to 0.15 seconds.
+@property (nonatomic) NSTimeInterval padding;
+
+// Total number of samples processed.
+@property (nonatomic, readonly) NSInteger sampleCount;
+
+- (void)processSamples:(const float *)samples count:(NSInteger)count;
+
+// Classifies the frames. Call once, after the last samples.
+- (void)finish;
+
+// The following are valid after -finish.
+
+@property (nonatomic, readonly) BOOL hasSpeech;
+
+// Bounds of the speech, padding included, as a sample range; [0, 0) if there is no speech.
+@property (nonatomic, readonly) NSInteger speechStartSample;
+@property (nonatomic, readonly) NSInteger speechEndSample;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,180 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKVoiceActivityDetector.h"
+
+
+static const NSTimeInterval FrameDuration = 0.01;
+
+static const NSTimeInterval DefaultPadding = 0.15;
+
+// Energy of a silent frame; keeps log10 finite.
+static const double MinimumEnergyDecibels = -100;
+
+// The noise floor is the energy of the frame at this percentile.
+static const double NoiseFloorPercentile = 0.1;
+
+static const double SpeechMarginDecibels = 12;
+
+// Never require more than this below the loudest frame, so recordings without silence are kept whole.
+static const double MaximumDepthBelowPeakDecibels = 20;
+
+// Frames below this level are never speech, so a recording of background noise alone is all silence.
+static const double MinimumSpeechDecibels = -50;
+
+static const double FricativeMarginDecibels = 8;
+
+static const double FricativeZeroCrossingRate = 0.3;
+
+// Speech has to last this many consecutive frames to bound the span.
+static const NSInteger MinimumSpeechFrames = 3;
+
+typedef struct {
+    float energyDecibels;
+    float zeroCrossingRate;
+} ORKVoiceActivityFrame;
+
+@implementation ORKVoiceActivityDetector {
+    NSMutableData *_frames;
+    double _frameEnergy;
+    NSInteger _frameZeroCrossings;
+    NSInteger _frameSampleCount;
+    float _previousSample;
+}
+
+- (instancetype)initWithSampleRate:(double)sampleRate {
+    NSParameterAssert(sampleRate > 0);
+    self = [super init];
+    if (self) {
+        _sampleRate = sampleRate;
+        _frameLength = MAX((NSInteger)round(sampleRate * FrameDuration), 1);
+        _padding = DefaultPadding;
+        _frames = [NSMutableData data];
+    }
+    return self;
+}
+
+- (void)processSamples:(const float *)samples count:(NSInteger)count {
+    for (NSInteger i = 0; i < count; i++) {
+        float sample = samples[i];
+        _frameEnergy += (double)sample * sample;
+        if ((sample >= 0) != (_previousSample >= 0)) {
+            _frameZeroCrossings++;
+        }
+        _previousSample = sample;
+        _frameSampleCount++;
+        if (_frameSampleCount == _frameLength) {
+            [self closeFrame];
+        }
+    }
+    _sampleCount += count;
+}
+
+- (void)closeFrame {
+    double meanSquare = _frameEnergy / _frameSampleCount;
+    ORKVoiceActivityFrame frame;
+    frame.energyDecibels = (meanSquare > 0) ? MAX(10 * log10(meanSquare), MinimumEnergyDecibels) : MinimumEnergyDecibels;
+    frame.zeroCrossingRate = (float)_frameZeroCrossings / _frameSampleCount;
+    [_frames appendBytes:&frame length:sizeof(frame)];
+    
+    _frameEnergy = 0;
+    _frameZeroCrossings = 0;
+    _frameSampleCount = 0;
+}
+
+static int ORKCompareFloats(const void *a, const void *b) {
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+- (void)finish {
+    // A trailing partial frame is only meaningful if it is at least half full.
+    if (_frameSampleCount * 2 >= _frameLength) {
+        [self closeFrame];
+    }
+    
+    _hasSpeech = NO;
+    _speechStartSample = 0;
+    _speechEndSample = 0;
+    
+    NSInteger frameCount = _frames.length / sizeof(ORKVoiceActivityFrame);
+    if (frameCount == 0) {
+        return;
+    }
+    const ORKVoiceActivityFrame *frames = _frames.bytes;
+    
+    float *energies = malloc(frameCount * sizeof(float));
+    if (energies == NULL) {
+        return;
+    }
+    for (NSInteger i = 0; i < frameCount; i++) {
+        energies[i] = frames[i].energyDecibels;
+    }
+    qsort(energies, frameCount, sizeof(float), ORKCompareFloats);
+    double noiseFloor = energies[(NSInteger)(NoiseFloorPercentile * (frameCount - 1))];
+    double peak = energies[frameCount - 1];
+    free(energies);
+    
+    double speechThreshold = MIN(noiseFloor + SpeechMarginDecibels, peak - MaximumDepthBelowPeakDecibels);
+    double fricativeThreshold = MIN(noiseFloor + FricativeMarginDecibels, speechThreshold);
+    BOOL (^isSpeech)(NSInteger) = ^BOOL(NSInteger index) {
+        ORKVoiceActivityFrame frame = frames[index];
+        if (frame.energyDecibels <= MinimumSpeechDecibels) {
+            return NO;
+        }
+        return (frame.energyDecibels > speechThreshold ||
+                (frame.energyDecibels > fricativeThreshold && frame.zeroCrossingRate > FricativeZeroCrossingRate));
+    };
+    
+    NSInteger firstFrame = NSNotFound;
+    NSInteger lastFrame = NSNotFound;
+    NSInteger run = 0;
+    for (NSInteger i = 0; i < frameCount; i++) {
+        run = isSpeech(i) ? run + 1 : 0;
+        if (run >= MinimumSpeechFrames) {
+            if (firstFrame == NSNotFound) {
+                firstFrame = i - run + 1;
+            }
+            lastFrame = i;
+        }
+    }
+    if (firstFrame == NSNotFound) {
+        return;
+    }
+    
+    NSInteger paddingSamples = (NSInteger)round(_padding * _sampleRate);
+    _hasSpeech = YES;
+    _speechStartSample = MAX(firstFrame * _frameLength - paddingSamples, 0);
+    _speechEndSample = MIN((lastFrame + 1) * _frameLength + paddingSamples, _sampleCount);
+}
+
+@end
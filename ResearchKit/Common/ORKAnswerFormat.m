@@ -1019,7 +1019,11 @@ static NSArray *ork_processTextChoices(NSArray *textChoices) {
 
 #pragma mark - ORKNumericAnswerFormat
 
-@implementation ORKNumericAnswerFormat
+@implementation ORKNumericAnswerFormat {
+    // Bounds as doubles, for validation on every keystroke; infinite when unset.
+    double _minimumValue;
+    double _maximumValue;
+}
 
 - (Class)questionResultClass {
     return [ORKNumericQuestionResult class];
@@ -1041,13 +1045,40 @@ static NSArray *ork_processTextChoices(NSArray *textChoices) {
     return self;
 }
 
+// `minimum` and `maximum` are atomic, so the setters that cache their values come with matching getters.
+- (NSNumber *)minimum {
+    @synchronized (self) {
+        return _minimum;
+    }
+}
+
+- (void)setMinimum:(NSNumber *)minimum {
+    @synchronized (self) {
+        _minimum = [minimum copy];
+        _minimumValue = _minimum ? [_minimum doubleValue] : -INFINITY;
+    }
+}
+
+- (NSNumber *)maximum {
+    @synchronized (self) {
+        return _maximum;
+    }
+}
+
+- (void)setMaximum:(NSNumber *)maximum {
+    @synchronized (self) {
+        _maximum = [maximum copy];
+        _maximumValue = _maximum ? [_maximum doubleValue] : INFINITY;
+    }
+}
+
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
     self = [super initWithCoder:aDecoder];
     if (self) {
         ORK_DECODE_ENUM(aDecoder, style);
         ORK_DECODE_OBJ_CLASS(aDecoder, unit, NSString);
-        ORK_DECODE_OBJ_CLASS(aDecoder, minimum, NSNumber);
-        ORK_DECODE_OBJ_CLASS(aDecoder, maximum, NSNumber);
+        self.minimum = (NSNumber *)[aDecoder decodeObjectOfClasses:ORK_CLASS_SET([NSNumber class]) forKey:@"minimum"];
+        self.maximum = (NSNumber *)[aDecoder decodeObjectOfClasses:ORK_CLASS_SET([NSNumber class]) forKey:@"maximum"];
     }
     return self;
 }
@@ -1069,8 +1100,8 @@ static NSArray *ork_processTextChoices(NSArray *textChoices) {
     ORKNumericAnswerFormat *fmt = [[[self class] allocWithZone:zone] init];
     fmt->_style = _style;
     fmt->_unit = [_unit copy];
-    fmt->_minimum = [_minimum copy];
-    fmt->_maximum = [_maximum copy];
+    fmt.minimum = self.minimum;
+    fmt.maximum = self.maximum;
     return fmt;
 }
 
@@ -1108,43 +1139,24 @@ static NSArray *ork_processTextChoices(NSArray *textChoices) {
 }
 
 - (BOOL)isAnswerValidWithString:(NSString *)text {
-    BOOL isValid = NO;
-    if ([text length] > 0) {
-        NSDecimalNumber *num = [NSDecimalNumber decimalNumberWithString:text locale:[NSLocale currentLocale]];
-        if (num) {
-            isValid = YES;
-            if (isnan([num doubleValue])) {
-                isValid = NO;
-            } else if (self.minimum && ([self.minimum doubleValue] > [num doubleValue])) {
-                isValid = NO;
-            } else if (self.maximum && ([self.maximum doubleValue] < [num doubleValue])) {
-                isValid = NO;
-            }
-        }
+    double value = 0;
+    if ([text length] == 0 || ! ORKParseDecimalString(text, &value)) {
+        return NO;
     }
-    return isValid;
-}
-
-- (NSNumberFormatter *)makeNumberFormatter {
-    NSNumberFormatter *numberFormatter = [NSNumberFormatter new];
-    numberFormatter.numberStyle = NSNumberFormatterDecimalStyle;
-    numberFormatter.usesGroupingSeparator = NO;
-    return numberFormatter;
+    return (value >= _minimumValue && value <= _maximumValue);
 }
 
 - (NSString *)localizedInvalidValueStringWithAnswerString:(NSString *)text {
     if (! [text length]) {
         return nil;
     }
-    NSDecimalNumber *num = [NSDecimalNumber decimalNumberWithString:text locale:[NSLocale currentLocale]];
-    if (! num) {
-        return nil;
-    }
+    double value = NAN;
+    ORKParseDecimalString(text, &value);
     NSString *string = nil;
-    NSNumberFormatter *formatter = [self makeNumberFormatter];
-    if (self.minimum && ([self.minimum doubleValue] > [num doubleValue])) {
+    NSNumberFormatter *formatter = ORKDecimalNumberFormatter();
+    if (_minimumValue > value) {
         string = [NSString stringWithFormat:ORKLocalizedString(@"RANGE_ALERT_MESSAGE_BELOW_MAXIMUM", nil), text, [formatter stringFromNumber:self.minimum]];
-    } else if (self.maximum && ([self.maximum doubleValue] < [num doubleValue])) {
+    } else if (_maximumValue < value) {
         string = [NSString stringWithFormat:ORKLocalizedString(@"RANGE_ALERT_MESSAGE_ABOVE_MAXIMUM", nil), text, [formatter stringFromNumber:self.maximum]];
     } else {
         string = [NSString stringWithFormat:ORKLocalizedString(@"RANGE_ALERT_MESSAGE_OTHER", nil), text];
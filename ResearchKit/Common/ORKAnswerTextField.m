@@ -31,6 +31,7 @@
 
 #import "ORKAnswerTextField.h"
 #import "ORKAccessibility.h"
+#import "ORKStyleCache.h"
 
 
 @implementation ORKAnswerTextField
@@ -60,7 +61,7 @@
 }
 
 - (void)updateAppearance {
-    self.font = [[self class] defaultFont];
+    self.font = ORKCachedDefaultFont([self class]);
     [self invalidateIntrinsicContentSize];
 }
 
@@ -30,6 +30,7 @@
 
 
 #import "ORKAnswerTextView.h"
+#import "ORKStyleCache.h"
 
 
 @implementation ORKAnswerTextView
@@ -69,7 +70,7 @@
 }
 
 - (void)updateAppearance {
-    self.font = [[self class] defaultFont];
+    self.font = ORKCachedDefaultFont([self class]);
     [self invalidateIntrinsicContentSize];
 }
 
@@ -0,0 +1,181 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <AVFoundation/AVFoundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_OPTIONS(NSUInteger, ORKAudioSessionNeeds) {
+    ORKAudioSessionNeedsNone            = 0,
+    // Spoken instructions and background audio prompts.
+    ORKAudioSessionNeedsPrompts         = (1 << 0),
+    // Generated tones, as in tone audiometry.
+    ORKAudioSessionNeedsTonePlayback    = (1 << 1),
+    ORKAudioSessionNeedsRecording       = (1 << 2)
+};
+
+
+/*
+ The subset of `AVAudioSession` used by the coordinator. `AVAudioSession` conforms as is;
+ tests substitute a fake session.
+ */
+@protocol ORKAudioSession <NSObject>
+
+- (NSString *)category;
+
+- (AVAudioSessionCategoryOptions)categoryOptions;
+
+- (BOOL)setCategory:(NSString *)category withOptions:(AVAudioSessionCategoryOptions)options error:(NSError * __autoreleasing *)outError;
+
+- (BOOL)setActive:(BOOL)active withOptions:(AVAudioSessionSetActiveOptions)options error:(NSError * __autoreleasing *)outError;
+
+- (BOOL)setPreferredSampleRate:(double)sampleRate error:(NSError * __autoreleasing *)outError;
+
+- (BOOL)setPreferredIOBufferDuration:(NSTimeInterval)duration error:(NSError * __autoreleasing *)outError;
+
+@end
+
+
+@interface AVAudioSession (ORKAudioSession) <ORKAudioSession>
+
+@end
+
+
+/*
+ Session settings that satisfy a set of needs. This is the coordinator's policy, kept
+ free of side effects so it can be tested directly.
+ */
+@interface ORKAudioSessionConfiguration : NSObject
+
+// Returns nil for `ORKAudioSessionNeedsNone`: the session is then left alone.
++ (nullable instancetype)configurationForNeeds:(ORKAudioSessionNeeds)needs;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithCategory:(NSString *)category
+                 categoryOptions:(AVAudioSessionCategoryOptions)categoryOptions
+             preferredSampleRate:(double)preferredSampleRate
+       preferredIOBufferDuration:(NSTimeInterval)preferredIOBufferDuration NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, copy, readonly) NSString *category;
+
+@property (nonatomic, readonly) AVAudioSessionCategoryOptions categoryOptions;
+
+@property (nonatomic, readonly) double preferredSampleRate;
+
+// 0 leaves the system default in place.
+@property (nonatomic, readonly) NSTimeInterval preferredIOBufferDuration;
+
+// Whether a session in this configuration can serve `needs` as is: with the category they
+// need, and with a low-latency IO buffer if they ask for one.
+- (BOOL)satisfiesNeeds:(ORKAudioSessionNeeds)needs;
+
+@end
+
+
+@class ORKAudioSessionCoordinator;
+
+@protocol ORKAudioSessionClient <NSObject>
+
+@optional
+- (void)audioSessionCoordinatorInterruptionDidBegin:(ORKAudioSessionCoordinator *)coordinator;
+
+// `shouldResume` is YES when the system allows playback to resume and the session was reactivated.
+- (void)audioSessionCoordinator:(ORKAudioSessionCoordinator *)coordinator interruptionDidEndShouldResume:(BOOL)shouldResume;
+
+- (void)audioSessionCoordinator:(ORKAudioSessionCoordinator *)coordinator routeDidChangeWithReason:(AVAudioSessionRouteChangeReason)reason;
+
+@end
+
+
+/*
+ Owns the configuration of the audio session for all of ResearchKit.
+ 
+ Changing the session category costs a route reconfiguration, which takes a noticeable
+ amount of time and interrupts any audio that is already playing. So the task view
+ controller declares the union of everything a task will need up front, with
+ `prepareForNeeds:error:`, and the session is configured once for that union. Clients
+ (prompts, tone generators, recorders) then only activate the session; the category only
+ changes if a client needs something that was not declared.
+ 
+ The session is activated when the first client begins, and deactivated once no clients
+ remain and nothing is prepared. Interruptions and route changes are handled once here
+ and forwarded to every client.
+ 
+ Main queue only. Session notifications are forwarded to the main queue.
+ */
+@interface ORKAudioSessionCoordinator : NSObject
+
++ (ORKAudioSessionCoordinator *)sharedCoordinator;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSession:(id<ORKAudioSession>)session notificationCenter:(NSNotificationCenter *)notificationCenter NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, strong, readonly) id<ORKAudioSession> session;
+
+// The configuration last applied to the session, or nil if it has not been configured.
+@property (nonatomic, strong, readonly, nullable) ORKAudioSessionConfiguration *configuration;
+
+@property (nonatomic, readonly) ORKAudioSessionNeeds preparedNeeds;
+
+// Union of the needs of all current clients.
+@property (nonatomic, readonly) ORKAudioSessionNeeds clientNeeds;
+
+@property (nonatomic, readonly, getter=isActive) BOOL active;
+
+@property (nonatomic, readonly, getter=isInterrupted) BOOL interrupted;
+
+// Configures the session for `needs` without activating it. Replaces any earlier preparation.
+- (BOOL)prepareForNeeds:(ORKAudioSessionNeeds)needs error:(NSError * __autoreleasing *)error;
+
+// Clears the preparation; deactivates the session if no clients remain.
+- (void)finishPreparation;
+
+// The client is held weakly. Beginning again with the same client replaces its needs.
+- (BOOL)beginUsingSessionForClient:(id<ORKAudioSessionClient>)client needs:(ORKAudioSessionNeeds)needs error:(NSError * __autoreleasing *)error;
+
+- (void)endUsingSessionForClient:(id<ORKAudioSessionClient>)client;
+
+// Clients cannot end their use from -dealloc, where the coordinator's weak reference to them already
+// reads nil. Call this afterwards instead, to deactivate the session if those clients were the last.
+- (void)endUsingSessionForDeallocatedClients;
+
+// Entry points for the session notifications; exposed for tests.
+- (void)handleInterruptionWithType:(AVAudioSessionInterruptionType)type options:(AVAudioSessionInterruptionOptions)options;
+
+- (void)handleRouteChangeWithReason:(AVAudioSessionRouteChangeReason)reason;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,324 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKAudioSessionCoordinator.h"
+#import "ORKHelpers.h"
+
+
+@implementation AVAudioSession (ORKAudioSession)
+
+@end
+
+
+static const double PreferredSampleRate = 44100.0;
+
+// Small enough for responsive tone onsets and capture; prompts alone keep the system default.
+static const NSTimeInterval LowLatencyIOBufferDuration = 0.01;
+
+@implementation ORKAudioSessionConfiguration
+
++ (instancetype)configurationForNeeds:(ORKAudioSessionNeeds)needs {
+    if (needs == ORKAudioSessionNeedsNone) {
+        return nil;
+    }
+    NSTimeInterval ioBufferDuration = 0;
+    if (needs & (ORKAudioSessionNeedsTonePlayback | ORKAudioSessionNeedsRecording)) {
+        ioBufferDuration = LowLatencyIOBufferDuration;
+    }
+    if (needs & ORKAudioSessionNeedsRecording) {
+        // Without DefaultToSpeaker, PlayAndRecord routes prompts and tones to the receiver.
+        return [[ORKAudioSessionConfiguration alloc] initWithCategory:AVAudioSessionCategoryPlayAndRecord
+                                                      categoryOptions:AVAudioSessionCategoryOptionDefaultToSpeaker
+                                                  preferredSampleRate:PreferredSampleRate
+                                            preferredIOBufferDuration:ioBufferDuration];
+    }
+    return [[ORKAudioSessionConfiguration alloc] initWithCategory:AVAudioSessionCategoryPlayback
+                                                  categoryOptions:0
+                                              preferredSampleRate:PreferredSampleRate
+                                        preferredIOBufferDuration:ioBufferDuration];
+}
+
+- (instancetype)initWithCategory:(NSString *)category
+                 categoryOptions:(AVAudioSessionCategoryOptions)categoryOptions
+             preferredSampleRate:(double)preferredSampleRate
+       preferredIOBufferDuration:(NSTimeInterval)preferredIOBufferDuration {
+    self = [super init];
+    if (self) {
+        _category = [category copy];
+        _categoryOptions = categoryOptions;
+        _preferredSampleRate = preferredSampleRate;
+        _preferredIOBufferDuration = preferredIOBufferDuration;
+    }
+    return self;
+}
+
+- (BOOL)satisfiesNeeds:(ORKAudioSessionNeeds)needs {
+    ORKAudioSessionNeeds provided = ORKAudioSessionNeedsPrompts | ORKAudioSessionNeedsTonePlayback;
+    if ([_category isEqualToString:AVAudioSessionCategoryPlayAndRecord]) {
+        provided |= ORKAudioSessionNeedsRecording;
+    }
+    if ((needs & ~provided) != 0) {
+        return NO;
+    }
+    NSTimeInterval ioBufferDuration = [ORKAudioSessionConfiguration configurationForNeeds:needs].preferredIOBufferDuration;
+    return (ioBufferDuration == 0 || (_preferredIOBufferDuration > 0 && _preferredIOBufferDuration <= ioBufferDuration));
+}
+
+- (BOOL)isEqual:(id)object {
+    if ([self class] != [object class]) {
+        return NO;
+    }
+    
+    __typeof(self) castObject = object;
+    return (ORKEqualObjects(self.category, castObject.category) &&
+            self.categoryOptions == castObject.categoryOptions &&
+            self.preferredSampleRate == castObject.preferredSampleRate &&
+            self.preferredIOBufferDuration == castObject.preferredIOBufferDuration);
+}
+
+- (NSUInteger)hash {
+    return [_category hash] ^ _categoryOptions;
+}
+
+@end
+
+
+@implementation ORKAudioSessionCoordinator {
+    NSNotificationCenter *_notificationCenter;
+    NSMapTable *_clientNeeds;
+}
+
++ (ORKAudioSessionCoordinator *)sharedCoordinator {
+    static ORKAudioSessionCoordinator *shared;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        shared = [[ORKAudioSessionCoordinator alloc] initWithSession:[AVAudioSession sharedInstance]
+                                                  notificationCenter:[NSNotificationCenter defaultCenter]];
+    });
+    return shared;
+}
+
+- (instancetype)initWithSession:(id<ORKAudioSession>)session notificationCenter:(NSNotificationCenter *)notificationCenter {
+    self = [super init];
+    if (self) {
+        _session = session;
+        _notificationCenter = notificationCenter;
+        _clientNeeds = [NSMapTable weakToStrongObjectsMapTable];
+        [_notificationCenter addObserver:self selector:@selector(interruptionNotification:) name:AVAudioSessionInterruptionNotification object:nil];
+        [_notificationCenter addObserver:self selector:@selector(routeChangeNotification:) name:AVAudioSessionRouteChangeNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_notificationCenter removeObserver:self];
+}
+
+- (NSArray *)clients {
+    return [[_clientNeeds keyEnumerator] allObjects];
+}
+
+- (ORKAudioSessionNeeds)clientNeeds {
+    ORKAudioSessionNeeds needs = ORKAudioSessionNeedsNone;
+    for (id client in [self clients]) {
+        needs |= [[_clientNeeds objectForKey:client] unsignedIntegerValue];
+    }
+    return needs;
+}
+
+#pragma mark Configuration
+
+- (BOOL)applyConfigurationForNeeds:(ORKAudioSessionNeeds)needs error:(NSError * __autoreleasing *)error {
+    if (_configuration && [_configuration satisfiesNeeds:needs] && [[_session category] isEqualToString:_configuration.category]) {
+        return YES;
+    }
+    
+    ORKAudioSessionConfiguration *configuration = [ORKAudioSessionConfiguration configurationForNeeds:needs];
+    if (configuration == nil) {
+        return YES;
+    }
+    
+    if (! [[_session category] isEqualToString:configuration.category] || [_session categoryOptions] != configuration.categoryOptions) {
+        ORK_Log_Debug(@"Audio session category %@ -> %@", [_session category], configuration.category);
+        if (! [_session setCategory:configuration.category withOptions:configuration.categoryOptions error:error]) {
+            return NO;
+        }
+    }
+    
+    // Preferences are hints; failing to apply them does not prevent using the session.
+    NSError *preferenceError = nil;
+    if (! [_session setPreferredSampleRate:configuration.preferredSampleRate error:&preferenceError]) {
+        ORK_Log_Debug(@"Could not set preferred sample rate: %@", preferenceError);
+    }
+    if (configuration.preferredIOBufferDuration > 0 &&
+        ! [_session setPreferredIOBufferDuration:configuration.preferredIOBufferDuration error:&preferenceError]) {
+        ORK_Log_Debug(@"Could not set preferred IO buffer duration: %@", preferenceError);
+    }
+    
+    _configuration = configuration;
+    return YES;
+}
+
+- (BOOL)prepareForNeeds:(ORKAudioSessionNeeds)needs error:(NSError * __autoreleasing *)error {
+    _preparedNeeds = needs;
+    return [self applyConfigurationForNeeds:(needs | [self clientNeeds]) error:error];
+}
+
+- (void)finishPreparation {
+    _preparedNeeds = ORKAudioSessionNeedsNone;
+    [self deactivateIfUnused];
+}
+
+#pragma mark Clients
+
+- (BOOL)beginUsingSessionForClient:(id<ORKAudioSessionClient>)client needs:(ORKAudioSessionNeeds)needs error:(NSError * __autoreleasing *)error {
+    NSParameterAssert(client);
+    
+    if (! [self applyConfigurationForNeeds:(_preparedNeeds | [self clientNeeds] | needs) error:error]) {
+        return NO;
+    }
+    
+    if (! _active) {
+        if (! [_session setActive:YES withOptions:0 error:error]) {
+            return NO;
+        }
+        _active = YES;
+        ORK_Log_Debug(@"*** Activated audio session");
+    }
+    
+    [_clientNeeds setObject:@(needs) forKey:client];
+    return YES;
+}
+
+- (void)endUsingSessionForClient:(id<ORKAudioSessionClient>)client {
+    if (client == nil || [_clientNeeds objectForKey:client] == nil) {
+        return;
+    }
+    [_clientNeeds removeObjectForKey:client];
+    [self deactivateIfUnused];
+}
+
+- (void)endUsingSessionForDeallocatedClients {
+    // Deallocated clients are no longer enumerated by -clients.
+    [self deactivateIfUnused];
+}
+
+- (void)deactivateIfUnused {
+    if (! _active || _preparedNeeds != ORKAudioSessionNeedsNone || [self clients].count > 0) {
+        return;
+    }
+    NSError *error = nil;
+    if (! [_session setActive:NO withOptions:AVAudioSessionSetActiveOptionNotifyOthersOnDeactivation error:&error]) {
+        ORK_Log_Debug(@"Could not deactivate audio session: %@", error);
+        return;
+    }
+    _active = NO;
+    ORK_Log_Debug(@"*** Deactivated audio session");
+}
+
+#pragma mark Notifications
+
+- (void)interruptionNotification:(NSNotification *)notification {
+    AVAudioSessionInterruptionType type = [notification.userInfo[AVAudioSessionInterruptionTypeKey] unsignedIntegerValue];
+    AVAudioSessionInterruptionOptions options = [notification.userInfo[AVAudioSessionInterruptionOptionKey] unsignedIntegerValue];
+    [self performOnMainQueue:^{
+        [self handleInterruptionWithType:type options:options];
+    }];
+}
+
+- (void)routeChangeNotification:(NSNotification *)notification {
+    AVAudioSessionRouteChangeReason reason = [notification.userInfo[AVAudioSessionRouteChangeReasonKey] unsignedIntegerValue];
+    [self performOnMainQueue:^{
+        [self handleRouteChangeWithReason:reason];
+    }];
+}
+
+- (void)performOnMainQueue:(void (^)(void))block {
+    // Route changes are posted on a secondary thread.
+    if ([NSThread isMainThread]) {
+        block();
+    } else {
+        dispatch_async(dispatch_get_main_queue(), block);
+    }
+}
+
+- (void)handleInterruptionWithType:(AVAudioSessionInterruptionType)type options:(AVAudioSessionInterruptionOptions)options {
+    NSArray *clients = [self clients];
+    if (type == AVAudioSessionInterruptionTypeBegan) {
+        // The system has already deactivated the session.
+        _interrupted = YES;
+        _active = NO;
+        for (id<ORKAudioSessionClient> client in clients) {
+            if ([client respondsToSelector:@selector(audioSessionCoordinatorInterruptionDidBegin:)]) {
+                [client audioSessionCoordinatorInterruptionDidBegin:self];
+            }
+        }
+        return;
+    }
+    
+    _interrupted = NO;
+    if (clients.count > 0 && ! _active) {
+        NSError *error = nil;
+        if ([_session setActive:YES withOptions:0 error:&error]) {
+            _active = YES;
+        } else {
+            ORK_Log_Debug(@"Could not reactivate audio session: %@", error);
+        }
+    }
+    BOOL shouldResume = _active && (options & AVAudioSessionInterruptionOptionShouldResume);
+    for (id<ORKAudioSessionClient> client in clients) {
+        if ([client respondsToSelector:@selector(audioSessionCoordinator:interruptionDidEndShouldResume:)]) {
+            [client audioSessionCoordinator:self interruptionDidEndShouldResume:shouldResume];
+        }
+    }
+}
+
+- (void)handleRouteChangeWithReason:(AVAudioSessionRouteChangeReason)reason {
+    if (reason == AVAudioSessionRouteChangeReasonCategoryChange && _configuration &&
+        ! [[_session category] isEqualToString:_configuration.category]) {
+        // Someone else changed the category under us; restore ours while it is still needed.
+        ORKAudioSessionNeeds needs = _preparedNeeds | [self clientNeeds];
+        if (needs != ORKAudioSessionNeedsNone) {
+            NSError *error = nil;
+            if (! [self applyConfigurationForNeeds:needs error:&error]) {
+                ORK_Log_Debug(@"Could not restore audio session category: %@", error);
+            }
+        }
+    }
+    
+    for (id<ORKAudioSessionClient> client in [self clients]) {
+        if ([client respondsToSelector:@selector(audioSessionCoordinator:routeDidChangeWithReason:)]) {
+            [client audioSessionCoordinator:self routeDidChangeWithReason:reason];
+        }
+    }
+}
+
+@end
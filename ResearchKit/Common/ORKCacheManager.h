@@ -0,0 +1,166 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <ResearchKit/ORKDefines.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The order in which the cache manager purges caches. Caches with a lower priority are purged first.
+ */
+typedef NS_ENUM(NSInteger, ORKCachePriority) {
+    /// Speculative or cheaply rebuilt content, purged first.
+    ORKCachePriorityLow = 0,
+    
+    /// Content that is rebuilt on demand at some cost.
+    ORKCachePriorityDefault,
+    
+    /// Content that is expensive to rebuild, purged only under critical memory pressure.
+    ORKCachePriorityHigh
+} ORK_ENUM_AVAILABLE;
+
+/**
+ Memory pressure levels, as reported by the system.
+ */
+typedef NS_ENUM(NSInteger, ORKMemoryPressureLevel) {
+    /// Memory is running low. Caches below high priority are purged, and the rest are held to half the budget.
+    ORKMemoryPressureLevelWarning = 0,
+    
+    /// Memory is critically low. Every cache is purged.
+    ORKMemoryPressureLevelCritical
+} ORK_ENUM_AVAILABLE;
+
+
+/**
+ The `ORKPurgeableCache` protocol is adopted by objects that hold in-memory content that can be
+ rebuilt, so that the cache manager can account for and release it.
+ */
+@protocol ORKPurgeableCache <NSObject>
+
+/// The approximate number of bytes the cache currently holds.
+- (NSUInteger)cacheCost;
+
+/// Releases the content that can be rebuilt, reducing `cacheCost`.
+- (void)purgeCache;
+
+@optional
+
+/**
+ Returns whether the cache is left out of the cost budget, and purged only under memory pressure.
+ 
+ Adopt this for caches that hold a single large item which is only useful whole, and which a budget
+ would purge as soon as it is filled. The cost of such a cache still counts toward `totalCost`.
+ */
+- (BOOL)ignoresCostLimit;
+
+@end
+
+
+/**
+ The `ORKCacheManager` class holds the caches of ResearchKit, and any registered by the app, to a
+ shared memory budget, and purges them when the system reports memory pressure.
+ 
+ When a cache reports that its cost changed and the total cost exceeds `totalCostLimit`, caches
+ are purged in priority order, and by decreasing cost within a priority, until the total is back
+ within the budget.
+ 
+ Use the cache manager on the main thread only.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKCacheManager : NSObject
+
+/**
+ Returns the cache manager used by ResearchKit, which responds to memory warnings and to the
+ system's memory pressure notifications.
+ */
++ (ORKCacheManager *)sharedManager;
+
+/// Returns a cache manager with the default budget of 16 MB, that only responds to memory pressure reported through `handleMemoryPressure:`.
+- (instancetype)init;
+
+/**
+ Returns a cache manager that only responds to memory pressure reported through `handleMemoryPressure:`.
+ 
+ @param totalCostLimit  The budget, in bytes. Zero means no budget.
+ 
+ @return A cache manager.
+ */
+- (instancetype)initWithTotalCostLimit:(NSUInteger)totalCostLimit NS_DESIGNATED_INITIALIZER;
+
+/**
+ The total cost, in bytes, that registered caches may hold before they are purged.
+ 
+ Zero means no budget. The default value for the shared manager is 16 MB.
+ */
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+
+/// The sum of the costs of the registered caches, including those that ignore the cost limit.
+@property (nonatomic, readonly) NSUInteger totalCost;
+
+/// The number of times a cache was purged.
+@property (nonatomic, readonly) NSUInteger purgeCount;
+
+/**
+ Registers a cache. The cache manager does not retain the cache.
+ 
+ @param cache       The cache to register.
+ @param priority    The priority of the cache.
+ */
+- (void)registerCache:(id<ORKPurgeableCache>)cache priority:(ORKCachePriority)priority;
+
+/**
+ Unregisters a cache.
+ 
+ @param cache       The cache to unregister.
+ */
+- (void)unregisterCache:(id<ORKPurgeableCache>)cache;
+
+/**
+ Call when the cost of a registered cache grows, so that the budget is enforced.
+ 
+ @param cache       The cache whose cost changed.
+ */
+- (void)cacheCostDidChange:(id<ORKPurgeableCache>)cache;
+
+/**
+ Purges caches as the memory pressure level requires.
+ 
+ The shared manager calls this method itself when the system reports memory pressure.
+ 
+ @param level       The memory pressure level.
+ */
+- (void)handleMemoryPressure:(ORKMemoryPressureLevel)level;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,223 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKCacheManager.h"
+#import "ORKHelpers.h"
+#import <UIKit/UIKit.h>
+
+
+static const NSUInteger ORKCacheManagerDefaultTotalCostLimit = 16 * 1024 * 1024;
+
+
+@implementation ORKCacheManager {
+    // Weak keys, so caches need not unregister when deallocated.
+    NSMapTable *_priorities;
+    dispatch_source_t _memoryPressureSource;
+    BOOL _purging;
+}
+
++ (ORKCacheManager *)sharedManager {
+    static ORKCacheManager *sharedManager = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedManager = [ORKCacheManager new];
+        [sharedManager observeMemoryPressure];
+    });
+    return sharedManager;
+}
+
+- (instancetype)init {
+    return [self initWithTotalCostLimit:ORKCacheManagerDefaultTotalCostLimit];
+}
+
+- (instancetype)initWithTotalCostLimit:(NSUInteger)totalCostLimit {
+    self = [super init];
+    if (self) {
+        _totalCostLimit = totalCostLimit;
+        _priorities = [NSMapTable weakToStrongObjectsMapTable];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    if (_memoryPressureSource) {
+        dispatch_source_cancel(_memoryPressureSource);
+    }
+}
+
+- (void)observeMemoryPressure {
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(applicationDidReceiveMemoryWarning:)
+                                                 name:UIApplicationDidReceiveMemoryWarningNotification
+                                               object:nil];
+    
+    // Also catches pressure while in the background, where memory warnings are not delivered.
+    _memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+                                                   DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+                                                   dispatch_get_main_queue());
+    __weak ORKCacheManager *weakSelf = self;
+    dispatch_source_set_event_handler(_memoryPressureSource, ^{
+        ORKCacheManager *strongSelf = weakSelf;
+        if (! strongSelf) {
+            return;
+        }
+        unsigned long status = dispatch_source_get_data(strongSelf->_memoryPressureSource);
+        if (status & DISPATCH_MEMORYPRESSURE_CRITICAL) {
+            [strongSelf handleMemoryPressure:ORKMemoryPressureLevelCritical];
+        } else if (status & DISPATCH_MEMORYPRESSURE_WARN) {
+            [strongSelf handleMemoryPressure:ORKMemoryPressureLevelWarning];
+        }
+    });
+    dispatch_resume(_memoryPressureSource);
+}
+
+- (void)applicationDidReceiveMemoryWarning:(NSNotification *)notification {
+    [self handleMemoryPressure:ORKMemoryPressureLevelWarning];
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit {
+    _totalCostLimit = totalCostLimit;
+    [self enforceCostLimit:totalCostLimit belowPriority:ORKCachePriorityHigh + 1];
+}
+
+static BOOL ORKCacheIgnoresCostLimit(id<ORKPurgeableCache> cache) {
+    return [cache respondsToSelector:@selector(ignoresCostLimit)] && [cache ignoresCostLimit];
+}
+
+- (NSUInteger)totalCost {
+    NSUInteger totalCost = 0;
+    for (id<ORKPurgeableCache> cache in _priorities) {
+        totalCost += [cache cacheCost];
+    }
+    return totalCost;
+}
+
+// The cost the budget applies to.
+- (NSUInteger)budgetedCost {
+    NSUInteger budgetedCost = 0;
+    for (id<ORKPurgeableCache> cache in _priorities) {
+        if (! ORKCacheIgnoresCostLimit(cache)) {
+            budgetedCost += [cache cacheCost];
+        }
+    }
+    return budgetedCost;
+}
+
+- (void)registerCache:(id<ORKPurgeableCache>)cache priority:(ORKCachePriority)priority {
+    [_priorities setObject:@(priority) forKey:cache];
+    [self cacheCostDidChange:cache];
+}
+
+- (void)unregisterCache:(id<ORKPurgeableCache>)cache {
+    [_priorities removeObjectForKey:cache];
+}
+
+- (void)cacheCostDidChange:(id<ORKPurgeableCache>)cache {
+    // Purging itself changes costs; those reports are not acted on.
+    if (_purging || _totalCostLimit == 0 || ORKCacheIgnoresCostLimit(cache)) {
+        return;
+    }
+    [self enforceCostLimit:_totalCostLimit belowPriority:ORKCachePriorityHigh + 1];
+}
+
+- (void)handleMemoryPressure:(ORKMemoryPressureLevel)level {
+    ORK_Log_Debug(@"Memory pressure %ld, cache cost %lu", (long)level, (unsigned long)self.totalCost);
+    switch (level) {
+        case ORKMemoryPressureLevelWarning:
+            [self purgeCachesBelowPriority:ORKCachePriorityHigh];
+            if (_totalCostLimit > 0) {
+                [self enforceCostLimit:_totalCostLimit / 2 belowPriority:ORKCachePriorityHigh + 1];
+            }
+            break;
+        case ORKMemoryPressureLevelCritical:
+            [self purgeCachesBelowPriority:ORKCachePriorityHigh + 1];
+            break;
+    }
+}
+
+// Registered caches below `priority`, by increasing priority, then by decreasing cost.
+- (NSArray *)cachesInPurgeOrderBelowPriority:(NSInteger)priority includingUnbudgeted:(BOOL)includingUnbudgeted {
+    NSMutableArray *entries = [NSMutableArray array];
+    for (id<ORKPurgeableCache> cache in _priorities) {
+        NSNumber *cachePriority = [_priorities objectForKey:cache];
+        if (cachePriority.integerValue < priority && (includingUnbudgeted || ! ORKCacheIgnoresCostLimit(cache))) {
+            [entries addObject:@[cachePriority, @([cache cacheCost]), cache]];
+        }
+    }
+    [entries sortUsingComparator:^NSComparisonResult(NSArray *entry1, NSArray *entry2) {
+        NSComparisonResult result = [entry1[0] compare:entry2[0]];
+        return (result != NSOrderedSame) ? result : [entry2[1] compare:entry1[1]];
+    }];
+    NSMutableArray *caches = [NSMutableArray arrayWithCapacity:entries.count];
+    for (NSArray *entry in entries) {
+        [caches addObject:entry.lastObject];
+    }
+    return caches;
+}
+
+- (void)purgeCache:(id<ORKPurgeableCache>)cache {
+    _purging = YES;
+    [cache purgeCache];
+    _purging = NO;
+    _purgeCount++;
+}
+
+- (void)purgeCachesBelowPriority:(NSInteger)priority {
+    for (id<ORKPurgeableCache> cache in [self cachesInPurgeOrderBelowPriority:priority includingUnbudgeted:YES]) {
+        if ([cache cacheCost] > 0) {
+            [self purgeCache:cache];
+        }
+    }
+}
+
+- (void)enforceCostLimit:(NSUInteger)costLimit belowPriority:(NSInteger)priority {
+    if (costLimit == 0) {
+        return;
+    }
+    NSUInteger totalCost = [self budgetedCost];
+    if (totalCost <= costLimit) {
+        return;
+    }
+    for (id<ORKPurgeableCache> cache in [self cachesInPurgeOrderBelowPriority:priority includingUnbudgeted:NO]) {
+        NSUInteger cost = [cache cacheCost];
+        if (cost == 0) {
+            continue;
+        }
+        [self purgeCache:cache];
+        totalCost = totalCost - cost + [cache cacheCost];
+        if (totalCost <= costLimit) {
+            break;
+        }
+    }
+}
+
+@end
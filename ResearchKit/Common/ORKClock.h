@@ -0,0 +1,71 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Relates the device's monotonic clock to the wall clock through a single anchor pair.
+ 
+ The monotonic clock is the system uptime in seconds: the base of `CMLogItem` and
+ `UITouch` timestamps and of `CACurrentMediaTime()`. A task view controller captures one
+ anchor per task run and shares its clock with its step view controllers and recorders,
+ which publish its time base so that sensor timestamps can be placed on the wall clock.
+ 
+ The uptime stops while the device sleeps, so conversions drift after a sleep. Result
+ start and end dates therefore come from `[NSDate date]`, not from the clock.
+ */
+@interface ORKClock : NSObject
+
+// Anchors the clock at the current uptime and date.
+- (instancetype)init;
+
+- (instancetype)initWithAnchorUptime:(NSTimeInterval)anchorUptime anchorDate:(NSDate *)anchorDate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) NSTimeInterval anchorUptime;
+
+@property (nonatomic, copy, readonly) NSDate *anchorDate;
+
+// Subclasses may override this to inject a clock, for instance for testing.
+- (NSTimeInterval)currentUptime;
+
+- (NSDate *)dateForUptime:(NSTimeInterval)uptime;
+
+- (NSTimeInterval)uptimeForDate:(NSDate *)date;
+
+// The anchor pair, suitable for a result's `userInfo` under `ORKResultTimeBaseKey`.
+- (NSDictionary *)timeBase;
+
+@end
+
+NS_ASSUME_NONNULL_END
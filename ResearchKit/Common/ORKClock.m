@@ -0,0 +1,76 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKClock.h"
+#import "ORKResult.h"
+
+
+@implementation ORKClock
+
+- (instancetype)init {
+    NSTimeInterval uptime = [NSProcessInfo processInfo].systemUptime;
+    return [self initWithAnchorUptime:uptime anchorDate:[NSDate date]];
+}
+
+- (instancetype)initWithAnchorUptime:(NSTimeInterval)anchorUptime anchorDate:(NSDate *)anchorDate {
+    self = [super init];
+    if (self) {
+        if (anchorDate == nil) {
+            @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"anchorDate cannot be nil." userInfo:nil];
+        }
+        _anchorUptime = anchorUptime;
+        _anchorDate = [anchorDate copy];
+    }
+    return self;
+}
+
+- (NSTimeInterval)currentUptime {
+    return [NSProcessInfo processInfo].systemUptime;
+}
+
+- (NSDate *)dateForUptime:(NSTimeInterval)uptime {
+    return [_anchorDate dateByAddingTimeInterval:(uptime - _anchorUptime)];
+}
+
+- (NSTimeInterval)uptimeForDate:(NSDate *)date {
+    return _anchorUptime + [date timeIntervalSinceDate:_anchorDate];
+}
+
+- (NSDictionary *)timeBase {
+    return @{ ORKTimeBaseUptimeKey : @(_anchorUptime),
+              ORKTimeBaseTimeIntervalSince1970Key : @([_anchorDate timeIntervalSince1970]) };
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; uptime %.6f = %@>", NSStringFromClass([self class]), self, _anchorUptime, _anchorDate];
+}
+
+@end
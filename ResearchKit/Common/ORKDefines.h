@@ -100,3 +100,21 @@ typedef NS_ENUM(NSInteger, ORKAudioChannel) {
     ORKAudioChannelRight
 } ORK_ENUM_AVAILABLE;
 
+
+/**
+ Processing applied by an audio recorder to its recording when it stops.
+ */
+typedef NS_OPTIONS(NSUInteger, ORKAudioProcessingOptions) {
+    /// The recording is returned as recorded.
+    ORKAudioProcessingOptionNone                    = 0,
+    
+    /// Leading and trailing silence is removed, keeping a short margin around the speech.
+    ORKAudioProcessingOptionTrimSilence             = (1 << 0),
+    
+    /// The recording is mixed down to a single channel.
+    ORKAudioProcessingOptionDownmixToMono           = (1 << 1),
+    
+    /// Phonation features are computed and attached to the result.
+    ORKAudioProcessingOptionComputeVoiceFeatures    = (1 << 2),
+} ORK_ENUM_AVAILABLE;
+
@@ -492,9 +492,7 @@ static const CGFloat kHMargin = 15.0;
 
 #pragma mark - ORKFormItemNumericCell
 
-@implementation ORKFormItemNumericCell {
-    NSNumberFormatter *_numberFormatter;
-}
+@implementation ORKFormItemNumericCell
 
 - (void)cellInit {
     [super cellInit];
@@ -509,7 +507,6 @@ static const CGFloat kHMargin = 15.0;
     self.textField.unit = answerFormat.unit;
     self.textField.placeholder = self.formItem.placeholder;
     
-    _numberFormatter = [(ORKNumericAnswerFormat *)answerFormat makeNumberFormatter];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(localeDidChange:) name:NSCurrentLocaleDidChangeNotification object:nil];
     
     [self answerDidChange];
@@ -522,7 +519,6 @@ static const CGFloat kHMargin = 15.0;
 
 - (void)localeDidChange:(NSNotification *)note {
     // On a locale change, re-format the value with the current locale
-    _numberFormatter.locale = [NSLocale currentLocale];
     [self answerDidChange];
 }
 
@@ -539,7 +535,7 @@ static const CGFloat kHMargin = 15.0;
     if (answer && answer != ORKNullAnswerValue()) {
         NSString *displayValue = answer;
         if ([answer isKindOfClass:[NSNumber class]]) {
-            displayValue = [_numberFormatter stringFromNumber:answer];
+            displayValue = [ORKDecimalNumberFormatter() stringFromNumber:answer];
         }
         self.textField.text = displayValue;
     } else {
@@ -592,7 +588,7 @@ static const CGFloat kHMargin = 15.0;
 
 - (void)valueFieldDidChange:(UITextField *)textField {
     ORKNumericAnswerFormat *answerFormat = (ORKNumericAnswerFormat *)[self.formItem impliedAnswerFormat];
-    NSString *sanitizedText = [answerFormat sanitizedTextFieldText:[textField text] decimalSeparator:[_numberFormatter decimalSeparator]];
+    NSString *sanitizedText = [answerFormat sanitizedTextFieldText:[textField text] decimalSeparator:[ORKDecimalNumberFormatter() decimalSeparator]];
     textField.text = sanitizedText;
     
     [self inputValueDidChange];
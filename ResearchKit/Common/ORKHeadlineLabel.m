@@ -32,6 +32,7 @@
 #import "ORKHeadlineLabel.h"
 #import "ORKHelpers.h"
 #import "ORKSkin.h"
+#import "ORKStyleCache.h"
 
 
 @implementation ORKHeadlineLabel
@@ -54,7 +55,13 @@
 }
 
 - (UIFont *)defaultFont {
-    return [[self class] defaultFontInSurveyMode:_useSurveyMode];
+    if (!_useSurveyMode) {
+        return ORKCachedDefaultFont([self class]);
+    }
+    Class labelClass = [self class];
+    return [[ORKStyleCache sharedCache] styleForKey:@[labelClass, @"surveyMode"] resolver:^id{
+        return [labelClass defaultFontInSurveyMode:YES];
+    }];
 }
 
 - (void)setUseSurveyMode:(BOOL)useSurveyMode {
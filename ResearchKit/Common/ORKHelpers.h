@@ -54,35 +54,44 @@
 #define STRINGIFY2( x) #x
 #define STRINGIFY(x) STRINGIFY2(x)
 
+/*
+ * Secure coding helpers.
+ *
+ * Sets of allowed classes are built once per call site. Members equal to the value decoded
+ * for a missing key (nil, NO, 0) are not encoded, which keeps archives compact and remains
+ * readable by, and able to read, archives that contain every key.
+ */
+#define ORK_CLASS_SET(...)  ({ static NSSet *__ork_classes; static dispatch_once_t __ork_once; dispatch_once(&__ork_once, ^{ __ork_classes = [NSSet setWithObjects:__VA_ARGS__, nil]; }); __ork_classes; })
+
 #define ORK_DECODE_OBJ(d,x)  _ ## x = [d decodeObjectForKey:@STRINGIFY(x)]
-#define ORK_ENCODE_OBJ(c,x)  [c encodeObject:_ ## x forKey:@STRINGIFY(x)]
+#define ORK_ENCODE_OBJ(c,x)  do { if (_ ## x) { [c encodeObject:_ ## x forKey:@STRINGIFY(x)]; } } while (0)
 
-#define ORK_DECODE_OBJ_CLASS(d,x,cl)  _ ## x = (cl *)[d decodeObjectOfClass:[cl class] forKey:@STRINGIFY(x)]
-#define ORK_DECODE_OBJ_ARRAY(d,x,cl)  _ ## x = (NSArray *)[d decodeObjectOfClasses:[NSSet setWithObjects:[NSArray class],[cl class],nil] forKey:@STRINGIFY(x)]
-#define ORK_DECODE_OBJ_MUTABLE_ORDERED_SET(d,x,cl)  _ ## x = [(NSOrderedSet *)[d decodeObjectOfClasses:[NSSet setWithObjects:[NSOrderedSet class],[cl class],nil] forKey:@STRINGIFY(x)] mutableCopy]
-#define ORK_DECODE_OBJ_MUTABLE_DICTIONARY(d,x,kcl,cl)  _ ## x = [(NSDictionary *)[d decodeObjectOfClasses:[NSSet setWithObjects:[NSDictionary class],[kcl class],[cl class],nil] forKey:@STRINGIFY(x)] mutableCopy]
+#define ORK_DECODE_OBJ_CLASS(d,x,cl)  _ ## x = (cl *)[d decodeObjectOfClasses:ORK_CLASS_SET([cl class]) forKey:@STRINGIFY(x)]
+#define ORK_DECODE_OBJ_ARRAY(d,x,cl)  _ ## x = (NSArray *)[d decodeObjectOfClasses:ORK_CLASS_SET([NSArray class],[cl class]) forKey:@STRINGIFY(x)]
+#define ORK_DECODE_OBJ_MUTABLE_ORDERED_SET(d,x,cl)  _ ## x = [(NSOrderedSet *)[d decodeObjectOfClasses:ORK_CLASS_SET([NSOrderedSet class],[cl class]) forKey:@STRINGIFY(x)] mutableCopy]
+#define ORK_DECODE_OBJ_MUTABLE_DICTIONARY(d,x,kcl,cl)  _ ## x = [(NSDictionary *)[d decodeObjectOfClasses:ORK_CLASS_SET([NSDictionary class],[kcl class],[cl class]) forKey:@STRINGIFY(x)] mutableCopy]
 
 #define ORK_ENCODE_COND_OBJ(c,x)  [c encodeConditionalObject:_ ## x forKey:@STRINGIFY(x)]
 
-#define ORK_DECODE_IMAGE(d,x)  _ ## x = (UIImage *)[d decodeObjectOfClass:[UIImage class] forKey:@STRINGIFY(x)]
+#define ORK_DECODE_IMAGE(d,x)  _ ## x = (UIImage *)[d decodeObjectOfClasses:ORK_CLASS_SET([UIImage class]) forKey:@STRINGIFY(x)]
 #define ORK_ENCODE_IMAGE(c,x)  { if (_ ## x) { UIImage * __ ## x = [UIImage imageWithCGImage:[_ ## x CGImage] scale:[_ ## x scale] orientation:[_ ## x imageOrientation]]; [c encodeObject:__ ## x forKey:@STRINGIFY(x)]; } }
 
-#define ORK_DECODE_URL(d,x) _ ## x = (NSURL *)[d decodeObjectOfClass:[NSURL class] forKey:@STRINGIFY(x)]
+#define ORK_DECODE_URL(d,x) _ ## x = (NSURL *)[d decodeObjectOfClasses:ORK_CLASS_SET([NSURL class]) forKey:@STRINGIFY(x)]
 
 #define ORK_DECODE_BOOL(d,x)  _ ## x = [d decodeBoolForKey:@STRINGIFY(x)]
-#define ORK_ENCODE_BOOL(c,x)  [c encodeBool:_ ## x forKey:@STRINGIFY(x)]
+#define ORK_ENCODE_BOOL(c,x)  do { if (_ ## x) { [c encodeBool:_ ## x forKey:@STRINGIFY(x)]; } } while (0)
 
 #define ORK_DECODE_DOUBLE(d,x)  _ ## x = [d decodeDoubleForKey:@STRINGIFY(x)]
-#define ORK_ENCODE_DOUBLE(c,x)  [c encodeDouble:_ ## x forKey:@STRINGIFY(x)]
+#define ORK_ENCODE_DOUBLE(c,x)  do { if (_ ## x != 0) { [c encodeDouble:_ ## x forKey:@STRINGIFY(x)]; } } while (0)
 
 #define ORK_DECODE_INTEGER(d,x)  _ ## x = [d decodeIntegerForKey:@STRINGIFY(x)]
-#define ORK_ENCODE_INTEGER(c,x)  [c encodeInteger:_ ## x forKey:@STRINGIFY(x)]
+#define ORK_ENCODE_INTEGER(c,x)  do { if (_ ## x != 0) { [c encodeInteger:_ ## x forKey:@STRINGIFY(x)]; } } while (0)
 
 #define ORK_ENCODE_UINT32(c,x)  [c encodeObject:[NSNumber numberWithUnsignedLongLong:_ ## x] forKey:@STRINGIFY(x)]
 #define ORK_DECODE_UINT32(d,x)  _ ## x = (uint32_t)[(NSNumber *)[d decodeObjectForKey:@STRINGIFY(x)] unsignedLongValue]
 
 #define ORK_DECODE_ENUM(d,x)  _ ## x = (__typeof(_ ## x))[d decodeIntegerForKey:@STRINGIFY(x)]
-#define ORK_ENCODE_ENUM(c,x)  [c encodeInteger:(NSInteger)_ ## x forKey:@STRINGIFY(x)]
+#define ORK_ENCODE_ENUM(c,x)  do { if ((NSInteger)_ ## x != 0) { [c encodeInteger:(NSInteger)_ ## x forKey:@STRINGIFY(x)]; } } while (0)
 
 #define ORK_DECODE_CGRECT(d,x)  _ ## x = (__typeof(_ ## x))[d decodeCGRectForKey:@STRINGIFY(x)]
 #define ORK_ENCODE_CGRECT(c,x)  [c encodeCGRect:_ ## x forKey:@STRINGIFY(x)]
@@ -157,6 +166,16 @@ NSDateComponentsFormatter *ORKTimeIntervalLabelFormatter();
 NSDateComponentsFormatter *ORKDurationStringFormatter();
 
 NSDateFormatter *ORKTimeOfDayLabelFormatter();
+
+// Shared decimal formatter for the current locale, without grouping; replaced when the locale changes. Do not modify.
+NSNumberFormatter *ORKDecimalNumberFormatter();
+
+/*
+ Parses the leading decimal number of `text` in the current locale, as
+ `+[NSDecimalNumber decimalNumberWithString:locale:]` does, without allocating.
+ Returns NO if `text` does not start with a number.
+ */
+BOOL ORKParseDecimalString(NSString *text, double *value);
 NSCalendar *ORKTimeOfDayReferenceCalendar();
 
 NSDateComponents *ORKTimeOfDayComponentsFromDate(NSDate *date);
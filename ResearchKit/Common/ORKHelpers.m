@@ -34,7 +34,9 @@
 #import <CoreText/CoreText.h>
 #import <UIKit/UIKit.h>
 #import "ORKSkin.h"
+#import "ORKStyleCache.h"
 #import "ORKDefines_Private.h"
+#import <pthread.h>
 
 
 NSURL *ORKCreateRandomBaseURL() {
@@ -168,11 +170,7 @@ NSString *ORKFileProtectionFromMode(ORKFileProtectionMode mode) {
 }
 
 CGFloat ORKExpectedLabelHeight(UILabel *label) {
-    CGSize expectedLabelSize = [label.text boundingRectWithSize:CGSizeMake(label.frame.size.width, CGFLOAT_MAX)
-                                                        options:NSStringDrawingUsesLineFragmentOrigin
-                                                     attributes:@{ NSFontAttributeName : label.font }
-                                                        context:nil].size;
-    return expectedLabelSize.height;
+    return [[ORKStyleCache sharedCache] heightForText:label.text font:label.font width:label.frame.size.width];
 }
 
 void ORKAdjustHeightForLabel(UILabel *label) {
@@ -246,6 +244,129 @@ NSDateFormatter *ORKTimeOfDayLabelFormatter() {
     return timeformatter;
 }
 
+static pthread_mutex_t ORKDecimalFormattingLock = PTHREAD_MUTEX_INITIALIZER;
+static NSNumberFormatter *ORKDecimalFormatter = nil;
+static NSLocale *ORKDecimalFormatterLocale = nil;
+static unichar ORKDecimalSeparator = '.';
+
+/*
+ Call with ORKDecimalFormattingLock held. The formatter is dropped on a locale change; the
+ locale check also covers callers whose own locale change observers run before ours.
+ */
+static NSNumberFormatter *ORKDecimalFormatterForCurrentLocale() {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        [[NSNotificationCenter defaultCenter] addObserverForName:NSCurrentLocaleDidChangeNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
+            pthread_mutex_lock(&ORKDecimalFormattingLock);
+            ORKDecimalFormatter = nil;
+            pthread_mutex_unlock(&ORKDecimalFormattingLock);
+        }];
+    });
+    NSLocale *locale = [NSLocale currentLocale];
+    if (! ORKDecimalFormatter || locale != ORKDecimalFormatterLocale) {
+        NSNumberFormatter *formatter = [NSNumberFormatter new];
+        formatter.locale = locale;
+        formatter.numberStyle = NSNumberFormatterDecimalStyle;
+        formatter.usesGroupingSeparator = NO;
+        NSString *separator = formatter.decimalSeparator;
+        ORKDecimalSeparator = separator.length ? [separator characterAtIndex:0] : '.';
+        ORKDecimalFormatter = formatter;
+        ORKDecimalFormatterLocale = locale;
+    }
+    return ORKDecimalFormatter;
+}
+
+NSNumberFormatter *ORKDecimalNumberFormatter() {
+    pthread_mutex_lock(&ORKDecimalFormattingLock);
+    NSNumberFormatter *formatter = ORKDecimalFormatterForCurrentLocale();
+    pthread_mutex_unlock(&ORKDecimalFormattingLock);
+    return formatter;
+}
+
+BOOL ORKParseDecimalString(NSString *text, double *value) {
+    pthread_mutex_lock(&ORKDecimalFormattingLock);
+    ORKDecimalFormatterForCurrentLocale();
+    unichar decimalSeparator = ORKDecimalSeparator;
+    pthread_mutex_unlock(&ORKDecimalFormattingLock);
+    
+    CFStringRef string = (__bridge CFStringRef)text;
+    CFIndex length = CFStringGetLength(string);
+    CFStringInlineBuffer buffer;
+    CFStringInitInlineBuffer(string, &buffer, CFRangeMake(0, length));
+    
+    // Copy the leading number in C notation; its digits bound the length of any meaningful input.
+    char number[64];
+    NSUInteger count = 0;
+    NSUInteger digitCount = 0;
+    BOOL seenSeparator = NO;
+    CFIndex i = 0;
+    CFCharacterSetRef whitespace = CFCharacterSetGetPredefined(kCFCharacterSetWhitespaceAndNewline);
+    while (i < length && CFCharacterSetIsCharacterMember(whitespace, CFStringGetCharacterFromInlineBuffer(&buffer, i))) {
+        i++;
+    }
+    if (i < length) {
+        unichar c = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+        if (c == '-' || c == '+') {
+            number[count++] = (char)c;
+            i++;
+        }
+    }
+    for (; i < length && count < sizeof(number) - 8; i++) {
+        unichar c = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+        if (c >= '0' && c <= '9') {
+            number[count++] = (char)c;
+            digitCount++;
+        } else if (c == decimalSeparator && ! seenSeparator) {
+            number[count++] = '.';
+            seenSeparator = YES;
+        } else {
+            break;
+        }
+    }
+    if (digitCount == 0) {
+        return NO;
+    }
+    if (i < length && count < sizeof(number) - 8) {
+        unichar c = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+        if (c == 'e' || c == 'E') {
+            NSUInteger mark = count;
+            number[count++] = 'e';
+            i++;
+            if (i < length) {
+                unichar sign = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+                if (sign == '-' || sign == '+') {
+                    number[count++] = (char)sign;
+                    i++;
+                }
+            }
+            NSUInteger exponentDigitCount = 0;
+            for (; i < length && count < sizeof(number) - 1; i++) {
+                unichar digit = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+                if (digit < '0' || digit > '9') {
+                    break;
+                }
+                number[count++] = (char)digit;
+                exponentDigitCount++;
+            }
+            if (exponentDigitCount == 0) {
+                count = mark;
+            }
+        }
+    }
+    if (i < length && count >= sizeof(number) - 8) {
+        // Too long for the buffer; rare enough to take the slow path.
+        NSDecimalNumber *decimalNumber = [NSDecimalNumber decimalNumberWithString:text locale:[NSLocale currentLocale]];
+        if (isnan(decimalNumber.doubleValue)) {
+            return NO;
+        }
+        *value = decimalNumber.doubleValue;
+        return YES;
+    }
+    number[count] = '\0';
+    *value = strtod(number, NULL);
+    return YES;
+}
+
 NSBundle *ORKBundle() {
     NSBundle *bundle = [NSBundle bundleForClass:[ORKStep class]];
     return bundle;
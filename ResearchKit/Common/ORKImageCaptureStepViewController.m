@@ -49,7 +49,9 @@
 @end
 
 
-@implementation ORKImageCaptureStepViewController
+@implementation ORKImageCaptureStepViewController {
+    BOOL _captureSessionSetUp;
+}
 
 - (instancetype)initWithStep:(ORKStep *)step result:(ORKResult *)result {
     self = [self initWithStep:step];
@@ -138,16 +140,19 @@
     
     // Capture actions should be performed off the main queue to keep the UI responsive
     self.sessionQueue = dispatch_queue_create("session queue", DISPATCH_QUEUE_SERIAL);
-    
-    // Setup the capture session
-    dispatch_async(self.sessionQueue, ^{
-        [self queue_setupCaptureSession];
-    });
 }
 
 - (void)viewWillAppear:(BOOL)animated {
     [super viewWillAppear:animated];
     
+    // Setup the capture session when first shown, so a view loaded ahead of the step leaves the camera alone
+    if (!_captureSessionSetUp) {
+        _captureSessionSetUp = YES;
+        dispatch_async(self.sessionQueue, ^{
+            [self queue_setupCaptureSession];
+        });
+    }
+    
     // If we don't already have a captured image, then start the capture session running
     if(!self.capturedImageData) {
         dispatch_async(self.sessionQueue, ^{
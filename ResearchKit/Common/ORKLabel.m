@@ -31,6 +31,7 @@
 
 #import "ORKLabel.h"
 #import "ORKHelpers.h"
+#import "ORKStyleCache.h"
 
 
 @implementation ORKLabel
@@ -65,7 +66,7 @@
 }
 
 - (void)updateAppearance {
-    self.font = [[self class] defaultFont];
+    self.font = ORKCachedDefaultFont([self class]);
     [self invalidateIntrinsicContentSize];
 }
 
@@ -86,6 +86,18 @@ ORK_CLASS_AVAILABLE
  */
 @property (nonatomic, copy, readonly) NSArray *steps;
 
+/**
+ An array of recorder configurations that span more than one step of the task.
+ 
+ Each element in the array must be an `ORKContinuousRecorderConfiguration` object.
+ The task view controller runs each of these recorders continuously while the
+ task is on any step in the configuration's range, and attaches a per-step
+ `ORKFileResult` object to the result of each step in that range.
+ 
+ The default value of this property is `nil`.
+ */
+@property (nonatomic, copy, nullable) NSArray *continuousRecorderConfigurations;
+
 @end
 
 
@@ -125,7 +137,10 @@ typedef NS_OPTIONS(NSUInteger, ORKPredefinedTaskOption) {
     ORKPredefinedTaskOptionExcludeHeartRate = (1 << 6),
     
     /// Exclude audio data collection.
-    ORKPredefinedTaskOptionExcludeAudio = (1 << 7)
+    ORKPredefinedTaskOptionExcludeAudio = (1 << 7),
+    
+    /// Record motion data continuously across consecutive active steps, instead of once per step.
+    ORKPredefinedTaskOptionContinuousMotionRecording = (1 << 8)
 } ORK_ENUM_AVAILABLE;
 
 
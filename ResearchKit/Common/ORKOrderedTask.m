@@ -55,6 +55,7 @@
 #import "ORKDeviceMotionReactionTimeStep.h"
 #import "ORKAccelerometerRecorder.h"
 #import "ORKAudioRecorder.h"
+#import "ORKRecorder_Private.h"
 
 
 ORKTaskProgress ORKTaskProgressMake(NSUInteger current, NSUInteger total) {
@@ -81,6 +82,7 @@ ORKTaskProgress ORKTaskProgressMake(NSUInteger current, NSUInteger total) {
     ORKOrderedTask *task = [[[self class] allocWithZone:zone] init];
     task->_identifier = [_identifier copy];
     task->_steps = ORKArrayCopyObjects(_steps);
+    task->_continuousRecorderConfigurations = ORKArrayCopyObjects(_continuousRecorderConfigurations);
     return task;
 }
 
@@ -91,11 +93,12 @@ ORKTaskProgress ORKTaskProgressMake(NSUInteger current, NSUInteger total) {
     
     __typeof(self) castObject = object;
     return (ORKEqualObjects(self.identifier, castObject.identifier)
-            && ORKEqualObjects(self.steps, castObject.steps));
+            && ORKEqualObjects(self.steps, castObject.steps)
+            && ORKEqualObjects(self.continuousRecorderConfigurations, castObject.continuousRecorderConfigurations));
 }
 
 - (NSUInteger)hash {
-    return [_identifier hash] ^ [_steps hash];
+    return [_identifier hash] ^ [_steps hash] ^ [_continuousRecorderConfigurations hash];
 }
 
 #pragma mark - ORKTask
@@ -212,6 +215,12 @@ ORKTaskProgress ORKTaskProgressMake(NSUInteger current, NSUInteger total) {
             [healthTypes unionSet:[activeStep requestedHealthKitTypesForReading]];
         }
     }
+    for (ORKContinuousRecorderConfiguration *configuration in self.continuousRecorderConfigurations) {
+        NSSet *subset = [configuration.recorderConfiguration requestedHealthKitTypesForReading];
+        if (subset) {
+            [healthTypes unionSet:subset];
+        }
+    }
     return [healthTypes count] ? healthTypes : nil;
 }
 
@@ -224,6 +233,9 @@ ORKTaskProgress ORKTaskProgressMake(NSUInteger current, NSUInteger total) {
     for (ORKStep *step in self.steps) {
         mask |= [step requestedPermissions];
     }
+    for (ORKContinuousRecorderConfiguration *configuration in self.continuousRecorderConfigurations) {
+        mask |= [configuration.recorderConfiguration requestedPermissionMask];
+    }
     return mask;
 }
 
@@ -250,6 +262,7 @@ ORKTaskProgress ORKTaskProgressMake(NSUInteger current, NSUInteger total) {
 - (void)encodeWithCoder:(NSCoder *)aCoder {
     ORK_ENCODE_OBJ(aCoder, identifier);
     ORK_ENCODE_OBJ(aCoder, steps);
+    ORK_ENCODE_OBJ(aCoder, continuousRecorderConfigurations);
 }
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
@@ -257,6 +270,7 @@ ORKTaskProgress ORKTaskProgressMake(NSUInteger current, NSUInteger total) {
     if (self) {
         ORK_DECODE_OBJ_CLASS(aDecoder, identifier, NSString);
         ORK_DECODE_OBJ_ARRAY(aDecoder, steps, ORKStep);
+        ORK_DECODE_OBJ_ARRAY(aDecoder, continuousRecorderConfigurations, ORKContinuousRecorderConfiguration);
         
         for (ORKStep *step in _steps) {
             if ([step isKindOfClass:[ORKStep class]]) {
@@ -592,6 +606,10 @@ static void ORKStepArrayAddStep(NSMutableArray *array, ORKStep *step) {
     
     NSDateComponentsFormatter *formatter = [self textTimeFormatter];
     
+    // With continuous recording, motion is recorded by the task rather than by each step.
+    BOOL recordsMotionContinuously = (options & ORKPredefinedTaskOptionContinuousMotionRecording) != 0;
+    NSMutableArray *continuousStepIdentifiers = [NSMutableArray array];
+    
     NSMutableArray *steps = [NSMutableArray array];
     if (! (options & ORKPredefinedTaskOptionExcludeInstructions)) {
         {
@@ -626,11 +644,11 @@ static void ORKStepArrayAddStep(NSMutableArray *array, ORKStep *step) {
             if (! (ORKPredefinedTaskOptionExcludePedometer & options)) {
                 [recorderConfigurations addObject:[[ORKPedometerRecorderConfiguration alloc] initWithIdentifier:ORKPedometerRecorderIdentifier]];
             }
-            if (! (ORKPredefinedTaskOptionExcludeAccelerometer & options)) {
+            if (! recordsMotionContinuously && ! (ORKPredefinedTaskOptionExcludeAccelerometer & options)) {
                 [recorderConfigurations addObject:[[ORKAccelerometerRecorderConfiguration alloc] initWithIdentifier:ORKAccelerometerRecorderIdentifier
                                                                                                           frequency:100]];
             }
-            if (! (ORKPredefinedTaskOptionExcludeDeviceMotion & options)) {
+            if (! recordsMotionContinuously && ! (ORKPredefinedTaskOptionExcludeDeviceMotion & options)) {
                 [recorderConfigurations addObject:[[ORKDeviceMotionRecorderConfiguration alloc] initWithIdentifier:ORKDeviceMotionRecorderIdentifier
                                                                                                          frequency:100]];
             }
@@ -648,6 +666,7 @@ static void ORKStepArrayAddStep(NSMutableArray *array, ORKStep *step) {
             walkingStep.shouldPlaySoundOnStart = YES;
             
             ORKStepArrayAddStep(steps, walkingStep);
+            [continuousStepIdentifiers addObject:walkingStep.identifier];
         }
         
         {
@@ -655,11 +674,11 @@ static void ORKStepArrayAddStep(NSMutableArray *array, ORKStep *step) {
             if (! (ORKPredefinedTaskOptionExcludePedometer & options)) {
                 [recorderConfigurations addObject:[[ORKPedometerRecorderConfiguration alloc] initWithIdentifier:ORKPedometerRecorderIdentifier]];
             }
-            if (! (ORKPredefinedTaskOptionExcludeAccelerometer & options)) {
+            if (! recordsMotionContinuously && ! (ORKPredefinedTaskOptionExcludeAccelerometer & options)) {
                 [recorderConfigurations addObject:[[ORKAccelerometerRecorderConfiguration alloc] initWithIdentifier:ORKAccelerometerRecorderIdentifier
                                                                                                           frequency:100]];
             }
-            if (! (ORKPredefinedTaskOptionExcludeDeviceMotion & options)) {
+            if (! recordsMotionContinuously && ! (ORKPredefinedTaskOptionExcludeDeviceMotion & options)) {
                 [recorderConfigurations addObject:[[ORKDeviceMotionRecorderConfiguration alloc] initWithIdentifier:ORKDeviceMotionRecorderIdentifier
                                                                                                          frequency:100]];
             }
@@ -677,15 +696,16 @@ static void ORKStepArrayAddStep(NSMutableArray *array, ORKStep *step) {
             walkingStep.shouldPlaySoundOnStart = YES;
             
             ORKStepArrayAddStep(steps, walkingStep);
+            [continuousStepIdentifiers addObject:walkingStep.identifier];
         }
         
         if (restDuration > 0) {
             NSMutableArray *recorderConfigurations = [NSMutableArray array];
-            if (! (ORKPredefinedTaskOptionExcludeAccelerometer & options)) {
+            if (! recordsMotionContinuously && ! (ORKPredefinedTaskOptionExcludeAccelerometer & options)) {
                 [recorderConfigurations addObject:[[ORKAccelerometerRecorderConfiguration alloc] initWithIdentifier:ORKAccelerometerRecorderIdentifier
                                                                                                           frequency:100]];
             }
-            if (! (ORKPredefinedTaskOptionExcludeDeviceMotion & options)) {
+            if (! recordsMotionContinuously && ! (ORKPredefinedTaskOptionExcludeDeviceMotion & options)) {
                 [recorderConfigurations addObject:[[ORKDeviceMotionRecorderConfiguration alloc] initWithIdentifier:ORKDeviceMotionRecorderIdentifier
                                                                                                          frequency:100]];
             }
@@ -705,6 +725,7 @@ static void ORKStepArrayAddStep(NSMutableArray *array, ORKStep *step) {
             activeStep.shouldPlaySoundOnFinish = YES;
             
             ORKStepArrayAddStep(steps, activeStep);
+            [continuousStepIdentifiers addObject:activeStep.identifier];
         }
     }
     
@@ -715,6 +736,23 @@ static void ORKStepArrayAddStep(NSMutableArray *array, ORKStep *step) {
     }
     
     ORKOrderedTask *task = [[ORKOrderedTask alloc] initWithIdentifier:identifier steps:steps];
+    
+    if (recordsMotionContinuously) {
+        NSMutableArray *continuousRecorderConfigurations = [NSMutableArray array];
+        if (! (ORKPredefinedTaskOptionExcludeAccelerometer & options)) {
+            ORKRecorderConfiguration *configuration = [[ORKAccelerometerRecorderConfiguration alloc] initWithIdentifier:ORKAccelerometerRecorderIdentifier
+                                                                                                             frequency:100];
+            [continuousRecorderConfigurations addObject:[[ORKContinuousRecorderConfiguration alloc] initWithRecorderConfiguration:configuration
+                                                                                                                  stepIdentifiers:continuousStepIdentifiers]];
+        }
+        if (! (ORKPredefinedTaskOptionExcludeDeviceMotion & options)) {
+            ORKRecorderConfiguration *configuration = [[ORKDeviceMotionRecorderConfiguration alloc] initWithIdentifier:ORKDeviceMotionRecorderIdentifier
+                                                                                                            frequency:100];
+            [continuousRecorderConfigurations addObject:[[ORKContinuousRecorderConfiguration alloc] initWithRecorderConfiguration:configuration
+                                                                                                                  stepIdentifiers:continuousStepIdentifiers]];
+        }
+        task.continuousRecorderConfigurations = continuousRecorderConfigurations;
+    }
     return task;
 }
 
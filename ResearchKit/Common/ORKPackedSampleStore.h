@@ -0,0 +1,121 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+#import "ORKResult.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Column-oriented storage for fixed-layout samples.
+ 
+ Each row has a fixed number of double columns followed by a fixed number of 32-bit
+ integer columns. Every column is stored contiguously, so appending is amortized O(1)
+ with no per-sample object, and the whole store packs into a single data blob.
+ 
+ Not thread safe.
+ */
+@interface ORKPackedSampleStore : NSObject <NSCopying>
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithDoubleColumnCount:(NSUInteger)doubleColumnCount integerColumnCount:(NSUInteger)integerColumnCount NS_DESIGNATED_INITIALIZER;
+
+// Returns nil if `packedData` was not produced by a store with the same column layout.
+- (nullable instancetype)initWithPackedData:(NSData *)packedData doubleColumnCount:(NSUInteger)doubleColumnCount integerColumnCount:(NSUInteger)integerColumnCount;
+
+@property (nonatomic, readonly) NSUInteger doubleColumnCount;
+
+@property (nonatomic, readonly) NSUInteger integerColumnCount;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+// `doubles` and `integers` must hold one value per column.
+- (void)appendRowWithDoubles:(const double *)doubles integers:(const int32_t *)integers;
+
+- (void)removeAllRows;
+
+// Pointers are valid until the store is next mutated.
+- (const double *)doubleColumn:(NSUInteger)column;
+
+- (const int32_t *)integerColumn:(NSUInteger)column;
+
+/*
+ A header (format version, row count, column counts), followed by each double column,
+ then each integer column, all little-endian regardless of the host's byte order.
+ */
+- (NSData *)packedData;
+
+@end
+
+
+// Tapping samples: timestamp, x, y, and button identifier.
+@interface ORKTappingSampleStore : ORKPackedSampleStore
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER;
+
+- (nullable instancetype)initWithPackedData:(NSData *)packedData;
+
+- (instancetype)initWithSamples:(NSArray *)samples;
+
+- (void)appendSampleWithTimestamp:(NSTimeInterval)timestamp location:(CGPoint)location buttonIdentifier:(ORKTappingButtonIdentifier)buttonIdentifier;
+
+- (const NSTimeInterval *)timestamps;
+
+- (ORKTappingSample *)sampleAtIndex:(NSUInteger)index;
+
+// New `ORKTappingSample` objects, one for each row.
+- (NSArray *)samples;
+
+@end
+
+
+// Spatial span memory touch samples: timestamp, x, y, target index, and correctness.
+@interface ORKSpatialSpanMemoryGameTouchSampleStore : ORKPackedSampleStore
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER;
+
+- (nullable instancetype)initWithPackedData:(NSData *)packedData;
+
+- (instancetype)initWithSamples:(NSArray *)samples;
+
+- (void)appendSampleWithTimestamp:(NSTimeInterval)timestamp location:(CGPoint)location targetIndex:(NSInteger)targetIndex correct:(BOOL)correct;
+
+- (ORKSpatialSpanMemoryGameTouchSample *)sampleAtIndex:(NSUInteger)index;
+
+// New `ORKSpatialSpanMemoryGameTouchSample` objects, one for each row.
+- (NSArray *)samples;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,373 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKPackedSampleStore.h"
+#import <libkern/OSByteOrder.h>
+
+
+typedef struct {
+    uint32_t version;
+    uint32_t count;
+    uint32_t doubleColumnCount;
+    uint32_t integerColumnCount;
+} ORKPackedSampleHeader;
+
+static const uint32_t ORKPackedSampleFormatVersion = 1;
+
+// Packed data is always little-endian. On little-endian hosts these are plain copies.
+static void ORKPackedSampleHeaderSwapLittleToHost(ORKPackedSampleHeader *header) {
+    header->version = OSSwapLittleToHostInt32(header->version);
+    header->count = OSSwapLittleToHostInt32(header->count);
+    header->doubleColumnCount = OSSwapLittleToHostInt32(header->doubleColumnCount);
+    header->integerColumnCount = OSSwapLittleToHostInt32(header->integerColumnCount);
+}
+
+static void ORKPackedSampleSwapElements(void *bytes, NSUInteger length, size_t elementSize) {
+#if __BIG_ENDIAN__
+    uint8_t *element = (uint8_t *)bytes;
+    for (NSUInteger offset = 0; offset < length; offset += elementSize) {
+        if (elementSize == sizeof(uint64_t)) {
+            uint64_t value;
+            memcpy(&value, element + offset, sizeof(value));
+            value = OSSwapInt64(value);
+            memcpy(element + offset, &value, sizeof(value));
+        } else {
+            uint32_t value;
+            memcpy(&value, element + offset, sizeof(value));
+            value = OSSwapInt32(value);
+            memcpy(element + offset, &value, sizeof(value));
+        }
+    }
+#else
+    (void)bytes;
+    (void)length;
+    (void)elementSize;
+#endif
+}
+
+
+@implementation ORKPackedSampleStore {
+    NSArray *_doubleColumns;
+    NSArray *_integerColumns;
+}
+
+- (instancetype)initWithDoubleColumnCount:(NSUInteger)doubleColumnCount integerColumnCount:(NSUInteger)integerColumnCount {
+    self = [super init];
+    if (self) {
+        _doubleColumnCount = doubleColumnCount;
+        _integerColumnCount = integerColumnCount;
+        
+        NSMutableArray *doubleColumns = [NSMutableArray arrayWithCapacity:doubleColumnCount];
+        for (NSUInteger i = 0; i < doubleColumnCount; i++) {
+            [doubleColumns addObject:[NSMutableData data]];
+        }
+        NSMutableArray *integerColumns = [NSMutableArray arrayWithCapacity:integerColumnCount];
+        for (NSUInteger i = 0; i < integerColumnCount; i++) {
+            [integerColumns addObject:[NSMutableData data]];
+        }
+        _doubleColumns = [doubleColumns copy];
+        _integerColumns = [integerColumns copy];
+    }
+    return self;
+}
+
+- (instancetype)initWithPackedData:(NSData *)packedData doubleColumnCount:(NSUInteger)doubleColumnCount integerColumnCount:(NSUInteger)integerColumnCount {
+    self = [self initWithDoubleColumnCount:doubleColumnCount integerColumnCount:integerColumnCount];
+    if (self) {
+        ORKPackedSampleHeader header;
+        if (packedData.length < sizeof(header)) {
+            return nil;
+        }
+        [packedData getBytes:&header length:sizeof(header)];
+        ORKPackedSampleHeaderSwapLittleToHost(&header);
+        if (header.version != ORKPackedSampleFormatVersion ||
+            header.doubleColumnCount != doubleColumnCount ||
+            header.integerColumnCount != integerColumnCount) {
+            return nil;
+        }
+        
+        NSUInteger count = header.count;
+        NSUInteger doubleLength = count * sizeof(double);
+        NSUInteger integerLength = count * sizeof(int32_t);
+        if (packedData.length != sizeof(header) + doubleColumnCount * doubleLength + integerColumnCount * integerLength) {
+            return nil;
+        }
+        
+        const uint8_t *bytes = (const uint8_t *)packedData.bytes + sizeof(header);
+        for (NSMutableData *column in _doubleColumns) {
+            [column appendBytes:bytes length:doubleLength];
+            ORKPackedSampleSwapElements(column.mutableBytes, doubleLength, sizeof(double));
+            bytes += doubleLength;
+        }
+        for (NSMutableData *column in _integerColumns) {
+            [column appendBytes:bytes length:integerLength];
+            ORKPackedSampleSwapElements(column.mutableBytes, integerLength, sizeof(int32_t));
+            bytes += integerLength;
+        }
+        _count = count;
+    }
+    return self;
+}
+
+- (void)appendRowWithDoubles:(const double *)doubles integers:(const int32_t *)integers {
+    for (NSUInteger i = 0; i < _doubleColumnCount; i++) {
+        [_doubleColumns[i] appendBytes:&doubles[i] length:sizeof(double)];
+    }
+    for (NSUInteger i = 0; i < _integerColumnCount; i++) {
+        [_integerColumns[i] appendBytes:&integers[i] length:sizeof(int32_t)];
+    }
+    _count++;
+}
+
+- (void)removeAllRows {
+    for (NSMutableData *column in _doubleColumns) {
+        column.length = 0;
+    }
+    for (NSMutableData *column in _integerColumns) {
+        column.length = 0;
+    }
+    _count = 0;
+}
+
+- (const double *)doubleColumn:(NSUInteger)column {
+    return (const double *)[_doubleColumns[column] bytes];
+}
+
+- (const int32_t *)integerColumn:(NSUInteger)column {
+    return (const int32_t *)[_integerColumns[column] bytes];
+}
+
+- (NSData *)packedData {
+    ORKPackedSampleHeader header = {
+        .version = OSSwapHostToLittleInt32(ORKPackedSampleFormatVersion),
+        .count = OSSwapHostToLittleInt32((uint32_t)_count),
+        .doubleColumnCount = OSSwapHostToLittleInt32((uint32_t)_doubleColumnCount),
+        .integerColumnCount = OSSwapHostToLittleInt32((uint32_t)_integerColumnCount)
+    };
+    NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(header) + _count * (_doubleColumnCount * sizeof(double) + _integerColumnCount * sizeof(int32_t))];
+    [data appendBytes:&header length:sizeof(header)];
+    for (NSData *column in _doubleColumns) {
+        NSUInteger offset = data.length;
+        [data appendData:column];
+        ORKPackedSampleSwapElements((uint8_t *)data.mutableBytes + offset, column.length, sizeof(double));
+    }
+    for (NSData *column in _integerColumns) {
+        NSUInteger offset = data.length;
+        [data appendData:column];
+        ORKPackedSampleSwapElements((uint8_t *)data.mutableBytes + offset, column.length, sizeof(int32_t));
+    }
+    return data;
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    ORKPackedSampleStore *store = [[[self class] allocWithZone:zone] initWithDoubleColumnCount:_doubleColumnCount integerColumnCount:_integerColumnCount];
+    for (NSUInteger i = 0; i < _doubleColumnCount; i++) {
+        [store->_doubleColumns[i] setData:_doubleColumns[i]];
+    }
+    for (NSUInteger i = 0; i < _integerColumnCount; i++) {
+        [store->_integerColumns[i] setData:_integerColumns[i]];
+    }
+    store->_count = _count;
+    return store;
+}
+
+- (BOOL)isEqual:(id)object {
+    if ([self class] != [object class]) {
+        return NO;
+    }
+    
+    __typeof(self) castObject = object;
+    if (_count != castObject.count ||
+        _doubleColumnCount != castObject.doubleColumnCount ||
+        _integerColumnCount != castObject.integerColumnCount) {
+        return NO;
+    }
+    // Compare values rather than bytes, so that 0.0 and -0.0 match as they do for sample objects.
+    for (NSUInteger column = 0; column < _doubleColumnCount; column++) {
+        const double *a = [self doubleColumn:column];
+        const double *b = [castObject doubleColumn:column];
+        for (NSUInteger row = 0; row < _count; row++) {
+            if (a[row] != b[row]) {
+                return NO;
+            }
+        }
+    }
+    for (NSUInteger column = 0; column < _integerColumnCount; column++) {
+        if (memcmp([self integerColumn:column], [castObject integerColumn:column], _count * sizeof(int32_t)) != 0) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (NSUInteger)hash {
+    return _count ^ (_doubleColumnCount << 8) ^ (_integerColumnCount << 16);
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; count: %@>", self.class.description, self, @(_count)];
+}
+
+@end
+
+
+enum {
+    ORKTappingColumnTimestamp = 0,
+    ORKTappingColumnX,
+    ORKTappingColumnY,
+    ORKTappingDoubleColumnCount
+};
+
+enum {
+    ORKTappingColumnButtonIdentifier = 0,
+    ORKTappingIntegerColumnCount
+};
+
+
+@implementation ORKTappingSampleStore
+
+- (instancetype)init {
+    return [super initWithDoubleColumnCount:ORKTappingDoubleColumnCount integerColumnCount:ORKTappingIntegerColumnCount];
+}
+
+- (instancetype)initWithDoubleColumnCount:(NSUInteger)doubleColumnCount integerColumnCount:(NSUInteger)integerColumnCount {
+    NSParameterAssert(doubleColumnCount == ORKTappingDoubleColumnCount && integerColumnCount == ORKTappingIntegerColumnCount);
+    return [self init];
+}
+
+- (instancetype)initWithPackedData:(NSData *)packedData {
+    return [self initWithPackedData:packedData doubleColumnCount:ORKTappingDoubleColumnCount integerColumnCount:ORKTappingIntegerColumnCount];
+}
+
+- (instancetype)initWithSamples:(NSArray *)samples {
+    self = [self init];
+    if (self) {
+        for (ORKTappingSample *sample in samples) {
+            [self appendSampleWithTimestamp:sample.timestamp location:sample.location buttonIdentifier:sample.buttonIdentifier];
+        }
+    }
+    return self;
+}
+
+- (void)appendSampleWithTimestamp:(NSTimeInterval)timestamp location:(CGPoint)location buttonIdentifier:(ORKTappingButtonIdentifier)buttonIdentifier {
+    double doubles[ORKTappingDoubleColumnCount] = { timestamp, location.x, location.y };
+    int32_t integers[ORKTappingIntegerColumnCount] = { (int32_t)buttonIdentifier };
+    [self appendRowWithDoubles:doubles integers:integers];
+}
+
+- (const NSTimeInterval *)timestamps {
+    return [self doubleColumn:ORKTappingColumnTimestamp];
+}
+
+- (ORKTappingSample *)sampleAtIndex:(NSUInteger)index {
+    ORKTappingSample *sample = [ORKTappingSample new];
+    sample.timestamp = [self doubleColumn:ORKTappingColumnTimestamp][index];
+    sample.location = CGPointMake([self doubleColumn:ORKTappingColumnX][index], [self doubleColumn:ORKTappingColumnY][index]);
+    sample.buttonIdentifier = (ORKTappingButtonIdentifier)[self integerColumn:ORKTappingColumnButtonIdentifier][index];
+    return sample;
+}
+
+- (NSArray *)samples {
+    NSUInteger count = self.count;
+    NSMutableArray *samples = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [samples addObject:[self sampleAtIndex:i]];
+    }
+    return [samples copy];
+}
+
+@end
+
+
+enum {
+    ORKTouchColumnTimestamp = 0,
+    ORKTouchColumnX,
+    ORKTouchColumnY,
+    ORKTouchDoubleColumnCount
+};
+
+enum {
+    ORKTouchColumnTargetIndex = 0,
+    ORKTouchColumnCorrect,
+    ORKTouchIntegerColumnCount
+};
+
+
+@implementation ORKSpatialSpanMemoryGameTouchSampleStore
+
+- (instancetype)init {
+    return [super initWithDoubleColumnCount:ORKTouchDoubleColumnCount integerColumnCount:ORKTouchIntegerColumnCount];
+}
+
+- (instancetype)initWithDoubleColumnCount:(NSUInteger)doubleColumnCount integerColumnCount:(NSUInteger)integerColumnCount {
+    NSParameterAssert(doubleColumnCount == ORKTouchDoubleColumnCount && integerColumnCount == ORKTouchIntegerColumnCount);
+    return [self init];
+}
+
+- (instancetype)initWithPackedData:(NSData *)packedData {
+    return [self initWithPackedData:packedData doubleColumnCount:ORKTouchDoubleColumnCount integerColumnCount:ORKTouchIntegerColumnCount];
+}
+
+- (instancetype)initWithSamples:(NSArray *)samples {
+    self = [self init];
+    if (self) {
+        for (ORKSpatialSpanMemoryGameTouchSample *sample in samples) {
+            [self appendSampleWithTimestamp:sample.timestamp location:sample.location targetIndex:sample.targetIndex correct:sample.isCorrect];
+        }
+    }
+    return self;
+}
+
+- (void)appendSampleWithTimestamp:(NSTimeInterval)timestamp location:(CGPoint)location targetIndex:(NSInteger)targetIndex correct:(BOOL)correct {
+    double doubles[ORKTouchDoubleColumnCount] = { timestamp, location.x, location.y };
+    int32_t integers[ORKTouchIntegerColumnCount] = { (int32_t)targetIndex, correct ? 1 : 0 };
+    [self appendRowWithDoubles:doubles integers:integers];
+}
+
+- (ORKSpatialSpanMemoryGameTouchSample *)sampleAtIndex:(NSUInteger)index {
+    ORKSpatialSpanMemoryGameTouchSample *sample = [ORKSpatialSpanMemoryGameTouchSample new];
+    sample.timestamp = [self doubleColumn:ORKTouchColumnTimestamp][index];
+    sample.location = CGPointMake([self doubleColumn:ORKTouchColumnX][index], [self doubleColumn:ORKTouchColumnY][index]);
+    sample.targetIndex = [self integerColumn:ORKTouchColumnTargetIndex][index];
+    sample.correct = ([self integerColumn:ORKTouchColumnCorrect][index] != 0);
+    return sample;
+}
+
+- (NSArray *)samples {
+    NSUInteger count = self.count;
+    NSMutableArray *samples = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [samples addObject:[self sampleAtIndex:i]];
+    }
+    return [samples copy];
+}
+
+@end
@@ -0,0 +1,142 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <ResearchKit/ORKDefines.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ORKTaskResult;
+
+/**
+ The `userInfo` key of an `ORKStepResult` object under which a task view controller that
+ collects performance metrics stores the metrics measured for that step.
+ 
+ The value is a dictionary whose keys are the metric keys below and whose values are
+ `NSNumber` objects. A metric that was not measured for a step is absent.
+ */
+ORK_EXTERN NSString *const ORKResultPerformanceMetricsKey ORK_AVAILABLE_DECL;
+
+/// The time in seconds taken to create the step view controller and load its view, if it was built ahead of time.
+ORK_EXTERN NSString *const ORKPerformanceMetricViewControllerCreationDurationKey ORK_AVAILABLE_DECL;
+
+/// The time in seconds from the navigation request to the first frame of the step's transition.
+ORK_EXTERN NSString *const ORKPerformanceMetricTransitionDurationKey ORK_AVAILABLE_DECL;
+
+/// The time in seconds the step spent on the main thread starting its recorders.
+ORK_EXTERN NSString *const ORKPerformanceMetricRecorderStartDurationKey ORK_AVAILABLE_DECL;
+
+/// The time in seconds the step spent on the main thread stopping its recorders.
+ORK_EXTERN NSString *const ORKPerformanceMetricRecorderStopDurationKey ORK_AVAILABLE_DECL;
+
+/// The time in seconds from stopping the step's recorders until their files were finished and their results delivered.
+ORK_EXTERN NSString *const ORKPerformanceMetricRecorderStopLatencyKey ORK_AVAILABLE_DECL;
+
+/// The longest start latency, in seconds, reported by the step's recorders. See `ORKRecorderStartLatencyKey`.
+ORK_EXTERN NSString *const ORKPerformanceMetricRecorderStartLatencyKey ORK_AVAILABLE_DECL;
+
+/// The total size in bytes of the files in the step's file results.
+ORK_EXTERN NSString *const ORKPerformanceMetricBytesWrittenKey ORK_AVAILABLE_DECL;
+
+/// The number of sensor samples the step's recorders are estimated to have missed. See `ORKRecorderDroppedSampleCountKey`.
+ORK_EXTERN NSString *const ORKPerformanceMetricDroppedSampleCountKey ORK_AVAILABLE_DECL;
+
+/// The number of times the main thread missed display refreshes for longer than 100 ms while the step was shown.
+ORK_EXTERN NSString *const ORKPerformanceMetricMainThreadStallCountKey ORK_AVAILABLE_DECL;
+
+/// The longest interval in seconds between display refreshes while the step was shown.
+ORK_EXTERN NSString *const ORKPerformanceMetricLongestMainThreadStallKey ORK_AVAILABLE_DECL;
+
+
+/**
+ An `ORKPerformanceMetricStatistics` object summarizes the values of one performance metric.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKPerformanceMetricStatistics : NSObject <NSSecureCoding, NSCopying>
+
+/// The number of values.
+@property (nonatomic, readonly) NSUInteger count;
+
+/// The smallest value, or 0 if there are no values.
+@property (nonatomic, readonly) double minimum;
+
+/// The largest value, or 0 if there are no values.
+@property (nonatomic, readonly) double maximum;
+
+/// The mean of the values, or 0 if there are no values.
+@property (nonatomic, readonly) double mean;
+
+/// The population standard deviation of the values, or 0 if there are fewer than two values.
+@property (nonatomic, readonly) double standardDeviation;
+
+@end
+
+
+/**
+ An `ORKPerformanceMetricsAggregate` object accumulates the performance metrics of task
+ results across sessions, so that changes in performance can be tracked over time.
+ 
+ Archive the aggregate with `NSKeyedArchiver` between sessions and keep adding the results
+ of new task runs to it. Only step results that carry `ORKResultPerformanceMetricsKey` in
+ their `userInfo` contribute.
+ 
+ This class is not thread safe.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKPerformanceMetricsAggregate : NSObject <NSSecureCoding, NSCopying>
+
+/// The number of task results that contributed at least one metric.
+@property (nonatomic, readonly) NSUInteger taskResultCount;
+
+/**
+ Adds the metrics of each step result of a task result.
+ 
+ @param taskResult      The task result whose step results to add.
+ */
+- (void)addTaskResult:(ORKTaskResult *)taskResult;
+
+/**
+ Returns the statistics of a metric.
+ 
+ @param metricKey       One of the performance metric keys.
+ @param taskIdentifier  The identifier of the task.
+ @param stepIdentifier  The identifier of the step, or `nil` to pool the values of every step of the task.
+ 
+ @return The statistics, or `nil` if no value was added for the metric.
+ */
+- (nullable ORKPerformanceMetricStatistics *)statisticsForMetric:(NSString *)metricKey
+                                                  taskIdentifier:(NSString *)taskIdentifier
+                                                  stepIdentifier:(nullable NSString *)stepIdentifier;
+
+@end
+
+NS_ASSUME_NONNULL_END
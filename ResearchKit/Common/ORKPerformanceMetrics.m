@@ -0,0 +1,232 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKPerformanceMetrics.h"
+#import "ORKResult.h"
+#import "ORKHelpers.h"
+
+
+NSString *const ORKResultPerformanceMetricsKey = @"performanceMetrics";
+
+NSString *const ORKPerformanceMetricViewControllerCreationDurationKey = @"viewControllerCreationDuration";
+NSString *const ORKPerformanceMetricTransitionDurationKey = @"transitionDuration";
+NSString *const ORKPerformanceMetricRecorderStartDurationKey = @"recorderStartDuration";
+NSString *const ORKPerformanceMetricRecorderStopDurationKey = @"recorderStopDuration";
+NSString *const ORKPerformanceMetricRecorderStopLatencyKey = @"recorderStopLatency";
+NSString *const ORKPerformanceMetricRecorderStartLatencyKey = @"recorderStartLatency";
+NSString *const ORKPerformanceMetricBytesWrittenKey = @"bytesWritten";
+NSString *const ORKPerformanceMetricDroppedSampleCountKey = @"droppedSampleCount";
+NSString *const ORKPerformanceMetricMainThreadStallCountKey = @"mainThreadStallCount";
+NSString *const ORKPerformanceMetricLongestMainThreadStallKey = @"longestMainThreadStall";
+
+
+@interface ORKPerformanceMetricStatistics ()
+
+- (void)addValue:(double)value;
+
+@end
+
+
+@implementation ORKPerformanceMetricStatistics {
+    // Sum of squared deviations from the running mean.
+    double _m2;
+}
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    self = [super init];
+    if (self) {
+        ORK_DECODE_INTEGER(aDecoder, count);
+        ORK_DECODE_DOUBLE(aDecoder, minimum);
+        ORK_DECODE_DOUBLE(aDecoder, maximum);
+        ORK_DECODE_DOUBLE(aDecoder, mean);
+        ORK_DECODE_DOUBLE(aDecoder, m2);
+    }
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    ORK_ENCODE_INTEGER(aCoder, count);
+    ORK_ENCODE_DOUBLE(aCoder, minimum);
+    ORK_ENCODE_DOUBLE(aCoder, maximum);
+    ORK_ENCODE_DOUBLE(aCoder, mean);
+    ORK_ENCODE_DOUBLE(aCoder, m2);
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    ORKPerformanceMetricStatistics *statistics = [[[self class] allocWithZone:zone] init];
+    statistics->_count = _count;
+    statistics->_minimum = _minimum;
+    statistics->_maximum = _maximum;
+    statistics->_mean = _mean;
+    statistics->_m2 = _m2;
+    return statistics;
+}
+
+- (BOOL)isEqual:(id)object {
+    if ([self class] != [object class]) {
+        return NO;
+    }
+    
+    __typeof(self) castObject = object;
+    return (_count == castObject->_count &&
+            _minimum == castObject->_minimum &&
+            _maximum == castObject->_maximum &&
+            _mean == castObject->_mean &&
+            _m2 == castObject->_m2);
+}
+
+- (NSUInteger)hash {
+    return _count ^ [@(_mean) hash];
+}
+
+- (void)addValue:(double)value {
+    _minimum = (_count == 0) ? value : MIN(_minimum, value);
+    _maximum = (_count == 0) ? value : MAX(_maximum, value);
+    _count++;
+    
+    // Welford's update, which stays accurate over many sessions.
+    double delta = value - _mean;
+    _mean += delta / _count;
+    _m2 += delta * (value - _mean);
+}
+
+- (double)standardDeviation {
+    return (_count > 1) ? sqrt(_m2 / _count) : 0;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; count: %lu; min: %g; max: %g; mean: %g; sd: %g>", self.class.description, self, (unsigned long)_count, _minimum, _maximum, _mean, self.standardDeviation];
+}
+
+@end
+
+
+@implementation ORKPerformanceMetricsAggregate {
+    // Keyed by @[taskIdentifier, metricKey, stepIdentifier], and by @[taskIdentifier, metricKey] for all steps.
+    NSMutableDictionary *_statistics;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _statistics = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    self = [super init];
+    if (self) {
+        ORK_DECODE_INTEGER(aDecoder, taskResultCount);
+        _statistics = [(NSDictionary *)[aDecoder decodeObjectOfClasses:ORK_CLASS_SET([NSDictionary class], [NSArray class], [NSString class], [ORKPerformanceMetricStatistics class]) forKey:@"statistics"] mutableCopy] ? : [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    ORK_ENCODE_INTEGER(aCoder, taskResultCount);
+    ORK_ENCODE_OBJ(aCoder, statistics);
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    ORKPerformanceMetricsAggregate *aggregate = [[[self class] allocWithZone:zone] init];
+    aggregate->_taskResultCount = _taskResultCount;
+    [_statistics enumerateKeysAndObjectsUsingBlock:^(NSArray *key, ORKPerformanceMetricStatistics *statistics, BOOL *stop) {
+        aggregate->_statistics[key] = [statistics copy];
+    }];
+    return aggregate;
+}
+
+- (BOOL)isEqual:(id)object {
+    if ([self class] != [object class]) {
+        return NO;
+    }
+    
+    __typeof(self) castObject = object;
+    return (_taskResultCount == castObject->_taskResultCount &&
+            ORKEqualObjects(_statistics, castObject->_statistics));
+}
+
+- (NSUInteger)hash {
+    return _taskResultCount ^ _statistics.count;
+}
+
+- (void)addValue:(double)value forKey:(NSArray *)key {
+    ORKPerformanceMetricStatistics *statistics = _statistics[key];
+    if (! statistics) {
+        statistics = [ORKPerformanceMetricStatistics new];
+        _statistics[key] = statistics;
+    }
+    [statistics addValue:value];
+}
+
+- (void)addTaskResult:(ORKTaskResult *)taskResult {
+    NSString *taskIdentifier = taskResult.identifier;
+    if (! taskIdentifier) {
+        return;
+    }
+    
+    BOOL contributed = NO;
+    for (ORKResult *result in taskResult.results) {
+        NSDictionary *metrics = result.userInfo[ORKResultPerformanceMetricsKey];
+        if (! [result isKindOfClass:[ORKStepResult class]] || ! [metrics isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        NSString *stepIdentifier = result.identifier;
+        for (NSString *metricKey in metrics) {
+            NSNumber *value = metrics[metricKey];
+            if (! [metricKey isKindOfClass:[NSString class]] || ! [value isKindOfClass:[NSNumber class]]) {
+                continue;
+            }
+            [self addValue:value.doubleValue forKey:@[taskIdentifier, metricKey, stepIdentifier]];
+            [self addValue:value.doubleValue forKey:@[taskIdentifier, metricKey]];
+            contributed = YES;
+        }
+    }
+    if (contributed) {
+        _taskResultCount++;
+    }
+}
+
+- (ORKPerformanceMetricStatistics *)statisticsForMetric:(NSString *)metricKey taskIdentifier:(NSString *)taskIdentifier stepIdentifier:(NSString *)stepIdentifier {
+    NSArray *key = stepIdentifier ? @[taskIdentifier, metricKey, stepIdentifier] : @[taskIdentifier, metricKey];
+    return [_statistics[key] copy];
+}
+
+@end
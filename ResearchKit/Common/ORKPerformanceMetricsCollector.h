@@ -0,0 +1,82 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ORKStepResult;
+
+/*
+ Collects the performance metrics of a task run, per step, for a task view controller that
+ has `collectsPerformanceMetrics` enabled. Nothing is created or measured when it is disabled.
+ 
+ Values added for a step accumulate over repeated visits to that step. Main queue only.
+ */
+@interface ORKPerformanceMetricsCollector : NSObject
+
+// Gap between display refreshes counted as a main thread stall. Defaults to 0.1 s.
+@property (nonatomic) NSTimeInterval stallThreshold;
+
+- (void)addValue:(double)value forMetric:(NSString *)metricKey stepIdentifier:(NSString *)stepIdentifier;
+
+- (void)addMaximumValue:(double)value forMetric:(NSString *)metricKey stepIdentifier:(NSString *)stepIdentifier;
+
+- (nullable NSDictionary *)metricsForStepIdentifier:(NSString *)stepIdentifier;
+
+/*
+ Counts main thread stalls, as gaps between display refreshes, against the given step until
+ monitoring ends or another step begins. Refreshes are not watched while the app is inactive.
+ */
+- (void)beginMonitoringStepIdentifier:(NSString *)stepIdentifier;
+
+- (void)endMonitoring;
+
+// Called on each display refresh while monitoring; exposed for testing.
+- (void)displayDidRefreshAtTime:(CFTimeInterval)timestamp;
+
+/*
+ Adds the metrics derived from recorder results as they come in: the longest start latency, the
+ dropped samples, and the size of each output file. Call once per result; file sizes are read here.
+ */
+- (void)addMetricsFromRecorderResults:(NSArray *)results stepIdentifier:(NSString *)stepIdentifier;
+
+/*
+ Stores the step's metrics in the result's userInfo under `ORKResultPerformanceMetricsKey`.
+ Leaves the result unchanged if there is nothing to report.
+ */
+- (void)attachMetricsToStepResult:(ORKStepResult *)stepResult;
+
+@end
+
+NS_ASSUME_NONNULL_END
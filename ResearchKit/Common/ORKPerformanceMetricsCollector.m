@@ -0,0 +1,176 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKPerformanceMetricsCollector.h"
+#import "ORKPerformanceMetrics.h"
+#import "ORKRecorder.h"
+#import "ORKResult.h"
+#import "ORKHelpers.h"
+#import <UIKit/UIKit.h>
+
+
+static const NSTimeInterval ORKPerformanceMetricsDefaultStallThreshold = 0.1;
+
+
+@implementation ORKPerformanceMetricsCollector {
+    NSMutableDictionary *_metrics;
+    
+    NSString *_monitoredStepIdentifier;
+    CADisplayLink *_displayLink;
+    CFTimeInterval _lastRefreshTime;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _metrics = [NSMutableDictionary dictionary];
+        _stallThreshold = ORKPerformanceMetricsDefaultStallThreshold;
+        
+        NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+        [center addObserver:self selector:@selector(applicationWillResignActive:) name:UIApplicationWillResignActiveNotification object:nil];
+        [center addObserver:self selector:@selector(applicationDidBecomeActive:) name:UIApplicationDidBecomeActiveNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [_displayLink invalidate];
+}
+
+- (NSMutableDictionary *)mutableMetricsForStepIdentifier:(NSString *)stepIdentifier {
+    NSMutableDictionary *metrics = _metrics[stepIdentifier];
+    if (! metrics) {
+        metrics = [NSMutableDictionary dictionary];
+        _metrics[stepIdentifier] = metrics;
+    }
+    return metrics;
+}
+
+- (void)addValue:(double)value forMetric:(NSString *)metricKey stepIdentifier:(NSString *)stepIdentifier {
+    NSMutableDictionary *metrics = [self mutableMetricsForStepIdentifier:stepIdentifier];
+    metrics[metricKey] = @([metrics[metricKey] doubleValue] + value);
+}
+
+- (void)addMaximumValue:(double)value forMetric:(NSString *)metricKey stepIdentifier:(NSString *)stepIdentifier {
+    NSMutableDictionary *metrics = [self mutableMetricsForStepIdentifier:stepIdentifier];
+    NSNumber *current = metrics[metricKey];
+    if (! current || current.doubleValue < value) {
+        metrics[metricKey] = @(value);
+    }
+}
+
+- (NSDictionary *)metricsForStepIdentifier:(NSString *)stepIdentifier {
+    return [_metrics[stepIdentifier] copy];
+}
+
+#pragma mark - main thread stalls
+
+- (void)beginMonitoringStepIdentifier:(NSString *)stepIdentifier {
+    _monitoredStepIdentifier = [stepIdentifier copy];
+    if (! _displayLink) {
+        _displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(displayLinkDidFire:)];
+        _displayLink.paused = ([UIApplication sharedApplication].applicationState != UIApplicationStateActive);
+        [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+    }
+}
+
+- (void)endMonitoring {
+    _monitoredStepIdentifier = nil;
+    _lastRefreshTime = 0;
+    [_displayLink invalidate];
+    _displayLink = nil;
+}
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink {
+    [self displayDidRefreshAtTime:displayLink.timestamp];
+}
+
+- (void)displayDidRefreshAtTime:(CFTimeInterval)timestamp {
+    if (! _monitoredStepIdentifier) {
+        return;
+    }
+    if (_lastRefreshTime > 0) {
+        NSTimeInterval gap = timestamp - _lastRefreshTime;
+        [self addMaximumValue:gap forMetric:ORKPerformanceMetricLongestMainThreadStallKey stepIdentifier:_monitoredStepIdentifier];
+        if (gap > _stallThreshold) {
+            [self addValue:1 forMetric:ORKPerformanceMetricMainThreadStallCountKey stepIdentifier:_monitoredStepIdentifier];
+        }
+    }
+    _lastRefreshTime = timestamp;
+}
+
+- (void)applicationWillResignActive:(NSNotification *)notification {
+    // Refreshes stop in the background; that gap is not a stall.
+    _displayLink.paused = YES;
+    _lastRefreshTime = 0;
+}
+
+- (void)applicationDidBecomeActive:(NSNotification *)notification {
+    _displayLink.paused = NO;
+}
+
+#pragma mark - results
+
+- (void)addMetricsFromRecorderResults:(NSArray *)results stepIdentifier:(NSString *)stepIdentifier {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (ORKResult *result in results) {
+        NSNumber *startLatency = result.userInfo[ORKRecorderStartLatencyKey];
+        if (startLatency) {
+            [self addMaximumValue:startLatency.doubleValue forMetric:ORKPerformanceMetricRecorderStartLatencyKey stepIdentifier:stepIdentifier];
+        }
+        
+        NSNumber *droppedSampleCount = result.userInfo[ORKRecorderDroppedSampleCountKey];
+        if (droppedSampleCount) {
+            [self addValue:droppedSampleCount.doubleValue forMetric:ORKPerformanceMetricDroppedSampleCountKey stepIdentifier:stepIdentifier];
+        }
+        
+        NSURL *fileURL = [result isKindOfClass:[ORKFileResult class]] ? [(ORKFileResult *)result fileURL] : nil;
+        if (fileURL.isFileURL) {
+            NSDictionary *attributes = [fileManager attributesOfItemAtPath:fileURL.path error:NULL];
+            if (attributes) {
+                [self addValue:attributes.fileSize forMetric:ORKPerformanceMetricBytesWrittenKey stepIdentifier:stepIdentifier];
+            }
+        }
+    }
+}
+
+- (void)attachMetricsToStepResult:(ORKStepResult *)stepResult {
+    NSDictionary *metrics = [self metricsForStepIdentifier:stepResult.identifier];
+    if (metrics.count == 0) {
+        return;
+    }
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:stepResult.userInfo ? : @{}];
+    userInfo[ORKResultPerformanceMetricsKey] = metrics;
+    stepResult.userInfo = userInfo;
+}
+
+@end
@@ -744,7 +744,7 @@ static NSString *const _ORKHaveChangedAnswerRestoreKey = @"haveChangedAnswer";
 - (void)decodeRestorableStateWithCoder:(NSCoder *)coder {
     [super decodeRestorableStateWithCoder:coder];
     
-    self.answer = [coder decodeObjectOfClasses:[NSSet setWithObjects:[NSNumber class],[NSString class],[NSDateComponents class],[NSArray class], nil] forKey:_ORKAnswerRestoreKey];
+    self.answer = [coder decodeObjectOfClasses:ORK_CLASS_SET([NSNumber class],[NSString class],[NSDateComponents class],[NSArray class]) forKey:_ORKAnswerRestoreKey];
     self.haveChangedAnswer = [coder decodeBoolForKey:_ORKHaveChangedAnswerRestoreKey];
     
     [self answerDidChange];
@@ -0,0 +1,65 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ A small, self-contained pseudorandom number generator (PCG32, XSH-RR variant).
+ 
+ Unlike `random()`, each instance owns its state, so generators never interfere with each
+ other or with other code in the process. Output depends only on the seed and sequence and
+ uses fixed-width integer arithmetic, so it is identical on every platform.
+ 
+ Not thread safe.
+ */
+@interface ORKRandomNumberGenerator : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSeed:(uint64_t)seed;
+
+// Generators with the same seed but different sequences produce independent streams.
+- (instancetype)initWithSeed:(uint64_t)seed sequence:(uint64_t)sequence NS_DESIGNATED_INITIALIZER;
+
+- (uint32_t)nextUInt32;
+
+// Returns a uniformly distributed value in [0, upperBound). `upperBound` must be greater than 0.
+- (uint32_t)nextUInt32WithUpperBound:(uint32_t)upperBound;
+
+// Fisher-Yates shuffle: every permutation of `values` is equally likely.
+- (void)shuffleIntegers:(NSInteger *)values count:(NSInteger)count;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,94 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKRandomNumberGenerator.h"
+
+
+static const uint64_t PCGMultiplier = 6364136223846793005ULL;
+
+@implementation ORKRandomNumberGenerator {
+    uint64_t _state;
+    uint64_t _increment;
+}
+
+- (instancetype)initWithSeed:(uint64_t)seed {
+    return [self initWithSeed:seed sequence:0];
+}
+
+- (instancetype)initWithSeed:(uint64_t)seed sequence:(uint64_t)sequence {
+    self = [super init];
+    if (self) {
+        // Seeding procedure of the PCG reference implementation; the increment must be odd.
+        _state = 0;
+        _increment = (sequence << 1) | 1;
+        [self nextUInt32];
+        _state += seed;
+        [self nextUInt32];
+    }
+    return self;
+}
+
+- (uint32_t)nextUInt32 {
+    uint64_t oldState = _state;
+    _state = oldState * PCGMultiplier + _increment;
+    uint32_t xorShifted = (uint32_t)(((oldState >> 18) ^ oldState) >> 27);
+    uint32_t rotation = (uint32_t)(oldState >> 59);
+    return (xorShifted >> rotation) | (xorShifted << ((-rotation) & 31));
+}
+
+- (uint32_t)nextUInt32WithUpperBound:(uint32_t)upperBound {
+    NSParameterAssert(upperBound > 0);
+    
+    // Multiply-shift with rejection (Lemire): maps a 32-bit draw onto [0, upperBound) without
+    // modulo bias. The division is only needed on the rare draws that land in the biased zone.
+    uint64_t product = (uint64_t)[self nextUInt32] * upperBound;
+    uint32_t low = (uint32_t)product;
+    if (low < upperBound) {
+        uint32_t threshold = (uint32_t)(-upperBound) % upperBound;
+        while (low < threshold) {
+            product = (uint64_t)[self nextUInt32] * upperBound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+- (void)shuffleIntegers:(NSInteger *)values count:(NSInteger)count {
+    NSParameterAssert(count <= UINT32_MAX);
+    for (NSInteger i = count - 1; i > 0; i--) {
+        NSInteger j = [self nextUInt32WithUpperBound:(uint32_t)(i + 1)];
+        NSInteger tmp = values[i];
+        values[i] = values[j];
+        values[j] = tmp;
+    }
+}
+
+@end
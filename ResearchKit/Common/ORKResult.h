@@ -138,6 +138,31 @@ ORK_CLASS_AVAILABLE
 @end
 
 
+/**
+ The `userInfo` key for the time base of a result.
+ 
+ The value is a dictionary that relates the device's monotonic clock to the wall clock. It holds one
+ anchor pair, captured once per task run, under `ORKTimeBaseUptimeKey` and
+ `ORKTimeBaseTimeIntervalSince1970Key`. Monotonic timestamps, such as those in recorder logs, convert to
+ dates by adding the difference between the two values. The monotonic clock stops while the device
+ sleeps, so converted dates fall behind after a sleep; the start and end dates of results are taken
+ from the wall clock directly.
+ */
+ORK_EXTERN NSString *const ORKResultTimeBaseKey ORK_AVAILABLE_DECL;
+
+/// The key in a time base dictionary for the anchor on the monotonic clock: the system uptime, in seconds.
+ORK_EXTERN NSString *const ORKTimeBaseUptimeKey ORK_AVAILABLE_DECL;
+
+/// The key in a time base dictionary for the anchor on the wall clock, in seconds since 1970.
+ORK_EXTERN NSString *const ORKTimeBaseTimeIntervalSince1970Key ORK_AVAILABLE_DECL;
+
+/**
+ The `userInfo` key for the system uptime, in seconds, that corresponds to a timestamp of zero in the
+ result's samples. Results whose sample timestamps are relative, such as tapping results, carry this key.
+ */
+ORK_EXTERN NSString *const ORKResultTimestampOriginUptimeKey ORK_AVAILABLE_DECL;
+
+
 /**
  Values that identify the button that was tapped in a tapping sample.
  */
@@ -196,6 +221,64 @@ ORK_CLASS_AVAILABLE
 @end
 
 
+/**
+ The `ORKTappingIntervalStatistics` class summarizes the performance of a tapping interval test.
+ 
+ The statistics are updated as each tap is recorded, and a final summary is included in an
+ `ORKTappingIntervalResult` object. Only taps inside one of the two buttons are counted;
+ taps that miss both buttons are ignored.
+ 
+ Values that need more taps than have been recorded (for example, the standard deviation
+ of fewer than two intervals) are zero.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKTappingIntervalStatistics : NSObject <NSCopying, NSSecureCoding>
+
+/**
+ The number of taps inside either button.
+ */
+@property (nonatomic, assign) NSInteger tapCount;
+
+/**
+ The mean interval, in seconds, between consecutive taps.
+ */
+@property (nonatomic, assign) NSTimeInterval meanInterTapInterval;
+
+/**
+ The sample standard deviation, in seconds, of the intervals between consecutive taps.
+ */
+@property (nonatomic, assign) NSTimeInterval interTapIntervalStandardDeviation;
+
+/**
+ The coefficient of variation of the intervals between consecutive taps: the standard deviation
+ divided by the mean.
+ */
+@property (nonatomic, assign) double interTapIntervalCoefficientOfVariation;
+
+/**
+ The fraction of consecutive taps that alternated between the two buttons, from `0.0` to `1.0`.
+ */
+@property (nonatomic, assign) double alternationAccuracy;
+
+/**
+ The least-squares slope of the inter-tap interval against time, in seconds of interval per second
+ of the test. A positive value indicates that tapping slowed down over the test.
+ */
+@property (nonatomic, assign) double interTapIntervalDrift;
+
+/**
+ The mean time, in seconds, that a finger stayed on a button.
+ */
+@property (nonatomic, assign) NSTimeInterval meanDwellTime;
+
+/**
+ The sample standard deviation, in seconds, of the time a finger stayed on a button.
+ */
+@property (nonatomic, assign) NSTimeInterval dwellTimeStandardDeviation;
+
+@end
+
+
 /**
  The `ORKTappingIntervalResult` class records the results of a tapping interval test.
  
@@ -213,6 +296,10 @@ ORK_CLASS_AVAILABLE
 /**
  An array of collected samples, in which each item is an `ORKTappingSample` object that represents a
  tapping event.
+ 
+ The samples are stored in a compact form and the sample objects are created when this property
+ is first read. Modifying a returned sample does not change the result; to change the samples,
+ set this property.
  */
 @property (nonatomic, copy, nullable) NSArray *samples;
 
@@ -231,6 +318,11 @@ ORK_CLASS_AVAILABLE
  */
 @property (nonatomic) CGRect buttonRect2;
 
+/**
+ Summary statistics computed from the taps as the test ran.
+ */
+@property (nonatomic, copy, nullable) ORKTappingIntervalStatistics *statistics;
+
 @end
 
 
@@ -402,6 +494,10 @@ ORK_CLASS_AVAILABLE
 /**
  An array of `ORKSpatialSpanMemoryGameTouchSample` objects that record the onscreen locations
 the user tapped during the game.
+ 
+ The samples are stored in a compact form and the sample objects are created when this property
+ is first read. Modifying a returned sample does not change the record; to change the samples,
+ set this property.
  */
 @property (nonatomic, copy, nullable) NSArray *touchSamples;
 
@@ -416,6 +512,34 @@ the user tapped during the game.
  */
 @property (nonatomic, assign) NSInteger score;
 
+/**
+ The number of targets the user tapped correctly, in order, from the start of the sequence.
+ */
+@property (nonatomic, assign) NSInteger correctSequenceLength;
+
+/**
+ The number of touches that did not hit the next target in the sequence, including touches
+ outside all of the targets.
+ */
+@property (nonatomic, assign) NSInteger numberOfErrors;
+
+/**
+ The mean time, in seconds, taken for each correctly tapped target: the timestamp of the
+ last correct touch divided by `correctSequenceLength`. The value is `0` if no target was
+ tapped correctly.
+ */
+@property (nonatomic, assign) NSTimeInterval meanTimePerTarget;
+
+/**
+ An array of `NSNumber` objects that record when each target highlighted during playback
+ appeared on screen, in the order presented.
+ 
+ Each time is measured at the display frame on which the highlight was shown, in seconds
+ relative to the first frame of gameplay, the same origin as the `timestamp` of the touch samples.
+ Because playback comes before gameplay, the values are negative.
+ */
+@property (nonatomic, copy, nullable) NSArray *stimulusOnsetTimestamps;
+
 @end
 
 
@@ -511,10 +635,10 @@ ORK_CLASS_AVAILABLE
 /**
  The 'ORKDeviceMotionReactionTimeResult' class represents the result of a single successful attempt within an ORKDeviceMotionReactionTimeStep.
  
- 'timestamp' is equal to the value of NSProcessInfo's systemUptime when the stimulus occurred.
+ 'timestamp' is equal to the value of NSProcessInfo's systemUptime when the stimulus occurred, as measured on the display refresh clock.
  'fileResult' references the motion data recorded from the beginning of the attempt until the thresholdAcceleration was reached. Each entry of motion data in this file contains a time interval which may be directly compared to the 'timestamp' in order to determine the elapsed time since the stimulus.
  
-Using the time taken to reach the thresholdAcceleration as the reactionTime of a participant will yield a rather crude measurement. Rather, you should devise your own method using the data recorded to obtain an accurate approximation of the true reaction time.
+Using the time taken to reach the thresholdAcceleration as the reactionTime of a participant will yield a rather crude measurement. 'reactionTime' refines it by interpolating the threshold crossing between motion samples, and 'reactionTimeUncertainty' bounds what remains of the error; for an accurate approximation of the true reaction time, you should still devise your own method using the data recorded.
  
  A reaction time result is typically generated by the framework as the task proceeds. When the task
  completes, it may be appropriate to serialize the sample for transmission to a server,
@@ -528,6 +652,16 @@ ORK_CLASS_AVAILABLE
 
 @property (nonatomic, strong) ORKFileResult *fileResult;
 
+/**
+ The time, in seconds, from the stimulus appearing to the device's acceleration exceeding the threshold.
+ */
+@property (nonatomic, assign) NSTimeInterval reactionTime;
+
+/**
+ The maximum error of `reactionTime`, in seconds, due to motion sample spacing and display refresh.
+ */
+@property (nonatomic, assign) NSTimeInterval reactionTimeUncertainty;
+
 @end
 
 /**
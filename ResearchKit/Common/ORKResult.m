@@ -47,6 +47,13 @@
 #import "ORKAnswerFormat_Internal.h"
 #import "ORKConsentDocument.h"
 #import "ORKConsentSignature.h"
+#import "ORKPackedSampleStore.h"
+
+
+NSString *const ORKResultTimeBaseKey = @"timeBase";
+NSString *const ORKTimeBaseUptimeKey = @"uptime";
+NSString *const ORKTimeBaseTimeIntervalSince1970Key = @"timeIntervalSince1970";
+NSString *const ORKResultTimestampOriginUptimeKey = @"timestampOriginUptime";
 
 
 @implementation ORKResult
@@ -174,6 +181,78 @@
 @end
 
 
+@implementation ORKTappingIntervalStatistics
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    ORK_ENCODE_INTEGER(aCoder, tapCount);
+    ORK_ENCODE_DOUBLE(aCoder, meanInterTapInterval);
+    ORK_ENCODE_DOUBLE(aCoder, interTapIntervalStandardDeviation);
+    ORK_ENCODE_DOUBLE(aCoder, interTapIntervalCoefficientOfVariation);
+    ORK_ENCODE_DOUBLE(aCoder, alternationAccuracy);
+    ORK_ENCODE_DOUBLE(aCoder, interTapIntervalDrift);
+    ORK_ENCODE_DOUBLE(aCoder, meanDwellTime);
+    ORK_ENCODE_DOUBLE(aCoder, dwellTimeStandardDeviation);
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    self = [super init];
+    if (self) {
+        ORK_DECODE_INTEGER(aDecoder, tapCount);
+        ORK_DECODE_DOUBLE(aDecoder, meanInterTapInterval);
+        ORK_DECODE_DOUBLE(aDecoder, interTapIntervalStandardDeviation);
+        ORK_DECODE_DOUBLE(aDecoder, interTapIntervalCoefficientOfVariation);
+        ORK_DECODE_DOUBLE(aDecoder, alternationAccuracy);
+        ORK_DECODE_DOUBLE(aDecoder, interTapIntervalDrift);
+        ORK_DECODE_DOUBLE(aDecoder, meanDwellTime);
+        ORK_DECODE_DOUBLE(aDecoder, dwellTimeStandardDeviation);
+    }
+    return self;
+}
+
+- (BOOL)isEqual:(id)object {
+    if ([self class] != [object class]) {
+        return NO;
+    }
+    
+    __typeof(self) castObject = object;
+    return ((self.tapCount == castObject.tapCount) &&
+            (self.meanInterTapInterval == castObject.meanInterTapInterval) &&
+            (self.interTapIntervalStandardDeviation == castObject.interTapIntervalStandardDeviation) &&
+            (self.interTapIntervalCoefficientOfVariation == castObject.interTapIntervalCoefficientOfVariation) &&
+            (self.alternationAccuracy == castObject.alternationAccuracy) &&
+            (self.interTapIntervalDrift == castObject.interTapIntervalDrift) &&
+            (self.meanDwellTime == castObject.meanDwellTime) &&
+            (self.dwellTimeStandardDeviation == castObject.dwellTimeStandardDeviation));
+}
+
+- (NSUInteger)hash {
+    return self.tapCount;
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    ORKTappingIntervalStatistics *statistics = [[[self class] allocWithZone:zone] init];
+    statistics.tapCount = self.tapCount;
+    statistics.meanInterTapInterval = self.meanInterTapInterval;
+    statistics.interTapIntervalStandardDeviation = self.interTapIntervalStandardDeviation;
+    statistics.interTapIntervalCoefficientOfVariation = self.interTapIntervalCoefficientOfVariation;
+    statistics.alternationAccuracy = self.alternationAccuracy;
+    statistics.interTapIntervalDrift = self.interTapIntervalDrift;
+    statistics.meanDwellTime = self.meanDwellTime;
+    statistics.dwellTimeStandardDeviation = self.dwellTimeStandardDeviation;
+    return statistics;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ taps=%@ iti=%.03f (sd %.03f, cv %.03f) alternation=%.03f drift=%.04f dwell=%.03f (sd %.03f)", [super description], @(self.tapCount), self.meanInterTapInterval, self.interTapIntervalStandardDeviation, self.interTapIntervalCoefficientOfVariation, self.alternationAccuracy, self.interTapIntervalDrift, self.meanDwellTime, self.dwellTimeStandardDeviation];
+}
+
+@end
+
+
 @implementation ORKToneAudiometryResult
 
 - (void)encodeWithCoder:(NSCoder *)aCoder {
@@ -328,7 +407,12 @@
 @end
 
 
-@implementation ORKSpatialSpanMemoryGameRecord
+@implementation ORKSpatialSpanMemoryGameRecord {
+    ORKSpatialSpanMemoryGameTouchSampleStore *_touchSampleStore;
+    
+    // Created on demand from `_touchSampleStore`.
+    NSArray *_touchSamples;
+}
 
 + (BOOL)supportsSecureCoding {
     return YES;
@@ -338,10 +422,14 @@
     ORK_ENCODE_UINT32(aCoder, seed);
     ORK_ENCODE_OBJ(aCoder, sequence);
     ORK_ENCODE_INTEGER(aCoder, gameSize);
-    ORK_ENCODE_OBJ(aCoder, touchSamples);
+    [aCoder encodeObject:[_touchSampleStore packedData] forKey:@"packedTouchSamples"];
     ORK_ENCODE_INTEGER(aCoder, gameStatus);
     ORK_ENCODE_INTEGER(aCoder, score);
     ORK_ENCODE_OBJ(aCoder, targetRects);
+    ORK_ENCODE_INTEGER(aCoder, correctSequenceLength);
+    ORK_ENCODE_INTEGER(aCoder, numberOfErrors);
+    ORK_ENCODE_DOUBLE(aCoder, meanTimePerTarget);
+    ORK_ENCODE_OBJ(aCoder, stimulusOnsetTimestamps);
 }
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
@@ -350,10 +438,23 @@
         ORK_DECODE_UINT32(aDecoder, seed);
         ORK_DECODE_OBJ_ARRAY(aDecoder, sequence, NSNumber);
         ORK_DECODE_INTEGER(aDecoder, gameSize);
-        ORK_DECODE_OBJ_ARRAY(aDecoder, touchSamples, ORKSpatialSpanMemoryGameTouchSample);
+        NSData *packedTouchSamples = [aDecoder decodeObjectOfClass:[NSData class] forKey:@"packedTouchSamples"];
+        if (packedTouchSamples) {
+            _touchSampleStore = [[ORKSpatialSpanMemoryGameTouchSampleStore alloc] initWithPackedData:packedTouchSamples];
+        } else {
+            // Archives written before touch samples were packed
+            NSArray *touchSamples = [aDecoder decodeObjectOfClasses:[NSSet setWithObjects:[NSArray class], [ORKSpatialSpanMemoryGameTouchSample class], nil] forKey:@"touchSamples"];
+            if (touchSamples) {
+                _touchSampleStore = [[ORKSpatialSpanMemoryGameTouchSampleStore alloc] initWithSamples:touchSamples];
+            }
+        }
         ORK_DECODE_INTEGER(aDecoder, gameStatus);
         ORK_DECODE_INTEGER(aDecoder, score);
         ORK_DECODE_OBJ_ARRAY(aDecoder, targetRects, NSValue);
+        ORK_DECODE_INTEGER(aDecoder, correctSequenceLength);
+        ORK_DECODE_INTEGER(aDecoder, numberOfErrors);
+        ORK_DECODE_DOUBLE(aDecoder, meanTimePerTarget);
+        ORK_DECODE_OBJ_ARRAY(aDecoder, stimulusOnsetTimestamps, NSNumber);
     }
     return self;
 }
@@ -366,11 +467,15 @@
     __typeof(self) castObject = object;
     return ((self.seed == castObject.seed) &&
             (ORKEqualObjects(self.sequence, castObject.sequence)) &&
-            (ORKEqualObjects(self.touchSamples, castObject.touchSamples)) &&
+            (ORKEqualObjects(_touchSampleStore, castObject->_touchSampleStore)) &&
             (self.gameSize == castObject.gameSize) &&
             (self.gameStatus == castObject.gameStatus) &&
             (self.score == castObject.score) &&
-            (ORKEqualObjects(self.targetRects, castObject.targetRects)));
+            (ORKEqualObjects(self.targetRects, castObject.targetRects)) &&
+            (self.correctSequenceLength == castObject.correctSequenceLength) &&
+            (self.numberOfErrors == castObject.numberOfErrors) &&
+            (self.meanTimePerTarget == castObject.meanTimePerTarget) &&
+            (ORKEqualObjects(self.stimulusOnsetTimestamps, castObject.stimulusOnsetTimestamps)));
 }
 
 - (NSUInteger)hash {
@@ -381,11 +486,15 @@
     ORKSpatialSpanMemoryGameRecord *record = [[[self class] allocWithZone:zone] init];
     record.seed = self.seed;
     record.sequence = [self.sequence copyWithZone:zone];
-    record.touchSamples = [self.touchSamples copyWithZone:zone];
+    record->_touchSampleStore = [_touchSampleStore copyWithZone:zone];
     record.gameSize = self.gameSize;
     record.gameStatus = self.gameStatus;
     record.score = self.score;
     record.targetRects = [self.targetRects copyWithZone:zone];
+    record.correctSequenceLength = self.correctSequenceLength;
+    record.numberOfErrors = self.numberOfErrors;
+    record.meanTimePerTarget = self.meanTimePerTarget;
+    record.stimulusOnsetTimestamps = [self.stimulusOnsetTimestamps copyWithZone:zone];
     return record;
 }
 
@@ -393,6 +502,27 @@
     return [NSString stringWithFormat:@"%@ %@ %@ %@ %@ %@", [super description], @(self.seed), self.sequence, @(self.gameSize), @(self.gameStatus), @(self.score)];
 }
 
+- (NSArray *)touchSamples {
+    if (! _touchSamples && _touchSampleStore) {
+        _touchSamples = [_touchSampleStore samples];
+    }
+    return _touchSamples;
+}
+
+- (void)setTouchSamples:(NSArray *)touchSamples {
+    _touchSampleStore = touchSamples ? [[ORKSpatialSpanMemoryGameTouchSampleStore alloc] initWithSamples:touchSamples] : nil;
+    _touchSamples = nil;
+}
+
+- (ORKSpatialSpanMemoryGameTouchSampleStore *)touchSampleStore {
+    return _touchSampleStore;
+}
+
+- (void)setTouchSampleStore:(ORKSpatialSpanMemoryGameTouchSampleStore *)touchSampleStore {
+    _touchSampleStore = [touchSampleStore copy];
+    _touchSamples = nil;
+}
+
 @end
 
 
@@ -454,23 +584,39 @@
 @end
 
 
-@implementation ORKTappingIntervalResult
+@implementation ORKTappingIntervalResult {
+    ORKTappingSampleStore *_sampleStore;
+    
+    // Created on demand from `_sampleStore`.
+    NSArray *_samples;
+}
 
 - (void)encodeWithCoder:(NSCoder *)aCoder {
     [super encodeWithCoder:aCoder];
-    ORK_ENCODE_OBJ(aCoder, samples);
+    [aCoder encodeObject:[_sampleStore packedData] forKey:@"packedSamples"];
     ORK_ENCODE_CGRECT(aCoder, buttonRect1);
     ORK_ENCODE_CGRECT(aCoder, buttonRect2);
     ORK_ENCODE_CGSIZE(aCoder, stepViewSize);
+    ORK_ENCODE_OBJ(aCoder, statistics);
 }
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
     self = [super initWithCoder:aDecoder];
     if (self) {
-        ORK_DECODE_OBJ_ARRAY(aDecoder, samples, ORKTappingSample);
+        NSData *packedSamples = [aDecoder decodeObjectOfClass:[NSData class] forKey:@"packedSamples"];
+        if (packedSamples) {
+            _sampleStore = [[ORKTappingSampleStore alloc] initWithPackedData:packedSamples];
+        } else {
+            // Archives written before samples were packed
+            NSArray *samples = [aDecoder decodeObjectOfClasses:[NSSet setWithObjects:[NSArray class], [ORKTappingSample class], nil] forKey:@"samples"];
+            if (samples) {
+                _sampleStore = [[ORKTappingSampleStore alloc] initWithSamples:samples];
+            }
+        }
         ORK_DECODE_CGRECT(aDecoder, buttonRect1);
         ORK_DECODE_CGRECT(aDecoder, buttonRect2);
         ORK_DECODE_CGSIZE(aDecoder, stepViewSize);
+        ORK_DECODE_OBJ_CLASS(aDecoder, statistics, ORKTappingIntervalStatistics);
     }
     return self;
 }
@@ -484,27 +630,50 @@
     
     __typeof(self) castObject = object;
     return (isParentSame &&
-            ORKEqualObjects(self.samples, castObject.samples) &&
+            ORKEqualObjects(_sampleStore, castObject->_sampleStore) &&
             CGRectEqualToRect(self.buttonRect1, castObject.buttonRect1) &&
             CGRectEqualToRect(self.buttonRect2, castObject.buttonRect2) &&
-            CGSizeEqualToSize(self.stepViewSize, castObject.stepViewSize));
+            CGSizeEqualToSize(self.stepViewSize, castObject.stepViewSize) &&
+            ORKEqualObjects(self.statistics, castObject.statistics));
 }
 
 - (NSUInteger)hash {
-    return [super hash] ^ [self.samples hash];
+    return [super hash] ^ [_sampleStore hash];
 }
 
 - (instancetype)copyWithZone:(NSZone *)zone {
     ORKTappingIntervalResult *result = [super copyWithZone:zone];
-    result.samples = [self.samples copy];
+    result->_sampleStore = [_sampleStore copy];
     result.buttonRect1 = self.buttonRect1;
     result.buttonRect2 = self.buttonRect2;
     result.stepViewSize = self.stepViewSize;
+    result.statistics = self.statistics;
     return result;
 }
 
 - (NSString *)description {
-    return [NSString stringWithFormat:@"%@ %@", [super description], self.samples];
+    return [NSString stringWithFormat:@"%@ %@", [super description], _sampleStore];
+}
+
+- (NSArray *)samples {
+    if (! _samples && _sampleStore) {
+        _samples = [_sampleStore samples];
+    }
+    return _samples;
+}
+
+- (void)setSamples:(NSArray *)samples {
+    _sampleStore = samples ? [[ORKTappingSampleStore alloc] initWithSamples:samples] : nil;
+    _samples = nil;
+}
+
+- (ORKTappingSampleStore *)sampleStore {
+    return _sampleStore;
+}
+
+- (void)setSampleStore:(ORKTappingSampleStore *)sampleStore {
+    _sampleStore = [sampleStore copy];
+    _samples = nil;
 }
 
 @end
@@ -568,6 +737,8 @@
     [super encodeWithCoder:aCoder];
     ORK_ENCODE_DOUBLE(aCoder, timestamp);
     ORK_ENCODE_OBJ(aCoder, fileResult);
+    ORK_ENCODE_DOUBLE(aCoder, reactionTime);
+    ORK_ENCODE_DOUBLE(aCoder, reactionTimeUncertainty);
 }
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
@@ -575,6 +746,8 @@
     if (self) {
         ORK_DECODE_DOUBLE(aDecoder, timestamp);
         ORK_DECODE_OBJ_CLASS(aDecoder, fileResult, ORKFileResult);
+        ORK_DECODE_DOUBLE(aDecoder, reactionTime);
+        ORK_DECODE_DOUBLE(aDecoder, reactionTimeUncertainty);
     }
     return self;
 }
@@ -589,6 +762,8 @@
     __typeof(self) castObject = object;
     return (isParentSame &&
             (self.timestamp == castObject.timestamp) &&
+            (self.reactionTime == castObject.reactionTime) &&
+            (self.reactionTimeUncertainty == castObject.reactionTimeUncertainty) &&
             ORKEqualObjects(self.fileResult, castObject.fileResult)) ;
 }
 
@@ -600,11 +775,13 @@
     ORKDeviceMotionReactionTimeResult *result = [super copyWithZone:zone];
     result.fileResult = [self.fileResult copy];
     result.timestamp = self.timestamp;
+    result.reactionTime = self.reactionTime;
+    result.reactionTimeUncertainty = self.reactionTimeUncertainty;
     return result;
 }
 
 - (NSString *)description {
-    return [NSString stringWithFormat:@"%@ %f %@", [super description], self.timestamp, self.fileResult.description];
+    return [NSString stringWithFormat:@"%@ %f %f (+/- %f) %@", [super description], self.timestamp, self.reactionTime, self.reactionTimeUncertainty, self.fileResult.description];
 }
 
 @end
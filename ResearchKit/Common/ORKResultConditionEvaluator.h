@@ -0,0 +1,310 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <ResearchKit/ORKDefines.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ An `ORKResultCondition` object is a condition on the question results of a set of task results,
+ equivalent to one of the predicates returned by `ORKResultPredicate`.
+ 
+ Unlike a predicate, a condition can be evaluated by an `ORKResultConditionEvaluator` object
+ together with many other conditions, over many sets of task results at once.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKResultCondition : NSObject <NSCopying>
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Returns a condition matching a numeric, scale, or Boolean question result whose answer is equal
+ to the specified integer value.
+ 
+ @param taskIdentifier      The identifier of the task whose result you want to match. Pass `nil`
+                                to match the task identifier given at evaluation.
+ @param resultIdentifier    The identifier of the question result you are interested in.
+ @param expectedAnswer      The expected value.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForNumericQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                   resultIdentifier:(NSString *)resultIdentifier
+                                                     expectedAnswer:(NSInteger)expectedAnswer;
+
+/**
+ Returns a condition matching a numeric, scale, or time interval question result whose answer is
+ within the specified range.
+ 
+ @param taskIdentifier              The identifier of the task whose result you want to match.
+                                        Pass `nil` to match the task identifier given at evaluation.
+ @param resultIdentifier            The identifier of the question result you are interested in.
+ @param minimumExpectedAnswerValue  The minimum expected value, inclusive. Pass `ORKIgnoreDoubleValue`
+                                        if you don't want to compare the answer against a minimum.
+ @param maximumExpectedAnswerValue  The maximum expected value, inclusive. Pass `ORKIgnoreDoubleValue`
+                                        if you don't want to compare the answer against a maximum.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForNumericQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                   resultIdentifier:(NSString *)resultIdentifier
+                                         minimumExpectedAnswerValue:(double)minimumExpectedAnswerValue
+                                         maximumExpectedAnswerValue:(double)maximumExpectedAnswerValue;
+
+/**
+ Returns a condition matching a Boolean question result whose answer is the specified value.
+ 
+ @param taskIdentifier      The identifier of the task whose result you want to match. Pass `nil`
+                                to match the task identifier given at evaluation.
+ @param resultIdentifier    The identifier of the question result you are interested in.
+ @param expectedAnswer      The expected Boolean value.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForBooleanQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                   resultIdentifier:(NSString *)resultIdentifier
+                                                     expectedAnswer:(BOOL)expectedAnswer;
+
+/**
+ Returns a condition matching a text question result whose answer is like the specified string,
+ as with the `LIKE` predicate operator.
+ 
+ @param taskIdentifier      The identifier of the task whose result you want to match. Pass `nil`
+                                to match the task identifier given at evaluation.
+ @param resultIdentifier    The identifier of the question result you are interested in.
+ @param expectedString      The expected string, which can contain `?` and `*` wildcards.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForTextQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                resultIdentifier:(NSString *)resultIdentifier
+                                                  expectedString:(NSString *)expectedString;
+
+/**
+ Returns a condition matching a text question result whose answer matches the specified regular
+ expression pattern.
+ 
+ @param taskIdentifier      The identifier of the task whose result you want to match. Pass `nil`
+                                to match the task identifier given at evaluation.
+ @param resultIdentifier    The identifier of the question result you are interested in.
+ @param pattern             An ICU-compliant regular expression pattern that matches the answer string.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForTextQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                resultIdentifier:(NSString *)resultIdentifier
+                                                 matchingPattern:(NSString *)pattern;
+
+/**
+ Returns a condition matching a choice question result that has an answer like each of the
+ specified strings.
+ 
+ @param taskIdentifier      The identifier of the task whose result you want to match. Pass `nil`
+                                to match the task identifier given at evaluation.
+ @param resultIdentifier    The identifier of the question result you are interested in.
+ @param expectedStrings     An array of expected strings. It must not be empty.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForChoiceQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                  resultIdentifier:(NSString *)resultIdentifier
+                                                   expectedStrings:(NSArray *)expectedStrings;
+
+/**
+ Returns a condition matching a choice question result that has an answer matching each of the
+ specified regular expression patterns.
+ 
+ @param taskIdentifier      The identifier of the task whose result you want to match. Pass `nil`
+                                to match the task identifier given at evaluation.
+ @param resultIdentifier    The identifier of the question result you are interested in.
+ @param patterns            An array of ICU-compliant regular expression patterns. It must not be empty.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForChoiceQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                  resultIdentifier:(NSString *)resultIdentifier
+                                                  matchingPatterns:(NSArray *)patterns;
+
+/**
+ Returns a condition matching a date question result whose answer is within the specified range.
+ 
+ @param taskIdentifier              The identifier of the task whose result you want to match.
+                                        Pass `nil` to match the task identifier given at evaluation.
+ @param resultIdentifier            The identifier of the question result you are interested in.
+ @param minimumExpectedAnswerDate   The minimum expected date, inclusive. Pass `nil` if you don't
+                                        want to compare the answer against a minimum.
+ @param maximumExpectedAnswerDate   The maximum expected date, inclusive. Pass `nil` if you don't
+                                        want to compare the answer against a maximum.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForDateQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                resultIdentifier:(NSString *)resultIdentifier
+                                       minimumExpectedAnswerDate:(nullable NSDate *)minimumExpectedAnswerDate
+                                       maximumExpectedAnswerDate:(nullable NSDate *)maximumExpectedAnswerDate;
+
+/**
+ Returns a condition matching a time of day question result whose answer is within the specified
+ hours and minutes, with the same semantics as the equivalent `ORKResultPredicate` predicate.
+ 
+ @param taskIdentifier                  The identifier of the task whose result you want to match.
+                                            Pass `nil` to match the task identifier given at evaluation.
+ @param resultIdentifier                The identifier of the question result you are interested in.
+ @param minimumExpectedAnswerHour       The minimum expected hour component value.
+ @param minimumExpectedAnswerMinute     The minimum expected minute component value.
+ @param maximumExpectedAnswerHour       The maximum expected hour component value.
+ @param maximumExpectedAnswerMinute     The maximum expected minute component value.
+ 
+ @return A result condition.
+ */
++ (instancetype)conditionForTimeOfDayQuestionResultWithTaskIdentifier:(nullable NSString *)taskIdentifier
+                                                     resultIdentifier:(NSString *)resultIdentifier
+                                            minimumExpectedAnswerHour:(NSInteger)minimumExpectedAnswerHour
+                                          minimumExpectedAnswerMinute:(NSInteger)minimumExpectedAnswerMinute
+                                            maximumExpectedAnswerHour:(NSInteger)maximumExpectedAnswerHour
+                                          maximumExpectedAnswerMinute:(NSInteger)maximumExpectedAnswerMinute;
+
+/// The identifier of the task whose result the condition matches, or `nil` for the task identifier given at evaluation.
+@property (nonatomic, copy, readonly, nullable) NSString *taskIdentifier;
+
+/// The identifier of the question result the condition matches.
+@property (nonatomic, copy, readonly) NSString *resultIdentifier;
+
+/**
+ The equivalent predicate, built with `ORKResultPredicate`.
+ 
+ Evaluate the predicate against an array of task results. If the task identifier of the condition
+ is `nil`, substitute the `ORKResultPredicateTaskIdentifierVariableName` variable.
+ */
+@property (nonatomic, readonly) NSPredicate *predicate;
+
+@end
+
+
+/**
+ An `ORKResultConditionMatrix` object holds, for each of a list of conditions, whether the
+ condition matched each of a list of task result groups.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKResultConditionMatrix : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The number of conditions that were evaluated.
+@property (nonatomic, readonly) NSUInteger numberOfConditions;
+
+/// The number of task result groups the conditions were evaluated over.
+@property (nonatomic, readonly) NSUInteger numberOfGroups;
+
+/**
+ Returns whether a condition matched a task result group.
+ 
+ @param conditionIndex  The index of the condition in the evaluated array.
+ @param groupIndex      The index of the task result group.
+ 
+ @return `YES` if the condition matched the group; otherwise, `NO`.
+ */
+- (BOOL)conditionAtIndex:(NSUInteger)conditionIndex matchesGroupAtIndex:(NSUInteger)groupIndex;
+
+/**
+ Returns the indexes of the task result groups matched by a condition.
+ 
+ @param conditionIndex  The index of the condition in the evaluated array.
+ 
+ @return The indexes of the matched groups.
+ */
+- (NSIndexSet *)groupIndexesMatchingConditionAtIndex:(NSUInteger)conditionIndex;
+
+/// Returns the indexes of the task result groups matched by every condition.
+- (NSIndexSet *)groupIndexesMatchingAllConditions;
+
+@end
+
+
+/**
+ The `ORKResultConditionEvaluator` class evaluates many result conditions over many groups of
+ task results, such as the task results of each participant in a study.
+ 
+ A group matches a condition exactly when the equivalent predicate, evaluated against the array of
+ task results of the group, would be true. Question results whose answer is of a type the
+ predicate cannot compare, where the predicate would raise an exception, do not match.
+ 
+ The task results are flattened into columns of identifiers and answers once, when the evaluator is
+ created. Each evaluation then tests identifier and string patterns once per distinct value rather
+ than once per result, and visits only the results whose identifier the condition can match.
+ 
+ An evaluator can be used from any thread.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKResultConditionEvaluator : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Returns an evaluator over the specified task result groups.
+ 
+ @param taskResultGroups    An array of groups, each an array of `ORKTaskResult` objects.
+ 
+ @return An initialized evaluator.
+ */
+- (instancetype)initWithTaskResultGroups:(NSArray *)taskResultGroups NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns an evaluator over the specified task results, each in its own group.
+ 
+ @param taskResults     An array of `ORKTaskResult` objects.
+ 
+ @return An initialized evaluator.
+ */
+- (instancetype)initWithTaskResults:(NSArray *)taskResults;
+
+/// The number of task result groups.
+@property (nonatomic, readonly) NSUInteger numberOfGroups;
+
+/// The number of question results flattened from the task result groups.
+@property (nonatomic, readonly) NSUInteger numberOfQuestionResults;
+
+/**
+ Evaluates conditions over every task result group.
+ 
+ @param conditions      An array of `ORKResultCondition` objects.
+ @param taskIdentifier  The task identifier matched by conditions that have no task identifier,
+                            or `nil` if no condition lacks one.
+ 
+ @return A matrix of the evaluated conditions and groups.
+ */
+- (ORKResultConditionMatrix *)evaluateConditions:(NSArray *)conditions taskIdentifier:(nullable NSString *)taskIdentifier;
+
+@end
+
+NS_ASSUME_NONNULL_END
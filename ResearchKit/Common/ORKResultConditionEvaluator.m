@@ -0,0 +1,640 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKResultConditionEvaluator.h"
+#import "ORKResult.h"
+#import "ORKResult_Private.h"
+#import "ORKResultPredicate.h"
+#import "ORKHelpers.h"
+
+
+typedef NS_ENUM(NSInteger, ORKResultConditionType) {
+    ORKResultConditionTypeNumericEquality = 0,
+    ORKResultConditionTypeNumericRange,
+    ORKResultConditionTypeBoolean,
+    ORKResultConditionTypeText,
+    ORKResultConditionTypeTextPattern,
+    ORKResultConditionTypeChoice,
+    ORKResultConditionTypeChoicePatterns,
+    ORKResultConditionTypeDateRange,
+    ORKResultConditionTypeTimeOfDay
+};
+
+// Answer kinds in the flattened columns. Conditions only compare answers of the kind they expect.
+typedef NS_ENUM(uint8_t, ORKAnswerKind) {
+    ORKAnswerKindNone = 0,
+    ORKAnswerKindNumber,
+    ORKAnswerKindDate,
+    ORKAnswerKindString,
+    ORKAnswerKindChoices,
+    ORKAnswerKindDateComponents
+};
+
+static const uint32_t ORKResultConditionNoString = UINT32_MAX;
+
+
+@interface ORKResultCondition ()
+
+@property (nonatomic, readonly) ORKResultConditionType type;
+@property (nonatomic, readonly) NSInteger expectedAnswer;
+// Also the hour bounds of time of day conditions. NAN if ignored.
+@property (nonatomic, readonly) double minimumValue;
+@property (nonatomic, readonly) double maximumValue;
+@property (nonatomic, readonly) NSInteger minimumMinute;
+@property (nonatomic, readonly) NSInteger maximumMinute;
+@property (nonatomic, copy, readonly) NSDate *minimumDate;
+@property (nonatomic, copy, readonly) NSDate *maximumDate;
+// Expected strings or patterns.
+@property (nonatomic, copy, readonly) NSArray *strings;
+
+@end
+
+
+@implementation ORKResultCondition
+
+- (instancetype)initWithType:(ORKResultConditionType)type taskIdentifier:(NSString *)taskIdentifier resultIdentifier:(NSString *)resultIdentifier {
+    ORKThrowInvalidArgumentExceptionIfNil(resultIdentifier);
+    self = [super init];
+    if (self) {
+        _type = type;
+        _taskIdentifier = [taskIdentifier copy];
+        _resultIdentifier = [resultIdentifier copy];
+        _minimumValue = ORKIgnoreDoubleValue;
+        _maximumValue = ORKIgnoreDoubleValue;
+    }
+    return self;
+}
+
++ (instancetype)conditionForNumericQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                   resultIdentifier:(NSString *)resultIdentifier
+                                                     expectedAnswer:(NSInteger)expectedAnswer {
+    ORKResultCondition *condition = [[self alloc] initWithType:ORKResultConditionTypeNumericEquality taskIdentifier:taskIdentifier resultIdentifier:resultIdentifier];
+    condition->_expectedAnswer = expectedAnswer;
+    return condition;
+}
+
++ (instancetype)conditionForNumericQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                   resultIdentifier:(NSString *)resultIdentifier
+                                         minimumExpectedAnswerValue:(double)minimumExpectedAnswerValue
+                                         maximumExpectedAnswerValue:(double)maximumExpectedAnswerValue {
+    ORKResultCondition *condition = [[self alloc] initWithType:ORKResultConditionTypeNumericRange taskIdentifier:taskIdentifier resultIdentifier:resultIdentifier];
+    condition->_minimumValue = minimumExpectedAnswerValue;
+    condition->_maximumValue = maximumExpectedAnswerValue;
+    return condition;
+}
+
++ (instancetype)conditionForBooleanQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                   resultIdentifier:(NSString *)resultIdentifier
+                                                     expectedAnswer:(BOOL)expectedAnswer {
+    ORKResultCondition *condition = [[self alloc] initWithType:ORKResultConditionTypeBoolean taskIdentifier:taskIdentifier resultIdentifier:resultIdentifier];
+    condition->_expectedAnswer = expectedAnswer ? 1 : 0;
+    return condition;
+}
+
++ (instancetype)conditionForTextQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                resultIdentifier:(NSString *)resultIdentifier
+                                                  expectedString:(NSString *)expectedString {
+    ORKThrowInvalidArgumentExceptionIfNil(expectedString);
+    ORKResultCondition *condition = [[self alloc] initWithType:ORKResultConditionTypeText taskIdentifier:taskIdentifier resultIdentifier:resultIdentifier];
+    condition->_strings = @[ [expectedString copy] ];
+    return condition;
+}
+
++ (instancetype)conditionForTextQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                resultIdentifier:(NSString *)resultIdentifier
+                                                 matchingPattern:(NSString *)pattern {
+    ORKThrowInvalidArgumentExceptionIfNil(pattern);
+    ORKResultCondition *condition = [[self alloc] initWithType:ORKResultConditionTypeTextPattern taskIdentifier:taskIdentifier resultIdentifier:resultIdentifier];
+    condition->_strings = @[ [pattern copy] ];
+    return condition;
+}
+
++ (instancetype)conditionForChoiceQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                  resultIdentifier:(NSString *)resultIdentifier
+                                                           strings:(NSArray *)strings
+                                                       usePatterns:(BOOL)usePatterns {
+    ORKThrowInvalidArgumentExceptionIfNil(strings);
+    if (strings.count == 0) {
+        @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"expectedAnswer can not be empty." userInfo:nil];
+    }
+    ORKResultCondition *condition = [[self alloc] initWithType:(usePatterns ? ORKResultConditionTypeChoicePatterns : ORKResultConditionTypeChoice)
+                                                taskIdentifier:taskIdentifier
+                                              resultIdentifier:resultIdentifier];
+    condition->_strings = [strings copy];
+    return condition;
+}
+
++ (instancetype)conditionForChoiceQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                  resultIdentifier:(NSString *)resultIdentifier
+                                                   expectedStrings:(NSArray *)expectedStrings {
+    return [self conditionForChoiceQuestionResultWithTaskIdentifier:taskIdentifier
+                                                   resultIdentifier:resultIdentifier
+                                                            strings:expectedStrings
+                                                        usePatterns:NO];
+}
+
++ (instancetype)conditionForChoiceQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                  resultIdentifier:(NSString *)resultIdentifier
+                                                  matchingPatterns:(NSArray *)patterns {
+    return [self conditionForChoiceQuestionResultWithTaskIdentifier:taskIdentifier
+                                                   resultIdentifier:resultIdentifier
+                                                            strings:patterns
+                                                        usePatterns:YES];
+}
+
++ (instancetype)conditionForDateQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                resultIdentifier:(NSString *)resultIdentifier
+                                       minimumExpectedAnswerDate:(NSDate *)minimumExpectedAnswerDate
+                                       maximumExpectedAnswerDate:(NSDate *)maximumExpectedAnswerDate {
+    ORKResultCondition *condition = [[self alloc] initWithType:ORKResultConditionTypeDateRange taskIdentifier:taskIdentifier resultIdentifier:resultIdentifier];
+    condition->_minimumDate = [minimumExpectedAnswerDate copy];
+    condition->_maximumDate = [maximumExpectedAnswerDate copy];
+    condition->_minimumValue = minimumExpectedAnswerDate ? minimumExpectedAnswerDate.timeIntervalSinceReferenceDate : ORKIgnoreDoubleValue;
+    condition->_maximumValue = maximumExpectedAnswerDate ? maximumExpectedAnswerDate.timeIntervalSinceReferenceDate : ORKIgnoreDoubleValue;
+    return condition;
+}
+
++ (instancetype)conditionForTimeOfDayQuestionResultWithTaskIdentifier:(NSString *)taskIdentifier
+                                                     resultIdentifier:(NSString *)resultIdentifier
+                                            minimumExpectedAnswerHour:(NSInteger)minimumExpectedAnswerHour
+                                          minimumExpectedAnswerMinute:(NSInteger)minimumExpectedAnswerMinute
+                                            maximumExpectedAnswerHour:(NSInteger)maximumExpectedAnswerHour
+                                          maximumExpectedAnswerMinute:(NSInteger)maximumExpectedAnswerMinute {
+    ORKResultCondition *condition = [[self alloc] initWithType:ORKResultConditionTypeTimeOfDay taskIdentifier:taskIdentifier resultIdentifier:resultIdentifier];
+    condition->_minimumValue = minimumExpectedAnswerHour;
+    condition->_maximumValue = maximumExpectedAnswerHour;
+    condition->_minimumMinute = minimumExpectedAnswerMinute;
+    condition->_maximumMinute = maximumExpectedAnswerMinute;
+    return condition;
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    // Conditions are immutable.
+    return self;
+}
+
+- (NSPredicate *)predicate {
+    switch (_type) {
+        case ORKResultConditionTypeNumericEquality:
+            return [ORKResultPredicate predicateForNumericQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                          resultIdentifier:_resultIdentifier
+                                                                            expectedAnswer:_expectedAnswer];
+        case ORKResultConditionTypeNumericRange:
+            return [ORKResultPredicate predicateForNumericQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                          resultIdentifier:_resultIdentifier
+                                                                minimumExpectedAnswerValue:_minimumValue
+                                                                maximumExpectedAnswerValue:_maximumValue];
+        case ORKResultConditionTypeBoolean:
+            return [ORKResultPredicate predicateForBooleanQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                          resultIdentifier:_resultIdentifier
+                                                                            expectedAnswer:(_expectedAnswer != 0)];
+        case ORKResultConditionTypeText:
+            return [ORKResultPredicate predicateForTextQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                       resultIdentifier:_resultIdentifier
+                                                                         expectedString:_strings[0]];
+        case ORKResultConditionTypeTextPattern:
+            return [ORKResultPredicate predicateForTextQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                       resultIdentifier:_resultIdentifier
+                                                                        matchingPattern:_strings[0]];
+        case ORKResultConditionTypeChoice:
+            return [ORKResultPredicate predicateForChoiceQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                         resultIdentifier:_resultIdentifier
+                                                                          expectedStrings:_strings];
+        case ORKResultConditionTypeChoicePatterns:
+            return [ORKResultPredicate predicateForChoiceQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                         resultIdentifier:_resultIdentifier
+                                                                         matchingPatterns:_strings];
+        case ORKResultConditionTypeDateRange:
+            return [ORKResultPredicate predicateForDateQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                       resultIdentifier:_resultIdentifier
+                                                              minimumExpectedAnswerDate:_minimumDate
+                                                              maximumExpectedAnswerDate:_maximumDate];
+        case ORKResultConditionTypeTimeOfDay:
+            return [ORKResultPredicate predicateForTimeOfDayQuestionResultWithTaskIdentifier:_taskIdentifier
+                                                                            resultIdentifier:_resultIdentifier
+                                                                   minimumExpectedAnswerHour:(NSInteger)_minimumValue
+                                                                 minimumExpectedAnswerMinute:_minimumMinute
+                                                                   maximumExpectedAnswerHour:(NSInteger)_maximumValue
+                                                                 maximumExpectedAnswerMinute:_maximumMinute];
+    }
+}
+
+@end
+
+
+@implementation ORKResultConditionMatrix {
+    // One byte per condition and group, condition major.
+    NSData *_matches;
+}
+
+- (instancetype)initWithMatches:(NSData *)matches numberOfConditions:(NSUInteger)numberOfConditions numberOfGroups:(NSUInteger)numberOfGroups {
+    self = [super init];
+    if (self) {
+        _matches = matches;
+        _numberOfConditions = numberOfConditions;
+        _numberOfGroups = numberOfGroups;
+    }
+    return self;
+}
+
+- (BOOL)conditionAtIndex:(NSUInteger)conditionIndex matchesGroupAtIndex:(NSUInteger)groupIndex {
+    if (conditionIndex >= _numberOfConditions || groupIndex >= _numberOfGroups) {
+        @throw [NSException exceptionWithName:NSRangeException reason:@"Index out of range" userInfo:nil];
+    }
+    return ((const uint8_t *)_matches.bytes)[conditionIndex * _numberOfGroups + groupIndex] != 0;
+}
+
+- (NSIndexSet *)groupIndexesMatchingConditionAtIndex:(NSUInteger)conditionIndex {
+    if (conditionIndex >= _numberOfConditions) {
+        @throw [NSException exceptionWithName:NSRangeException reason:@"Index out of range" userInfo:nil];
+    }
+    const uint8_t *row = (const uint8_t *)_matches.bytes + conditionIndex * _numberOfGroups;
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    for (NSUInteger group = 0; group < _numberOfGroups; group++) {
+        if (row[group]) {
+            [indexes addIndex:group];
+        }
+    }
+    return indexes;
+}
+
+- (NSIndexSet *)groupIndexesMatchingAllConditions {
+    const uint8_t *matches = _matches.bytes;
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    for (NSUInteger group = 0; group < _numberOfGroups; group++) {
+        BOOL all = YES;
+        for (NSUInteger condition = 0; condition < _numberOfConditions && all; condition++) {
+            all = (matches[condition * _numberOfGroups + group] != 0);
+        }
+        if (all) {
+            [indexes addIndex:group];
+        }
+    }
+    return indexes;
+}
+
+@end
+
+
+/*
+ A condition resolved against the columns of one evaluator. Masks have one byte per distinct
+ identifier or string, set when the pattern of the condition matches that value.
+ */
+typedef struct {
+    const uint8_t *taskMask;
+    const uint8_t *resultMask;
+    const uint8_t *const *stringMasks;
+    NSUInteger stringMaskCount;
+    ORKAnswerKind kind;
+    double minimumValue; // NAN to ignore.
+    double maximumValue; // NAN to ignore.
+    double minimumMinute;
+    double maximumMinute;
+} ORKCompiledResultCondition;
+
+static BOOL ORKCompiledResultConditionMatchesRow(const ORKCompiledResultCondition *condition,
+                                                 ORKAnswerKind kind,
+                                                 double value,
+                                                 double minute,
+                                                 uint32_t string,
+                                                 uint32_t choiceCount,
+                                                 const uint32_t *choiceStrings) {
+    if (kind != condition->kind) {
+        return NO;
+    }
+    switch (kind) {
+        case ORKAnswerKindNumber:
+        case ORKAnswerKindDate:
+            // NAN bounds are ignored, as in ORKResultPredicate.
+            return ((isnan(condition->minimumValue) || value >= condition->minimumValue) &&
+                    (isnan(condition->maximumValue) || value <= condition->maximumValue));
+        case ORKAnswerKindDateComponents:
+            return (value >= condition->minimumValue && minute >= condition->minimumMinute &&
+                    value <= condition->maximumValue && minute <= condition->maximumMinute);
+        case ORKAnswerKindString:
+            return condition->stringMasks[0][string] != 0;
+        case ORKAnswerKindChoices:
+            // Every expected string must be matched by at least one of the choices.
+            for (NSUInteger maskIndex = 0; maskIndex < condition->stringMaskCount; maskIndex++) {
+                const uint8_t *mask = condition->stringMasks[maskIndex];
+                BOOL found = NO;
+                for (uint32_t choice = 0; choice < choiceCount && !found; choice++) {
+                    found = (choiceStrings[choice] != ORKResultConditionNoString && mask[choiceStrings[choice]]);
+                }
+                if (!found) {
+                    return NO;
+                }
+            }
+            return YES;
+        case ORKAnswerKindNone:
+            return NO;
+    }
+    return NO;
+}
+
+
+@implementation ORKResultConditionEvaluator {
+    // Distinct task and result identifiers, and distinct answer strings.
+    NSArray *_identifiers;
+    NSArray *_strings;
+    
+    // One element per question result, in group order.
+    NSMutableData *_groupColumn;  // uint32_t
+    NSMutableData *_taskColumn;   // uint32_t, index in _identifiers
+    NSMutableData *_kindColumn;   // ORKAnswerKind
+    NSMutableData *_valueColumn;  // double: number, date since the reference date, or hour
+    NSMutableData *_minuteColumn; // double
+    NSMutableData *_stringColumn; // uint32_t: index in _strings, or first index in _choiceStrings
+    NSMutableData *_choiceCountColumn; // uint32_t
+    
+    NSMutableData *_choiceStrings; // uint32_t, index in _strings
+    
+    // Question results by result identifier: the results with identifier `i` are
+    // _rowsByIdentifier[_identifierOffsets[i] ..< _identifierOffsets[i + 1]], in group order.
+    NSMutableData *_identifierOffsets; // uint32_t
+    NSMutableData *_rowsByIdentifier;  // uint32_t
+}
+
+- (instancetype)initWithTaskResults:(NSArray *)taskResults {
+    NSMutableArray *groups = [NSMutableArray arrayWithCapacity:taskResults.count];
+    for (ORKTaskResult *taskResult in taskResults) {
+        [groups addObject:@[ taskResult ]];
+    }
+    return [self initWithTaskResultGroups:groups];
+}
+
+- (instancetype)initWithTaskResultGroups:(NSArray *)taskResultGroups {
+    ORKThrowInvalidArgumentExceptionIfNil(taskResultGroups);
+    self = [super init];
+    if (self) {
+        _numberOfGroups = taskResultGroups.count;
+        [self flattenTaskResultGroups:taskResultGroups];
+    }
+    return self;
+}
+
+static uint32_t ORKInternString(NSString *string, NSMutableDictionary *indexes, NSMutableArray *strings) {
+    NSNumber *index = indexes[string];
+    if (!index) {
+        index = @(strings.count);
+        indexes[string] = index;
+        [strings addObject:string];
+    }
+    return (uint32_t)index.unsignedIntValue;
+}
+
+- (void)flattenTaskResultGroups:(NSArray *)taskResultGroups {
+    NSMutableArray *identifiers = [NSMutableArray array];
+    NSMutableDictionary *identifierIndexes = [NSMutableDictionary dictionary];
+    NSMutableArray *strings = [NSMutableArray array];
+    NSMutableDictionary *stringIndexes = [NSMutableDictionary dictionary];
+    
+    _groupColumn = [NSMutableData data];
+    _taskColumn = [NSMutableData data];
+    _kindColumn = [NSMutableData data];
+    _valueColumn = [NSMutableData data];
+    _minuteColumn = [NSMutableData data];
+    _stringColumn = [NSMutableData data];
+    _choiceCountColumn = [NSMutableData data];
+    _choiceStrings = [NSMutableData data];
+    NSMutableData *resultColumn = [NSMutableData data];
+    
+    uint32_t group = 0;
+    for (NSArray *taskResults in taskResultGroups) {
+        for (ORKCollectionResult *taskResult in taskResults) {
+            // Mirrors the SUBQUERY nesting of ORKResultPredicate: task results, their step results, and their question results.
+            // Nil identifiers are skipped, since `nil LIKE pattern` is never true.
+            if (![taskResult isKindOfClass:[ORKCollectionResult class]] || !taskResult.identifier) {
+                continue;
+            }
+            uint32_t task = ORKInternString(taskResult.identifier, identifierIndexes, identifiers);
+            for (ORKCollectionResult *stepResult in taskResult.results) {
+                if (![stepResult isKindOfClass:[ORKCollectionResult class]]) {
+                    continue;
+                }
+                for (ORKQuestionResult *questionResult in stepResult.results) {
+                    if (![questionResult isKindOfClass:[ORKQuestionResult class]] || !questionResult.identifier) {
+                        continue;
+                    }
+                    uint32_t result = ORKInternString(questionResult.identifier, identifierIndexes, identifiers);
+                    
+                    ORKAnswerKind kind = ORKAnswerKindNone;
+                    double value = 0;
+                    double minute = 0;
+                    uint32_t string = ORKResultConditionNoString;
+                    uint32_t choiceCount = 0;
+                    
+                    id answer = questionResult.answer;
+                    if ([answer isKindOfClass:[NSNumber class]]) {
+                        kind = ORKAnswerKindNumber;
+                        value = [answer doubleValue];
+                    } else if ([answer isKindOfClass:[NSDate class]]) {
+                        kind = ORKAnswerKindDate;
+                        value = [answer timeIntervalSinceReferenceDate];
+                    } else if ([answer isKindOfClass:[NSString class]]) {
+                        kind = ORKAnswerKindString;
+                        string = ORKInternString(answer, stringIndexes, strings);
+                    } else if ([answer isKindOfClass:[NSArray class]]) {
+                        kind = ORKAnswerKindChoices;
+                        string = (uint32_t)(_choiceStrings.length / sizeof(uint32_t));
+                        for (id choice in (NSArray *)answer) {
+                            uint32_t choiceString = [choice isKindOfClass:[NSString class]] ? ORKInternString(choice, stringIndexes, strings) : ORKResultConditionNoString;
+                            [_choiceStrings appendBytes:&choiceString length:sizeof(choiceString)];
+                            choiceCount++;
+                        }
+                    } else if ([answer isKindOfClass:[NSDateComponents class]]) {
+                        kind = ORKAnswerKindDateComponents;
+                        value = [answer hour];
+                        minute = [answer minute];
+                    }
+                    
+                    [_groupColumn appendBytes:&group length:sizeof(group)];
+                    [_taskColumn appendBytes:&task length:sizeof(task)];
+                    [resultColumn appendBytes:&result length:sizeof(result)];
+                    [_kindColumn appendBytes:&kind length:sizeof(kind)];
+                    [_valueColumn appendBytes:&value length:sizeof(value)];
+                    [_minuteColumn appendBytes:&minute length:sizeof(minute)];
+                    [_stringColumn appendBytes:&string length:sizeof(string)];
+                    [_choiceCountColumn appendBytes:&choiceCount length:sizeof(choiceCount)];
+                }
+            }
+        }
+        group++;
+    }
+    
+    _identifiers = [identifiers copy];
+    _strings = [strings copy];
+    _numberOfQuestionResults = _kindColumn.length;
+    
+    // Counting sort of question results by result identifier; stable, so each run stays in group order.
+    NSUInteger identifierCount = _identifiers.count;
+    _identifierOffsets = [NSMutableData dataWithLength:(identifierCount + 1) * sizeof(uint32_t)];
+    _rowsByIdentifier = [NSMutableData dataWithLength:_numberOfQuestionResults * sizeof(uint32_t)];
+    uint32_t *offsets = _identifierOffsets.mutableBytes;
+    uint32_t *rows = _rowsByIdentifier.mutableBytes;
+    const uint32_t *results = resultColumn.bytes;
+    for (NSUInteger row = 0; row < _numberOfQuestionResults; row++) {
+        offsets[results[row] + 1]++;
+    }
+    for (NSUInteger identifier = 0; identifier < identifierCount; identifier++) {
+        offsets[identifier + 1] += offsets[identifier];
+    }
+    uint32_t *next = calloc(MAX(identifierCount, 1), sizeof(uint32_t));
+    memcpy(next, offsets, identifierCount * sizeof(uint32_t));
+    for (NSUInteger row = 0; row < _numberOfQuestionResults; row++) {
+        rows[next[results[row]]++] = (uint32_t)row;
+    }
+    free(next);
+}
+
+// Evaluates a LIKE or MATCHES pattern once per distinct value, as ORKResultPredicate would per result.
+static NSData *ORKPatternMask(NSArray *values, NSString *operatorName, NSString *pattern, NSMutableDictionary *cache) {
+    NSString *key = [NSString stringWithFormat:@"%@ %@", operatorName, pattern];
+    NSData *mask = cache[key];
+    if (!mask) {
+        NSPredicate *predicate = [NSPredicate predicateWithFormat:[NSString stringWithFormat:@"SELF %@ %%@", operatorName], pattern];
+        NSMutableData *bytes = [NSMutableData dataWithLength:values.count];
+        uint8_t *flags = bytes.mutableBytes;
+        NSUInteger index = 0;
+        for (NSString *value in values) {
+            flags[index++] = [predicate evaluateWithObject:value] ? 1 : 0;
+        }
+        mask = bytes;
+        cache[key] = mask;
+    }
+    return mask;
+}
+
+- (ORKResultConditionMatrix *)evaluateConditions:(NSArray *)conditions taskIdentifier:(NSString *)taskIdentifier {
+    ORKThrowInvalidArgumentExceptionIfNil(conditions);
+    NSUInteger conditionCount = conditions.count;
+    
+    // Resolve every condition against the distinct values first, so the scans below share nothing mutable.
+    // The compiled conditions point into these objects, which must outlive the scans.
+    NSMutableDictionary *identifierMasks NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableDictionary dictionary];
+    NSMutableDictionary *stringMasks NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableDictionary dictionary];
+    NSMutableArray *maskPointerArrays NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableArray array];
+    NSMutableData *compiledData NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:MAX(conditionCount, 1) * sizeof(ORKCompiledResultCondition)];
+    ORKCompiledResultCondition *compiled = compiledData.mutableBytes;
+    
+    NSUInteger conditionIndex = 0;
+    for (ORKResultCondition *condition in conditions) {
+        NSString *conditionTaskIdentifier = condition.taskIdentifier ? : taskIdentifier;
+        if (!conditionTaskIdentifier) {
+            @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"taskIdentifier can not be nil when a condition has no task identifier." userInfo:nil];
+        }
+        ORKCompiledResultCondition *compiledCondition = &compiled[conditionIndex++];
+        compiledCondition->taskMask = ORKPatternMask(_identifiers, @"LIKE", conditionTaskIdentifier, identifierMasks).bytes;
+        compiledCondition->resultMask = ORKPatternMask(_identifiers, @"LIKE", condition.resultIdentifier, identifierMasks).bytes;
+        compiledCondition->minimumValue = condition.minimumValue;
+        compiledCondition->maximumValue = condition.maximumValue;
+        
+        switch (condition.type) {
+            case ORKResultConditionTypeNumericEquality:
+            case ORKResultConditionTypeBoolean:
+                compiledCondition->kind = ORKAnswerKindNumber;
+                compiledCondition->minimumValue = condition.expectedAnswer;
+                compiledCondition->maximumValue = condition.expectedAnswer;
+                break;
+            case ORKResultConditionTypeNumericRange:
+                compiledCondition->kind = ORKAnswerKindNumber;
+                break;
+            case ORKResultConditionTypeDateRange:
+                compiledCondition->kind = ORKAnswerKindDate;
+                break;
+            case ORKResultConditionTypeTimeOfDay:
+                compiledCondition->kind = ORKAnswerKindDateComponents;
+                compiledCondition->minimumMinute = condition.minimumMinute;
+                compiledCondition->maximumMinute = condition.maximumMinute;
+                break;
+            case ORKResultConditionTypeText:
+            case ORKResultConditionTypeTextPattern:
+            case ORKResultConditionTypeChoice:
+            case ORKResultConditionTypeChoicePatterns: {
+                BOOL choice = (condition.type == ORKResultConditionTypeChoice || condition.type == ORKResultConditionTypeChoicePatterns);
+                BOOL patterns = (condition.type == ORKResultConditionTypeTextPattern || condition.type == ORKResultConditionTypeChoicePatterns);
+                compiledCondition->kind = choice ? ORKAnswerKindChoices : ORKAnswerKindString;
+                NSMutableData *maskPointers = [NSMutableData dataWithLength:condition.strings.count * sizeof(const uint8_t *)];
+                const uint8_t **pointers = maskPointers.mutableBytes;
+                NSUInteger maskIndex = 0;
+                for (NSString *string in condition.strings) {
+                    NSData *mask = ORKPatternMask(_strings, (patterns ? @"MATCHES" : @"LIKE"), string, stringMasks);
+                    pointers[maskIndex++] = mask.bytes;
+                }
+                [maskPointerArrays addObject:maskPointers];
+                compiledCondition->stringMasks = pointers;
+                compiledCondition->stringMaskCount = maskIndex;
+                break;
+            }
+        }
+    }
+    
+    NSMutableData *matches NS_VALID_UNTIL_END_OF_SCOPE = [NSMutableData dataWithLength:conditionCount * _numberOfGroups];
+    uint8_t *matchBytes = matches.mutableBytes;
+    NSUInteger numberOfGroups = _numberOfGroups;
+    NSUInteger identifierCount = _identifiers.count;
+    const uint32_t *offsets = _identifierOffsets.bytes;
+    const uint32_t *rows = _rowsByIdentifier.bytes;
+    const uint32_t *groups = _groupColumn.bytes;
+    const uint32_t *tasks = _taskColumn.bytes;
+    const uint8_t *kinds = _kindColumn.bytes;
+    const double *values = _valueColumn.bytes;
+    const double *minutes = _minuteColumn.bytes;
+    const uint32_t *stringColumn = _stringColumn.bytes;
+    const uint32_t *choiceCounts = _choiceCountColumn.bytes;
+    const uint32_t *choiceStrings = _choiceStrings.bytes;
+    
+    // Conditions write disjoint rows of the matrix, so they are scanned concurrently.
+    dispatch_apply(conditionCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        const ORKCompiledResultCondition *condition = &compiled[index];
+        uint8_t *conditionMatches = matchBytes + index * numberOfGroups;
+        for (NSUInteger identifier = 0; identifier < identifierCount; identifier++) {
+            if (!condition->resultMask[identifier]) {
+                continue;
+            }
+            for (uint32_t position = offsets[identifier]; position < offsets[identifier + 1]; position++) {
+                uint32_t row = rows[position];
+                uint32_t group = groups[row];
+                if (conditionMatches[group] || !condition->taskMask[tasks[row]]) {
+                    continue;
+                }
+                const uint32_t *rowChoices = (kinds[row] == ORKAnswerKindChoices) ? choiceStrings + stringColumn[row] : NULL;
+                if (ORKCompiledResultConditionMatchesRow(condition, kinds[row], values[row], minutes[row], stringColumn[row], choiceCounts[row], rowChoices)) {
+                    conditionMatches[group] = 1;
+                }
+            }
+        }
+    });
+    
+    return [[ORKResultConditionMatrix alloc] initWithMatches:matches numberOfConditions:conditionCount numberOfGroups:_numberOfGroups];
+}
+
+@end
@@ -0,0 +1,223 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <ResearchKit/ORKDefines.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ORKTaskResult;
+
+/**
+ An `ORKResultStoreQuery` object selects values from an `ORKResultStore` object.
+ 
+ Every property is optional; a `nil` property does not constrain the query.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKResultStoreQuery : NSObject <NSCopying>
+
+/// The identifier of the task whose results to select.
+@property (nonatomic, copy, nullable) NSString *taskIdentifier;
+
+/// The identifier of the step whose results to select.
+@property (nonatomic, copy, nullable) NSString *stepIdentifier;
+
+/// The identifier of the results to select.
+@property (nonatomic, copy, nullable) NSString *resultIdentifier;
+
+/**
+ The name of the value to select within each result.
+ 
+ For question results the value is named `answer`. For other results, each numeric property
+ is a value named after the property.
+ */
+@property (nonatomic, copy, nullable) NSString *key;
+
+/// The earliest date selected, inclusive.
+@property (nonatomic, copy, nullable) NSDate *startDate;
+
+/// The latest date selected, exclusive.
+@property (nonatomic, copy, nullable) NSDate *endDate;
+
+/// The smallest numeric value selected, inclusive. When set, values that are not numeric are not selected.
+@property (nonatomic, copy, nullable) NSNumber *minimumValue;
+
+/// The largest numeric value selected, inclusive. When set, values that are not numeric are not selected.
+@property (nonatomic, copy, nullable) NSNumber *maximumValue;
+
+@end
+
+
+/**
+ An `ORKResultStoreRecord` object is one value recorded in a result that was added to an
+ `ORKResultStore` object.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKResultStoreRecord : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The identifier of the task that produced the value.
+@property (nonatomic, copy, readonly) NSString *taskIdentifier;
+
+/// The task run UUID of the task result that contains the value.
+@property (nonatomic, copy, readonly) NSUUID *taskRunUUID;
+
+/// The identifier of the step result that contains the value, or `nil` if the result was not part of a step result.
+@property (nonatomic, copy, readonly, nullable) NSString *stepIdentifier;
+
+/// The identifier of the result that contains the value.
+@property (nonatomic, copy, readonly) NSString *resultIdentifier;
+
+/// The name of the value within its result.
+@property (nonatomic, copy, readonly) NSString *key;
+
+/// The end date of the result, or its start date if it has no end date.
+@property (nonatomic, copy, readonly) NSDate *date;
+
+/// The numeric value, or `nil` if the value is not numeric.
+@property (nonatomic, copy, readonly, nullable) NSNumber *numericValue;
+
+/// The string value, or `nil` if the value is not a string.
+@property (nonatomic, copy, readonly, nullable) NSString *stringValue;
+
+@end
+
+
+/**
+ An `ORKResultStoreStatistics` object summarizes the numeric values selected by a query over one interval.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKResultStoreStatistics : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The start of the interval.
+@property (nonatomic, copy, readonly) NSDate *startDate;
+
+/// The end of the interval.
+@property (nonatomic, copy, readonly) NSDate *endDate;
+
+/// The number of numeric values in the interval.
+@property (nonatomic, readonly) NSUInteger count;
+
+/// The smallest value in the interval.
+@property (nonatomic, readonly) double minimum;
+
+/// The largest value in the interval.
+@property (nonatomic, readonly) double maximum;
+
+/// The mean of the values in the interval.
+@property (nonatomic, readonly) double mean;
+
+@end
+
+
+/**
+ The `ORKResultStore` class persists task results on the device, and indexes the values they
+ contain so that they can be queried without unarchiving whole task results.
+ 
+ Each task result added to the store is archived in its own file, and each of its leaf results
+ is flattened into values: the answer of a question result, or each numeric property of any other
+ result. Values are indexed by task, step and result identifier, date and value. New result classes
+ need no configuration; their numeric properties are found at run time.
+ 
+ The index is appended to as task results are added, and loaded on first use. A store can be used
+ from any thread.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKResultStore : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Returns a result store that keeps its files in the specified directory.
+ 
+ The directory is created when the first task result is added.
+ 
+ @param url     The URL of the directory of the store.
+ 
+ @return An initialized result store.
+ */
+- (instancetype)initWithDirectory:(NSURL *)url NS_DESIGNATED_INITIALIZER;
+
+/// The directory of the store.
+@property (nonatomic, copy, readonly) NSURL *directory;
+
+/// The file protection mode of files created by the store. The default value is `ORKFileProtectionCompleteUntilFirstUserAuthentication`.
+@property (assign) ORKFileProtectionMode fileProtectionMode;
+
+/// The number of task results in the store.
+@property (nonatomic, readonly) NSUInteger taskResultCount;
+
+/**
+ Adds a task result to the store.
+ 
+ @param taskResult  The task result to add. A task result with the same task run UUID must not already be in the store.
+ @param error       On failure, the error that occurred.
+ 
+ @return `YES` if the task result was added; otherwise, `NO`.
+ */
+- (BOOL)addTaskResult:(ORKTaskResult *)taskResult error:(NSError * __autoreleasing *)error;
+
+/**
+ Returns the task result with the specified task run UUID, unarchived from the store.
+ 
+ @param taskRunUUID The task run UUID of the task result.
+ @param error       On failure, the error that occurred.
+ 
+ @return The task result, or `nil` if it is not in the store or could not be read.
+ */
+- (nullable ORKTaskResult *)taskResultWithTaskRunUUID:(NSUUID *)taskRunUUID error:(NSError * __autoreleasing *)error;
+
+/**
+ Returns the values selected by a query, in date order.
+ 
+ @param query   The query.
+ 
+ @return An array of `ORKResultStoreRecord` objects.
+ */
+- (NSArray *)recordsMatchingQuery:(ORKResultStoreQuery *)query;
+
+/**
+ Returns statistics over the numeric values selected by a query, for each day that has values.
+ 
+ @param query       The query.
+ @param calendar    The calendar that defines days. If `nil`, the current calendar is used.
+ 
+ @return An array of `ORKResultStoreStatistics` objects, in date order.
+ */
+- (NSArray *)dailyStatisticsForQuery:(ORKResultStoreQuery *)query calendar:(nullable NSCalendar *)calendar;
+
+@end
+
+NS_ASSUME_NONNULL_END
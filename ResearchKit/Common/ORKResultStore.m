@@ -0,0 +1,684 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKResultStore.h"
+#import "ORKResult.h"
+#import "ORKResult_Private.h"
+#import "ORKHelpers.h"
+#import "ORKErrors.h"
+#import <objc/runtime.h>
+
+
+/*
+ Files in the store directory:
+ 
+ - `Sessions/<task run UUID>.archive`: each task result, archived with NSKeyedArchiver.
+ - `strings`: every identifier and string value, each as a 32-bit length and UTF-8 bytes.
+ - `index`: one fixed-size ORKResultStoreEntry per value, referring to strings by position.
+ 
+ Both `strings` and `index` are only appended to. Strings are written before the entries that
+ use them, so a partially written tail is detected on load and ignored, and the next append
+ overwrites it: appends are made at the length validated on load, not at the end of the file.
+ */
+
+static const uint32_t ORKResultStoreNoString = UINT32_MAX;
+
+// Key of the entry that marks each task result, so that results without values are counted.
+static const uint32_t ORKResultStoreSessionKey = UINT32_MAX - 1;
+
+typedef struct {
+    NSTimeInterval date; // Since the reference date.
+    double value; // NAN if not numeric.
+    uint32_t session;
+    uint32_t task;
+    uint32_t step;
+    uint32_t result;
+    uint32_t key;
+    uint32_t string;
+} ORKResultStoreEntry;
+
+static int ORKResultStoreEntryCompareDates(const void *a, const void *b) {
+    NSTimeInterval dateA = ((const ORKResultStoreEntry *)a)->date;
+    NSTimeInterval dateB = ((const ORKResultStoreEntry *)b)->date;
+    return (dateA < dateB) ? -1 : (dateA > dateB) ? 1 : 0;
+}
+
+// Index of the first entry dated at or after `date` in entries sorted by date.
+static NSUInteger ORKResultStoreLowerBound(const ORKResultStoreEntry *entries, NSUInteger count, NSTimeInterval date) {
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger mid = low + (high - low) / 2;
+        if (entries[mid].date < date) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+
+@implementation ORKResultStoreQuery
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    ORKResultStoreQuery *query = [[[self class] allocWithZone:zone] init];
+    query->_taskIdentifier = [_taskIdentifier copy];
+    query->_stepIdentifier = [_stepIdentifier copy];
+    query->_resultIdentifier = [_resultIdentifier copy];
+    query->_key = [_key copy];
+    query->_startDate = [_startDate copy];
+    query->_endDate = [_endDate copy];
+    query->_minimumValue = [_minimumValue copy];
+    query->_maximumValue = [_maximumValue copy];
+    return query;
+}
+
+@end
+
+
+@implementation ORKResultStoreRecord
+
+- (instancetype)initWithTaskIdentifier:(NSString *)taskIdentifier
+                           taskRunUUID:(NSUUID *)taskRunUUID
+                        stepIdentifier:(NSString *)stepIdentifier
+                      resultIdentifier:(NSString *)resultIdentifier
+                                   key:(NSString *)key
+                                  date:(NSDate *)date
+                          numericValue:(NSNumber *)numericValue
+                           stringValue:(NSString *)stringValue {
+    self = [super init];
+    if (self) {
+        _taskIdentifier = [taskIdentifier copy];
+        _taskRunUUID = [taskRunUUID copy];
+        _stepIdentifier = [stepIdentifier copy];
+        _resultIdentifier = [resultIdentifier copy];
+        _key = [key copy];
+        _date = [date copy];
+        _numericValue = [numericValue copy];
+        _stringValue = [stringValue copy];
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; %@/%@/%@.%@ %@ %@>", self.class.description, self, _taskIdentifier, _stepIdentifier, _resultIdentifier, _key, _date, _numericValue ? : _stringValue];
+}
+
+@end
+
+
+@implementation ORKResultStoreStatistics
+
+- (instancetype)initWithStartDate:(NSDate *)startDate endDate:(NSDate *)endDate count:(NSUInteger)count minimum:(double)minimum maximum:(double)maximum mean:(double)mean {
+    self = [super init];
+    if (self) {
+        _startDate = [startDate copy];
+        _endDate = [endDate copy];
+        _count = count;
+        _minimum = minimum;
+        _maximum = maximum;
+        _mean = mean;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; %@ n=%lu min=%g max=%g mean=%g>", self.class.description, self, _startDate, (unsigned long)_count, _minimum, _maximum, _mean];
+}
+
+@end
+
+
+@implementation ORKResultStore {
+    dispatch_queue_t _queue;
+    BOOL _loaded;
+    
+    NSMutableArray *_strings;
+    NSMutableDictionary *_stringIndexes;
+    
+    // Lengths of the complete records in the files, where the next append goes.
+    unsigned long long _stringsLength;
+    unsigned long long _indexLength;
+    
+    // Task string index to NSMutableData of ORKResultStoreEntry.
+    NSMutableDictionary *_entriesByTask;
+    NSMutableSet *_unsortedTasks;
+    NSMutableSet *_sessions;
+    
+    // Result class to the key paths of its indexed values.
+    NSMutableDictionary *_keyPathsByClass;
+}
+
+- (instancetype)initWithDirectory:(NSURL *)url {
+    self = [super init];
+    if (self) {
+        _directory = [url copy];
+        _fileProtectionMode = ORKFileProtectionCompleteUntilFirstUserAuthentication;
+        NSString *queueId = [@"ResearchKit.ResultStore." stringByAppendingString:[[NSUUID UUID] UUIDString]];
+        _queue = dispatch_queue_create([queueId cStringUsingEncoding:NSUTF8StringEncoding], DISPATCH_QUEUE_SERIAL);
+        _keyPathsByClass = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+#pragma mark Files
+
+- (NSURL *)sessionsDirectory {
+    return [_directory URLByAppendingPathComponent:@"Sessions" isDirectory:YES];
+}
+
+- (NSURL *)archiveURLForTaskRunUUID:(NSUUID *)taskRunUUID {
+    return [[self sessionsDirectory] URLByAppendingPathComponent:[[taskRunUUID UUIDString] stringByAppendingPathExtension:@"archive"]];
+}
+
+- (NSURL *)stringsURL {
+    return [_directory URLByAppendingPathComponent:@"strings"];
+}
+
+- (NSURL *)indexURL {
+    return [_directory URLByAppendingPathComponent:@"index"];
+}
+
+- (NSDictionary *)fileAttributes {
+    return @{NSFileProtectionKey : ORKFileProtectionFromMode(self.fileProtectionMode)};
+}
+
+// Writes `data` at `offset`, discarding anything after it. On failure, the file is cut back to `offset`.
+- (BOOL)appendData:(NSData *)data toURL:(NSURL *)url atOffset:(unsigned long long)offset error:(NSError * __autoreleasing *)error {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (! [fileManager fileExistsAtPath:[url path]]) {
+        if (! [fileManager createFileAtPath:[url path] contents:nil attributes:[self fileAttributes]]) {
+            if (error) {
+                *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey : [url path]}];
+            }
+            return NO;
+        }
+    }
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:url error:error];
+    if (! fileHandle) {
+        return NO;
+    }
+    BOOL success = YES;
+    @try {
+        [fileHandle truncateFileAtOffset:offset];
+        [fileHandle writeData:data];
+    } @catch (NSException *exception) {
+        success = NO;
+        if (error) {
+            *error = [NSError errorWithDomain:ORKErrorDomain code:ORKErrorException userInfo:@{NSLocalizedFailureReasonErrorKey : exception.reason ? : @""}];
+        }
+        @try {
+            [fileHandle truncateFileAtOffset:offset];
+        } @catch (NSException *truncateException) {
+            // Left for the next load to detect.
+        }
+    }
+    [fileHandle closeFile];
+    return success;
+}
+
+#pragma mark Index
+
+- (void)loadIfNeeded {
+    if (_loaded) {
+        return;
+    }
+    _loaded = YES;
+    _strings = [NSMutableArray array];
+    _stringIndexes = [NSMutableDictionary dictionary];
+    _entriesByTask = [NSMutableDictionary dictionary];
+    _unsortedTasks = [NSMutableSet set];
+    _sessions = [NSMutableSet set];
+    
+    NSData *strings = [NSData dataWithContentsOfURL:[self stringsURL] options:NSDataReadingMappedIfSafe error:NULL];
+    const uint8_t *bytes = strings.bytes;
+    NSUInteger offset = 0;
+    while (offset + sizeof(uint32_t) <= strings.length) {
+        uint32_t length;
+        memcpy(&length, bytes + offset, sizeof(length));
+        if (offset + sizeof(uint32_t) + length > strings.length) {
+            break;
+        }
+        NSString *string = [[NSString alloc] initWithBytes:bytes + offset + sizeof(uint32_t) length:length encoding:NSUTF8StringEncoding] ? : @"";
+        _stringIndexes[string] = @(_strings.count);
+        [_strings addObject:string];
+        offset += sizeof(uint32_t) + length;
+    }
+    _stringsLength = offset;
+    
+    NSData *index = [NSData dataWithContentsOfURL:[self indexURL] options:NSDataReadingMappedIfSafe error:NULL];
+    NSUInteger entryCount = index.length / sizeof(ORKResultStoreEntry);
+    _indexLength = entryCount * sizeof(ORKResultStoreEntry);
+    const ORKResultStoreEntry *entries = index.bytes;
+    uint32_t stringCount = (uint32_t)_strings.count;
+    for (NSUInteger i = 0; i < entryCount; i++) {
+        const ORKResultStoreEntry *entry = &entries[i];
+        if (entry->session >= stringCount || entry->task >= stringCount || entry->result >= stringCount ||
+            (entry->step != ORKResultStoreNoString && entry->step >= stringCount) ||
+            (entry->key != ORKResultStoreSessionKey && entry->key >= stringCount) ||
+            (entry->string != ORKResultStoreNoString && entry->string >= stringCount)) {
+            continue;
+        }
+        [self addEntry:entry];
+    }
+}
+
+- (void)addEntry:(const ORKResultStoreEntry *)entry {
+    if (entry->key == ORKResultStoreSessionKey) {
+        [_sessions addObject:@(entry->session)];
+    }
+    NSNumber *task = @(entry->task);
+    NSMutableData *entries = _entriesByTask[task];
+    if (! entries) {
+        entries = [NSMutableData data];
+        _entriesByTask[task] = entries;
+    }
+    NSUInteger count = entries.length / sizeof(ORKResultStoreEntry);
+    if (count > 0 && ((const ORKResultStoreEntry *)entries.bytes)[count - 1].date > entry->date) {
+        [_unsortedTasks addObject:task];
+    }
+    [entries appendBytes:entry length:sizeof(ORKResultStoreEntry)];
+}
+
+- (uint32_t)indexOfString:(NSString *)string newStrings:(NSMutableData *)newStrings {
+    if (! string) {
+        return ORKResultStoreNoString;
+    }
+    NSNumber *index = _stringIndexes[string];
+    if (! index) {
+        index = @(_strings.count);
+        _stringIndexes[string] = index;
+        [_strings addObject:string];
+        NSData *utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+        uint32_t length = (uint32_t)utf8.length;
+        [newStrings appendBytes:&length length:sizeof(length)];
+        [newStrings appendData:utf8];
+    }
+    return (uint32_t)index.unsignedIntegerValue;
+}
+
+- (uint32_t)existingIndexOfString:(NSString *)string {
+    NSNumber *index = string ? _stringIndexes[string] : nil;
+    return index ? (uint32_t)index.unsignedIntegerValue : ORKResultStoreNoString;
+}
+
+#pragma mark Flattening
+
+static BOOL ORKResultStoreIsNumericType(const char *type) {
+    return (type[0] != '\0' && type[1] == '\0' && strchr("cCsSiIlLqQfdB", type[0]) != NULL);
+}
+
+// Key paths of the numeric values of `aClass`, descending once into ResearchKit model objects.
+- (NSArray *)keyPathsForClass:(Class)aClass depth:(NSInteger)depth {
+    NSMutableArray *keyPaths = [NSMutableArray array];
+    Class rootClass = [aClass isSubclassOfClass:[ORKResult class]] ? [ORKResult class] : [NSObject class];
+    NSMutableSet *names = [NSMutableSet set];
+    for (Class cls = aClass; cls && cls != rootClass; cls = class_getSuperclass(cls)) {
+        unsigned int count = 0;
+        objc_property_t *properties = class_copyPropertyList(cls, &count);
+        for (unsigned int i = 0; i < count; i++) {
+            NSString *name = @(property_getName(properties[i]));
+            char *type = property_copyAttributeValue(properties[i], "T");
+            if (! type || [names containsObject:name]) {
+                free(type);
+                continue;
+            }
+            [names addObject:name];
+            if (ORKResultStoreIsNumericType(type)) {
+                [keyPaths addObject:name];
+            } else if (type[0] == '@' && strlen(type) > 3) {
+                NSString *className = [[NSString alloc] initWithBytes:type + 2 length:strlen(type) - 3 encoding:NSUTF8StringEncoding];
+                Class propertyClass = NSClassFromString(className);
+                if (propertyClass == [NSNumber class]) {
+                    [keyPaths addObject:name];
+                } else if (depth > 0 && [className hasPrefix:@"ORK"] && ! [propertyClass isSubclassOfClass:[ORKResult class]]) {
+                    for (NSString *keyPath in [self keyPathsForClass:propertyClass depth:depth - 1]) {
+                        [keyPaths addObject:[NSString stringWithFormat:@"%@.%@", name, keyPath]];
+                    }
+                }
+            }
+            free(type);
+        }
+        free(properties);
+    }
+    [keyPaths sortUsingSelector:@selector(compare:)];
+    return keyPaths;
+}
+
+- (NSArray *)keyPathsForResultClass:(Class)aClass {
+    NSString *className = NSStringFromClass(aClass);
+    NSArray *keyPaths = _keyPathsByClass[className];
+    if (! keyPaths) {
+        keyPaths = [self keyPathsForClass:aClass depth:1];
+        _keyPathsByClass[className] = keyPaths;
+    }
+    return keyPaths;
+}
+
+- (void)appendEntriesForResult:(ORKResult *)result
+                stepIdentifier:(NSString *)stepIdentifier
+                      base:(ORKResultStoreEntry)base
+                   defaultDate:(NSDate *)defaultDate
+                       entries:(NSMutableData *)entries
+                    newStrings:(NSMutableData *)newStrings {
+    if ([result isKindOfClass:[ORKCollectionResult class]]) {
+        NSString *childStepIdentifier = [result isKindOfClass:[ORKStepResult class]] ? result.identifier : stepIdentifier;
+        for (ORKResult *child in [(ORKCollectionResult *)result results]) {
+            [self appendEntriesForResult:child stepIdentifier:childStepIdentifier base:base defaultDate:defaultDate entries:entries newStrings:newStrings];
+        }
+        return;
+    }
+    if (! result.identifier) {
+        return;
+    }
+    
+    ORKResultStoreEntry entry = base;
+    entry.date = (result.endDate ? : result.startDate ? : defaultDate).timeIntervalSinceReferenceDate;
+    entry.step = [self indexOfString:stepIdentifier newStrings:newStrings];
+    entry.result = [self indexOfString:result.identifier newStrings:newStrings];
+    
+    if ([result isKindOfClass:[ORKQuestionResult class]]) {
+        id answer = [(ORKQuestionResult *)result answer];
+        if ([answer isKindOfClass:[NSArray class]] && [answer count] == 1) {
+            answer = [answer firstObject];
+        }
+        if ([answer isKindOfClass:[NSNumber class]]) {
+            entry.value = [answer doubleValue];
+        } else if ([answer isKindOfClass:[NSString class]]) {
+            entry.string = [self indexOfString:answer newStrings:newStrings];
+        } else {
+            return;
+        }
+        entry.key = [self indexOfString:@"answer" newStrings:newStrings];
+        [entries appendBytes:&entry length:sizeof(entry)];
+        return;
+    }
+    
+    for (NSString *keyPath in [self keyPathsForResultClass:[result class]]) {
+        id value = [result valueForKeyPath:keyPath];
+        if (! [value isKindOfClass:[NSNumber class]]) {
+            continue;
+        }
+        ORKResultStoreEntry valueEntry = entry;
+        valueEntry.value = [value doubleValue];
+        valueEntry.key = [self indexOfString:keyPath newStrings:newStrings];
+        [entries appendBytes:&valueEntry length:sizeof(valueEntry)];
+    }
+}
+
+#pragma mark Public
+
+- (NSUInteger)taskResultCount {
+    __block NSUInteger count = 0;
+    dispatch_sync(_queue, ^{
+        [self loadIfNeeded];
+        count = _sessions.count;
+    });
+    return count;
+}
+
+- (BOOL)addTaskResult:(ORKTaskResult *)taskResult error:(NSError * __autoreleasing *)error {
+    if (! taskResult.taskRunUUID || ! taskResult.identifier) {
+        if (error) {
+            *error = [NSError errorWithDomain:ORKErrorDomain code:ORKErrorInvalidObject userInfo:@{NSLocalizedFailureReasonErrorKey : @"Task result has no identifier or task run UUID"}];
+        }
+        return NO;
+    }
+    
+    __block BOOL success = NO;
+    __block NSError *localError = nil;
+    dispatch_sync(_queue, ^{
+        [self loadIfNeeded];
+        
+        NSString *session = [taskResult.taskRunUUID UUIDString];
+        uint32_t existingSession = [self existingIndexOfString:session];
+        if (existingSession != ORKResultStoreNoString && [_sessions containsObject:@(existingSession)]) {
+            localError = [NSError errorWithDomain:ORKErrorDomain code:ORKErrorInvalidObject userInfo:@{NSLocalizedFailureReasonErrorKey : @"Task result is already in the store"}];
+            return;
+        }
+        
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        if (! [fileManager createDirectoryAtURL:[self sessionsDirectory] withIntermediateDirectories:YES attributes:[self fileAttributes] error:&localError]) {
+            return;
+        }
+        NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:taskResult];
+        NSDataWritingOptions options = NSDataWritingAtomic;
+        switch (self.fileProtectionMode) {
+            case ORKFileProtectionComplete:
+                options |= NSDataWritingFileProtectionComplete;
+                break;
+            case ORKFileProtectionCompleteUnlessOpen:
+                options |= NSDataWritingFileProtectionCompleteUnlessOpen;
+                break;
+            case ORKFileProtectionCompleteUntilFirstUserAuthentication:
+                options |= NSDataWritingFileProtectionCompleteUntilFirstUserAuthentication;
+                break;
+            case ORKFileProtectionNone:
+                options |= NSDataWritingFileProtectionNone;
+                break;
+        }
+        if (! [archive writeToURL:[self archiveURLForTaskRunUUID:taskResult.taskRunUUID] options:options error:&localError]) {
+            return;
+        }
+        
+        NSMutableData *newStrings = [NSMutableData data];
+        NSMutableData *entries = [NSMutableData data];
+        NSDate *defaultDate = taskResult.endDate ? : taskResult.startDate ? : [NSDate date];
+        
+        ORKResultStoreEntry base = {0};
+        base.value = NAN;
+        base.session = [self indexOfString:session newStrings:newStrings];
+        base.task = [self indexOfString:taskResult.identifier newStrings:newStrings];
+        base.step = ORKResultStoreNoString;
+        base.string = ORKResultStoreNoString;
+        
+        ORKResultStoreEntry marker = base;
+        marker.date = defaultDate.timeIntervalSinceReferenceDate;
+        marker.result = base.task;
+        marker.key = ORKResultStoreSessionKey;
+        [entries appendBytes:&marker length:sizeof(marker)];
+        [self appendEntriesForResult:taskResult stepIdentifier:nil base:base defaultDate:defaultDate entries:entries newStrings:newStrings];
+        
+        if ((newStrings.length && ! [self appendData:newStrings toURL:[self stringsURL] atOffset:_stringsLength error:&localError]) ||
+            ! [self appendData:entries toURL:[self indexURL] atOffset:_indexLength error:&localError]) {
+            // The string table in memory may no longer match the file; reload both on next use.
+            _loaded = NO;
+            return;
+        }
+        _stringsLength += newStrings.length;
+        _indexLength += entries.length;
+        
+        const ORKResultStoreEntry *newEntries = entries.bytes;
+        for (NSUInteger i = 0; i < entries.length / sizeof(ORKResultStoreEntry); i++) {
+            [self addEntry:&newEntries[i]];
+        }
+        success = YES;
+    });
+    if (error) {
+        *error = localError;
+    }
+    return success;
+}
+
+- (ORKTaskResult *)taskResultWithTaskRunUUID:(NSUUID *)taskRunUUID error:(NSError * __autoreleasing *)error {
+    NSData *data = [NSData dataWithContentsOfURL:[self archiveURLForTaskRunUUID:taskRunUUID] options:0 error:error];
+    if (! data) {
+        return nil;
+    }
+    ORKTaskResult *taskResult = nil;
+    @try {
+        NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+        unarchiver.requiresSecureCoding = YES;
+        taskResult = [unarchiver decodeObjectOfClass:[ORKTaskResult class] forKey:NSKeyedArchiveRootObjectKey];
+    } @catch (NSException *exception) {
+        taskResult = nil;
+    }
+    if (! taskResult && error) {
+        *error = [NSError errorWithDomain:ORKErrorDomain code:ORKErrorInvalidObject userInfo:@{NSLocalizedFailureReasonErrorKey : @"Task result could not be unarchived"}];
+    }
+    return taskResult;
+}
+
+// Matching entries sorted by date. Call on the queue.
+- (NSData *)entriesMatchingQuery:(ORKResultStoreQuery *)query {
+    [self loadIfNeeded];
+    NSMutableData *matches = [NSMutableData data];
+    
+    NSArray *tasks = nil;
+    if (query.taskIdentifier) {
+        uint32_t task = [self existingIndexOfString:query.taskIdentifier];
+        tasks = (task == ORKResultStoreNoString) ? @[] : @[@(task)];
+    } else {
+        tasks = [_entriesByTask allKeys];
+    }
+    
+    // An identifier that was never stored matches nothing.
+    uint32_t step = [self existingIndexOfString:query.stepIdentifier];
+    uint32_t result = [self existingIndexOfString:query.resultIdentifier];
+    uint32_t key = [self existingIndexOfString:query.key];
+    if ((query.stepIdentifier && step == ORKResultStoreNoString) ||
+        (query.resultIdentifier && result == ORKResultStoreNoString) ||
+        (query.key && key == ORKResultStoreNoString)) {
+        return matches;
+    }
+    
+    NSTimeInterval startDate = query.startDate ? query.startDate.timeIntervalSinceReferenceDate : -INFINITY;
+    NSTimeInterval endDate = query.endDate ? query.endDate.timeIntervalSinceReferenceDate : INFINITY;
+    BOOL filtersValue = (query.minimumValue || query.maximumValue);
+    double minimumValue = query.minimumValue ? query.minimumValue.doubleValue : -INFINITY;
+    double maximumValue = query.maximumValue ? query.maximumValue.doubleValue : INFINITY;
+    
+    for (NSNumber *task in tasks) {
+        NSMutableData *taskEntries = _entriesByTask[task];
+        if ([_unsortedTasks containsObject:task]) {
+            qsort(taskEntries.mutableBytes, taskEntries.length / sizeof(ORKResultStoreEntry), sizeof(ORKResultStoreEntry), ORKResultStoreEntryCompareDates);
+            [_unsortedTasks removeObject:task];
+        }
+        const ORKResultStoreEntry *entries = taskEntries.bytes;
+        NSUInteger count = taskEntries.length / sizeof(ORKResultStoreEntry);
+        for (NSUInteger i = ORKResultStoreLowerBound(entries, count, startDate); i < count && entries[i].date < endDate; i++) {
+            const ORKResultStoreEntry *entry = &entries[i];
+            if (entry->key == ORKResultStoreSessionKey ||
+                (query.stepIdentifier && entry->step != step) ||
+                (query.resultIdentifier && entry->result != result) ||
+                (query.key && entry->key != key) ||
+                (filtersValue && ! (entry->value >= minimumValue && entry->value <= maximumValue))) {
+                continue;
+            }
+            [matches appendBytes:entry length:sizeof(ORKResultStoreEntry)];
+        }
+    }
+    if (tasks.count > 1) {
+        qsort(matches.mutableBytes, matches.length / sizeof(ORKResultStoreEntry), sizeof(ORKResultStoreEntry), ORKResultStoreEntryCompareDates);
+    }
+    return matches;
+}
+
+- (NSArray *)recordsMatchingQuery:(ORKResultStoreQuery *)query {
+    NSMutableArray *records = [NSMutableArray array];
+    dispatch_sync(_queue, ^{
+        NSData *matches = [self entriesMatchingQuery:query];
+        const ORKResultStoreEntry *entries = matches.bytes;
+        NSMutableDictionary *uuids = [NSMutableDictionary dictionary];
+        for (NSUInteger i = 0; i < matches.length / sizeof(ORKResultStoreEntry); i++) {
+            const ORKResultStoreEntry *entry = &entries[i];
+            NSNumber *session = @(entry->session);
+            NSUUID *uuid = uuids[session];
+            if (! uuid) {
+                uuid = [[NSUUID alloc] initWithUUIDString:_strings[entry->session]];
+                uuids[session] = uuid;
+            }
+            ORKResultStoreRecord *record = [[ORKResultStoreRecord alloc] initWithTaskIdentifier:_strings[entry->task]
+                                                                                    taskRunUUID:uuid
+                                                                                 stepIdentifier:(entry->step == ORKResultStoreNoString) ? nil : _strings[entry->step]
+                                                                               resultIdentifier:_strings[entry->result]
+                                                                                            key:_strings[entry->key]
+                                                                                           date:[NSDate dateWithTimeIntervalSinceReferenceDate:entry->date]
+                                                                                   numericValue:isnan(entry->value) ? nil : @(entry->value)
+                                                                                    stringValue:(entry->string == ORKResultStoreNoString) ? nil : _strings[entry->string]];
+            [records addObject:record];
+        }
+    });
+    return records;
+}
+
+- (NSArray *)dailyStatisticsForQuery:(ORKResultStoreQuery *)query calendar:(NSCalendar *)calendar {
+    calendar = calendar ? : [NSCalendar currentCalendar];
+    NSMutableArray *statistics = [NSMutableArray array];
+    dispatch_sync(_queue, ^{
+        NSData *matches = [self entriesMatchingQuery:query];
+        const ORKResultStoreEntry *entries = matches.bytes;
+        NSUInteger count = matches.length / sizeof(ORKResultStoreEntry);
+        
+        // Entries are in date order, so the calendar is only consulted once per day.
+        NSDate *dayStart = nil;
+        NSTimeInterval dayEnd = -INFINITY;
+        NSUInteger dayCount = 0;
+        double minimum = 0, maximum = 0, sum = 0;
+        for (NSUInteger i = 0; i <= count; i++) {
+            BOOL done = (i == count);
+            if (! done && isnan(entries[i].value)) {
+                continue;
+            }
+            if (done || entries[i].date >= dayEnd) {
+                if (dayCount > 0) {
+                    [statistics addObject:[[ORKResultStoreStatistics alloc] initWithStartDate:dayStart
+                                                                                      endDate:[NSDate dateWithTimeIntervalSinceReferenceDate:dayEnd]
+                                                                                        count:dayCount
+                                                                                      minimum:minimum
+                                                                                      maximum:maximum
+                                                                                         mean:sum / dayCount]];
+                }
+                if (done) {
+                    break;
+                }
+                NSDate *start = nil;
+                NSTimeInterval length = 0;
+                [calendar rangeOfUnit:NSCalendarUnitDay startDate:&start interval:&length forDate:[NSDate dateWithTimeIntervalSinceReferenceDate:entries[i].date]];
+                dayStart = start;
+                dayEnd = start.timeIntervalSinceReferenceDate + length;
+                dayCount = 0;
+                minimum = INFINITY;
+                maximum = -INFINITY;
+                sum = 0;
+            }
+            double value = entries[i].value;
+            minimum = MIN(minimum, value);
+            maximum = MAX(maximum, value);
+            sum += value;
+            dayCount++;
+        }
+    });
+    return statistics;
+}
+
+@end
@@ -81,6 +81,34 @@ ORK_CLASS_AVAILABLE
 @end
 
 
+@class ORKTappingSampleStore;
+@class ORKSpatialSpanMemoryGameTouchSampleStore;
+
+/*
+ Tapping and touch samples are held in packed column storage; the sample object
+ arrays are created from it on demand. The framework appends to a store directly,
+ instead of building sample objects.
+ 
+ Declared as methods rather than properties so they are not mistaken for serialized state.
+ */
+@interface ORKTappingIntervalResult ()
+
+- (nullable ORKTappingSampleStore *)sampleStore;
+
+- (void)setSampleStore:(nullable ORKTappingSampleStore *)sampleStore;
+
+@end
+
+
+@interface ORKSpatialSpanMemoryGameRecord ()
+
+- (nullable ORKSpatialSpanMemoryGameTouchSampleStore *)touchSampleStore;
+
+- (void)setTouchSampleStore:(nullable ORKSpatialSpanMemoryGameTouchSampleStore *)touchSampleStore;
+
+@end
+
+
 @interface ORKQuestionResult ()
 
 // Used internally for unit testing.
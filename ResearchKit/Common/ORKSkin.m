@@ -31,6 +31,7 @@
 
 #import "ORKSkin.h"
 #import "ORKHelpers.h"
+#import "ORKStyleCache.h"
 
 
 NSString *const ORKSignatureColorKey = @"ORKSignatureColorKey";
@@ -41,6 +42,8 @@ NSString *const ORKDarkTintColorKey = @"ORKDarkTintColorKey";
 NSString *const ORKCaptionTextColorKey = @"ORKCaptionTextColorKey";
 NSString *const ORKBlueHighlightColorKey = @"ORKBlueHighlightColorKey";
 
+static const NSUInteger ORKColorKeyCount = 7;
+
 @implementation UIColor (ORKColor)
 
 #define cachedColorMethod(m, r, g, b, a) \
@@ -81,13 +84,35 @@ static NSMutableDictionary *colors() {
     return colors;
 }
 
+// Callers pass the exported key constants, so resolved colors are looked up by key identity
+static NSMapTable *resolvedColors() {
+    static NSMapTable *resolvedColors = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        resolvedColors = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                                   valueOptions:NSPointerFunctionsStrongMemory
+                                                       capacity:ORKColorKeyCount];
+    });
+    return resolvedColors;
+}
+
 UIColor *ORKColor(NSString *colorKey) {
-    return colors()[colorKey];
+    NSMapTable *resolved = resolvedColors();
+    UIColor *color = [resolved objectForKey:colorKey];
+    if (!color) {
+        color = colors()[colorKey];
+        if (color) {
+            [resolved setObject:color forKey:colorKey];
+        }
+    }
+    return color;
 }
 
 void ORKColorSetColorForKey(NSString *key, UIColor *color) {
     NSMutableDictionary *d = colors();
     d[key] = color;
+    [resolvedColors() removeAllObjects];
+    [[ORKStyleCache sharedCache] invalidate];
 }
 
 const CGSize ORKiPhone4ScreenSize = (CGSize){320, 480};
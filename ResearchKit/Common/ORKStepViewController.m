@@ -94,6 +94,10 @@
     return [self initWithStep:step];
 }
 
++ (BOOL)supportsPreparationBeforePresentation {
+    return YES;
+}
+
 - (void)viewDidLoad {
     [super viewDidLoad];
 
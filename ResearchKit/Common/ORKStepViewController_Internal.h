@@ -34,6 +34,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class ORKClock;
+
 @interface ORKStepViewController () <UIViewControllerRestoration>
 
 - (void)stepDidChange;
@@ -53,6 +55,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, copy, nullable) NSDate *presentedDate;
 @property (nonatomic, copy, nullable) NSDate *dismissedDate;
 
+// The task's clock, set by the task view controller, whose time base results publish.
+@property (nonatomic, strong, nullable) ORKClock *clock;
+
 @property (nonatomic, copy, nullable) NSString *restoredStepIdentifier;
 
 - (void)willNavigateDirection:(ORKStepViewControllerNavigationDirection)direction;
@@ -61,6 +66,15 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (instancetype)initWithStep:(ORKStep *)step result:(ORKResult *)result;
 
+// Whether the task view controller may create this view controller and load its view before the step
+// is presented. Defaults to YES.
++ (BOOL)supportsPreparationBeforePresentation;
+
+// YES while the task view controller holds this view controller ahead of its step. It is configured and
+// its view loaded and laid out as usual, but subclasses leave capture sessions and recorders alone
+// until it is cleared.
+@property (nonatomic, getter=isPreparedAheadOfPresentation) BOOL preparedAheadOfPresentation;
+
 - (instancetype)initWithNibName:(NSString *)nibNameOrNil bundle:(NSBundle *)nibBundleOrNil NS_DESIGNATED_INITIALIZER;
 
 - (void)showValidityAlertWithMessage:(NSString *)text;
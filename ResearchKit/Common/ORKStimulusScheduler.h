@@ -0,0 +1,93 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^ORKDisplayClockHandler)(CFTimeInterval timestamp, CFTimeInterval frameDuration);
+
+/*
+ A source of display refresh callbacks. The handler is called on the main queue once per
+ refresh, with the time of the refresh that just happened and the refresh interval, both in
+ the `CACurrentMediaTime()` time base.
+ 
+ The default clock is backed by `CADisplayLink`; tests drive a fake clock by hand.
+ */
+@protocol ORKDisplayClock <NSObject>
+
+- (void)startWithHandler:(ORKDisplayClockHandler)handler;
+
+- (void)stop;
+
+@end
+
+
+@interface ORKDisplayLinkClock : NSObject <ORKDisplayClock>
+
+@end
+
+
+/*
+ The handler runs from the display refresh callback, so any view or layer change it makes is
+ committed for the next frame. `presentationTime` is the time that frame is shown.
+ */
+typedef void (^ORKStimulusHandler)(CFTimeInterval presentationTime, CFTimeInterval frameDuration);
+
+/*
+ Presents visual stimuli on display frame boundaries.
+ 
+ Each stimulus is assigned to the frame boundary nearest its requested time, or to the next
+ frame if that boundary has already passed. Stimuli due on the same frame run in the order
+ they were scheduled. The display clock only runs while stimuli are pending.
+ 
+ Main queue only.
+ */
+@interface ORKStimulusScheduler : NSObject
+
+- (instancetype)init;
+
+- (instancetype)initWithDisplayClock:(id<ORKDisplayClock>)displayClock NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, strong, readonly) id<ORKDisplayClock> displayClock;
+
+@property (nonatomic, readonly) NSUInteger pendingStimulusCount;
+
+// `time` is in the `CACurrentMediaTime()` time base.
+- (void)scheduleStimulusAtTime:(CFTimeInterval)time handler:(ORKStimulusHandler)handler;
+
+- (void)cancelAllStimuli;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,166 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKStimulusScheduler.h"
+
+
+@implementation ORKDisplayLinkClock {
+    CADisplayLink *_displayLink;
+    ORKDisplayClockHandler _handler;
+}
+
+- (void)dealloc {
+    [_displayLink invalidate];
+}
+
+- (void)startWithHandler:(ORKDisplayClockHandler)handler {
+    [self stop];
+    _handler = [handler copy];
+    _displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(displayLinkDidFire:)];
+    [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+- (void)stop {
+    // The display link retains its target; invalidating it breaks the cycle.
+    [_displayLink invalidate];
+    _displayLink = nil;
+    _handler = nil;
+}
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink {
+    ORKDisplayClockHandler handler = _handler;
+    if (handler) {
+        handler(displayLink.timestamp, displayLink.duration);
+    }
+}
+
+@end
+
+
+@interface ORKScheduledStimulus : NSObject
+
+@property (nonatomic) CFTimeInterval time;
+
+@property (nonatomic, copy) ORKStimulusHandler handler;
+
+@end
+
+
+@implementation ORKScheduledStimulus
+
+@end
+
+
+@implementation ORKStimulusScheduler {
+    // Sorted by time; stimuli with equal times keep their scheduling order.
+    NSMutableArray *_pendingStimuli;
+    BOOL _clockRunning;
+}
+
+- (instancetype)init {
+    return [self initWithDisplayClock:[ORKDisplayLinkClock new]];
+}
+
+- (instancetype)initWithDisplayClock:(id<ORKDisplayClock>)displayClock {
+    self = [super init];
+    if (self) {
+        _displayClock = displayClock;
+        _pendingStimuli = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_displayClock stop];
+}
+
+- (NSUInteger)pendingStimulusCount {
+    return _pendingStimuli.count;
+}
+
+- (void)scheduleStimulusAtTime:(CFTimeInterval)time handler:(ORKStimulusHandler)handler {
+    ORKScheduledStimulus *stimulus = [ORKScheduledStimulus new];
+    stimulus.time = time;
+    stimulus.handler = handler;
+    
+    NSUInteger index = _pendingStimuli.count;
+    while (index > 0 && [_pendingStimuli[index - 1] time] > time) {
+        index--;
+    }
+    [_pendingStimuli insertObject:stimulus atIndex:index];
+    
+    [self startClockIfNeeded];
+}
+
+- (void)cancelAllStimuli {
+    [_pendingStimuli removeAllObjects];
+    [self stopClock];
+}
+
+- (void)startClockIfNeeded {
+    if (_clockRunning || _pendingStimuli.count == 0) {
+        return;
+    }
+    _clockRunning = YES;
+    __weak __typeof(self) weakSelf = self;
+    [_displayClock startWithHandler:^(CFTimeInterval timestamp, CFTimeInterval frameDuration) {
+        [weakSelf displayClockDidTickWithTimestamp:timestamp frameDuration:frameDuration];
+    }];
+}
+
+- (void)stopClock {
+    if (_clockRunning) {
+        _clockRunning = NO;
+        [_displayClock stop];
+    }
+}
+
+- (void)displayClockDidTickWithTimestamp:(CFTimeInterval)timestamp frameDuration:(CFTimeInterval)frameDuration {
+    // Changes made now are shown on the next refresh.
+    CFTimeInterval presentationTime = timestamp + frameDuration;
+    
+    // A stimulus belongs to this frame if this frame's boundary is the nearest one not yet passed.
+    CFTimeInterval cutoff = presentationTime + frameDuration / 2;
+    while (_pendingStimuli.count > 0) {
+        ORKScheduledStimulus *stimulus = _pendingStimuli[0];
+        if (stimulus.time >= cutoff) {
+            break;
+        }
+        [_pendingStimuli removeObjectAtIndex:0];
+        stimulus.handler(presentationTime, frameDuration);
+    }
+    
+    if (_pendingStimuli.count == 0) {
+        [self stopClock];
+    }
+}
+
+@end
@@ -0,0 +1,79 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <UIKit/UIKit.h>
+#import "ORKSkin.h"
+#import "ORKCacheManager.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Cache of resolved skin styles: default fonts, text measurements and tinted images.
+ 
+ Styles are keyed by a style key and the screen type the skin varies its metrics on, within
+ the current content size category. A lookup made under a different content size category
+ than the cached entries empties the cache first, so views that update in response to
+ `UIContentSizeCategoryDidChangeNotification` never see stale fonts, whatever the order in
+ which observers are notified. Skin color customization also empties it, and so does the
+ shared cache manager, with which the shared cache registers at low priority.
+ 
+ Main thread only, like the views that use it.
+ */
+@interface ORKStyleCache : NSObject <ORKPurgeableCache>
+
++ (ORKStyleCache *)sharedCache;
+
+// Returns the cached style, calling `resolver` if there is none yet for the current traits.
+- (id)styleForKey:(id<NSCopying>)styleKey resolver:(id (^)(void))resolver;
+
+// Height of `text` laid out in `font`, wrapped to `width`.
+- (CGFloat)heightForText:(NSString *)text font:(UIFont *)font width:(CGFloat)width;
+
+// Returns the cached tinted image, calling `resolver` if there is none yet. `tintColor` may be nil for images whose tinted form does not depend on the color.
+- (UIImage *)tintedImageForImage:(UIImage *)image tintColor:(nullable UIColor *)tintColor scale:(CGFloat)scale resolver:(UIImage *(^)(void))resolver;
+
+- (void)invalidate;
+
+// Measurement: lookups made, and how many of them had to resolve the style, since the last reset.
+@property (nonatomic, readonly) NSUInteger lookupCount;
+
+@property (nonatomic, readonly) NSUInteger resolutionCount;
+
+- (void)resetCounts;
+
+@end
+
+
+// The cached `+defaultFont` of a class adopting ORKDefaultFont.
+UIFont *ORKCachedDefaultFont(Class fontClass);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,264 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKStyleCache.h"
+#import "ORKDefaultFont.h"
+#import "ORKHelpers.h"
+
+
+static const NSUInteger ORKStyleCacheMeasurementLimit = 512;
+static const NSUInteger ORKStyleCacheTintedImageLimit = 64;
+
+// Estimated bytes per entry, for the cache manager.
+static const NSUInteger ORKStyleCacheStyleCost = 256;
+static const NSUInteger ORKStyleCacheMeasurementCost = 64;
+
+static NSUInteger ORKStyleCacheImageCost(UIImage *image) {
+    CGImageRef cgImage = image.CGImage;
+    return cgImage ? CGImageGetBytesPerRow(cgImage) * CGImageGetHeight(cgImage) : 0;
+}
+
+@interface ORKStyleCacheKey : NSObject <NSCopying>
+
+- (instancetype)initWithObject:(id)object secondObject:(nullable id)secondObject value:(CGFloat)value;
+
+@end
+
+
+@implementation ORKStyleCacheKey {
+    id _object;
+    id _secondObject;
+    CGFloat _value;
+    NSUInteger _hash;
+}
+
+- (instancetype)initWithObject:(id)object secondObject:(id)secondObject value:(CGFloat)value {
+    self = [super init];
+    if (self) {
+        _object = object;
+        _secondObject = secondObject;
+        _value = value;
+        _hash = [object hash] ^ ([secondObject hash] * 31) ^ (NSUInteger)(value * 1000);
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    // Immutable
+    return self;
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
+    if (![object isKindOfClass:[ORKStyleCacheKey class]]) {
+        return NO;
+    }
+    ORKStyleCacheKey *key = object;
+    return (_hash == key->_hash
+            && _value == key->_value
+            && ORKEqualObjects(_object, key->_object)
+            && ORKEqualObjects(_secondObject, key->_secondObject));
+}
+
+@end
+
+
+@interface ORKStyleCache () <NSCacheDelegate>
+
+@end
+
+
+@implementation ORKStyleCache {
+    NSString *_contentSizeCategory;
+    NSMutableDictionary *_styles[ORKScreenType_COUNT];
+    NSCache *_measurements;
+    NSCache *_tintedImages;
+    
+    // Tracked through the NSCache delegate, since NSCache evicts on its own.
+    NSUInteger _measurementCount;
+    NSUInteger _tintedImageCost;
+}
+
++ (ORKStyleCache *)sharedCache {
+    static ORKStyleCache *sharedCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedCache = [[ORKStyleCache alloc] init];
+        [[ORKCacheManager sharedManager] registerCache:sharedCache priority:ORKCachePriorityLow];
+    });
+    return sharedCache;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        for (NSInteger screenType = 0; screenType < ORKScreenType_COUNT; screenType++) {
+            _styles[screenType] = [NSMutableDictionary dictionary];
+        }
+        _measurements = [NSCache new];
+        _measurements.countLimit = ORKStyleCacheMeasurementLimit;
+        _measurements.delegate = self;
+        _tintedImages = [NSCache new];
+        _tintedImages.countLimit = ORKStyleCacheTintedImageLimit;
+        _tintedImages.delegate = self;
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(invalidate)
+                                                     name:UIContentSizeCategoryDidChangeNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)invalidate {
+    for (NSInteger screenType = 0; screenType < ORKScreenType_COUNT; screenType++) {
+        [_styles[screenType] removeAllObjects];
+    }
+    [_measurements removeAllObjects];
+    [_tintedImages removeAllObjects];
+    _measurementCount = 0;
+    _tintedImageCost = 0;
+}
+
+#pragma mark - ORKPurgeableCache
+
+- (NSUInteger)cacheCost {
+    NSUInteger styleCount = 0;
+    for (NSInteger screenType = 0; screenType < ORKScreenType_COUNT; screenType++) {
+        styleCount += _styles[screenType].count;
+    }
+    return (styleCount * ORKStyleCacheStyleCost +
+            _measurementCount * ORKStyleCacheMeasurementCost +
+            _tintedImageCost);
+}
+
+- (void)purgeCache {
+    [self invalidate];
+}
+
+#pragma mark - NSCacheDelegate
+
+- (void)cache:(NSCache *)cache willEvictObject:(id)object {
+    if (cache == _measurements) {
+        _measurementCount -= MIN(_measurementCount, 1);
+    } else if (cache == _tintedImages) {
+        _tintedImageCost -= MIN(_tintedImageCost, ORKStyleCacheImageCost(object));
+    }
+}
+
+- (void)invalidateIfContentSizeCategoryChanged {
+    NSString *contentSizeCategory = [[UIApplication sharedApplication] preferredContentSizeCategory];
+    if (!ORKEqualObjects(contentSizeCategory, _contentSizeCategory)) {
+        _contentSizeCategory = [contentSizeCategory copy];
+        // Tinted images do not depend on the content size category
+        for (NSInteger screenType = 0; screenType < ORKScreenType_COUNT; screenType++) {
+            [_styles[screenType] removeAllObjects];
+        }
+        [_measurements removeAllObjects];
+        _measurementCount = 0;
+    }
+}
+
+- (id)styleForKey:(id<NSCopying>)styleKey resolver:(id (^)(void))resolver {
+    [self invalidateIfContentSizeCategoryChanged];
+    _lookupCount++;
+    NSMutableDictionary *styles = _styles[ORKGetScreenTypeForWindow(nil)];
+    id style = styles[styleKey];
+    if (!style) {
+        _resolutionCount++;
+        style = resolver();
+        if (style) {
+            styles[styleKey] = style;
+        }
+    }
+    return style;
+}
+
+- (CGFloat)heightForText:(NSString *)text font:(UIFont *)font width:(CGFloat)width {
+    if (text.length == 0 || !font) {
+        return 0;
+    }
+    [self invalidateIfContentSizeCategoryChanged];
+    _lookupCount++;
+    ORKStyleCacheKey *key = [[ORKStyleCacheKey alloc] initWithObject:text secondObject:font value:width];
+    NSNumber *height = [_measurements objectForKey:key];
+    if (!height) {
+        _resolutionCount++;
+        CGSize size = [text boundingRectWithSize:CGSizeMake(width, CGFLOAT_MAX)
+                                         options:NSStringDrawingUsesLineFragmentOrigin
+                                      attributes:@{ NSFontAttributeName : font }
+                                         context:nil].size;
+        height = @(size.height);
+        [_measurements setObject:height forKey:key];
+        _measurementCount++;
+    }
+    return height.doubleValue;
+}
+
+- (UIImage *)tintedImageForImage:(UIImage *)image tintColor:(UIColor *)tintColor scale:(CGFloat)scale resolver:(UIImage *(^)(void))resolver {
+    _lookupCount++;
+    ORKStyleCacheKey *key = [[ORKStyleCacheKey alloc] initWithObject:image secondObject:tintColor value:scale];
+    UIImage *tintedImage = [_tintedImages objectForKey:key];
+    if (!tintedImage) {
+        _resolutionCount++;
+        tintedImage = resolver();
+        if (tintedImage) {
+            [_tintedImages setObject:tintedImage forKey:key];
+            _tintedImageCost += ORKStyleCacheImageCost(tintedImage);
+            [[ORKCacheManager sharedManager] cacheCostDidChange:self];
+        }
+    }
+    return tintedImage;
+}
+
+- (void)resetCounts {
+    _lookupCount = 0;
+    _resolutionCount = 0;
+}
+
+@end
+
+
+UIFont *ORKCachedDefaultFont(Class fontClass) {
+    return [[ORKStyleCache sharedCache] styleForKey:fontClass resolver:^id{
+        return [(Class<ORKDefaultFont>)fontClass defaultFont];
+    }];
+}
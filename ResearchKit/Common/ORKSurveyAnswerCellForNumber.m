@@ -45,9 +45,7 @@
 @end
 
 
-@implementation ORKSurveyAnswerCellForNumber {
-    NSNumberFormatter *_numberFormatter;
-}
+@implementation ORKSurveyAnswerCellForNumber
 
 - (ORKUnitTextField *)textField {
     return _textFieldView.textField;
@@ -55,7 +53,6 @@
 
 - (void)numberCell_initialize {
     ORKQuestionType questionType = self.step.questionType;
-    _numberFormatter = [(ORKNumericAnswerFormat *)[[self.step answerFormat] impliedAnswerFormat] makeNumberFormatter];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(localeDidChange:) name:NSCurrentLocaleDidChangeNotification object:nil];
     
     _textFieldView = [[ORKTextFieldView alloc] init];
@@ -90,7 +87,6 @@
 
 - (void)localeDidChange:(NSNotification *)note {
     // On a locale change, re-format the value with the current locale
-    _numberFormatter.locale = [NSLocale currentLocale];
     [self answerDidChange];
 }
 
@@ -162,7 +158,7 @@
     ORKNumericAnswerFormat *numericFormat = (ORKNumericAnswerFormat *)answerFormat;
     NSString *displayValue = (answer && answer != ORKNullAnswerValue()) ? answer : nil;
     if ([answer isKindOfClass:[NSNumber class]]) {
-        displayValue = [_numberFormatter stringFromNumber:answer];
+        displayValue = [ORKDecimalNumberFormatter() stringFromNumber:answer];
     }
    
     NSString *placeholder = self.step.placeholder? : ORKLocalizedString(@"PLACEHOLDER_TEXT_OR_NUMBER", nil);
@@ -177,7 +173,7 @@
 
 - (void)valueFieldDidChange:(UITextField *)textField {
     ORKNumericAnswerFormat *answerFormat = (ORKNumericAnswerFormat *)[self.step impliedAnswerFormat];
-    NSString *sanitizedText = [answerFormat sanitizedTextFieldText:[textField text] decimalSeparator:[_numberFormatter decimalSeparator]];
+    NSString *sanitizedText = [answerFormat sanitizedTextFieldText:[textField text] decimalSeparator:[ORKDecimalNumberFormatter() decimalSeparator]];
     textField.text = sanitizedText;
     [self setAnswerWithText:textField.text];
 }
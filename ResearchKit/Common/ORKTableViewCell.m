@@ -32,6 +32,7 @@
 #import "ORKTableViewCell.h"
 #import "ORKSkin.h"
 #import "ORKSelectionTitleLabel.h"
+#import "ORKStyleCache.h"
 
 
 @interface ORKTableViewCell ()
@@ -134,7 +135,7 @@
 }
 
 - (void)updateAppearance {
-    self.textLabel.font = [ORKSelectionTitleLabel defaultFont];
+    self.textLabel.font = ORKCachedDefaultFont([ORKSelectionTitleLabel class]);
     [self invalidateIntrinsicContentSize];
 
 }
@@ -0,0 +1,221 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <ResearchKit/ORKDefines.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ORKStep;
+@class ORKStepResult;
+@class ORKTaskResult;
+@class ORKTaskRunner;
+@protocol ORKTask;
+@protocol ORKTaskResultSource;
+
+/**
+ The `ORKTaskRunnerAnswerProvider` protocol supplies the results of the steps that an
+ `ORKTaskRunner` object walks, in place of a participant.
+ */
+@protocol ORKTaskRunnerAnswerProvider <NSObject>
+
+/**
+ Asks the answer provider for the result of a step, as its step view controller would produce it.
+ 
+ @param taskRunner      The task runner asking for the result.
+ @param step            The current step.
+ @param previousResult  The result the step would be presented with: the result recorded earlier in
+                        the run, or the result from the default result source, or `nil`.
+ 
+ @return The result of the step, or `nil` to record a step result without child results. The
+    identifier of the result must be the identifier of the step.
+ */
+- (nullable ORKStepResult *)taskRunner:(ORKTaskRunner *)taskRunner resultForStep:(ORKStep *)step previousResult:(nullable ORKStepResult *)previousResult;
+
+@optional
+/**
+ Asks the answer provider whether to navigate back from a step instead of answering it.
+ 
+ This method is only called when the task runner can go back from the step. If this method is not
+ implemented, the task runner always goes forward.
+ 
+ @param taskRunner      The task runner asking.
+ @param step            The current step.
+ 
+ @return `YES` to go back to the previous step; otherwise, `NO`.
+ */
+- (BOOL)taskRunner:(ORKTaskRunner *)taskRunner shouldGoBackwardFromStep:(ORKStep *)step;
+
+@end
+
+
+/**
+ An `ORKTaskRunner` object walks a task without presenting it, following the same navigation and
+ producing the same task result as an `ORKTaskViewController` object would.
+ 
+ The task runner keeps the result of every step it visits, asks the task for the step after or
+ before the current one with the task result so far, and allows back navigation under the same
+ conditions as the task view controller. It does not use UIKit, so it can drive tasks from tests,
+ for instance to check navigation rules or to measure result assembly over many scripted runs.
+ 
+ Steps can be driven one at a time with `goForwardWithResult:` and `goBackward`, or a whole run
+ can be scripted with an answer provider using `runWithAnswerProvider:maximumStepCount:`.
+ 
+ The restoration data of a task runner uses the same format as the restoration data of a task view
+ controller, so either can resume a run saved by the other.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKTaskRunner : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Returns a new task runner for the specified task.
+ 
+ @param task        The task to run.
+ @param taskRunUUID The UUID of this run of the task. If `nil`, a new UUID is created.
+ 
+ @return A new task runner.
+ */
+- (instancetype)initWithTask:(id<ORKTask>)task taskRunUUID:(nullable NSUUID *)taskRunUUID NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns a new task runner that resumes a saved run of the specified task.
+ 
+ The restored run continues from the step that was current when the data was saved, without
+ calling `start`. If the restoration data is not valid, an exception may be thrown.
+ 
+ @param task    The task that was running.
+ @param data    Data obtained from the `restorationData` property of a task runner or of a task
+                view controller.
+ 
+ @return A new task runner.
+ */
+- (instancetype)initWithTask:(id<ORKTask>)task restorationData:(NSData *)data;
+
+/// The task being run.
+@property (nonatomic, strong, readonly) id<ORKTask> task;
+
+/// The UUID of this run of the task.
+@property (nonatomic, copy, readonly) NSUUID *taskRunUUID;
+
+/**
+ The output directory reported in the task result.
+ 
+ The task runner does not write any files, since it does not run recorders.
+ */
+@property (nonatomic, copy, nullable) NSURL *outputDirectory;
+
+/**
+ A source of results for steps that have not been visited in this run.
+ 
+ As with the task view controller, these results are passed to the answer provider as the
+ previous results of steps, but are not part of the task result until the steps are visited.
+ */
+@property (nonatomic, strong, nullable) id<ORKTaskResultSource> defaultResultSource;
+
+/// The step the run is at, or `nil` if the run has not started or has finished.
+@property (nonatomic, strong, readonly, nullable) ORKStep *currentStep;
+
+/// A Boolean value indicating whether the run went forward past the last step.
+@property (nonatomic, readonly, getter=isFinished) BOOL finished;
+
+/// The number of times the run moved to a step, forward or backward.
+@property (nonatomic, readonly) NSUInteger navigationCount;
+
+/**
+ Moves to the first step of the task.
+ 
+ @return The first step, or `nil` if the task has no steps.
+ */
+- (nullable ORKStep *)start;
+
+/**
+ Records the result of the current step and moves to the next step.
+ 
+ @param result  The result of the current step, or `nil` to record a step result without child
+                results, dated from the time the step was entered. Its identifier must be the
+                identifier of the current step.
+ 
+ @return The next step, or `nil` if the run has finished.
+ */
+- (nullable ORKStep *)goForwardWithResult:(nullable ORKStepResult *)result;
+
+/**
+ A Boolean value indicating whether the run can go back from the current step.
+ 
+ As in the task view controller, the run cannot go back to an active step, nor from a step that
+ does not allow back navigation.
+ */
+@property (nonatomic, readonly) BOOL canGoBackward;
+
+/**
+ Moves to the previous step, keeping the result of the current step in case it is visited again.
+ 
+ @return The previous step, or `nil` if the run cannot go back.
+ */
+- (nullable ORKStep *)goBackward;
+
+/**
+ Returns the result that the specified step would be presented with.
+ 
+ @param step    A step of the task.
+ 
+ @return The result recorded for the step in this run, or else the result from the default
+    result source, or `nil`.
+ */
+- (nullable ORKStepResult *)previousResultForStep:(ORKStep *)step;
+
+/**
+ Runs the task from its first step, asking the answer provider for the result of each step.
+ 
+ @param answerProvider      The object that supplies step results.
+ @param maximumStepCount    The maximum number of navigations, which bounds runs that navigate in a
+                            loop. Check `finished` to know whether the run completed.
+ 
+ @return The task result at the end of the run.
+ */
+- (ORKTaskResult *)runWithAnswerProvider:(id<ORKTaskRunnerAnswerProvider>)answerProvider maximumStepCount:(NSUInteger)maximumStepCount;
+
+/**
+ The task result so far, including the result of the current step.
+ 
+ A new task result is returned each time, as from the `result` property of a task view controller.
+ */
+@property (nonatomic, copy, readonly) ORKTaskResult *result;
+
+/// Data from which the run can be resumed with `initWithTask:restorationData:`.
+@property (nonatomic, copy, readonly) NSData *restorationData;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,329 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKTaskRunner.h"
+#import "ORKTaskRunner_Internal.h"
+#import "ORKTask.h"
+#import "ORKStep.h"
+#import "ORKStep_Private.h"
+#import "ORKActiveStep.h"
+#import "ORKResult.h"
+#import "ORKClock.h"
+
+
+NSString *const ORKTaskRunUUIDRestoreKey = @"taskRunUUID";
+NSString *const ORKShowsProgressInNavigationBarRestoreKey = @"showsProgressInNavigationBar";
+NSString *const ORKManagedResultsRestoreKey = @"managedResults";
+NSString *const ORKManagedStepIdentifiersRestoreKey = @"managedStepIdentifiers";
+NSString *const ORKOutputDirectoryRestoreKey = @"outputDirectory";
+NSString *const ORKTaskIdentifierRestoreKey = @"taskIdentifier";
+NSString *const ORKStepIdentifierRestoreKey = @"stepIdentifier";
+NSString *const ORKPresentedDateRestoreKey = @"presentedDate";
+
+BOOL ORKTaskRunCanGoBackward(ORKStep *step, ORKStep *previousStep) {
+    if (! previousStep || ! step.allowsBackNavigation) {
+        return NO;
+    }
+    return ! [previousStep isKindOfClass:[ORKActiveStep class]]; // Can't go back to an active step
+}
+
+@implementation ORKTaskRunner {
+    NSMutableDictionary *_managedResults;
+    NSMutableArray *_managedStepIdentifiers;
+    
+    // The results in the order of _managedStepIdentifiers, so that task results are assembled without lookups.
+    NSMutableArray *_stepResults;
+    NSCountedSet *_stepIdentifierCounts;
+    
+    ORKStepResult *_currentStepSourceResult;
+    NSDate *_currentStepDate;
+    NSString *_lastRestorableStepIdentifier;
+    
+    ORKClock *_clock;
+    NSDictionary *_resultUserInfo;
+    NSDate *_presentedDate;
+}
+
+- (instancetype)initWithTask:(id<ORKTask>)task taskRunUUID:(NSUUID *)taskRunUUID {
+    NSParameterAssert(task);
+    self = [super init];
+    if (self) {
+        _task = task;
+        _taskRunUUID = taskRunUUID ? [taskRunUUID copy] : [NSUUID UUID];
+        _managedResults = [NSMutableDictionary new];
+        _managedStepIdentifiers = [NSMutableArray new];
+        _stepResults = [NSMutableArray new];
+        _stepIdentifierCounts = [NSCountedSet new];
+        _clock = [ORKClock new];
+        _resultUserInfo = @{ ORKResultTimeBaseKey : [_clock timeBase] };
+    }
+    return self;
+}
+
+- (instancetype)initWithTask:(id<ORKTask>)task restorationData:(NSData *)data {
+    self = [self initWithTask:task taskRunUUID:nil];
+    if (self) {
+        NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+        [self decodeRestorableStateWithCoder:unarchiver];
+    }
+    return self;
+}
+
+#pragma mark - navigation
+
+- (ORKStep *)start {
+    if (_navigationCount > 0 || _finished) {
+        @throw [NSException exceptionWithName:NSGenericException reason:@"Task runner has already started" userInfo:nil];
+    }
+    _presentedDate = [NSDate date];
+    return [self moveToStep:[_task stepAfterStep:nil withResult:[self result]]];
+}
+
+- (ORKStep *)goForwardWithResult:(ORKStepResult *)result {
+    ORKStep *step = _currentStep;
+    if (! step) {
+        @throw [NSException exceptionWithName:NSGenericException reason:@"Task runner has no current step" userInfo:nil];
+    }
+    
+    NSString *identifier = step.identifier;
+    if (! result) {
+        result = [[ORKStepResult alloc] initWithStepIdentifier:identifier results:@[]];
+        result.startDate = _currentStepDate;
+    } else if (! [result.identifier isEqualToString:identifier]) {
+        @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                       reason:[NSString stringWithFormat:@"Result identifier %@ does not match step %@", result.identifier, identifier]
+                                     userInfo:nil];
+    }
+    [self setManagedResult:result forStepIdentifier:identifier];
+    
+    ORKStep *nextStep = [_task stepAfterStep:step withResult:[self result]];
+    if (! nextStep) {
+        _currentStep = nil;
+        _currentStepSourceResult = nil;
+        _finished = YES;
+        return nil;
+    }
+    return [self moveToStep:nextStep];
+}
+
+// Returns the step before the current one if the task view controller would offer to go back to it.
+- (ORKStep *)allowedPreviousStep {
+    ORKStep *step = _currentStep;
+    if (! step || ! step.allowsBackNavigation) {
+        return nil;
+    }
+    ORKStep *previousStep = [_task stepBeforeStep:step withResult:[self result]];
+    return ORKTaskRunCanGoBackward(step, previousStep) ? previousStep : nil;
+}
+
+- (BOOL)canGoBackward {
+    return ([self allowedPreviousStep] != nil);
+}
+
+- (ORKStep *)goBackward {
+    return [self goBackwardToStep:[self allowedPreviousStep]];
+}
+
+- (ORKStep *)goBackwardToStep:(ORKStep *)previousStep {
+    if (! previousStep) {
+        return nil;
+    }
+    NSString *identifier = [_managedStepIdentifiers lastObject];
+    NSAssert([identifier isEqualToString:_currentStep.identifier], @"The current step should be the last step visited");
+    [_managedStepIdentifiers removeLastObject];
+    [_stepResults removeLastObject];
+    [_stepIdentifierCounts removeObject:identifier];
+    
+    return [self moveToStep:previousStep];
+}
+
+- (ORKStep *)moveToStep:(ORKStep *)step {
+    _currentStep = step;
+    if (! step) {
+        _currentStepSourceResult = nil;
+        return nil;
+    }
+    _navigationCount++;
+    _currentStepDate = [NSDate date];
+    
+    NSString *identifier = step.identifier;
+    if ([step isRestorable]) {
+        _lastRestorableStepIdentifier = identifier;
+    }
+    
+    // Until the step is answered, the task result includes the result it is presented with, as in the task view controller.
+    _currentStepSourceResult = [self sourceResultForStepIdentifier:identifier];
+    ORKStepResult *result = _currentStepSourceResult;
+    if (! result) {
+        result = [[ORKStepResult alloc] initWithStepIdentifier:identifier results:@[]];
+        result.startDate = _currentStepDate;
+    }
+    
+    if (! [[_managedStepIdentifiers lastObject] isEqualToString:identifier]) {
+        [_managedStepIdentifiers addObject:identifier];
+        [_stepResults addObject:result];
+        [_stepIdentifierCounts addObject:identifier];
+    }
+    [self setManagedResult:result forStepIdentifier:identifier];
+    
+    return step;
+}
+
+- (void)setManagedResult:(ORKStepResult *)result forStepIdentifier:(NSString *)identifier {
+    _managedResults[identifier] = result;
+    
+    NSUInteger count = _managedStepIdentifiers.count;
+    if (count > 0 && [_managedStepIdentifiers[count - 1] isEqualToString:identifier]) {
+        _stepResults[count - 1] = result;
+    }
+    // A step visited several times in a run that loops shows its latest result everywhere.
+    if ([_stepIdentifierCounts countForObject:identifier] > 1) {
+        for (NSUInteger index = 0; index + 1 < count; index++) {
+            if ([_managedStepIdentifiers[index] isEqualToString:identifier]) {
+                _stepResults[index] = result;
+            }
+        }
+    }
+}
+
+- (ORKStepResult *)sourceResultForStepIdentifier:(NSString *)identifier {
+    ORKStepResult *result = _managedResults[identifier];
+    if (! result) {
+        result = [_defaultResultSource stepResultForStepIdentifier:identifier];
+    }
+    return result;
+}
+
+- (ORKStepResult *)previousResultForStep:(ORKStep *)step {
+    if (step == _currentStep) {
+        return _currentStepSourceResult;
+    }
+    return [self sourceResultForStepIdentifier:step.identifier];
+}
+
+- (ORKTaskResult *)runWithAnswerProvider:(id<ORKTaskRunnerAnswerProvider>)answerProvider maximumStepCount:(NSUInteger)maximumStepCount {
+    NSParameterAssert(answerProvider);
+    BOOL asksForBackNavigation = [answerProvider respondsToSelector:@selector(taskRunner:shouldGoBackwardFromStep:)];
+    
+    ORKStep *step = (_navigationCount == 0 && ! _finished) ? [self start] : _currentStep;
+    while (step && _navigationCount < maximumStepCount) {
+        @autoreleasepool {
+            ORKStep *previousStep = asksForBackNavigation ? [self allowedPreviousStep] : nil;
+            if (previousStep && [answerProvider taskRunner:self shouldGoBackwardFromStep:step]) {
+                step = [self goBackwardToStep:previousStep];
+            } else {
+                ORKStepResult *result = [answerProvider taskRunner:self resultForStep:step previousResult:_currentStepSourceResult];
+                step = [self goForwardWithResult:result];
+            }
+        }
+    }
+    return [self result];
+}
+
+#pragma mark - results
+
+- (ORKTaskResult *)result {
+    ORKTaskResult *result = [[ORKTaskResult alloc] initWithTaskIdentifier:[_task identifier] taskRunUUID:_taskRunUUID outputDirectory:_outputDirectory];
+    result.startDate = _presentedDate;
+    result.endDate = [NSDate date];
+    result.userInfo = _resultUserInfo;
+    result.results = _stepResults;
+    return result;
+}
+
+#pragma mark - restoration
+
+- (NSData *)restorationData {
+    NSMutableData *data = [[NSMutableData alloc] init];
+    NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+    
+    [archiver encodeObject:_taskRunUUID forKey:ORKTaskRunUUIDRestoreKey];
+    // The task view controller's default, which it does not fall back to when restoring.
+    [archiver encodeBool:YES forKey:ORKShowsProgressInNavigationBarRestoreKey];
+    [archiver encodeObject:_managedResults forKey:ORKManagedResultsRestoreKey];
+    [archiver encodeObject:_managedStepIdentifiers forKey:ORKManagedStepIdentifiersRestoreKey];
+    [archiver encodeObject:_presentedDate forKey:ORKPresentedDateRestoreKey];
+    [archiver encodeObject:_outputDirectory forKey:ORKOutputDirectoryRestoreKey];
+    [archiver encodeObject:_task.identifier forKey:ORKTaskIdentifierRestoreKey];
+    
+    if ([_currentStep isRestorable]) {
+        [archiver encodeObject:_currentStep.identifier forKey:ORKStepIdentifierRestoreKey];
+    } else if (_lastRestorableStepIdentifier) {
+        [archiver encodeObject:_lastRestorableStepIdentifier forKey:ORKStepIdentifierRestoreKey];
+    }
+    
+    [archiver finishEncoding];
+    return [data copy];
+}
+
+- (void)decodeRestorableStateWithCoder:(NSCoder *)coder {
+    NSUUID *taskRunUUID = [coder decodeObjectOfClass:[NSUUID class] forKey:ORKTaskRunUUIDRestoreKey];
+    if (taskRunUUID) {
+        _taskRunUUID = taskRunUUID;
+    }
+    _outputDirectory = [coder decodeObjectOfClass:[NSURL class] forKey:ORKOutputDirectoryRestoreKey];
+    
+    NSString *restoredTaskIdentifier = [coder decodeObjectOfClass:[NSString class] forKey:ORKTaskIdentifierRestoreKey];
+    if (restoredTaskIdentifier && ! [_task.identifier isEqualToString:restoredTaskIdentifier]) {
+        @throw [NSException exceptionWithName:NSInternalInconsistencyException
+                                       reason:[NSString stringWithFormat:@"Restored task identifier %@ does not match task %@ provided", restoredTaskIdentifier, _task.identifier]
+                                     userInfo:nil];
+    }
+    
+    NSDictionary *managedResults = [coder decodeObjectOfClass:[NSDictionary class] forKey:ORKManagedResultsRestoreKey];
+    NSArray *managedStepIdentifiers = [coder decodeObjectOfClass:[NSArray class] forKey:ORKManagedStepIdentifiersRestoreKey];
+    [_managedResults addEntriesFromDictionary:managedResults];
+    for (NSString *identifier in managedStepIdentifiers) {
+        ORKStepResult *result = _managedResults[identifier];
+        if (! result) {
+            result = [[ORKStepResult alloc] initWithStepIdentifier:identifier results:@[]];
+            _managedResults[identifier] = result;
+        }
+        [_managedStepIdentifiers addObject:identifier];
+        [_stepResults addObject:result];
+        [_stepIdentifierCounts addObject:identifier];
+    }
+    
+    _presentedDate = [coder decodeObjectOfClass:[NSDate class] forKey:ORKPresentedDateRestoreKey] ? : [NSDate date];
+    
+    // Like the task view controller, resume at the saved step if the task can look it up, and otherwise at the first step.
+    ORKStep *step = nil;
+    NSString *stepIdentifier = [coder decodeObjectOfClass:[NSString class] forKey:ORKStepIdentifierRestoreKey];
+    if (stepIdentifier && [_task respondsToSelector:@selector(stepWithIdentifier:)]) {
+        step = [_task stepWithIdentifier:stepIdentifier];
+    }
+    if (! step) {
+        step = [_task stepAfterStep:nil withResult:[self result]];
+    }
+    [self moveToStep:step];
+}
+
+@end
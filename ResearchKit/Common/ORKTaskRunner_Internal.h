@@ -0,0 +1,54 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <ResearchKit/ORKTaskRunner.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ORKStep;
+
+// Keys of the restorable state of a run. Task runners and task view controllers both use them,
+// so that either can resume a run saved by the other.
+ORK_EXTERN NSString *const ORKTaskRunUUIDRestoreKey;
+ORK_EXTERN NSString *const ORKShowsProgressInNavigationBarRestoreKey;
+ORK_EXTERN NSString *const ORKManagedResultsRestoreKey;
+ORK_EXTERN NSString *const ORKManagedStepIdentifiersRestoreKey;
+ORK_EXTERN NSString *const ORKOutputDirectoryRestoreKey;
+ORK_EXTERN NSString *const ORKTaskIdentifierRestoreKey;
+ORK_EXTERN NSString *const ORKStepIdentifierRestoreKey;
+ORK_EXTERN NSString *const ORKPresentedDateRestoreKey;
+
+// Whether a run at `step` may go back to `previousStep`, the step the task returns before it.
+// A run cannot go back to an active step, nor from a step that does not allow back navigation.
+ORK_EXTERN BOOL ORKTaskRunCanGoBackward(ORKStep *step, ORKStep * _Nullable previousStep);
+
+NS_ASSUME_NONNULL_END
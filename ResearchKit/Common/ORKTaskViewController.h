@@ -408,6 +408,40 @@ ORK_CLASS_AVAILABLE
  */
 @property (nonatomic, assign) BOOL showsProgressInNavigationBar;
 
+/**
+ A Boolean value indicating whether the task view controller prepares the view controller for the
+ next step ahead of navigation.
+
+ While a step is displayed, the task view controller creates and lays out, off-screen, the view
+ controller for the step that follows it given the current results. Navigating forward then
+ presents that view controller without loading it first. The prepared view controller is discarded
+ when the results change which step comes next, and when the app receives a memory warning.
+
+ View controllers are not prepared for active steps, or when the delegate implements
+ `taskViewController:viewControllerForStep:`.
+
+ The default value of this property is `YES`.
+ */
+@property (nonatomic, assign) BOOL preparesNextStepViewController;
+
+/**
+ A Boolean value indicating whether the task view controller measures the performance of each
+ step and reports it in the step's result.
+ 
+ When the value of this property is `YES`, the `userInfo` of each step result in `result` contains
+ a dictionary of performance metrics under `ORKResultPerformanceMetricsKey`: how long the step
+ view controller took to create and to transition to, how long its recorders took to start and
+ stop, how much data they wrote and how many sensor samples they missed, and how often the main
+ thread stalled while the step was shown. Use an `ORKPerformanceMetricsAggregate` object to
+ follow these metrics across sessions.
+ 
+ Set this property before presenting the task view controller. When the value is `NO`, nothing
+ is measured.
+ 
+ The default value of this property is `NO`.
+ */
+@property (nonatomic, assign) BOOL collectsPerformanceMetrics;
+
 /**
  The current step view controller.
  
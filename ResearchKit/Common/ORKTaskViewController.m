@@ -36,10 +36,12 @@
 
 #import "ORKStepViewController.h"
 #import "ORKActiveStepViewController.h"
+#import "ORKActiveStepViewController_Internal.h"
 #import "ORKQuestionStepViewController.h"
 #import "ORKVisualConsentStepViewController.h"
 #import "ORKInstructionStepViewController_Internal.h"
 #import "ORKTaskViewController_Internal.h"
+#import "ORKTaskRunner_Internal.h"
 #import "ORKStepViewController_Internal.h"
 #import "ORKFormStepViewController.h"
 
@@ -54,9 +56,18 @@
 #import "ORKTaskViewController_Private.h"
 #import "ORKTappingIntervalStep.h"
 #import "ORKTappingIntervalStepViewController.h"
+#import "ORKContinuousRecordingSession.h"
+#import "ORKRecorder_Internal.h"
+#import "ORKClock.h"
+#import "ORKAudioSessionCoordinator.h"
+#import "ORKPerformanceMetrics.h"
+#import "ORKPerformanceMetricsCollector.h"
+#import "ORKTraceBuffer_Internal.h"
+#import "ORKCacheManager.h"
 #import <CoreMotion/CoreMotion.h>
 #import <AVFoundation/AVFoundation.h>
 #import <CoreLocation/CoreLocation.h>
+#import <QuartzCore/QuartzCore.h>
 
 
 typedef void (^_ORKLocationAuthorizationRequestHandler)(BOOL success);
@@ -158,7 +169,7 @@ static void *_ORKViewControllerToolbarObserverContext = &_ORKViewControllerToolb
 @end
 
 
-@interface ORKTaskViewController () <ORKViewControllerToolbarObserverDelegate, ORKScrollViewObserverDelegate> {
+@interface ORKTaskViewController () <ORKViewControllerToolbarObserverDelegate, ORKScrollViewObserverDelegate, ORKContinuousRecordingSessionDelegate, ORKAudioSessionClient, ORKPurgeableCache> {
     NSMutableDictionary *_managedResults;
     NSMutableArray *_managedStepIdentifiers;
     ORKViewControllerToolbarObserver *_stepViewControllerObserver;
@@ -173,12 +184,30 @@ static void *_ORKViewControllerToolbarObserverContext = &_ORKViewControllerToolb
     
     NSDate *_presentedDate;
     NSDate *_dismissedDate;
+    ORKClock *_clock; // does not need state restoration - each run has its own time base
     
     NSString *_lastBeginningInstructionStepIdentifier;
     NSString *_lastRestorableStepIdentifier;
     
     BOOL _haveAudioSession; // does not need state restoration - temporary
     
+    ORKContinuousRecordingSession *_continuousRecordingSession; // does not need state restoration - temporary
+    BOOL _finished; // does not need state restoration - temporary
+    NSMutableDictionary *_continuousRecorderResults;
+    
+    NSArray *_preparedRecorders; // does not need state restoration - temporary
+    NSString *_preparedRecordersStepIdentifier;
+    
+    ORKStepViewController *_preparedStepViewController; // does not need state restoration - temporary
+    ORKStepResult *_preparedStepSourceResult;
+    BOOL _nextStepPreparationSuspended;
+    
+    CFTimeInterval _transitionStartTime;
+    CADisplayLink *_transitionDisplayLink;
+    
+    ORKPerformanceMetricsCollector *_performanceMetricsCollector; // does not need state restoration - only created when collecting
+    NSTimeInterval _preparedStepViewControllerCreationDuration;
+    
     NSString *_restoredTaskIdentifier;
     NSString *_restoredStepIdentifier;
 }
@@ -262,6 +291,7 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     [self setTask: task];
     
     self.showsProgressInNavigationBar = YES;
+    self.preparesNextStepViewController = YES;
     
     _managedResults = [NSMutableDictionary dictionary];
     _managedStepIdentifiers = [NSMutableArray array];
@@ -276,6 +306,10 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     // Ensure taskRunUUID has non-nil valuetaskRunUUID
     (void)[self taskRunUUID];
     self.restorationClass = [ORKTaskViewController class];
+    
+    // The prepared step view controller is the first thing to go under memory pressure. It is
+    // left out of the budget, which a single full-screen view can exceed on large devices.
+    [[ORKCacheManager sharedManager] registerCache:self priority:ORKCachePriorityLow];
 
     return self;
 }
@@ -551,45 +585,56 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     });
 }
 
-- (void)startAudioPromptSessionIfNeeded {
+- (ORKAudioSessionNeeds)audioSessionNeeds {
     id<ORKTask> task = self.task;
-    if ([task isKindOfClass:[ORKOrderedTask class]]) {
-        if ([(ORKOrderedTask *)task providesBackgroundAudioPrompts]) {
-            NSError *error = nil;
-            if (! [self startAudioPromptSessionWithError:&error]) {
-                // User-visible console log message
-                ORK_Log_Oops(@"ResearchKit: failed to start audio prompt session: %@", error);
-            }
+    if (! [task isKindOfClass:[ORKOrderedTask class]]) {
+        return ORKAudioSessionNeedsNone;
+    }
+    ORKOrderedTask *orderedTask = (ORKOrderedTask *)task;
+    ORKAudioSessionNeeds needs = ORKAudioSessionNeedsNone;
+    if ([orderedTask providesBackgroundAudioPrompts]) {
+        needs |= ORKAudioSessionNeedsPrompts;
+    }
+    if ([orderedTask requestedPermissions] & ORKPermissionAudioRecording) {
+        needs |= ORKAudioSessionNeedsRecording;
+    }
+    for (ORKStep *step in orderedTask.steps) {
+        if ([step isKindOfClass:[ORKToneAudiometryStep class]] || [step isKindOfClass:[ORKToneAudiometryPracticeStep class]]) {
+            needs |= ORKAudioSessionNeedsTonePlayback;
         }
     }
+    return needs;
 }
 
-- (BOOL)startAudioPromptSessionWithError:(NSError **)errorOut {
-    NSError *error = nil;
-    AVAudioSession *session = [AVAudioSession sharedInstance];
-    BOOL success = YES;
-    // Use PlayAndRecord to avoid overwriting the category being used by
-    // recording configurations.
-    if (! [session setCategory:AVAudioSessionCategoryPlayback
-                   withOptions:0
-                         error:&error]) {
-        success = NO;
-        ORK_Log_Debug(@"Could not start audio session: %@", error);
+- (void)startAudioPromptSessionIfNeeded {
+    ORKAudioSessionNeeds needs = [self audioSessionNeeds];
+    if (needs == ORKAudioSessionNeedsNone) {
+        return;
     }
     
-    // We are setting the session active so that we can stay live to play audio
-    // in the background.
-    if (success && ! [session setActive:YES withOptions:0 error:&error]) {
-        success = NO;
-        ORK_Log_Debug(@"Could not set audio session active: %@", error);
+    // Configure the session once for everything the task plays or records, so that
+    // no step has to change the category mid-task.
+    NSError *error = nil;
+    if (! [[ORKAudioSessionCoordinator sharedCoordinator] prepareForNeeds:needs error:&error]) {
+        // User-visible console log message
+        ORK_Log_Oops(@"ResearchKit: failed to configure audio session: %@", error);
     }
+    _haveAudioSession = YES;
     
-    if (errorOut) {
-        *errorOut = error;
+    if (needs & ORKAudioSessionNeedsPrompts) {
+        if (! [self startAudioPromptSessionWithError:&error]) {
+            // User-visible console log message
+            ORK_Log_Oops(@"ResearchKit: failed to start audio prompt session: %@", error);
+        }
     }
-    
-    _haveAudioSession = _haveAudioSession || success;
-    if (_haveAudioSession) {
+}
+
+- (BOOL)startAudioPromptSessionWithError:(NSError **)errorOut {
+    // We keep the session active so that we can stay live to play audio in the background.
+    BOOL success = [[ORKAudioSessionCoordinator sharedCoordinator] beginUsingSessionForClient:self
+                                                                                      needs:ORKAudioSessionNeedsPrompts
+                                                                                      error:errorOut];
+    if (success) {
         ORK_Log_Debug(@"*** Started audio session");
     }
     return success;
@@ -597,16 +642,277 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
 
 - (void)finishAudioPromptSession {
     if (_haveAudioSession) {
-        AVAudioSession *session = [AVAudioSession sharedInstance];
-        NSError *error = nil;
-        if (! [session setActive:NO withOptions:0 error:&error]) {
-            ORK_Log_Debug(@"Could not deactivate audio session: %@", error);
-        } else {
-            ORK_Log_Debug(@"*** Finished audio session");
+        ORKAudioSessionCoordinator *coordinator = [ORKAudioSessionCoordinator sharedCoordinator];
+        [coordinator endUsingSessionForClient:self];
+        [coordinator finishPreparation];
+        _haveAudioSession = NO;
+        ORK_Log_Debug(@"*** Finished audio session");
+    }
+}
+
+- (void)updateContinuousRecordingFromStep:(ORKStep *)fromStep toStep:(ORKStep *)toStep {
+    if (! _continuousRecordingSession) {
+        id<ORKTask> task = self.task;
+        if (! [task isKindOfClass:[ORKOrderedTask class]]) {
+            return;
         }
+        NSArray *configurations = [(ORKOrderedTask *)task continuousRecorderConfigurations];
+        if (configurations.count == 0) {
+            return;
+        }
+        _continuousRecordingSession = [[ORKContinuousRecordingSession alloc] initWithConfigurations:configurations outputDirectory:self.outputDirectory];
+        _continuousRecordingSession.delegate = self;
+        _continuousRecordingSession.clock = self.clock;
+    }
+    _continuousRecordingSession.countsDroppedSamples = _collectsPerformanceMetrics;
+    
+    if (fromStep) {
+        [_continuousRecordingSession stepDidFinish:fromStep];
+    }
+    if (toStep) {
+        [_continuousRecordingSession stepWillStart:toStep];
     }
 }
 
+- (void)finishContinuousRecordingSession {
+    [_continuousRecordingSession finishWithCompletion:nil];
+}
+
+// Calls `completion` once the slices of continuous recordings are in the managed results.
+- (void)finishContinuousRecordingSessionWithCompletion:(dispatch_block_t)completion {
+    if (! _continuousRecordingSession) {
+        completion();
+        return;
+    }
+    [_continuousRecordingSession finishWithCompletion:completion];
+}
+
+// Preparing starts sensors, which then run with their samples discarded until the step starts.
+// That is only worth it when the current step leads straight into the next one.
+- (BOOL)currentStepLeadsIntoNextStep {
+    ORKStep *step = _currentStepViewController.step;
+    return ([step isKindOfClass:[ORKInstructionStep class]] || [step isKindOfClass:[ORKCountdownStep class]]);
+}
+
+// Creates and prepares the recorders of the step expected to follow the current one, so that
+// output files and sensors are ready by the time that step starts.
+- (void)prepareRecordersForNextStep {
+    ORKStep *nextStep = [self nextStep];
+    if (nextStep.identifier && [_preparedRecordersStepIdentifier isEqualToString:nextStep.identifier]) {
+        return;
+    }
+    [self discardPreparedRecorders];
+    
+    if (! [nextStep isKindOfClass:[ORKActiveStep class]] || ! self.outputDirectory || ! [self currentStepLeadsIntoNextStep]) {
+        return;
+    }
+    NSArray *configurations = [(ORKActiveStep *)nextStep recorderConfigurations];
+    if (configurations.count == 0) {
+        return;
+    }
+    
+    NSMutableArray *recorders = [NSMutableArray arrayWithCapacity:configurations.count];
+    for (ORKRecorderConfiguration *configuration in configurations) {
+        ORKRecorder *recorder = [configuration recorderForStep:nextStep outputDirectory:self.outputDirectory];
+        if (! recorder) {
+            continue;
+        }
+        recorder.configuration = configuration;
+        recorder.clock = self.clock;
+        [recorder prepare];
+        [recorders addObject:recorder];
+    }
+    _preparedRecorders = [recorders copy];
+    _preparedRecordersStepIdentifier = nextStep.identifier;
+}
+
+- (void)discardPreparedRecorders {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (ORKRecorder *recorder in _preparedRecorders) {
+        // Stopping turns the recorder's sensors off again, and moves it to a new directory,
+        // so take the prepared one first.
+        NSURL *directory = [recorder recordingDirectoryURL];
+        recorder.delegate = nil;
+        [recorder stop];
+        if (directory) {
+            [fileManager removeItemAtURL:directory error:NULL];
+        }
+    }
+    _preparedRecorders = nil;
+    _preparedRecordersStepIdentifier = nil;
+}
+
+#pragma mark - next step preparation
+
+- (void)setNeedsNextStepPreparation {
+    // Coalesce result changes, and stay out of tracking run loop modes so preparation never runs during scrolling.
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prepareViewControllerForNextStep) object:nil];
+    [self performSelector:@selector(prepareViewControllerForNextStep) withObject:nil afterDelay:0 inModes:@[NSDefaultRunLoopMode]];
+}
+
+- (BOOL)canPrepareViewControllerForStep:(ORKStep *)step {
+    return (step != nil &&
+            _preparesNextStepViewController &&
+            ! _nextStepPreparationSuspended &&
+            ! [self.delegate respondsToSelector:@selector(taskViewController:viewControllerForStep:)] &&
+            [[[step class] stepViewControllerClass] supportsPreparationBeforePresentation]);
+}
+
+// Creates and lays out, off-screen, the view controller of the step expected to follow the current one,
+// so that navigating forward does not load it during the transition. At most one view controller is kept.
+- (void)prepareViewControllerForNextStep {
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prepareViewControllerForNextStep) object:nil];
+
+    ORKStep *nextStep = _currentStepViewController ? [self nextStep] : nil;
+    if (! [self canPrepareViewControllerForStep:nextStep]) {
+        [self discardPreparedViewController];
+        return;
+    }
+    if (_preparedStepViewController && [_preparedStepViewController.step isEqual:nextStep]) {
+        return;
+    }
+    [self discardPreparedViewController];
+
+    ORKPerformanceMetricsCollector *collector = [self performanceMetricsCollector];
+    CFTimeInterval creationStartTime = collector ? CACurrentMediaTime() : 0;
+
+    ORKStepResult *sourceResult = [self sourceResultForStep:nextStep];
+    ORK_TRACE_BEGIN("navigation", "prepareViewController");
+    ORKStepViewController *stepViewController = [self instantiateViewControllerForStep:nextStep sourceResult:sourceResult];
+    // Configure it as for presentation before loading the view, so that view setup is the same on both paths.
+    stepViewController.preparedAheadOfPresentation = YES;
+    [self configureStepViewController:stepViewController forStep:nextStep];
+    UIView *view = stepViewController.view;
+    view.frame = self.pageViewController.view.bounds;
+    [view setNeedsLayout];
+    [view layoutIfNeeded];
+    ORK_TRACE_END("navigation", "prepareViewController");
+
+    _preparedStepViewControllerCreationDuration = collector ? CACurrentMediaTime() - creationStartTime : 0;
+    _preparedStepViewController = stepViewController;
+    _preparedStepSourceResult = [sourceResult copy];
+    ORK_Log_Debug(@"%@ prepared %@", self, stepViewController);
+}
+
+// Returns the prepared view controller if it was built for `step` from the same result, and so matches
+// what would be created now.
+- (ORKStepViewController *)takePreparedViewControllerForStep:(ORKStep *)step sourceResult:(ORKStepResult *)sourceResult {
+    if (! _preparedStepViewController || ! [_preparedStepViewController.step isEqual:step]) {
+        return nil;
+    }
+    ORKStepViewController *stepViewController = _preparedStepViewController;
+    BOOL upToDate = ORKEqualObjects(sourceResult, _preparedStepSourceResult);
+    [self discardPreparedViewController];
+    return upToDate ? stepViewController : nil;
+}
+
+- (void)discardPreparedViewController {
+    _preparedStepViewController = nil;
+    _preparedStepSourceResult = nil;
+    _preparedStepViewControllerCreationDuration = 0;
+}
+
+- (void)didReceiveMemoryWarning {
+    [super didReceiveMemoryWarning];
+
+    // Stop preparing for the rest of the task, rather than rebuilding what the system asked us to free.
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prepareViewControllerForNextStep) object:nil];
+    [self discardPreparedViewController];
+    _nextStepPreparationSuspended = YES;
+}
+
+#pragma mark - ORKPurgeableCache
+
+// Estimated from the backing store of the prepared view; its subviews and images are not counted.
+- (NSUInteger)cacheCost {
+    if (! _preparedStepViewController.isViewLoaded) {
+        return 0;
+    }
+    CGSize size = _preparedStepViewController.view.bounds.size;
+    CGFloat scale = [UIScreen mainScreen].scale;
+    return (NSUInteger)(size.width * scale * size.height * scale * 4);
+}
+
+- (void)purgeCache {
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(prepareViewControllerForNextStep) object:nil];
+    [self discardPreparedViewController];
+}
+
+- (BOOL)ignoresCostLimit {
+    return YES;
+}
+
+#pragma mark - transition timing
+
+- (void)startMeasuringTransition {
+    [self stopMeasuringTransition];
+    ORK_TRACE_BEGIN("navigation", "transition");
+    _transitionDisplayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(transitionDisplayLinkDidFire:)];
+    [_transitionDisplayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+- (void)stopMeasuringTransition {
+    if (_transitionDisplayLink) {
+        ORK_TRACE_END("navigation", "transition");
+    }
+    [_transitionDisplayLink invalidate];
+    _transitionDisplayLink = nil;
+}
+
+- (void)transitionDisplayLinkDidFire:(CADisplayLink *)displayLink {
+    [self stopMeasuringTransition];
+
+    // The first refresh after the transition was committed is when its first frame reaches the screen.
+    _lastTransitionTimeToFirstFrame = CACurrentMediaTime() - _transitionStartTime;
+    NSString *stepIdentifier = _currentStepViewController.step.identifier;
+    if (_performanceMetricsCollector && stepIdentifier) {
+        [_performanceMetricsCollector addValue:_lastTransitionTimeToFirstFrame forMetric:ORKPerformanceMetricTransitionDurationKey stepIdentifier:stepIdentifier];
+    }
+    ORK_Log_Debug(@"%@ time to first frame: %.1f ms (prepared: %d)", self, _lastTransitionTimeToFirstFrame * 1000.0, _lastTransitionUsedPreparedStepViewController);
+}
+
+#pragma mark - performance metrics
+
+- (void)setCollectsPerformanceMetrics:(BOOL)collectsPerformanceMetrics {
+    _collectsPerformanceMetrics = collectsPerformanceMetrics;
+    if (! collectsPerformanceMetrics) {
+        [_performanceMetricsCollector endMonitoring];
+        _performanceMetricsCollector = nil;
+    }
+}
+
+// Returns nil unless collecting, so that callers skip measuring.
+- (ORKPerformanceMetricsCollector *)performanceMetricsCollector {
+    if (_collectsPerformanceMetrics && ! _performanceMetricsCollector) {
+        _performanceMetricsCollector = [ORKPerformanceMetricsCollector new];
+    }
+    return _performanceMetricsCollector;
+}
+
+#pragma mark - ORKContinuousRecordingSessionDelegate
+
+- (void)continuousRecordingSession:(ORKContinuousRecordingSession *)session didProduceResult:(ORKFileResult *)result forStepIdentifier:(NSString *)stepIdentifier {
+    if (_continuousRecorderResults == nil) {
+        _continuousRecorderResults = [NSMutableDictionary new];
+    }
+    
+    // Replace any earlier slice from the same recorder, for instance after navigating back.
+    NSMutableArray *results = [NSMutableArray array];
+    for (ORKResult *existingResult in _continuousRecorderResults[stepIdentifier]) {
+        if (! [existingResult.identifier isEqualToString:result.identifier]) {
+            [results addObject:existingResult];
+        }
+    }
+    [results addObject:result];
+    _continuousRecorderResults[stepIdentifier] = [results copy];
+    
+    [_performanceMetricsCollector addMetricsFromRecorderResults:@[result] stepIdentifier:stepIdentifier];
+}
+
+- (void)continuousRecordingSession:(ORKContinuousRecordingSession *)session didFailWithError:(NSError *)error {
+    [self reportError:error onStep:self.currentStepViewController.step];
+}
+
 - (NSSet *)requestedHealthTypesForRead {
     return _requestedHealthTypesForRead;
 }
@@ -645,6 +951,7 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
                 [self requestHealthAuthorizationWithCompletion:nil];
             }
             
+            _transitionStartTime = CACurrentMediaTime();
             ORKStepViewController *firstViewController = [self viewControllerForStep:step];
             [self showViewController:firstViewController goForward:YES animated:animated];
             
@@ -665,6 +972,9 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
 - (void)viewDidDisappear:(BOOL)animated {
     [super viewDidDisappear:animated];
     
+    [self stopMeasuringTransition];
+    [_performanceMetricsCollector endMonitoring];
+    
     // Set endDate on TaskVC is dismissed,
     // because nextResponder is not nil when current TaskVC is covered by another modal view
     if (self.nextResponder == nil) {
@@ -694,6 +1004,17 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
         NSString *identifier = obj;
         ORKResult *result = _managedResults[identifier];
         NSAssert(result, @"Not expect result to be nil for identifier %@", identifier);
+        
+        // Slices of continuous recordings are kept apart, since the step view controller replaces its result.
+        NSArray *continuousResults = _continuousRecorderResults[identifier];
+        if ((continuousResults.count > 0 || _performanceMetricsCollector) && [result isKindOfClass:[ORKStepResult class]]) {
+            ORKStepResult *stepResult = [(ORKStepResult *)result copy];
+            if (continuousResults.count > 0) {
+                stepResult.results = [(stepResult.results ? : @[]) arrayByAddingObjectsFromArray:continuousResults];
+            }
+            [_performanceMetricsCollector attachMetricsToStepResult:stepResult];
+            result = stepResult;
+        }
         [results addObject:result];
     }];
     
@@ -723,11 +1044,20 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     return _taskRunUUID;
 }
 
+// Recorder timestamps of a task run are on this clock's time base.
+- (ORKClock *)clock {
+    if (_clock == nil) {
+        _clock = [ORKClock new];
+    }
+    return _clock;
+}
+
 - (ORKTaskResult *)result {
     
     ORKTaskResult *result = [[ORKTaskResult alloc] initWithTaskIdentifier:[self.task identifier] taskRunUUID:self.taskRunUUID outputDirectory:self.outputDirectory];
     result.startDate = _presentedDate;
     result.endDate = _dismissedDate ? :[NSDate date];
+    result.userInfo = @{ ORKResultTimeBaseKey : [self.clock timeBase] };
     
     // Update current step result
     [self setManagedResult:[self.currentStepViewController result] forKey:self.currentStepViewController.step.identifier];
@@ -738,10 +1068,12 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
 }
 
 - (NSData *)restorationData {
+    ORK_TRACE_BEGIN("serialization", "restorationData");
     NSMutableData *data = [[NSMutableData alloc] init];
     NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
     [self encodeRestorableStateWithCoder:archiver];
     [archiver finishEncoding];
+    ORK_TRACE_END_VALUE("serialization", "restorationData", data.length);
     
     return [data copy];
 }
@@ -917,9 +1249,14 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     // Switch to non-animated transition if the application is not in the foreground.
     animated = animated && ([[UIApplication sharedApplication] applicationState] == UIApplicationStateActive);
     
+    [self updateContinuousRecordingFromStep:fromController.step toStep:step];
+    
     // Update currentStepViewController now, so we don't accept additional transition requests
     // from the same VC.
     _currentStepViewController = viewController;
+    if (step.identifier) {
+        [_performanceMetricsCollector beginMonitoringStepIdentifier:step.identifier];
+    }
     
     [self.pageViewController setViewControllers:@[viewController] direction:direction animated:animated completion:^(BOOL finished) {
         __strong typeof(weakSelf) strongSelf = weakSelf;
@@ -935,7 +1272,14 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
         
         // Collect toolbarItems
         [strongSelf collectToolbarItemsFromViewController:viewController];
+        
+        if (strongSelf->_currentStepViewController == viewController) {
+            [strongSelf prepareRecordersForNextStep];
+            [strongSelf setNeedsNextStepPreparation];
+        }
     }];
+    
+    [self startMeasuringTransition];
 }
 
 - (BOOL)shouldPresentStep:(ORKStep *)step {
@@ -981,11 +1325,16 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     self.hairline.alpha = alpha;
 }
 
-- (ORKStepViewController *)viewControllerForStep:(ORKStep *)step {
-    if (step == nil) {
-        return nil;
+- (ORKStepResult *)sourceResultForStep:(ORKStep *)step {
+    ORKStepResult *result = _managedResults[step.identifier];
+    if (! result) {
+        result = [_defaultResultSource stepResultForStepIdentifier:step.identifier];
     }
-    
+    return result;
+}
+
+// Creates the view controller for a step, without attaching it to the task view controller.
+- (ORKStepViewController *)instantiateViewControllerForStep:(ORKStep *)step sourceResult:(ORKStepResult *)sourceResult {
     ORKStepViewController *stepViewController = nil;
     
     if ([self.delegate respondsToSelector:@selector(taskViewController:viewControllerForStep:)]) {
@@ -995,12 +1344,7 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     if (! stepViewController) {
         Class stepViewControllerClass = [[step class] stepViewControllerClass];
         
-        ORKStepResult *result = nil;
-        result = _managedResults[step.identifier];
-        if (! result ) {
-            result = [_defaultResultSource stepResultForStepIdentifier:step.identifier];
-        }
-        
+        ORKStepResult *result = sourceResult;
         if (! result) {
             result = [[ORKStepResult alloc] initWithIdentifier:step.identifier];
         }
@@ -1014,9 +1358,14 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
         @throw [NSException exceptionWithName:NSGenericException reason:[NSString stringWithFormat:@"View controller should be of class %@", [ORKStepViewController class]] userInfo:@{@"viewController": stepViewController}];
     }
     
+    return stepViewController;
+}
+
+// Gives a step view controller what it needs from the task view controller. Setting the output directory
+// is when an active step creates its recorders.
+- (void)configureStepViewController:(ORKStepViewController *)stepViewController forStep:(ORKStep *)step {
+    stepViewController.clock = self.clock;
     stepViewController.outputDirectory = self.outputDirectory;
-    [self setManagedResult:stepViewController.result forKey:step.identifier];
-    
     
     if (stepViewController.cancelButtonItem == nil) {
         stepViewController.cancelButtonItem = [self defaultCancelButtonItem];
@@ -1027,16 +1376,61 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
         
         stepViewController.learnMoreButtonItem = [self defaultLearnMoreButtonItem];
     }
-
+    
     stepViewController.delegate = self;
+}
+
+- (ORKStepViewController *)viewControllerForStep:(ORKStep *)step {
+    if (step == nil) {
+        return nil;
+    }
+    
+    ORK_TRACE_BEGIN("navigation", "viewControllerForStep");
+    ORKPerformanceMetricsCollector *collector = [self performanceMetricsCollector];
+    CFTimeInterval creationStartTime = collector ? CACurrentMediaTime() : 0;
+    
+    ORKStepResult *sourceResult = [self sourceResultForStep:step];
+    NSTimeInterval preparedCreationDuration = _preparedStepViewControllerCreationDuration;
+    ORKStepViewController *stepViewController = [self takePreparedViewControllerForStep:step sourceResult:sourceResult];
+    _lastTransitionUsedPreparedStepViewController = (stepViewController != nil);
+    stepViewController.preparedAheadOfPresentation = NO;
+    if (! stepViewController) {
+        stepViewController = [self instantiateViewControllerForStep:step sourceResult:sourceResult];
+        preparedCreationDuration = 0;
+    }
+    if (collector && step.identifier) {
+        // A prepared view controller was created earlier, off the navigation path; report what it cost then.
+        NSTimeInterval creationDuration = _lastTransitionUsedPreparedStepViewController ? preparedCreationDuration : CACurrentMediaTime() - creationStartTime;
+        [collector addValue:creationDuration forMetric:ORKPerformanceMetricViewControllerCreationDurationKey stepIdentifier:step.identifier];
+    }
+    if ([stepViewController isKindOfClass:[ORKActiveStepViewController class]]) {
+        [(ORKActiveStepViewController *)stepViewController setPerformanceMetricsCollector:collector];
+    }
+    
+    if ([stepViewController isKindOfClass:[ORKActiveStepViewController class]] &&
+        [_preparedRecordersStepIdentifier isEqualToString:step.identifier]) {
+        // Hand over before setting the output directory, which is when the step creates its recorders.
+        [(ORKActiveStepViewController *)stepViewController setPreparedRecorders:_preparedRecorders];
+        _preparedRecorders = nil;
+        _preparedRecordersStepIdentifier = nil;
+    }
+    
+    [self configureStepViewController:stepViewController forStep:step];
+    [self setManagedResult:stepViewController.result forKey:step.identifier];
     
     _stepViewControllerObserver = [[ORKViewControllerToolbarObserver alloc] initWithTargetViewController:stepViewController delegate:self];
+    ORK_TRACE_END("navigation", "viewControllerForStep");
     return stepViewController;
 }
 
 #pragma mark - internal action Handlers
 
 - (void)finishWithReason:(ORKTaskViewControllerFinishReason)reason error:(NSError *)error {
+    _finished = YES;
+    [self finishContinuousRecordingSession];
+    [self discardPreparedRecorders];
+    [self discardPreparedViewController];
+    [_performanceMetricsCollector endMonitoring];
 
     STRONGTYPE(self.delegate) strongDelegate = self.delegate;
     if ([strongDelegate respondsToSelector:@selector(taskViewController:didFinishWithReason:error:)]) {
@@ -1119,14 +1513,20 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
         return;
     }
     
+    ORK_TRACE_INSTANT("navigation", "goForward");
     ORKStep *step = [self nextStep];
     
     if (step == nil) {
-        if ([self.delegate respondsToSelector:@selector(taskViewController:didChangeResult:)]) {
-            [self.delegate taskViewController:self didChangeResult:[self result]];
-        }
-        [self finishAudioPromptSession];
-        [self finishWithReason:ORKTaskViewControllerFinishReasonCompleted error:nil];
+        [self finishContinuousRecordingSessionWithCompletion:^{
+            if (_finished || fromController != _currentStepViewController) {
+                return;
+            }
+            if ([self.delegate respondsToSelector:@selector(taskViewController:didChangeResult:)]) {
+                [self.delegate taskViewController:self didChangeResult:[self result]];
+            }
+            [self finishAudioPromptSession];
+            [self finishWithReason:ORKTaskViewControllerFinishReasonCompleted error:nil];
+        }];
     } else if ([self shouldPresentStep:step]) {
         ORKStepViewController *stepViewController = [self viewControllerForStep:step];
         NSAssert(stepViewController != nil, @"A non-nil step should always generate a step view controller");
@@ -1140,6 +1540,7 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
         return;
     }
     
+    ORK_TRACE_INSTANT("navigation", "goBackward");
     ORKStep *step = [self prevStep];
     ORKStepViewController *stepViewController = nil;
     
@@ -1169,7 +1570,37 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
 }
 
 - (void)stepViewController:(ORKStepViewController *)stepViewController didFinishWithNavigationDirection:(ORKStepViewControllerNavigationDirection)direction {
-    
+    _transitionStartTime = CACurrentMediaTime();
+    
+    // Recorders of an active step finish their files in the background; their results reach the
+    // stored step result through -stepViewControllerResultDidChange: once they are done. Only wait
+    // for them when the task may choose the next step from them, or is about to deliver its result.
+    ORKActiveStepViewController *activeStepViewController = ORKDynamicCast(stepViewController, ORKActiveStepViewController);
+    if (direction == ORKStepViewControllerNavigationDirectionForward && activeStepViewController &&
+        [self navigationMayDependOnResultOfStep:stepViewController.step]) {
+        [activeStepViewController waitForRecorderResultsWithCompletion:^{
+            if (stepViewController != _currentStepViewController) {
+                return;
+            }
+            [self navigateFromStepViewController:stepViewController direction:direction];
+        }];
+        return;
+    }
+    [self navigateFromStepViewController:stepViewController direction:direction];
+}
+
+// Plain ordered tasks go through their steps in order whatever the results, until the last step.
+- (BOOL)navigationMayDependOnResultOfStep:(ORKStep *)step {
+    ORKOrderedTask *orderedTask = ORKDynamicCast(self.task, ORKOrderedTask);
+    SEL selector = @selector(stepAfterStep:withResult:);
+    if (! orderedTask || [[orderedTask class] instanceMethodForSelector:selector] != [ORKOrderedTask instanceMethodForSelector:selector]) {
+        return YES;
+    }
+    ORKStep *lastStep = orderedTask.steps.lastObject;
+    return (lastStep == nil || [lastStep.identifier isEqualToString:step.identifier]);
+}
+
+- (void)navigateFromStepViewController:(ORKStepViewController *)stepViewController direction:(ORKStepViewControllerNavigationDirection)direction {
     // Add step result object
     [self setManagedResult:[stepViewController result] forKey:stepViewController.step.identifier];
     
@@ -1185,8 +1616,17 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
 }
 
 - (void)stepViewControllerResultDidChange:(ORKStepViewController *)stepViewController {
+    if (stepViewController.preparedAheadOfPresentation) {
+        // Its step has not been reached; the result is taken when it is presented.
+        return;
+    }
     [self setManagedResult:stepViewController.result forKey:stepViewController.step.identifier];
     
+    // The new answers may route to a different step; check once the changes settle.
+    if (stepViewController == _currentStepViewController) {
+        [self setNeedsNextStepPreparation];
+    }
+    
     STRONGTYPE(self.delegate) strongDelegate = self.delegate;
     if ([strongDelegate respondsToSelector:@selector(taskViewController:didChangeResult:)]) {
         [strongDelegate taskViewController:self didChangeResult: [self result]];
@@ -1198,11 +1638,7 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
     if (! thisStep) {
         return NO;
     }
-    ORKStep *previousStep = [self stepBeforeStep:thisStep];
-    if ([previousStep isKindOfClass:[ORKActiveStep class]] || ([thisStep allowsBackNavigation] == NO)) {
-        previousStep = nil; // Can't go back to an active step
-    }
-    return (previousStep != nil);
+    return ORKTaskRunCanGoBackward(thisStep, [self stepBeforeStep:thisStep]);
 }
 
 - (BOOL)stepViewControllerHasNextStep:(ORKStepViewController *)stepViewController {
@@ -1231,60 +1667,52 @@ static NSString *const _ChildNavigationControllerRestorationKey = @"childNavigat
 
 #pragma mark - UIStateRestoring
 
-static NSString *const _ORKTaskRunUUIDRestoreKey = @"taskRunUUID";
-static NSString *const _ORKShowsProgressInNavigationBarRestoreKey = @"showsProgressInNavigationBar";
-static NSString *const _ORKManagedResultsRestoreKey = @"managedResults";
-static NSString *const _ORKManagedStepIdentifiersRestoreKey = @"managedStepIdentifiers";
 static NSString *const _ORKHaveSetProgressLabelRestoreKey = @"haveSetProgressLabel";
 static NSString *const _ORKHasRequestedHealthDataRestoreKey = @"hasRequestedHealthData";
 static NSString *const _ORKRequestedHealthTypesForReadRestoreKey = @"requestedHealthTypesForRead";
 static NSString *const _ORKRequestedHealthTypesForWriteRestoreKey = @"requestedHealthTypesForWrite";
-static NSString *const _ORKOutputDirectoryRestoreKey = @"outputDirectory";
 static NSString *const _ORKLastBeginningInstructionStepIdentifierKey = @"lastBeginningInstructionStepIdentifier";
-static NSString *const _ORKTaskIdentifierRestoreKey = @"taskIdentifier";
-static NSString *const _ORKStepIdentifierRestoreKey = @"stepIdentifier";
-static NSString *const _ORKPresentedDate = @"presentedDate";
 
 - (void)encodeRestorableStateWithCoder:(NSCoder *)coder {
     [super encodeRestorableStateWithCoder:coder];
     
-    [coder encodeObject:_taskRunUUID forKey:_ORKTaskRunUUIDRestoreKey];
-    [coder encodeBool:self.showsProgressInNavigationBar forKey:_ORKShowsProgressInNavigationBarRestoreKey];
-    [coder encodeObject:_managedResults forKey:_ORKManagedResultsRestoreKey];
-    [coder encodeObject:_managedStepIdentifiers forKey:_ORKManagedStepIdentifiersRestoreKey];
+    [coder encodeObject:_taskRunUUID forKey:ORKTaskRunUUIDRestoreKey];
+    [coder encodeBool:self.showsProgressInNavigationBar forKey:ORKShowsProgressInNavigationBarRestoreKey];
+    [coder encodeObject:_managedResults forKey:ORKManagedResultsRestoreKey];
+    [coder encodeObject:_managedStepIdentifiers forKey:ORKManagedStepIdentifiersRestoreKey];
     [coder encodeBool:_haveSetProgressLabel forKey:_ORKHaveSetProgressLabelRestoreKey];
     [coder encodeObject:_requestedHealthTypesForRead forKey:_ORKRequestedHealthTypesForReadRestoreKey];
     [coder encodeObject:_requestedHealthTypesForWrite forKey:_ORKRequestedHealthTypesForWriteRestoreKey];
-    [coder encodeObject:_presentedDate forKey:_ORKPresentedDate];
-    [coder encodeObject:_outputDirectory forKey:_ORKOutputDirectoryRestoreKey];
+    [coder encodeObject:_presentedDate forKey:ORKPresentedDateRestoreKey];
+    [coder encodeObject:_outputDirectory forKey:ORKOutputDirectoryRestoreKey];
     [coder encodeObject:_lastBeginningInstructionStepIdentifier forKey:_ORKLastBeginningInstructionStepIdentifierKey];
     
-    [coder encodeObject:_task.identifier forKey:_ORKTaskIdentifierRestoreKey];
+    [coder encodeObject:_task.identifier forKey:ORKTaskIdentifierRestoreKey];
     
     ORKStep *step = [_currentStepViewController step];
     if ([step isRestorable]) {
-        [coder encodeObject:step.identifier forKey:_ORKStepIdentifierRestoreKey];
+        [coder encodeObject:step.identifier forKey:ORKStepIdentifierRestoreKey];
     } else if (_lastRestorableStepIdentifier) {
-        [coder encodeObject:_lastRestorableStepIdentifier forKey:_ORKStepIdentifierRestoreKey];
+        [coder encodeObject:_lastRestorableStepIdentifier forKey:ORKStepIdentifierRestoreKey];
     }
 }
 
 - (void)decodeRestorableStateWithCoder:(NSCoder *)coder {
     [super decodeRestorableStateWithCoder:coder];
     
-    _taskRunUUID = [coder decodeObjectOfClass:[NSUUID class] forKey:_ORKTaskRunUUIDRestoreKey];
-    self.showsProgressInNavigationBar = [coder decodeBoolForKey:_ORKShowsProgressInNavigationBarRestoreKey];
+    _taskRunUUID = [coder decodeObjectOfClass:[NSUUID class] forKey:ORKTaskRunUUIDRestoreKey];
+    self.showsProgressInNavigationBar = [coder decodeBoolForKey:ORKShowsProgressInNavigationBarRestoreKey];
     
-    _outputDirectory = [coder decodeObjectOfClass:[NSURL class] forKey:_ORKOutputDirectoryRestoreKey];
+    _outputDirectory = [coder decodeObjectOfClass:[NSURL class] forKey:ORKOutputDirectoryRestoreKey];
     
     // Must have a task object already provided by this point in the restoration, in order to restore any other state.
     if (_task) {
         
         // Recover partially entered results, even if we may not be able to jump to the desired step.
-        _managedResults = [coder decodeObjectOfClass:[NSMutableDictionary class] forKey:_ORKManagedResultsRestoreKey];
-        _managedStepIdentifiers = [coder decodeObjectOfClass:[NSMutableArray class] forKey:_ORKManagedStepIdentifiersRestoreKey];
+        _managedResults = [coder decodeObjectOfClass:[NSMutableDictionary class] forKey:ORKManagedResultsRestoreKey];
+        _managedStepIdentifiers = [coder decodeObjectOfClass:[NSMutableArray class] forKey:ORKManagedStepIdentifiersRestoreKey];
         
-        _restoredTaskIdentifier = [coder decodeObjectOfClass:[NSString class] forKey:_ORKTaskIdentifierRestoreKey];
+        _restoredTaskIdentifier = [coder decodeObjectOfClass:[NSString class] forKey:ORKTaskIdentifierRestoreKey];
         if (_restoredTaskIdentifier) {
             if (! [_task.identifier isEqualToString:_restoredTaskIdentifier]) {
                 @throw [NSException exceptionWithName:NSInternalInconsistencyException
@@ -1297,10 +1725,10 @@ static NSString *const _ORKPresentedDate = @"presentedDate";
             _haveSetProgressLabel = [coder decodeBoolForKey:_ORKHaveSetProgressLabelRestoreKey];
             _requestedHealthTypesForRead = [coder decodeObjectOfClass:[NSSet class] forKey:_ORKRequestedHealthTypesForReadRestoreKey];
             _requestedHealthTypesForWrite = [coder decodeObjectOfClass:[NSSet class] forKey:_ORKRequestedHealthTypesForWriteRestoreKey];
-            _presentedDate = [coder decodeObjectOfClass:[NSDate class] forKey:_ORKPresentedDate];
+            _presentedDate = [coder decodeObjectOfClass:[NSDate class] forKey:ORKPresentedDateRestoreKey];
             _lastBeginningInstructionStepIdentifier = [coder decodeObjectOfClass:[NSString class] forKey:_ORKLastBeginningInstructionStepIdentifierKey];
             
-            _restoredStepIdentifier = [coder decodeObjectOfClass:[NSString class] forKey:_ORKStepIdentifierRestoreKey];
+            _restoredStepIdentifier = [coder decodeObjectOfClass:[NSString class] forKey:ORKStepIdentifierRestoreKey];
     
         } else {
             ORK_Log_Debug(@"Not restoring current step of task %@ because it does not implement -stepWithIdentifier:", _task.identifier);
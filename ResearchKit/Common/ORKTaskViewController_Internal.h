@@ -43,6 +43,16 @@ NS_ASSUME_NONNULL_BEGIN
 // So taskVC can monitor scroll view's content offset and update hairline's alpha.
 @property (nonatomic, weak, nullable) UIScrollView *registeredScrollView;
 
+// View controller built ahead of time for the step expected to follow the current one.
+@property (nonatomic, strong, readonly, nullable) ORKStepViewController *preparedStepViewController;
+
+- (void)prepareViewControllerForNextStep;
+
+// Time from the navigation request to the first frame rendered after the step transition began,
+// for the most recent transition, and whether that transition used a prepared view controller.
+@property (nonatomic, readonly) NSTimeInterval lastTransitionTimeToFirstFrame;
+@property (nonatomic, readonly) BOOL lastTransitionUsedPreparedStepViewController;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -30,6 +30,7 @@
 
 
 #import "ORKTextButton.h"
+#import "ORKStyleCache.h"
 
 
 @implementation ORKTextButton
@@ -74,7 +75,7 @@
 
 - (void)updateAppearance {
     
-    self.titleLabel.font = [[self class] defaultFont];
+    self.titleLabel.font = ORKCachedDefaultFont([self class]);
     [self invalidateIntrinsicContentSize];
 
 }
@@ -32,11 +32,17 @@
 #import <Foundation/Foundation.h>
 #import <ResearchKit/ResearchKit.h>
 #import "ORKChoiceViewCell.h"
+#import "ORKCacheManager.h"
 
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface ORKTextChoiceCellGroup : NSObject
+/*
+ Cells are created on demand and kept for the lifetime of the group, since they hold the selection.
+ When purged by the cache manager, cells that are neither selected nor on screen are only held weakly,
+ so the same cell is reused for as long as the table view keeps it.
+ */
+@interface ORKTextChoiceCellGroup : NSObject <ORKPurgeableCache>
 
 - (instancetype)initWithTextChoiceAnswerFormat:(ORKTextChoiceAnswerFormat *)answerFormat
                                         answer:(nullable id)answer
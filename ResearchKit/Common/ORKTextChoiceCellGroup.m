@@ -34,6 +34,9 @@
 #import "ORKAnswerFormat_Internal.h"
 
 
+// Rough size of a choice cell with its labels and layers, for the cache manager.
+static const NSUInteger ORKTextChoiceCellEstimatedCost = 8 * 1024;
+
 @implementation ORKTextChoiceCellGroup {
     ORKChoiceAnswerFormatHelper *_helper;
     BOOL _singleChoice;
@@ -41,6 +44,7 @@
     NSIndexPath *_beginningIndexPath;
     
     NSMutableDictionary *_cells;
+    NSMapTable *_purgedCells;
 }
 
 - (instancetype)initWithTextChoiceAnswerFormat:(ORKTextChoiceAnswerFormat *)answerFormat
@@ -54,7 +58,9 @@
         _singleChoice = answerFormat.style == ORKChoiceAnswerStyleSingleChoice;
         _immediateNavigation = immediateNavigation;
         _cells = [NSMutableDictionary new];
+        _purgedCells = [NSMapTable strongToWeakObjectsMapTable];
         [self setAnswer:answer];
+        [[ORKCacheManager sharedManager] registerCache:self priority:ORKCachePriorityDefault];
     }
     return self;
 }
@@ -77,9 +83,22 @@
     return [self cellAtIndex:indexPath.row-_beginningIndexPath.row withReuseIdentifier:identifier];
 }
 
+- (ORKChoiceViewCell *)existingCellAtIndex:(NSUInteger)index {
+    return _cells[@(index)] ? : [_purgedCells objectForKey:@(index)];
+}
+
 - (ORKChoiceViewCell *)cellAtIndex:(NSUInteger)index withReuseIdentifier:(NSString *)identifier {
     ORKChoiceViewCell *cell = _cells[@(index)];
     
+    if (cell == nil) {
+        // A purged cell may still be in use by the table view; keep using it.
+        cell = [_purgedCells objectForKey:@(index)];
+        if (cell) {
+            [_purgedCells removeObjectForKey:@(index)];
+            _cells[@(index)] = cell;
+        }
+    }
+    
     if (cell == nil) {
         cell = [[ORKChoiceViewCell alloc] initWithStyle:UITableViewCellStyleDefault reuseIdentifier:identifier];
         cell.immediateNavigation = _immediateNavigation;
@@ -90,6 +109,7 @@
         _cells[@(index)] = cell;
         
         [self setSelectedIndexes:[_helper selectedIndexesForAnswer:_answer]];
+        [[ORKCacheManager sharedManager] cacheCostDidChange:self];
     }
     
     return cell;
@@ -100,7 +120,8 @@
         
     if (_singleChoice) {
         touchedCell.selectedItem = YES;
-        for (ORKChoiceViewCell *cell in [_cells allValues]) {
+        for (NSUInteger index = 0; index < self.size; index++) {
+            ORKChoiceViewCell *cell = [self existingCellAtIndex:index];
             if (cell != touchedCell) {
                 cell.selectedItem = NO;
             }
@@ -137,7 +158,7 @@
             cell.selectedItem = YES;
         } else {
             // It is ok to not create the cell at here
-            ORKChoiceViewCell *cell = _cells[@(index)];
+            ORKChoiceViewCell *cell = [self existingCellAtIndex:index];
             cell.selectedItem = NO;
         }
     }
@@ -147,7 +168,7 @@
     NSMutableArray *indexes = [NSMutableArray new];
     
     for (NSUInteger index = 0; index < self.size; index++ ) {
-        ORKChoiceViewCell *cell = _cells[@(index)];
+        ORKChoiceViewCell *cell = [self existingCellAtIndex:index];
         if (cell.selectedItem) {
             [indexes addObject:@(index)];
         }
@@ -165,4 +186,21 @@
     return _answer;
 }
 
+#pragma mark - ORKPurgeableCache
+
+- (NSUInteger)cacheCost {
+    return _cells.count * ORKTextChoiceCellEstimatedCost;
+}
+
+- (void)purgeCache {
+    // Selection is read back from the cells, so selected cells stay; so do cells on screen.
+    for (NSNumber *index in [_cells allKeys]) {
+        ORKChoiceViewCell *cell = _cells[index];
+        if (cell.selectedItem == NO && cell.window == nil) {
+            [_purgedCells setObject:cell forKey:index];
+            [_cells removeObjectForKey:index];
+        }
+    }
+}
+
 @end
@@ -31,6 +31,7 @@
 
 #import "ORKTintedImageView.h"
 #import "ORKHelpers.h"
+#import "ORKStyleCache.h"
 
 static inline BOOL ORKIsImageAnimated(UIImage *image) {
     return [[image images] count] > 1;
@@ -59,9 +60,6 @@ UIImage *ORKImageByTintingImage(UIImage *image, UIColor *tintColor, CGFloat scal
 
 @implementation ORKTintedImageView {
     UIImage *_originalImage;
-    UIImage *_tintedImage;
-    UIColor *_appliedTintColor;
-    CGFloat _appliedScaleFactor;
 }
 
 - (void)setShouldApplyTint:(BOOL)shouldApplyTint {
@@ -75,25 +73,23 @@ UIImage *ORKImageByTintingImage(UIImage *image, UIColor *tintColor, CGFloat scal
         return image;
     }
     
+    if (!ORKIsImageAnimated(image)) {
+        // Template images are tinted by UIKit, whatever the color and scale
+        return [[ORKStyleCache sharedCache] tintedImageForImage:image tintColor:nil scale:0 resolver:^UIImage *{
+            return [image imageWithRenderingMode:UIImageRenderingModeAlwaysTemplate];
+        }];
+    }
+    
     UIColor *tintColor = self.tintColor;
     CGFloat screenScale = self.window.screen.scale; // Use screen.scale; self.contentScaleFactor remains 1.0 until later
-    if ((![_appliedTintColor isEqual:tintColor] || !ORKCGFloatNearlyEqualToFloat(_appliedScaleFactor, screenScale))) {
-        _appliedTintColor = tintColor;
-        _appliedScaleFactor = screenScale;
-        
-        if (!ORKIsImageAnimated(image)) {
-            _tintedImage = [image imageWithRenderingMode:UIImageRenderingModeAlwaysTemplate];
-        } else {
-            // Manually apply the tint for animated images (template rendering mode doesn't work: <rdar://problem/19792197>)
-            NSMutableArray *images = [NSMutableArray array];
-            for (UIImage *image in image.images) {
-                [images addObject:ORKImageByTintingImage(image, tintColor, screenScale)];
-            }
-            _tintedImage = [UIImage animatedImageWithImages:images duration:image.duration];
+    return [[ORKStyleCache sharedCache] tintedImageForImage:image tintColor:tintColor scale:screenScale resolver:^UIImage *{
+        // Manually apply the tint for animated images (template rendering mode doesn't work: <rdar://problem/19792197>)
+        NSMutableArray *images = [NSMutableArray array];
+        for (UIImage *frame in image.images) {
+            [images addObject:ORKImageByTintingImage(frame, tintColor, screenScale)];
         }
-        
-    }
-    return _tintedImage;
+        return [UIImage animatedImageWithImages:images duration:image.duration];
+    }];
 }
 
 - (void)setImage:(UIImage *)image {
@@ -0,0 +1,116 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import <ResearchKit/ORKDefines.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ An `ORKTraceBuffer` object records timed events in a fixed-size ring buffer, for diagnosing
+ performance problems on devices that cannot be attached to Instruments.
+ 
+ When the shared buffer is enabled, ResearchKit records events for data logger appends,
+ rollovers, file syncs and directory scans, motion sample delivery, recorder start and stop,
+ step transitions, and serialization. When the buffer is full, the oldest events are
+ overwritten.
+ 
+ Export the buffer in the Chrome trace event format, which can be opened in
+ `chrome://tracing` or other trace viewers. Timestamps are system uptimes in microseconds,
+ so they can be matched with the uptimes recorded in results.
+ 
+ This class is thread safe.
+ */
+ORK_CLASS_AVAILABLE
+@interface ORKTraceBuffer : NSObject
+
+/**
+ Returns the buffer into which ResearchKit records its events.
+ 
+ The shared buffer is disabled until you enable it. While it is disabled, recording an event
+ costs a single check.
+ */
++ (ORKTraceBuffer *)sharedBuffer;
+
+/// Returns a disabled buffer with the default capacity of 16384 events.
+- (instancetype)init;
+
+/**
+ Returns a disabled buffer.
+ 
+ @param capacity    The number of events retained. Must be greater than zero.
+ 
+ @return A trace buffer.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/// The number of events retained.
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ A Boolean value indicating whether the buffer records events.
+ 
+ The default value of this property is `NO`.
+ */
+@property (atomic, assign, getter=isEnabled) BOOL enabled;
+
+/// The number of events currently in the buffer.
+@property (nonatomic, readonly) NSUInteger eventCount;
+
+/// The number of events overwritten because the buffer was full, since the buffer was last cleared.
+@property (nonatomic, readonly) NSUInteger overwrittenEventCount;
+
+/// Removes all events from the buffer.
+- (void)removeAllEvents;
+
+/**
+ Returns the events in the buffer as a Chrome trace JSON object.
+ 
+ @param error   On failure, the error that occurred.
+ 
+ @return UTF-8 encoded JSON data, or `nil` on failure.
+ */
+- (nullable NSData *)chromeTraceDataWithError:(NSError * __autoreleasing *)error;
+
+/**
+ Writes the events in the buffer to a file as a Chrome trace JSON object.
+ 
+ @param url     The file URL to write to.
+ @param error   On failure, the error that occurred.
+ 
+ @return `YES` if the file was written; otherwise, `NO`.
+ */
+- (BOOL)writeChromeTraceToURL:(NSURL *)url error:(NSError * __autoreleasing *)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
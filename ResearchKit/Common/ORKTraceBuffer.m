@@ -0,0 +1,231 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import "ORKTraceBuffer.h"
+#import "ORKTraceBuffer_Internal.h"
+#include <mach/mach_time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+
+static const NSUInteger ORKTraceBufferDefaultCapacity = 16384;
+
+volatile BOOL ORKTracingEnabled = NO;
+
+typedef struct {
+    const char *category;
+    const char *name;
+    uint64_t machTime;
+    uint64_t threadID;
+    int64_t value;
+    ORKTraceEventPhase phase;
+} ORKTraceEvent;
+
+static ORKTraceBuffer *ORKSharedTraceBuffer = nil;
+
+static double ORKMachTimeToMicroseconds(uint64_t machTime) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (double)machTime * timebase.numer / timebase.denom / 1000.0;
+}
+
+void ORKTraceRecordEvent(ORKTraceEventPhase phase, const char *category, const char *name, int64_t value) {
+    [ORKSharedTraceBuffer recordEventWithPhase:phase category:category name:name value:value];
+}
+
+
+@implementation ORKTraceBuffer {
+    pthread_mutex_t _lock;
+    ORKTraceEvent *_events;
+    NSUInteger _nextIndex;
+    NSUInteger _eventCount;
+    NSUInteger _overwrittenEventCount;
+    uint64_t _mainThreadID;
+    BOOL _enabled;
+}
+
++ (ORKTraceBuffer *)sharedBuffer {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        ORKSharedTraceBuffer = [ORKTraceBuffer new];
+    });
+    return ORKSharedTraceBuffer;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:ORKTraceBufferDefaultCapacity];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    if (capacity == 0) {
+        @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Capacity must be greater than zero" userInfo:nil];
+    }
+    self = [super init];
+    if (self) {
+        _capacity = capacity;
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_events);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (BOOL)isEnabled {
+    pthread_mutex_lock(&_lock);
+    BOOL enabled = _enabled;
+    pthread_mutex_unlock(&_lock);
+    return enabled;
+}
+
+- (void)setEnabled:(BOOL)enabled {
+    pthread_mutex_lock(&_lock);
+    if (enabled && ! _events) {
+        // Allocated on first use, so an unused buffer costs nothing.
+        _events = calloc(_capacity, sizeof(ORKTraceEvent));
+    }
+    _enabled = enabled && (_events != NULL);
+    BOOL isEnabled = _enabled;
+    pthread_mutex_unlock(&_lock);
+    
+    if (self == ORKSharedTraceBuffer) {
+        ORKTracingEnabled = isEnabled;
+    }
+}
+
+- (void)recordEventWithPhase:(ORKTraceEventPhase)phase category:(const char *)category name:(const char *)name value:(int64_t)value {
+    uint64_t machTime = mach_absolute_time();
+    uint64_t threadID = 0;
+    pthread_threadid_np(NULL, &threadID);
+    BOOL isMainThread = pthread_main_np();
+    
+    pthread_mutex_lock(&_lock);
+    if (_enabled) {
+        if (isMainThread) {
+            _mainThreadID = threadID;
+        }
+        _events[_nextIndex] = (ORKTraceEvent){
+            .category = category,
+            .name = name,
+            .machTime = machTime,
+            .threadID = threadID,
+            .value = value,
+            .phase = phase
+        };
+        _nextIndex = (_nextIndex + 1) % _capacity;
+        if (_eventCount < _capacity) {
+            _eventCount++;
+        } else {
+            _overwrittenEventCount++;
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+- (NSUInteger)eventCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger eventCount = _eventCount;
+    pthread_mutex_unlock(&_lock);
+    return eventCount;
+}
+
+- (NSUInteger)overwrittenEventCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger overwrittenEventCount = _overwrittenEventCount;
+    pthread_mutex_unlock(&_lock);
+    return overwrittenEventCount;
+}
+
+- (void)removeAllEvents {
+    pthread_mutex_lock(&_lock);
+    _nextIndex = 0;
+    _eventCount = 0;
+    _overwrittenEventCount = 0;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (NSData *)chromeTraceDataWithError:(NSError * __autoreleasing *)error {
+    // Copy out under the lock; formatting happens without blocking recording threads.
+    pthread_mutex_lock(&_lock);
+    NSUInteger eventCount = _eventCount;
+    NSUInteger overwrittenEventCount = _overwrittenEventCount;
+    uint64_t mainThreadID = _mainThreadID;
+    ORKTraceEvent *events = eventCount > 0 ? malloc(eventCount * sizeof(ORKTraceEvent)) : NULL;
+    NSUInteger firstIndex = (_nextIndex + _capacity - eventCount) % _capacity;
+    for (NSUInteger i = 0; i < eventCount; i++) {
+        events[i] = _events[(firstIndex + i) % _capacity];
+    }
+    pthread_mutex_unlock(&_lock);
+    
+    NSNumber *processID = @(getpid());
+    NSMutableArray *traceEvents = [NSMutableArray arrayWithCapacity:eventCount + 2];
+    [traceEvents addObject:@{@"name": @"process_name", @"ph": @"M", @"pid": processID, @"tid": @0,
+                             @"args": @{@"name": [NSProcessInfo processInfo].processName ? : @""}}];
+    if (mainThreadID != 0) {
+        [traceEvents addObject:@{@"name": @"thread_name", @"ph": @"M", @"pid": processID, @"tid": @(mainThreadID),
+                                 @"args": @{@"name": @"main"}}];
+    }
+    
+    for (NSUInteger i = 0; i < eventCount; i++) {
+        ORKTraceEvent *event = &events[i];
+        NSMutableDictionary *traceEvent = [@{@"name": [NSString stringWithUTF8String:event->name] ? : @"",
+                                             @"cat": [NSString stringWithUTF8String:event->category] ? : @"",
+                                             @"ph": [NSString stringWithFormat:@"%c", event->phase],
+                                             @"ts": @(ORKMachTimeToMicroseconds(event->machTime)),
+                                             @"pid": processID,
+                                             @"tid": @(event->threadID)} mutableCopy];
+        if (event->phase == ORKTraceEventPhaseInstant) {
+            traceEvent[@"s"] = @"t";
+        }
+        if (event->value != 0) {
+            traceEvent[@"args"] = @{@"value": @(event->value)};
+        }
+        [traceEvents addObject:traceEvent];
+    }
+    free(events);
+    
+    NSDictionary *trace = @{@"traceEvents": traceEvents,
+                            @"displayTimeUnit": @"ms",
+                            @"otherData": @{@"overwrittenEventCount": @(overwrittenEventCount)}};
+    return [NSJSONSerialization dataWithJSONObject:trace options:(NSJSONWritingOptions)0 error:error];
+}
+
+- (BOOL)writeChromeTraceToURL:(NSURL *)url error:(NSError * __autoreleasing *)error {
+    NSData *data = [self chromeTraceDataWithError:error];
+    return data && [data writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+@end
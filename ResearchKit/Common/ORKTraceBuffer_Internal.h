@@ -0,0 +1,69 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <ResearchKit/ORKTraceBuffer.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Chrome trace event phases.
+typedef NS_ENUM(char, ORKTraceEventPhase) {
+    ORKTraceEventPhaseBegin = 'B',
+    ORKTraceEventPhaseEnd = 'E',
+    ORKTraceEventPhaseInstant = 'i'
+};
+
+@interface ORKTraceBuffer ()
+
+/*
+ Records an event on the calling thread, if the buffer is enabled.
+ 
+ `category` and `name` are not copied and must be string literals. A begin event and its end event
+ must be recorded on the same thread.
+ */
+- (void)recordEventWithPhase:(ORKTraceEventPhase)phase category:(const char *)category name:(const char *)name value:(int64_t)value;
+
+@end
+
+// Mirrors the shared buffer's `enabled`, so that disabled tracing costs one load.
+ORK_EXTERN volatile BOOL ORKTracingEnabled;
+
+ORK_EXTERN void ORKTraceRecordEvent(ORKTraceEventPhase phase, const char *category, const char *name, int64_t value);
+
+#define ORK_TRACE_EVENT(phase, category, name, value) \
+    do { if (__builtin_expect(ORKTracingEnabled, 0)) { ORKTraceRecordEvent((phase), (category), (name), (value)); } } while (0)
+
+#define ORK_TRACE_BEGIN(category, name)             ORK_TRACE_EVENT(ORKTraceEventPhaseBegin, category, name, 0)
+#define ORK_TRACE_END(category, name)               ORK_TRACE_EVENT(ORKTraceEventPhaseEnd, category, name, 0)
+#define ORK_TRACE_END_VALUE(category, name, value)  ORK_TRACE_EVENT(ORKTraceEventPhaseEnd, category, name, (int64_t)(value))
+#define ORK_TRACE_INSTANT(category, name)           ORK_TRACE_EVENT(ORKTraceEventPhaseInstant, category, name, 0)
+
+NS_ASSUME_NONNULL_END
@@ -46,6 +46,12 @@
 
 #import <ResearchKit/ORKResult.h>
 #import <ResearchKit/ORKResultPredicate.h>
+#import <ResearchKit/ORKResultStore.h>
+#import <ResearchKit/ORKResultConditionEvaluator.h>
+#import <ResearchKit/ORKTaskRunner.h>
+#import <ResearchKit/ORKPerformanceMetrics.h>
+#import <ResearchKit/ORKTraceBuffer.h>
+#import <ResearchKit/ORKCacheManager.h>
 
 #import <ResearchKit/ORKTaskViewController.h>
 #import <ResearchKit/ORKStepViewController.h>
@@ -0,0 +1,131 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import <ResearchKit/ResearchKit.h>
+#import <malloc/malloc.h>
+#import "ORKAnswerFormat_Internal.h"
+#import "ORKHelpers.h"
+
+
+@interface ORKAnswerFormatTests : XCTestCase
+
+@end
+
+
+@implementation ORKAnswerFormatTests
+
+- (NSString *)decimalSeparator {
+    return ORKDecimalNumberFormatter().decimalSeparator;
+}
+
+- (void)testParseDecimalStringMatchesDecimalNumber {
+    NSString *separator = [self decimalSeparator];
+    NSArray *texts = @[@"0", @"42", @"-7",
+                       [NSString stringWithFormat:@"3%@25", separator],
+                       [NSString stringWithFormat:@"%@5", separator],
+                       [NSString stringWithFormat:@"5%@", separator],
+                       [NSString stringWithFormat:@"1%@2%@3", separator, separator],
+                       @"1e3", @"2E-2", @"1e", @"12abc", @"0x10"];
+    for (NSString *text in texts) {
+        double value = 0;
+        XCTAssertTrue(ORKParseDecimalString(text, &value), @"%@", text);
+        double expected = [[NSDecimalNumber decimalNumberWithString:text locale:[NSLocale currentLocale]] doubleValue];
+        XCTAssertEqualWithAccuracy(value, expected, fabs(expected) * 1e-15, @"%@", text);
+    }
+    
+    for (NSString *text in @[@"", @"-", @"abc", separator, @"e5", @"inf", @"nan"]) {
+        double value = 0;
+        XCTAssertFalse(ORKParseDecimalString(text, &value), @"%@", text);
+        XCTAssertTrue(isnan([[NSDecimalNumber decimalNumberWithString:text locale:[NSLocale currentLocale]] doubleValue]), @"%@", text);
+    }
+}
+
+- (void)testNumericAnswerValidation {
+    ORKNumericAnswerFormat *answerFormat = [[ORKNumericAnswerFormat alloc] initWithStyle:ORKNumericAnswerStyleDecimal unit:nil minimum:@(-1.5) maximum:@(10)];
+    NSString *separator = [self decimalSeparator];
+    
+    XCTAssertTrue([answerFormat isAnswerValidWithString:@"10"]);
+    XCTAssertTrue([answerFormat isAnswerValidWithString:[NSString stringWithFormat:@"-1%@5", separator]]);
+    XCTAssertFalse([answerFormat isAnswerValidWithString:[NSString stringWithFormat:@"10%@01", separator]]);
+    XCTAssertFalse([answerFormat isAnswerValidWithString:@"-2"]);
+    XCTAssertFalse([answerFormat isAnswerValidWithString:@""]);
+    XCTAssertFalse([answerFormat isAnswerValidWithString:@"abc"]);
+    XCTAssertNotNil([answerFormat localizedInvalidValueStringWithAnswerString:@"11"]);
+    
+    // Bounds follow the properties, and survive copying and archiving.
+    answerFormat.maximum = nil;
+    XCTAssertTrue([answerFormat isAnswerValidWithString:@"1000000"]);
+    answerFormat.minimum = @(0);
+    XCTAssertFalse([answerFormat isAnswerValidWithString:@"-1"]);
+    
+    ORKNumericAnswerFormat *copy = [answerFormat copy];
+    XCTAssertFalse([copy isAnswerValidWithString:@"-1"]);
+    XCTAssertTrue([copy isAnswerValidWithString:@"1000000"]);
+    
+    NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:[NSKeyedArchiver archivedDataWithRootObject:answerFormat]];
+    unarchiver.requiresSecureCoding = YES;
+    ORKNumericAnswerFormat *decoded = [unarchiver decodeObjectOfClass:[ORKNumericAnswerFormat class] forKey:NSKeyedArchiveRootObjectKey];
+    XCTAssertEqualObjects(decoded, answerFormat);
+    XCTAssertFalse([decoded isAnswerValidWithString:@"-1"]);
+    XCTAssertTrue([decoded isAnswerValidWithString:@"1000000"]);
+}
+
+// Keystroke validation should not allocate; allow a little slack for the first call's caches.
+- (void)testNumericAnswerValidationDoesNotAllocate {
+    ORKNumericAnswerFormat *answerFormat = [[ORKNumericAnswerFormat alloc] initWithStyle:ORKNumericAnswerStyleDecimal unit:nil minimum:@(0) maximum:@(100)];
+    NSString *text = [NSString stringWithFormat:@"42%@5", [self decimalSeparator]];
+    XCTAssertTrue([answerFormat isAnswerValidWithString:text]);
+    
+    const NSInteger iterations = 10000;
+    malloc_statistics_t before, after;
+    @autoreleasepool {
+        malloc_zone_statistics(NULL, &before);
+        for (NSInteger i = 0; i < iterations; i++) {
+            [answerFormat isAnswerValidWithString:text];
+        }
+        malloc_zone_statistics(NULL, &after);
+    }
+    XCTAssertLessThan((NSInteger)after.blocks_in_use - (NSInteger)before.blocks_in_use, 16);
+}
+
+- (void)testNumericAnswerValidationPerformance {
+    ORKNumericAnswerFormat *answerFormat = [[ORKNumericAnswerFormat alloc] initWithStyle:ORKNumericAnswerStyleDecimal unit:nil minimum:@(0) maximum:@(100)];
+    NSString *text = [NSString stringWithFormat:@"42%@5", [self decimalSeparator]];
+    
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 100000; i++) {
+            [answerFormat isAnswerValidWithString:text];
+        }
+    }];
+}
+
+@end
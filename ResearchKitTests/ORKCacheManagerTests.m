@@ -0,0 +1,202 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import <ResearchKit/ResearchKit.h>
+
+
+@interface ORKMockPurgeableCache : NSObject <ORKPurgeableCache>
+
+- (instancetype)initWithName:(NSString *)name cost:(NSUInteger)cost purgeLog:(NSMutableArray *)purgeLog;
+
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, assign) NSUInteger cost;
+@property (nonatomic, assign) BOOL ignoresCostLimit;
+
+@end
+
+
+@implementation ORKMockPurgeableCache {
+    NSMutableArray *_purgeLog;
+}
+
+- (instancetype)initWithName:(NSString *)name cost:(NSUInteger)cost purgeLog:(NSMutableArray *)purgeLog {
+    self = [super init];
+    if (self) {
+        _name = [name copy];
+        _cost = cost;
+        _purgeLog = purgeLog;
+    }
+    return self;
+}
+
+- (NSUInteger)cacheCost {
+    return _cost;
+}
+
+- (void)purgeCache {
+    _cost = 0;
+    [_purgeLog addObject:_name];
+}
+
+@end
+
+
+@interface ORKCacheManagerTests : XCTestCase
+
+@end
+
+
+@implementation ORKCacheManagerTests
+
+- (void)testTotalCost {
+    ORKCacheManager *manager = [[ORKCacheManager alloc] initWithTotalCostLimit:0];
+    ORKMockPurgeableCache *cache1 = [[ORKMockPurgeableCache alloc] initWithName:@"1" cost:100 purgeLog:nil];
+    ORKMockPurgeableCache *cache2 = [[ORKMockPurgeableCache alloc] initWithName:@"2" cost:50 purgeLog:nil];
+    
+    [manager registerCache:cache1 priority:ORKCachePriorityDefault];
+    [manager registerCache:cache2 priority:ORKCachePriorityLow];
+    XCTAssertEqual(manager.totalCost, 150);
+    
+    [manager unregisterCache:cache2];
+    XCTAssertEqual(manager.totalCost, 100);
+}
+
+- (void)testCachesAreNotRetained {
+    ORKCacheManager *manager = [[ORKCacheManager alloc] initWithTotalCostLimit:0];
+    __weak ORKMockPurgeableCache *weakCache = nil;
+    @autoreleasepool {
+        ORKMockPurgeableCache *cache = [[ORKMockPurgeableCache alloc] initWithName:@"1" cost:100 purgeLog:nil];
+        weakCache = cache;
+        [manager registerCache:cache priority:ORKCachePriorityDefault];
+    }
+    XCTAssertNil(weakCache);
+    XCTAssertEqual(manager.totalCost, 0);
+}
+
+- (void)testBudgetPurgesByPriorityThenCost {
+    NSMutableArray *purgeLog = [NSMutableArray array];
+    ORKCacheManager *manager = [[ORKCacheManager alloc] initWithTotalCostLimit:1000];
+    ORKMockPurgeableCache *high = [[ORKMockPurgeableCache alloc] initWithName:@"high" cost:400 purgeLog:purgeLog];
+    ORKMockPurgeableCache *defaultLarge = [[ORKMockPurgeableCache alloc] initWithName:@"defaultLarge" cost:300 purgeLog:purgeLog];
+    ORKMockPurgeableCache *defaultSmall = [[ORKMockPurgeableCache alloc] initWithName:@"defaultSmall" cost:100 purgeLog:purgeLog];
+    ORKMockPurgeableCache *low = [[ORKMockPurgeableCache alloc] initWithName:@"low" cost:100 purgeLog:purgeLog];
+    
+    [manager registerCache:high priority:ORKCachePriorityHigh];
+    [manager registerCache:defaultSmall priority:ORKCachePriorityDefault];
+    [manager registerCache:defaultLarge priority:ORKCachePriorityDefault];
+    [manager registerCache:low priority:ORKCachePriorityLow];
+    XCTAssertEqual(purgeLog.count, 0);
+    
+    // 1300 over a budget of 1000: the low priority cache goes first, then the largest default one.
+    defaultSmall.cost = 500;
+    [manager cacheCostDidChange:defaultSmall];
+    NSArray *expectedPurges = @[@"low", @"defaultSmall"];
+    XCTAssertEqualObjects(purgeLog, expectedPurges);
+    XCTAssertEqual(manager.totalCost, 700);
+    XCTAssertEqual(manager.purgeCount, 2);
+}
+
+- (void)testLoweringBudgetPurges {
+    NSMutableArray *purgeLog = [NSMutableArray array];
+    ORKCacheManager *manager = [[ORKCacheManager alloc] initWithTotalCostLimit:0];
+    ORKMockPurgeableCache *cache1 = [[ORKMockPurgeableCache alloc] initWithName:@"1" cost:100 purgeLog:purgeLog];
+    ORKMockPurgeableCache *cache2 = [[ORKMockPurgeableCache alloc] initWithName:@"2" cost:200 purgeLog:purgeLog];
+    [manager registerCache:cache1 priority:ORKCachePriorityDefault];
+    [manager registerCache:cache2 priority:ORKCachePriorityDefault];
+    
+    manager.totalCostLimit = 150;
+    NSArray *expectedPurges = @[@"2"];
+    XCTAssertEqualObjects(purgeLog, expectedPurges);
+    XCTAssertEqual(manager.totalCost, 100);
+}
+
+- (void)testCachesIgnoringCostLimitArePurgedOnlyUnderMemoryPressure {
+    NSMutableArray *purgeLog = [NSMutableArray array];
+    ORKCacheManager *manager = [[ORKCacheManager alloc] initWithTotalCostLimit:1000];
+    ORKMockPurgeableCache *large = [[ORKMockPurgeableCache alloc] initWithName:@"large" cost:5000 purgeLog:purgeLog];
+    large.ignoresCostLimit = YES;
+    ORKMockPurgeableCache *small = [[ORKMockPurgeableCache alloc] initWithName:@"small" cost:100 purgeLog:purgeLog];
+    [manager registerCache:large priority:ORKCachePriorityLow];
+    [manager registerCache:small priority:ORKCachePriorityDefault];
+    
+    // Neither its own report nor the budget being exceeded by others purges it.
+    [manager cacheCostDidChange:large];
+    small.cost = 1500;
+    [manager cacheCostDidChange:small];
+    NSArray *expectedPurges = @[@"small"];
+    XCTAssertEqualObjects(purgeLog, expectedPurges);
+    XCTAssertEqual(manager.totalCost, 5000);
+    
+    [manager handleMemoryPressure:ORKMemoryPressureLevelWarning];
+    expectedPurges = @[@"small", @"large"];
+    XCTAssertEqualObjects(purgeLog, expectedPurges);
+}
+
+- (void)testMemoryPressureWarning {
+    NSMutableArray *purgeLog = [NSMutableArray array];
+    ORKCacheManager *manager = [[ORKCacheManager alloc] initWithTotalCostLimit:1000];
+    ORKMockPurgeableCache *high = [[ORKMockPurgeableCache alloc] initWithName:@"high" cost:400 purgeLog:purgeLog];
+    ORKMockPurgeableCache *low = [[ORKMockPurgeableCache alloc] initWithName:@"low" cost:100 purgeLog:purgeLog];
+    ORKMockPurgeableCache *empty = [[ORKMockPurgeableCache alloc] initWithName:@"empty" cost:0 purgeLog:purgeLog];
+    [manager registerCache:high priority:ORKCachePriorityHigh];
+    [manager registerCache:low priority:ORKCachePriorityLow];
+    [manager registerCache:empty priority:ORKCachePriorityLow];
+    
+    // High priority caches survive a warning while within half the budget.
+    [manager handleMemoryPressure:ORKMemoryPressureLevelWarning];
+    NSArray *expectedPurges = @[@"low"];
+    XCTAssertEqualObjects(purgeLog, expectedPurges);
+    XCTAssertEqual(manager.totalCost, 400);
+    
+    // ...but not when over it.
+    high.cost = 600;
+    [manager handleMemoryPressure:ORKMemoryPressureLevelWarning];
+    expectedPurges = @[@"low", @"high"];
+    XCTAssertEqualObjects(purgeLog, expectedPurges);
+    XCTAssertEqual(manager.totalCost, 0);
+}
+
+- (void)testMemoryPressureCritical {
+    NSMutableArray *purgeLog = [NSMutableArray array];
+    ORKCacheManager *manager = [[ORKCacheManager alloc] initWithTotalCostLimit:0];
+    ORKMockPurgeableCache *high = [[ORKMockPurgeableCache alloc] initWithName:@"high" cost:400 purgeLog:purgeLog];
+    ORKMockPurgeableCache *low = [[ORKMockPurgeableCache alloc] initWithName:@"low" cost:100 purgeLog:purgeLog];
+    [manager registerCache:high priority:ORKCachePriorityHigh];
+    [manager registerCache:low priority:ORKCachePriorityLow];
+    
+    [manager handleMemoryPressure:ORKMemoryPressureLevelCritical];
+    NSArray *expectedPurges = @[@"low", @"high"];
+    XCTAssertEqualObjects(purgeLog, expectedPurges);
+    XCTAssertEqual(manager.totalCost, 0);
+}
+
+@end
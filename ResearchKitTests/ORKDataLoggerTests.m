@@ -323,6 +323,30 @@
     XCTAssertEqual([_finishedLogFiles count], 0);
 }
 
+- (void)testFinishCurrentLogReportsFinishedFile {
+    [self logJsonObject:@{@"test" : @(1)}];
+    NSError *error = nil;
+    NSURL *fileUrl = [_dataLogger finishCurrentLogWithError:&error];
+    XCTAssertNil(error);
+    XCTAssertNotNil(fileUrl);
+    XCTAssertNil([_dataLogger finishCurrentLogWithError:&error], @"Nothing left to finish");
+    
+    [self logJsonObject:@{@"test" : @(2)}];
+    __block NSURL *asyncFileUrl = nil;
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [_dataLogger finishCurrentLogWithCompletion:^(NSURL *finishedUrl, NSError *finishError) {
+        XCTAssertNil(finishError);
+        asyncFileUrl = finishedUrl;
+        dispatch_semaphore_signal(semaphore);
+    }];
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    XCTAssertNotNil(asyncFileUrl);
+    XCTAssertNotEqualObjects(fileUrl, asyncFileUrl);
+    
+    [self wait];
+    XCTAssertEqualObjects(_finishedLogFiles, (@[fileUrl, asyncFileUrl]));
+}
+
 - (void)testExplicitRolloverWithZeroLengthFile {
     XCTAssertNil([_dataLogger fileHandle]);
     NSDictionary *jsonObject = @{};
@@ -0,0 +1,157 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import <ResearchKit/ResearchKit.h>
+#import "ORKPerformanceMetricsCollector.h"
+
+
+@interface ORKPerformanceMetricsTests : XCTestCase
+
+@end
+
+
+@implementation ORKPerformanceMetricsTests
+
+- (ORKTaskResult *)taskResultWithTransitionDurations:(NSArray *)durations {
+    NSMutableArray *stepResults = [NSMutableArray array];
+    [durations enumerateObjectsUsingBlock:^(NSNumber *duration, NSUInteger idx, BOOL *stop) {
+        ORKStepResult *stepResult = [[ORKStepResult alloc] initWithStepIdentifier:[NSString stringWithFormat:@"step%lu", (unsigned long)idx] results:nil];
+        stepResult.userInfo = @{ORKResultPerformanceMetricsKey: @{ORKPerformanceMetricTransitionDurationKey: duration}};
+        [stepResults addObject:stepResult];
+    }];
+    ORKTaskResult *taskResult = [[ORKTaskResult alloc] initWithTaskIdentifier:@"task" taskRunUUID:[NSUUID UUID] outputDirectory:nil];
+    taskResult.results = stepResults;
+    return taskResult;
+}
+
+- (void)testAggregateStatistics {
+    ORKPerformanceMetricsAggregate *aggregate = [ORKPerformanceMetricsAggregate new];
+    [aggregate addTaskResult:[self taskResultWithTransitionDurations:@[@0.1, @0.2]]];
+    [aggregate addTaskResult:[self taskResultWithTransitionDurations:@[@0.3, @0.6]]];
+    
+    // Results without metrics do not count as sessions.
+    ORKTaskResult *emptyResult = [[ORKTaskResult alloc] initWithTaskIdentifier:@"task" taskRunUUID:[NSUUID UUID] outputDirectory:nil];
+    emptyResult.results = @[[[ORKStepResult alloc] initWithStepIdentifier:@"step0" results:nil]];
+    [aggregate addTaskResult:emptyResult];
+    XCTAssertEqual(aggregate.taskResultCount, 2);
+    
+    ORKPerformanceMetricStatistics *step0 = [aggregate statisticsForMetric:ORKPerformanceMetricTransitionDurationKey taskIdentifier:@"task" stepIdentifier:@"step0"];
+    XCTAssertEqual(step0.count, 2);
+    XCTAssertEqualWithAccuracy(step0.minimum, 0.1, 1e-9);
+    XCTAssertEqualWithAccuracy(step0.maximum, 0.3, 1e-9);
+    XCTAssertEqualWithAccuracy(step0.mean, 0.2, 1e-9);
+    XCTAssertEqualWithAccuracy(step0.standardDeviation, 0.1, 1e-9);
+    
+    ORKPerformanceMetricStatistics *allSteps = [aggregate statisticsForMetric:ORKPerformanceMetricTransitionDurationKey taskIdentifier:@"task" stepIdentifier:nil];
+    XCTAssertEqual(allSteps.count, 4);
+    XCTAssertEqualWithAccuracy(allSteps.mean, 0.3, 1e-9);
+    XCTAssertEqualWithAccuracy(allSteps.maximum, 0.6, 1e-9);
+    
+    XCTAssertNil([aggregate statisticsForMetric:ORKPerformanceMetricBytesWrittenKey taskIdentifier:@"task" stepIdentifier:nil]);
+    XCTAssertNil([aggregate statisticsForMetric:ORKPerformanceMetricTransitionDurationKey taskIdentifier:@"other" stepIdentifier:nil]);
+}
+
+- (void)testAggregateSecureCoding {
+    ORKPerformanceMetricsAggregate *aggregate = [ORKPerformanceMetricsAggregate new];
+    [aggregate addTaskResult:[self taskResultWithTransitionDurations:@[@0.1, @0.2, @0.4]]];
+    
+    NSData *data = [NSKeyedArchiver archivedDataWithRootObject:aggregate];
+    NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+    unarchiver.requiresSecureCoding = YES;
+    ORKPerformanceMetricsAggregate *decoded = [unarchiver decodeObjectOfClass:[ORKPerformanceMetricsAggregate class] forKey:NSKeyedArchiveRootObjectKey];
+    XCTAssertEqualObjects(decoded, aggregate);
+    XCTAssertEqualObjects([decoded copy], aggregate);
+    
+    // A restored aggregate keeps accumulating.
+    [decoded addTaskResult:[self taskResultWithTransitionDurations:@[@0.3]]];
+    XCTAssertEqual(decoded.taskResultCount, 2);
+    XCTAssertEqual([decoded statisticsForMetric:ORKPerformanceMetricTransitionDurationKey taskIdentifier:@"task" stepIdentifier:@"step0"].count, 2);
+}
+
+- (void)testCollectorCountsMainThreadStalls {
+    ORKPerformanceMetricsCollector *collector = [ORKPerformanceMetricsCollector new];
+    [collector beginMonitoringStepIdentifier:@"step"];
+    
+    CFTimeInterval timestamp = 100.0;
+    for (NSInteger i = 0; i < 60; i++) {
+        timestamp += (i == 20 || i == 40) ? 0.25 : 1.0 / 60;
+        [collector displayDidRefreshAtTime:timestamp];
+    }
+    [collector endMonitoring];
+    [collector displayDidRefreshAtTime:timestamp + 1.0];
+    
+    NSDictionary *metrics = [collector metricsForStepIdentifier:@"step"];
+    XCTAssertEqualObjects(metrics[ORKPerformanceMetricMainThreadStallCountKey], @2);
+    XCTAssertEqualWithAccuracy([metrics[ORKPerformanceMetricLongestMainThreadStallKey] doubleValue], 0.25, 1e-9);
+}
+
+- (void)testCollectorAttachesMetricsToStepResult {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertTrue([[NSData dataWithBytes:"0123456789" length:10] writeToFile:path atomically:YES]);
+    
+    ORKFileResult *fileResult = [[ORKFileResult alloc] initWithIdentifier:@"accelerometer"];
+    fileResult.fileURL = [NSURL fileURLWithPath:path];
+    fileResult.userInfo = @{ORKRecorderStartLatencyKey: @0.05, ORKRecorderDroppedSampleCountKey: @3};
+    ORKFileResult *otherFileResult = [[ORKFileResult alloc] initWithIdentifier:@"deviceMotion"];
+    otherFileResult.userInfo = @{ORKRecorderStartLatencyKey: @0.08, ORKRecorderDroppedSampleCountKey: @1};
+    ORKStepResult *stepResult = [[ORKStepResult alloc] initWithStepIdentifier:@"step" results:@[fileResult, otherFileResult]];
+    stepResult.userInfo = @{@"custom": @YES};
+    
+    ORKPerformanceMetricsCollector *collector = [ORKPerformanceMetricsCollector new];
+    [collector addValue:0.02 forMetric:ORKPerformanceMetricViewControllerCreationDurationKey stepIdentifier:@"step"];
+    [collector addValue:0.01 forMetric:ORKPerformanceMetricViewControllerCreationDurationKey stepIdentifier:@"step"];
+    [collector addMetricsFromRecorderResults:@[fileResult, otherFileResult] stepIdentifier:@"step"];
+    
+    // File sizes are read when the results come in, not each time metrics are attached.
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    [collector attachMetricsToStepResult:stepResult];
+    
+    NSDictionary *metrics = stepResult.userInfo[ORKResultPerformanceMetricsKey];
+    XCTAssertEqualObjects(stepResult.userInfo[@"custom"], @YES);
+    XCTAssertEqualWithAccuracy([metrics[ORKPerformanceMetricViewControllerCreationDurationKey] doubleValue], 0.03, 1e-9);
+    XCTAssertEqualObjects(metrics[ORKPerformanceMetricRecorderStartLatencyKey], @0.08);
+    XCTAssertEqualObjects(metrics[ORKPerformanceMetricDroppedSampleCountKey], @4);
+    XCTAssertEqualObjects(metrics[ORKPerformanceMetricBytesWrittenKey], @10);
+    
+    // Nothing to report leaves the result alone.
+    ORKStepResult *plainResult = [[ORKStepResult alloc] initWithStepIdentifier:@"plain" results:nil];
+    [collector attachMetricsToStepResult:plainResult];
+    XCTAssertNil(plainResult.userInfo);
+}
+
+- (void)testTaskViewControllerDoesNotCollectByDefault {
+    ORKOrderedTask *task = [[ORKOrderedTask alloc] initWithIdentifier:@"task" steps:@[[[ORKInstructionStep alloc] initWithIdentifier:@"intro"]]];
+    ORKTaskViewController *taskViewController = [[ORKTaskViewController alloc] initWithTask:task taskRunUUID:[NSUUID UUID]];
+    XCTAssertFalse(taskViewController.collectsPerformanceMetrics);
+}
+
+@end
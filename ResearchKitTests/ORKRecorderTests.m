@@ -39,6 +39,16 @@
 #import "ORKTouchRecorder.h"
 #import "ORKAudioRecorder.h"
 #import "ORKHealthQuantityTypeRecorder.h"
+#import "ORKMotionHub.h"
+#import "ORKMotionThresholdDetector.h"
+#import "ORKContinuousRecordingSession.h"
+#import "ORKClock.h"
+#import "ORKStimulusScheduler.h"
+#import "ORKAudioSessionCoordinator.h"
+#import "ORKVoiceActivityDetector.h"
+#import "ORKPhonationAnalyzer.h"
+#import "ORKAudioCapturePipeline.h"
+#import "ORKRandomNumberGenerator.h"
 #import <CoreMotion/CoreMotion.h>
 #import "ORKHelpers.h"
 #import "ORKRecorder_Internal.h"
@@ -101,6 +111,8 @@
 
 - (void)injectAccelerometerData:(CMAccelerometerData *)accelerometerData;
 
+@property (nonatomic, readonly) BOOL receivesAccelerometerUpdates;
+
 @end
 
 
@@ -127,6 +139,15 @@
     [super startAccelerometerUpdatesToQueue:queue withHandler:handler];
 }
 
+- (void)stopAccelerometerUpdates {
+    _accelerometerHandler = nil;
+    [super stopAccelerometerUpdates];
+}
+
+- (BOOL)receivesAccelerometerUpdates {
+    return (_accelerometerHandler != nil);
+}
+
 - (BOOL)isAccelerometerAvailable {
     return YES;
 }
@@ -180,6 +201,27 @@
 @end
 
 
+@interface ORKMockAccelerometerRecorderConfiguration : ORKAccelerometerRecorderConfiguration
+
+@property (nonatomic, strong) ORKMockMotionManager* mockManager;
+
+@end
+
+
+@implementation ORKMockAccelerometerRecorderConfiguration
+
+- (ORKRecorder *)recorderForStep:(ORKStep *)step outputDirectory:(NSURL *)outputDirectory {
+    ORKMockAccelerometerRecorder *recorder = [[ORKMockAccelerometerRecorder alloc] initWithIdentifier:self.identifier
+                                                                                           frequency:self.frequency
+                                                                                                step:step
+                                                                                     outputDirectory:outputDirectory];
+    recorder.mockManager = _mockManager;
+    return recorder;
+}
+
+@end
+
+
 @interface ORKMockAccelerometerData : CMAccelerometerData
 
 @end
@@ -198,6 +240,32 @@
 @end
 
 
+@interface ORKMockTimestampedAccelerometerData : ORKMockAccelerometerData
+
+- (instancetype)initWithTimestamp:(NSTimeInterval)timestamp;
+
+@end
+
+
+@implementation ORKMockTimestampedAccelerometerData {
+    NSTimeInterval _timestamp;
+}
+
+- (instancetype)initWithTimestamp:(NSTimeInterval)timestamp {
+    self = [super init];
+    if (self) {
+        _timestamp = timestamp;
+    }
+    return self;
+}
+
+- (NSTimeInterval)timestamp {
+    return _timestamp;
+}
+
+@end
+
+
 @interface ORKMockPedometerRecorder : ORKPedometerRecorder
 
 @property (nonatomic, strong) ORKMockPedometer* mockPedometer;
@@ -312,6 +380,201 @@
 @end
 
 
+@interface ORKMockMotionSampleSource : NSObject <ORKMotionSampleSource>
+
+@property (nonatomic) NSInteger startCount;
+
+@property (nonatomic) NSInteger stopCount;
+
+@property (nonatomic) NSTimeInterval updateInterval;
+
+- (void)injectSample:(CMLogItem *)sample forSensor:(ORKMotionSensor)sensor;
+
+@end
+
+
+@implementation ORKMockMotionSampleSource {
+    NSMutableDictionary *_handlers;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _handlers = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)injectSample:(CMLogItem *)sample forSensor:(ORKMotionSensor)sensor {
+    ORKMotionSampleHandler handler = _handlers[@(sensor)];
+    if (handler) {
+        handler(sample, nil);
+    }
+}
+
+- (BOOL)isSensorAvailable:(ORKMotionSensor)sensor {
+    return (sensor == ORKMotionSensorAccelerometer);
+}
+
+- (void)startSensor:(ORKMotionSensor)sensor updateInterval:(NSTimeInterval)updateInterval queue:(NSOperationQueue *)queue handler:(ORKMotionSampleHandler)handler {
+    _startCount++;
+    _updateInterval = updateInterval;
+    _handlers[@(sensor)] = [handler copy];
+}
+
+- (void)setUpdateInterval:(NSTimeInterval)updateInterval forSensor:(ORKMotionSensor)sensor {
+    _updateInterval = updateInterval;
+}
+
+- (void)stopSensor:(ORKMotionSensor)sensor {
+    _stopCount++;
+    [_handlers removeObjectForKey:@(sensor)];
+}
+
+@end
+
+
+
+@interface ORKMockClock : ORKClock
+
+@property (nonatomic) NSTimeInterval uptime;
+
+@end
+
+
+@implementation ORKMockClock
+
+- (NSTimeInterval)currentUptime {
+    return _uptime;
+}
+
+@end
+
+
+@interface ORKMockDisplayClock : NSObject <ORKDisplayClock>
+
+@property (nonatomic, readonly, getter=isRunning) BOOL running;
+
+@property (nonatomic, readonly) NSInteger startCount;
+
+- (void)tickWithTimestamp:(CFTimeInterval)timestamp frameDuration:(CFTimeInterval)frameDuration;
+
+@end
+
+
+@implementation ORKMockDisplayClock {
+    ORKDisplayClockHandler _handler;
+}
+
+- (void)startWithHandler:(ORKDisplayClockHandler)handler {
+    _handler = [handler copy];
+    _running = YES;
+    _startCount++;
+}
+
+- (void)stop {
+    _handler = nil;
+    _running = NO;
+}
+
+- (void)tickWithTimestamp:(CFTimeInterval)timestamp frameDuration:(CFTimeInterval)frameDuration {
+    ORKDisplayClockHandler handler = _handler;
+    if (handler) {
+        handler(timestamp, frameDuration);
+    }
+}
+
+@end
+
+
+@interface ORKMockAudioSession : NSObject <ORKAudioSession>
+
+@property (nonatomic, copy) NSString *category;
+
+@property (nonatomic) AVAudioSessionCategoryOptions categoryOptions;
+
+@property (nonatomic) BOOL active;
+
+@property (nonatomic) double preferredSampleRate;
+
+@property (nonatomic) NSTimeInterval preferredIOBufferDuration;
+
+@property (nonatomic) NSInteger setCategoryCount;
+
+@property (nonatomic) NSInteger activationCount;
+
+@end
+
+
+@implementation ORKMockAudioSession
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _category = AVAudioSessionCategorySoloAmbient;
+    }
+    return self;
+}
+
+- (BOOL)setCategory:(NSString *)category withOptions:(AVAudioSessionCategoryOptions)options error:(NSError * __autoreleasing *)outError {
+    _category = [category copy];
+    _categoryOptions = options;
+    _setCategoryCount++;
+    return YES;
+}
+
+- (BOOL)setActive:(BOOL)active withOptions:(AVAudioSessionSetActiveOptions)options error:(NSError * __autoreleasing *)outError {
+    if (active && ! _active) {
+        _activationCount++;
+    }
+    _active = active;
+    return YES;
+}
+
+- (BOOL)setPreferredSampleRate:(double)sampleRate error:(NSError * __autoreleasing *)outError {
+    _preferredSampleRate = sampleRate;
+    return YES;
+}
+
+- (BOOL)setPreferredIOBufferDuration:(NSTimeInterval)duration error:(NSError * __autoreleasing *)outError {
+    _preferredIOBufferDuration = duration;
+    return YES;
+}
+
+@end
+
+
+@interface ORKMockAudioSessionClient : NSObject <ORKAudioSessionClient>
+
+@property (nonatomic) NSInteger interruptionBeginCount;
+
+@property (nonatomic) NSInteger interruptionEndCount;
+
+@property (nonatomic) BOOL shouldResume;
+
+@property (nonatomic) NSInteger routeChangeCount;
+
+@end
+
+
+@implementation ORKMockAudioSessionClient
+
+- (void)audioSessionCoordinatorInterruptionDidBegin:(ORKAudioSessionCoordinator *)coordinator {
+    _interruptionBeginCount++;
+}
+
+- (void)audioSessionCoordinator:(ORKAudioSessionCoordinator *)coordinator interruptionDidEndShouldResume:(BOOL)shouldResume {
+    _interruptionEndCount++;
+    _shouldResume = shouldResume;
+}
+
+- (void)audioSessionCoordinator:(ORKAudioSessionCoordinator *)coordinator routeDidChangeWithReason:(AVAudioSessionRouteChangeReason)reason {
+    _routeChangeCount++;
+}
+
+@end
+
+
 static BOOL ork_doubleEqual(double x, double y) {
     static double K = 1;
     return (fabs(x-y) < K * DBL_EPSILON * fabs(x+y) || fabs(x-y) < DBL_MIN);
@@ -320,7 +583,7 @@ static BOOL ork_doubleEqual(double x, double y) {
 #pragma mark - ORKRecorderTests
 #pragma mark -
 
-@interface ORKRecorderTests : XCTestCase <ORKRecorderDelegate>
+@interface ORKRecorderTests : XCTestCase <ORKRecorderDelegate, ORKContinuousRecordingSessionDelegate>
 
 @end
 
@@ -330,6 +593,7 @@ static BOOL ork_doubleEqual(double x, double y) {
     ORKRecorder *_recorder;
     ORKResult *_result;
     NSArray   *_items;
+    NSMutableDictionary *_sliceResults;
 }
 
 static const NSInteger kNumberOfSamples = 5;
@@ -370,6 +634,14 @@ static const NSInteger kNumberOfSamples = 5;
     _result = nil;
 }
 
+- (void)continuousRecordingSession:(ORKContinuousRecordingSession *)session didProduceResult:(ORKFileResult *)result forStepIdentifier:(NSString *)stepIdentifier {
+    _sliceResults[stepIdentifier] = result;
+}
+
+- (void)continuousRecordingSession:(ORKContinuousRecordingSession *)session didFailWithError:(NSError *)error {
+    NSLog(@"didFailWithError: %@", error);
+}
+
 - (ORKRecorder *)createRecorder:(ORKRecorderConfiguration *)recorderConfiguration {
     ORKRecorder *recorder = [recorderConfiguration recorderForStep:[[ORKStep alloc] initWithIdentifier:@"step"]
                                                    outputDirectory:[NSURL fileURLWithPath:_outputPath]];
@@ -479,6 +751,137 @@ static const NSInteger kNumberOfSamples = 5;
     }
 }
 
+- (void)testAccelerometerRecorderStopWithCompletion {
+    ORKMockAccelerometerRecorder *recorder = [[ORKMockAccelerometerRecorder alloc] initWithIdentifier:@"accelerometer"
+                                                                                           frequency:60.0
+                                                                                                step:[[ORKStep alloc] initWithIdentifier:@"step"]
+                                                                                     outputDirectory:[NSURL fileURLWithPath:_outputPath]];
+    recorder.delegate = self;
+    ORKMockMotionManager *manager = [ORKMockMotionManager new];
+    recorder.mockManager = manager;
+    
+    [recorder start];
+    ORKMockAccelerometerData *data = [ORKMockAccelerometerData new];
+    for (NSInteger i = 0; i < kNumberOfSamples; i++) {
+        [manager injectAccelerometerData:data];
+    }
+    
+    __block ORKResult *completionResult = nil;
+    __block BOOL completed = NO;
+    [recorder stopWithCompletion:^(ORKResult *result, NSError *error) {
+        XCTAssertNil(error);
+        completionResult = result;
+        completed = YES;
+    }];
+    XCTAssertFalse(recorder.isRecording);
+    
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (! completed && [timeout timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    XCTAssertTrue(completed);
+    XCTAssertNil(_result, @"Result goes to the completion, not the delegate");
+    
+    _recorder = recorder;
+    _result = completionResult;
+    [self checkResult];
+}
+
+- (void)testAccelerometerRecorderPrepare {
+    ORKMockAccelerometerRecorder *recorder = [[ORKMockAccelerometerRecorder alloc] initWithIdentifier:@"accelerometer"
+                                                                                           frequency:60.0
+                                                                                                step:[[ORKStep alloc] initWithIdentifier:@"step"]
+                                                                                     outputDirectory:[NSURL fileURLWithPath:_outputPath]];
+    recorder.delegate = self;
+    ORKMockMotionManager *manager = [ORKMockMotionManager new];
+    recorder.mockManager = manager;
+    
+    [recorder prepare];
+    XCTAssertFalse(recorder.isRecording);
+    
+    // The sensor is delivering already, but samples before -start are discarded.
+    XCTAssertTrue(manager.receivesAccelerometerUpdates);
+    ORKMockAccelerometerData *data = [ORKMockAccelerometerData new];
+    for (NSInteger i = 0; i < kNumberOfSamples; i++) {
+        [manager injectAccelerometerData:data];
+    }
+    
+    [recorder start];
+    XCTAssertTrue(recorder.isRecording);
+    for (NSInteger i = 0; i < kNumberOfSamples; i++) {
+        [manager injectAccelerometerData:data];
+    }
+    
+    [recorder stop];
+    [self checkResult];
+    
+    NSNumber *startLatency = _result.userInfo[ORKRecorderStartLatencyKey];
+    XCTAssertNotNil(startLatency);
+    XCTAssertGreaterThanOrEqual(startLatency.doubleValue, 0);
+    XCTAssertEqualObjects(_result.userInfo[@"frequency"], @(60.0));
+}
+
+- (void)testAccelerometerRecorderStopsSensorWhenDiscarded {
+    ORKMockAccelerometerRecorder *recorder = [[ORKMockAccelerometerRecorder alloc] initWithIdentifier:@"accelerometer"
+                                                                                           frequency:60.0
+                                                                                                step:[[ORKStep alloc] initWithIdentifier:@"step"]
+                                                                                     outputDirectory:[NSURL fileURLWithPath:_outputPath]];
+    ORKMockMotionManager *manager = [ORKMockMotionManager new];
+    recorder.mockManager = manager;
+    
+    [recorder prepare];
+    XCTAssertTrue(manager.receivesAccelerometerUpdates);
+    
+    // A prepared recorder that is never started is discarded by stopping it.
+    [recorder stop];
+    XCTAssertFalse(recorder.isRecording);
+    XCTAssertFalse(manager.receivesAccelerometerUpdates);
+}
+
+- (void)testClockConversion {
+    NSDate *anchorDate = [NSDate dateWithTimeIntervalSince1970:1000];
+    ORKMockClock *clock = [[ORKMockClock alloc] initWithAnchorUptime:100 anchorDate:anchorDate];
+    
+    XCTAssertEqualWithAccuracy([[clock dateForUptime:130.5] timeIntervalSince1970], 1030.5, 1e-9);
+    XCTAssertEqualWithAccuracy([[clock dateForUptime:40] timeIntervalSince1970], 940, 1e-9);
+    XCTAssertEqualWithAccuracy([clock uptimeForDate:[NSDate dateWithTimeIntervalSince1970:1050]], 150, 1e-9);
+    XCTAssertEqualWithAccuracy([clock uptimeForDate:[clock dateForUptime:123.25]], 123.25, 1e-9);
+    
+    NSDictionary *timeBase = [clock timeBase];
+    XCTAssertEqualObjects(timeBase[ORKTimeBaseUptimeKey], @(100));
+    XCTAssertEqualObjects(timeBase[ORKTimeBaseTimeIntervalSince1970Key], @(1000));
+}
+
+- (void)testRecorderUsesClock {
+    ORKMockAccelerometerRecorder *recorder = [[ORKMockAccelerometerRecorder alloc] initWithIdentifier:@"accelerometer"
+                                                                                           frequency:60.0
+                                                                                                step:[[ORKStep alloc] initWithIdentifier:@"step"]
+                                                                                     outputDirectory:[NSURL fileURLWithPath:_outputPath]];
+    recorder.delegate = self;
+    ORKMockMotionManager *manager = [ORKMockMotionManager new];
+    recorder.mockManager = manager;
+    
+    ORKMockClock *clock = [[ORKMockClock alloc] initWithAnchorUptime:100 anchorDate:[NSDate dateWithTimeIntervalSince1970:1000]];
+    clock.uptime = 250;
+    recorder.clock = clock;
+    
+    [recorder start];
+    clock.uptime = 250.5;
+    ORKMockAccelerometerData *data = [ORKMockAccelerometerData new];
+    for (NSInteger i = 0; i < kNumberOfSamples; i++) {
+        [manager injectAccelerometerData:data];
+    }
+    clock.uptime = 260;
+    [recorder stop];
+    [self checkResult];
+    
+    // Dates stay on the wall clock; only the time base and uptimes come from the clock.
+    XCTAssertEqualWithAccuracy([_result.startDate timeIntervalSinceNow], 0, 60);
+    XCTAssertEqualWithAccuracy([_result.endDate timeIntervalSinceNow], 0, 60);
+    XCTAssertEqualObjects(_result.userInfo[ORKResultTimeBaseKey], [clock timeBase]);
+    XCTAssertEqualWithAccuracy([_result.userInfo[ORKRecorderStartLatencyKey] doubleValue], 0.5, 1e-9);
+}
+
 - (void)testDeviceMotionRecorder {
     
     ORKDeviceMotionRecorderConfiguration *recorderConfiguration = [[ORKDeviceMotionRecorderConfiguration alloc] initWithIdentifier:@"deviceMotion" frequency:60.0];
@@ -620,4 +1023,625 @@ static const NSInteger kNumberOfSamples = 5;
     XCTAssertTrue([recorder isKindOfClass:recorderClass], @"");
 }
 
+- (void)testMotionHubFanOutAndDecimation {
+    ORKMockMotionSampleSource *source = [ORKMockMotionSampleSource new];
+    ORKMotionHub *hub = [[ORKMotionHub alloc] initWithSampleSource:source];
+    
+    __block NSInteger fullRateCount = 0;
+    __block NSInteger halfRateCount = 0;
+    __block NSInteger thirdRateCount = 0;
+    ORKMotionHubSubscription *full = [hub subscribeToSensor:ORKMotionSensorAccelerometer frequency:100 handler:^(CMLogItem *sample, NSError *error) {
+        fullRateCount++;
+    } error:NULL];
+    ORKMotionHubSubscription *half = [hub subscribeToSensor:ORKMotionSensorAccelerometer frequency:50 handler:^(CMLogItem *sample, NSError *error) {
+        halfRateCount++;
+    } error:NULL];
+    ORKMotionHubSubscription *third = [hub subscribeToSensor:ORKMotionSensorAccelerometer frequency:100.0 / 3 handler:^(CMLogItem *sample, NSError *error) {
+        thirdRateCount++;
+    } error:NULL];
+    
+    // One sensor activation shared by all subscribers, at the highest rate requested.
+    XCTAssertEqual(source.startCount, 1);
+    XCTAssertTrue(ork_doubleEqual(source.updateInterval, 0.01));
+    XCTAssertTrue([hub isSensorActive:ORKMotionSensorAccelerometer]);
+    
+    ORKMockAccelerometerData *data = [ORKMockAccelerometerData new];
+    for (NSInteger i = 0; i < 300; i++) {
+        [source injectSample:data forSensor:ORKMotionSensorAccelerometer];
+    }
+    XCTAssertEqual(fullRateCount, 300);
+    XCTAssertEqual(halfRateCount, 150);
+    XCTAssertEqual(thirdRateCount, 100);
+    
+    [hub removeSubscription:full];
+    XCTAssertEqual(source.stopCount, 0);
+    XCTAssertTrue(ork_doubleEqual(source.updateInterval, 0.02));
+    
+    [hub removeSubscription:half];
+    [hub removeSubscription:third];
+    XCTAssertEqual(source.stopCount, 1);
+    XCTAssertFalse([hub isSensorActive:ORKMotionSensorAccelerometer]);
+    
+    [source injectSample:data forSensor:ORKMotionSensorAccelerometer];
+    XCTAssertEqual(halfRateCount, 150);
+}
+
+- (void)testMotionHubCountsDroppedSamples {
+    ORKMockMotionSampleSource *source = [ORKMockMotionSampleSource new];
+    ORKMotionHub *hub = [[ORKMotionHub alloc] initWithSampleSource:source];
+    
+    ORKMotionHubSubscription *full = [hub subscribeToSensor:ORKMotionSensorAccelerometer frequency:100 handler:^(CMLogItem *sample, NSError *error) {
+    } error:NULL];
+    ORKMotionHubSubscription *half = [hub subscribeToSensor:ORKMotionSensorAccelerometer frequency:50 handler:^(CMLogItem *sample, NSError *error) {
+    } error:NULL];
+    ORKMotionHubSubscription *uncounted = [hub subscribeToSensor:ORKMotionSensorAccelerometer frequency:100 handler:^(CMLogItem *sample, NSError *error) {
+    } error:NULL];
+    XCTAssertFalse(uncounted.countsDroppedSamples);
+    full.countsDroppedSamples = YES;
+    half.countsDroppedSamples = YES;
+    
+    // 100 samples at 100 Hz, with four samples missing after the 50th.
+    NSTimeInterval timestamp = 10.0;
+    for (NSInteger i = 0; i < 100; i++) {
+        timestamp += (i == 50) ? 0.05 : 0.01;
+        [source injectSample:[[ORKMockTimestampedAccelerometerData alloc] initWithTimestamp:timestamp] forSensor:ORKMotionSensorAccelerometer];
+    }
+    XCTAssertEqual(full.droppedSampleCount, 4);
+    XCTAssertEqual(half.droppedSampleCount, 2);
+    XCTAssertEqual(uncounted.droppedSampleCount, 0);
+    
+    // Jitter within the tolerance is not a drop.
+    [source injectSample:[[ORKMockTimestampedAccelerometerData alloc] initWithTimestamp:timestamp + 0.014] forSensor:ORKMotionSensorAccelerometer];
+    XCTAssertEqual(full.droppedSampleCount, 4);
+    
+    [hub removeSubscription:full];
+    [hub removeSubscription:half];
+    [hub removeSubscription:uncounted];
+}
+
+- (void)testMotionHubUnavailableSensor {
+    ORKMockMotionSampleSource *source = [ORKMockMotionSampleSource new];
+    ORKMotionHub *hub = [[ORKMotionHub alloc] initWithSampleSource:source];
+    
+    NSError *error = nil;
+    ORKMotionHubSubscription *subscription = [hub subscribeToSensor:ORKMotionSensorDeviceMotion frequency:60 handler:^(CMLogItem *sample, NSError *error) {
+    } error:&error];
+    XCTAssertNil(subscription);
+    XCTAssertEqual(error.code, NSFeatureUnsupportedError);
+    XCTAssertEqual(source.startCount, 0);
+}
+
+- (void)testMotionThresholdDetector {
+    ORKMotionThresholdDetector *detector = [[ORKMotionThresholdDetector alloc] initWithThreshold:0.5 sampleInterval:0.01];
+    
+    // Magnitude ramps 0.0, 0.2, 0.4, 0.8: the threshold is crossed a quarter of the way into the last interval.
+    XCTAssertNil([detector processAcceleration:(CMAcceleration){0, 0, 0} timestamp:10.00]);
+    XCTAssertNil([detector processAcceleration:(CMAcceleration){0.2, 0, 0} timestamp:10.01]);
+    XCTAssertNil([detector processAcceleration:(CMAcceleration){0, 0.4, 0} timestamp:10.02]);
+    ORKMotionThresholdDetection *detection = [detector processAcceleration:(CMAcceleration){0, 0, -0.8} timestamp:10.03];
+    XCTAssertNotNil(detection);
+    XCTAssertTrue(detector.detected);
+    XCTAssertEqualWithAccuracy(detection.crossingUptime, 10.0225, 1e-9);
+    XCTAssertEqualWithAccuracy(detection.uncertainty, 0.0075, 1e-9);
+    
+    // Detection latches until reset.
+    XCTAssertNil([detector processAcceleration:(CMAcceleration){1, 1, 1} timestamp:10.04]);
+    
+    // Without a sample below the threshold, the crossing is bounded by the nominal interval.
+    [detector reset];
+    XCTAssertFalse(detector.detected);
+    detection = [detector processAcceleration:(CMAcceleration){0.6, 0, 0} timestamp:20.0];
+    XCTAssertEqualWithAccuracy(detection.crossingUptime, 19.995, 1e-9);
+    XCTAssertEqualWithAccuracy(detection.uncertainty, 0.005, 1e-9);
+    
+    // A magnitude exactly at the threshold does not count as exceeding it.
+    [detector reset];
+    XCTAssertNil([detector processAcceleration:(CMAcceleration){0.5, 0, 0} timestamp:30.0]);
+    XCTAssertFalse(detector.detected);
+}
+
+- (void)testStimulusScheduler {
+    ORKMockDisplayClock *clock = [ORKMockDisplayClock new];
+    ORKStimulusScheduler *scheduler = [[ORKStimulusScheduler alloc] initWithDisplayClock:clock];
+    XCTAssertFalse(clock.running);
+    
+    NSMutableArray *fired = [NSMutableArray array];
+    NSMutableArray *presentationTimes = [NSMutableArray array];
+    void (^schedule)(NSString *, CFTimeInterval) = ^(NSString *name, CFTimeInterval time) {
+        [scheduler scheduleStimulusAtTime:time handler:^(CFTimeInterval presentationTime, CFTimeInterval frameDuration) {
+            [fired addObject:name];
+            [presentationTimes addObject:@(presentationTime)];
+        }];
+    };
+    
+    schedule(@"b", 0.4);
+    schedule(@"a1", 0.3);
+    schedule(@"past", 0.1);
+    schedule(@"a2", 0.3);
+    XCTAssertTrue(clock.running);
+    XCTAssertEqual(scheduler.pendingStimulusCount, 4);
+    
+    // A refresh at 0 presents at 0.25; everything nearer to 0.25 than to 0.5 belongs to it, in time order.
+    [clock tickWithTimestamp:0 frameDuration:0.25];
+    XCTAssertEqualObjects(fired, (@[@"past", @"a1", @"a2"]));
+    XCTAssertEqualObjects(presentationTimes, (@[@0.25, @0.25, @0.25]));
+    XCTAssertTrue(clock.running);
+    
+    [clock tickWithTimestamp:0.25 frameDuration:0.25];
+    XCTAssertEqualObjects(fired.lastObject, @"b");
+    XCTAssertEqualObjects(presentationTimes.lastObject, @0.5);
+    
+    // The clock only runs while stimuli are pending.
+    XCTAssertEqual(scheduler.pendingStimulusCount, 0);
+    XCTAssertFalse(clock.running);
+    XCTAssertEqual(clock.startCount, 1);
+    
+    // A stimulus whose time has passed runs on the next refresh.
+    schedule(@"late", 0.1);
+    XCTAssertTrue(clock.running);
+    [clock tickWithTimestamp:1.0 frameDuration:0.25];
+    XCTAssertEqualObjects(fired.lastObject, @"late");
+    XCTAssertEqualObjects(presentationTimes.lastObject, @1.25);
+    
+    schedule(@"cancelled", 2.0);
+    [scheduler cancelAllStimuli];
+    XCTAssertFalse(clock.running);
+    XCTAssertEqual(scheduler.pendingStimulusCount, 0);
+    [clock tickWithTimestamp:2.0 frameDuration:0.25];
+    XCTAssertEqual(fired.count, 5);
+}
+
+- (void)testAudioSessionConfigurationPolicy {
+    XCTAssertNil([ORKAudioSessionConfiguration configurationForNeeds:ORKAudioSessionNeedsNone]);
+    
+    ORKAudioSessionConfiguration *prompts = [ORKAudioSessionConfiguration configurationForNeeds:ORKAudioSessionNeedsPrompts];
+    XCTAssertEqualObjects(prompts.category, AVAudioSessionCategoryPlayback);
+    XCTAssertEqual(prompts.preferredIOBufferDuration, 0);
+    XCTAssertTrue([prompts satisfiesNeeds:ORKAudioSessionNeedsPrompts]);
+    XCTAssertFalse([prompts satisfiesNeeds:ORKAudioSessionNeedsRecording]);
+    
+    // Same category, but tones ask for a low-latency buffer.
+    XCTAssertFalse([prompts satisfiesNeeds:ORKAudioSessionNeedsTonePlayback]);
+    ORKAudioSessionConfiguration *tones = [ORKAudioSessionConfiguration configurationForNeeds:ORKAudioSessionNeedsTonePlayback];
+    XCTAssertEqualObjects(tones.category, prompts.category);
+    XCTAssertTrue([tones satisfiesNeeds:(ORKAudioSessionNeedsPrompts | ORKAudioSessionNeedsTonePlayback)]);
+    
+    ORKAudioSessionConfiguration *all = [ORKAudioSessionConfiguration configurationForNeeds:(ORKAudioSessionNeedsPrompts | ORKAudioSessionNeedsTonePlayback | ORKAudioSessionNeedsRecording)];
+    XCTAssertEqualObjects(all.category, AVAudioSessionCategoryPlayAndRecord);
+    XCTAssertEqual(all.categoryOptions, AVAudioSessionCategoryOptionDefaultToSpeaker);
+    XCTAssertEqual(all.preferredSampleRate, 44100.0);
+    XCTAssertGreaterThan(all.preferredIOBufferDuration, 0);
+    XCTAssertTrue([all satisfiesNeeds:ORKAudioSessionNeedsRecording]);
+    XCTAssertEqualObjects(all, [ORKAudioSessionConfiguration configurationForNeeds:(ORKAudioSessionNeedsTonePlayback | ORKAudioSessionNeedsRecording)]);
+}
+
+- (void)testAudioSessionCoordinatorConfiguresOncePerTask {
+    ORKMockAudioSession *session = [ORKMockAudioSession new];
+    ORKAudioSessionCoordinator *coordinator = [[ORKAudioSessionCoordinator alloc] initWithSession:session notificationCenter:[NSNotificationCenter new]];
+    
+    // Preparing configures the session but does not activate it.
+    ORKAudioSessionNeeds taskNeeds = ORKAudioSessionNeedsPrompts | ORKAudioSessionNeedsTonePlayback | ORKAudioSessionNeedsRecording;
+    XCTAssertTrue([coordinator prepareForNeeds:taskNeeds error:NULL]);
+    XCTAssertEqualObjects(session.category, AVAudioSessionCategoryPlayAndRecord);
+    XCTAssertEqual(session.preferredSampleRate, 44100.0);
+    XCTAssertEqual(session.setCategoryCount, 1);
+    XCTAssertFalse(session.active);
+    
+    ORKMockAudioSessionClient *prompts = [ORKMockAudioSessionClient new];
+    ORKMockAudioSessionClient *tones = [ORKMockAudioSessionClient new];
+    ORKMockAudioSessionClient *recorder = [ORKMockAudioSessionClient new];
+    XCTAssertTrue([coordinator beginUsingSessionForClient:prompts needs:ORKAudioSessionNeedsPrompts error:NULL]);
+    XCTAssertTrue([coordinator beginUsingSessionForClient:tones needs:ORKAudioSessionNeedsTonePlayback error:NULL]);
+    XCTAssertTrue([coordinator beginUsingSessionForClient:recorder needs:ORKAudioSessionNeedsRecording error:NULL]);
+    XCTAssertEqual(coordinator.clientNeeds, taskNeeds);
+    XCTAssertEqual(session.setCategoryCount, 1);
+    XCTAssertEqual(session.activationCount, 1);
+    
+    // The session stays active between steps while the task is prepared.
+    [coordinator endUsingSessionForClient:tones];
+    [coordinator endUsingSessionForClient:recorder];
+    [coordinator endUsingSessionForClient:prompts];
+    XCTAssertTrue(session.active);
+    
+    [coordinator finishPreparation];
+    XCTAssertFalse(session.active);
+    XCTAssertFalse(coordinator.active);
+}
+
+- (void)testAudioSessionCoordinatorEscalatesUndeclaredNeeds {
+    ORKMockAudioSession *session = [ORKMockAudioSession new];
+    ORKAudioSessionCoordinator *coordinator = [[ORKAudioSessionCoordinator alloc] initWithSession:session notificationCenter:[NSNotificationCenter new]];
+    
+    ORKMockAudioSessionClient *prompts = [ORKMockAudioSessionClient new];
+    ORKMockAudioSessionClient *recorder = [ORKMockAudioSessionClient new];
+    XCTAssertTrue([coordinator beginUsingSessionForClient:prompts needs:ORKAudioSessionNeedsPrompts error:NULL]);
+    XCTAssertEqualObjects(session.category, AVAudioSessionCategoryPlayback);
+    
+    XCTAssertTrue([coordinator beginUsingSessionForClient:recorder needs:ORKAudioSessionNeedsRecording error:NULL]);
+    XCTAssertEqualObjects(session.category, AVAudioSessionCategoryPlayAndRecord);
+    XCTAssertEqual(session.setCategoryCount, 2);
+    
+    // Fewer needs never downgrade the category.
+    [coordinator endUsingSessionForClient:recorder];
+    XCTAssertTrue([coordinator beginUsingSessionForClient:prompts needs:ORKAudioSessionNeedsPrompts error:NULL]);
+    XCTAssertEqual(session.setCategoryCount, 2);
+    XCTAssertTrue(session.active);
+    
+    [coordinator endUsingSessionForClient:prompts];
+    XCTAssertFalse(session.active);
+}
+
+- (void)testAudioSessionCoordinatorAppliesLowLatencyBufferForTones {
+    ORKMockAudioSession *session = [ORKMockAudioSession new];
+    ORKAudioSessionCoordinator *coordinator = [[ORKAudioSessionCoordinator alloc] initWithSession:session notificationCenter:[NSNotificationCenter new]];
+    
+    ORKMockAudioSessionClient *prompts = [ORKMockAudioSessionClient new];
+    XCTAssertTrue([coordinator beginUsingSessionForClient:prompts needs:ORKAudioSessionNeedsPrompts error:NULL]);
+    XCTAssertEqual(session.preferredIOBufferDuration, 0);
+    
+    // Adding tones keeps the category but lowers the buffer duration.
+    ORKMockAudioSessionClient *tones = [ORKMockAudioSessionClient new];
+    XCTAssertTrue([coordinator beginUsingSessionForClient:tones needs:ORKAudioSessionNeedsTonePlayback error:NULL]);
+    XCTAssertEqual(session.setCategoryCount, 1);
+    XCTAssertGreaterThan(session.preferredIOBufferDuration, 0);
+    
+    [coordinator endUsingSessionForClient:tones];
+    [coordinator endUsingSessionForClient:prompts];
+}
+
+- (void)testAudioSessionCoordinatorDeactivatesAfterDeallocatedClients {
+    ORKMockAudioSession *session = [ORKMockAudioSession new];
+    ORKAudioSessionCoordinator *coordinator = [[ORKAudioSessionCoordinator alloc] initWithSession:session notificationCenter:[NSNotificationCenter new]];
+    
+    @autoreleasepool {
+        ORKMockAudioSessionClient *client = [ORKMockAudioSessionClient new];
+        XCTAssertTrue([coordinator beginUsingSessionForClient:client needs:ORKAudioSessionNeedsPrompts error:NULL]);
+        XCTAssertTrue(session.active);
+    }
+    XCTAssertEqual(coordinator.clientNeeds, ORKAudioSessionNeedsNone);
+    
+    [coordinator endUsingSessionForDeallocatedClients];
+    XCTAssertFalse(session.active);
+}
+
+- (void)testAudioSessionCoordinatorInterruptionsAndRouteChanges {
+    ORKMockAudioSession *session = [ORKMockAudioSession new];
+    ORKAudioSessionCoordinator *coordinator = [[ORKAudioSessionCoordinator alloc] initWithSession:session notificationCenter:[NSNotificationCenter new]];
+    ORKMockAudioSessionClient *first = [ORKMockAudioSessionClient new];
+    ORKMockAudioSessionClient *second = [ORKMockAudioSessionClient new];
+    [coordinator beginUsingSessionForClient:first needs:ORKAudioSessionNeedsPrompts error:NULL];
+    [coordinator beginUsingSessionForClient:second needs:ORKAudioSessionNeedsTonePlayback error:NULL];
+    
+    session.active = NO;
+    [coordinator handleInterruptionWithType:AVAudioSessionInterruptionTypeBegan options:0];
+    XCTAssertTrue(coordinator.interrupted);
+    XCTAssertEqual(first.interruptionBeginCount, 1);
+    XCTAssertEqual(second.interruptionBeginCount, 1);
+    
+    // The session is reactivated once, on behalf of all clients.
+    [coordinator handleInterruptionWithType:AVAudioSessionInterruptionTypeEnded options:AVAudioSessionInterruptionOptionShouldResume];
+    XCTAssertFalse(coordinator.interrupted);
+    XCTAssertTrue(session.active);
+    XCTAssertEqual(session.activationCount, 2);
+    XCTAssertTrue(first.shouldResume);
+    XCTAssertTrue(second.shouldResume);
+    
+    // Another party changing the category is undone while clients need the session.
+    [session setCategory:AVAudioSessionCategoryAmbient withOptions:0 error:NULL];
+    [coordinator handleRouteChangeWithReason:AVAudioSessionRouteChangeReasonCategoryChange];
+    XCTAssertEqualObjects(session.category, AVAudioSessionCategoryPlayback);
+    
+    [coordinator handleRouteChangeWithReason:AVAudioSessionRouteChangeReasonOldDeviceUnavailable];
+    XCTAssertEqual(first.routeChangeCount, 2);
+    XCTAssertEqual(second.routeChangeCount, 2);
+}
+
+static void ORKFillTone(float *samples, NSInteger count, double sampleRate, double frequency, double amplitude) {
+    for (NSInteger i = 0; i < count; i++) {
+        samples[i] = amplitude * sin(2 * M_PI * frequency * i / sampleRate);
+    }
+}
+
+static void ORKAddNoise(float *samples, NSInteger count, double deviation, ORKRandomNumberGenerator *generator) {
+    for (NSInteger i = 0; i < count; i += 2) {
+        // Box-Muller
+        double u1 = ((double)[generator nextUInt32] + 1) / 4294967297.0;
+        double u2 = ((double)[generator nextUInt32] + 1) / 4294967297.0;
+        double r = sqrt(-2 * log(u1));
+        samples[i] += deviation * r * cos(2 * M_PI * u2);
+        if (i + 1 < count) {
+            samples[i + 1] += deviation * r * sin(2 * M_PI * u2);
+        }
+    }
+}
+
+- (void)testVoiceActivityDetector {
+    const double sampleRate = 16000;
+    const NSInteger count = 32000;
+    float *samples = calloc(count, sizeof(float));
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:2017];
+    
+    // 0.5 s of noise, 1 s of tone, 0.5 s of noise.
+    ORKFillTone(samples + 8000, 16000, sampleRate, 150, 0.3);
+    ORKAddNoise(samples, count, 0.001, generator);
+    
+    ORKVoiceActivityDetector *detector = [[ORKVoiceActivityDetector alloc] initWithSampleRate:sampleRate];
+    for (NSInteger offset = 0; offset < count; offset += 1000) {
+        [detector processSamples:samples + offset count:1000];
+    }
+    [detector finish];
+    XCTAssertTrue(detector.hasSpeech);
+    XCTAssertEqual(detector.sampleCount, count);
+    // The tone, widened by 0.15 s of padding on each side.
+    XCTAssertEqualWithAccuracy(detector.speechStartSample, 5600, detector.frameLength);
+    XCTAssertEqualWithAccuracy(detector.speechEndSample, 26400, detector.frameLength);
+    
+    // A recording that is all speech is kept whole.
+    ORKFillTone(samples, count, sampleRate, 150, 0.3);
+    detector = [[ORKVoiceActivityDetector alloc] initWithSampleRate:sampleRate];
+    [detector processSamples:samples count:count];
+    [detector finish];
+    XCTAssertTrue(detector.hasSpeech);
+    XCTAssertEqual(detector.speechStartSample, 0);
+    XCTAssertEqual(detector.speechEndSample, count);
+    
+    // Background noise alone is not speech.
+    memset(samples, 0, count * sizeof(float));
+    ORKAddNoise(samples, count, 0.001, generator);
+    detector = [[ORKVoiceActivityDetector alloc] initWithSampleRate:sampleRate];
+    [detector processSamples:samples count:count];
+    [detector finish];
+    XCTAssertFalse(detector.hasSpeech);
+    
+    free(samples);
+}
+
+- (void)testPhonationAnalyzer {
+    const double sampleRate = 16000;
+    const NSInteger count = 32000;
+    float *samples = calloc(count, sizeof(float));
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:2017];
+    
+    // A pure tone has no perturbation.
+    ORKFillTone(samples, count, sampleRate, 150, 0.5);
+    ORKPhonationAnalyzer *analyzer = [[ORKPhonationAnalyzer alloc] initWithSampleRate:sampleRate];
+    for (NSInteger offset = 0; offset < count; offset += 500) {
+        [analyzer processSamples:samples + offset count:500];
+    }
+    XCTAssertGreaterThan(analyzer.voicedFrameCount, 150);
+    XCTAssertEqual(analyzer.voicedFrameCount, (NSInteger)[[analyzer.fundamentalFrequencyTrack filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"self > 0"]] count]);
+    XCTAssertEqualWithAccuracy(analyzer.meanFundamentalFrequency, 150, 0.5);
+    XCTAssertLessThan(analyzer.jitter, 0.001);
+    XCTAssertLessThan(analyzer.shimmer, 0.001);
+    XCTAssertGreaterThan(analyzer.harmonicsToNoiseRatio, 40);
+    
+    // Noise at 20 dB below the tone.
+    double deviation = 0.5 / sqrt(2) / 10;
+    ORKAddNoise(samples, count, deviation, generator);
+    analyzer = [[ORKPhonationAnalyzer alloc] initWithSampleRate:sampleRate];
+    [analyzer processSamples:samples count:count];
+    XCTAssertEqualWithAccuracy(analyzer.meanFundamentalFrequency, 150, 1);
+    XCTAssertEqualWithAccuracy(analyzer.harmonicsToNoiseRatio, 20, 3);
+    
+    // Amplitude modulation shows up as shimmer.
+    for (NSInteger i = 0; i < count; i++) {
+        double envelope = 1 + 0.2 * sin(2 * M_PI * 10 * i / sampleRate);
+        samples[i] = 0.4 * envelope * sin(2 * M_PI * 150 * i / sampleRate);
+    }
+    analyzer = [[ORKPhonationAnalyzer alloc] initWithSampleRate:sampleRate];
+    [analyzer processSamples:samples count:count];
+    XCTAssertGreaterThan(analyzer.shimmer, 0.02);
+    XCTAssertLessThan(analyzer.jitter, 0.005);
+    
+    // Noise has no pitch.
+    memset(samples, 0, count * sizeof(float));
+    ORKAddNoise(samples, count, 0.3, generator);
+    analyzer = [[ORKPhonationAnalyzer alloc] initWithSampleRate:sampleRate];
+    [analyzer processSamples:samples count:count];
+    XCTAssertEqual(analyzer.voicedFrameCount, 0);
+    XCTAssertEqual(analyzer.meanFundamentalFrequency, 0);
+    
+    free(samples);
+}
+
+- (void)testAudioSampleRateConverter {
+    const NSInteger inputCount = 48000;
+    float *input = calloc(inputCount, sizeof(float));
+    ORKFillTone(input, inputCount, 48000, 1000, 0.5);
+    
+    ORKAudioSampleRateConverter *converter = [[ORKAudioSampleRateConverter alloc] initWithInputSampleRate:48000 outputSampleRate:16000];
+    float *output = calloc([converter maximumOutputCountForInputCount:inputCount], sizeof(float));
+    NSInteger outputCount = 0;
+    for (NSInteger offset = 0; offset < inputCount; offset += 4096) {
+        NSInteger count = MIN(4096, inputCount - offset);
+        outputCount += [converter convertSamples:input + offset count:count output:output + outputCount];
+    }
+    XCTAssertEqualWithAccuracy(outputCount, 16000, 32);
+    
+    // Away from the filter's start-up transient, the output is the same tone at the new rate.
+    ORKPhonationAnalyzer *analyzer = [[ORKPhonationAnalyzer alloc] initWithSampleRate:16000 minimumFrequency:500 maximumFrequency:2000];
+    [analyzer processSamples:output + 100 count:outputCount - 100];
+    XCTAssertEqualWithAccuracy(analyzer.meanFundamentalFrequency, 1000, 2);
+    float peak = 0;
+    for (NSInteger i = 100; i < outputCount; i++) {
+        peak = MAX(peak, fabsf(output[i]));
+    }
+    XCTAssertEqualWithAccuracy(peak, 0.5, 0.02);
+    
+    free(input);
+    free(output);
+}
+
+- (void)testAudioCapturePipelineProcessesFile {
+    const double sampleRate = 44100;
+    const AVAudioFrameCount frameCount = 88200;
+    AVAudioFormat *format = [[AVAudioFormat alloc] initStandardFormatWithSampleRate:sampleRate channels:2];
+    AVAudioPCMBuffer *buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:format frameCapacity:frameCount];
+    buffer.frameLength = frameCount;
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:2017];
+    for (AVAudioChannelCount channel = 0; channel < 2; channel++) {
+        float *samples = buffer.floatChannelData[channel];
+        // 0.5 s of noise, 1 s of tone, 0.5 s of noise.
+        ORKFillTone(samples + 22050, 44100, sampleRate, 150, 0.3);
+        ORKAddNoise(samples, frameCount, 0.001, generator);
+    }
+    
+    NSDictionary *settings = @{AVFormatIDKey : @(kAudioFormatLinearPCM),
+                               AVSampleRateKey : @(sampleRate),
+                               AVNumberOfChannelsKey : @(2),
+                               AVLinearPCMBitDepthKey : @(16)};
+    NSURL *inputURL = [[NSURL fileURLWithPath:_outputPath] URLByAppendingPathComponent:@"voice.wav"];
+    NSURL *outputURL = [[NSURL fileURLWithPath:_outputPath] URLByAppendingPathComponent:@"voice.processing.wav"];
+    NSError *error = nil;
+    AVAudioFile *file = [[AVAudioFile alloc] initForWriting:inputURL settings:settings error:&error];
+    XCTAssertNotNil(file, @"%@", error);
+    XCTAssertTrue([file writeFromBuffer:buffer error:&error], @"%@", error);
+    file = nil;
+    
+    ORKAudioProcessingOptions options = ORKAudioProcessingOptionTrimSilence | ORKAudioProcessingOptionDownmixToMono | ORKAudioProcessingOptionComputeVoiceFeatures;
+    BOOL wroteOutput = NO;
+    ORKAudioCapturePipeline *pipeline = [ORKAudioCapturePipeline processFileAtURL:inputURL
+                                                                            toURL:outputURL
+                                                                         settings:settings
+                                                                          options:options
+                                                                 outputSampleRate:16000
+                                                                      wroteOutput:&wroteOutput
+                                                                            error:&error];
+    XCTAssertNotNil(pipeline, @"%@", error);
+    XCTAssertTrue(wroteOutput);
+    XCTAssertTrue(pipeline.trimsSilence);
+    XCTAssertEqualWithAccuracy(pipeline.speechStartTime, 0.35, 0.011);
+    XCTAssertEqualWithAccuracy(pipeline.speechEndTime, 1.65, 0.011);
+    
+    NSDictionary *features = pipeline.voiceFeatures;
+    XCTAssertEqualWithAccuracy([features[ORKVoiceFeatureMeanFundamentalFrequencyKey] doubleValue], 150, 0.5);
+    XCTAssertEqualWithAccuracy([features[ORKVoiceFeatureVoicedFrameCountKey] integerValue], 100, 5);
+    XCTAssertEqualWithAccuracy([features[ORKVoiceFeatureFrameIntervalKey] doubleValue], 0.01, 0.0001);
+    // The track covers the whole recording, not only the span that was kept.
+    XCTAssertEqualWithAccuracy((NSInteger)[features[ORKVoiceFeatureFundamentalFrequencyTrackKey] count], 200, 3);
+    
+    AVAudioFile *output = [[AVAudioFile alloc] initForReading:outputURL error:&error];
+    XCTAssertNotNil(output, @"%@", error);
+    XCTAssertEqual(output.fileFormat.channelCount, 1);
+    XCTAssertEqual(output.fileFormat.sampleRate, 16000);
+    XCTAssertEqualWithAccuracy(output.length, 1.3 * 16000, 200);
+}
+
+- (void)testAudioCaptureWriterProcessesBuffersAsTheyArrive {
+    const double sampleRate = 48000;
+    const AVAudioFrameCount frameCount = 96000;
+    const AVAudioFrameCount bufferSize = 4096;
+    float *samples = calloc(frameCount, sizeof(float));
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:2017];
+    // 0.5 s of noise, 1 s of tone, 0.5 s of noise.
+    ORKFillTone(samples + 24000, 48000, sampleRate, 150, 0.3);
+    ORKAddNoise(samples, frameCount, 0.001, generator);
+    
+    NSDictionary *settings = @{AVFormatIDKey : @(kAudioFormatLinearPCM),
+                               AVLinearPCMBitDepthKey : @(16)};
+    NSURL *outputURL = [[NSURL fileURLWithPath:_outputPath] URLByAppendingPathComponent:@"live.processing.wav"];
+    AVAudioFormat *format = [[AVAudioFormat alloc] initStandardFormatWithSampleRate:sampleRate channels:1];
+    NSError *error = nil;
+    ORKAudioCaptureWriter *writer = [[ORKAudioCaptureWriter alloc] initWithInputFormat:format
+                                                                             outputURL:outputURL
+                                                                              settings:settings
+                                                                               options:ORKAudioProcessingOptionTrimSilence
+                                                                      outputSampleRate:16000
+                                                                                 error:&error];
+    XCTAssertNotNil(writer, @"%@", error);
+    XCTAssertTrue(writer.writesOutput);
+    
+    // Fed a tap-sized buffer at a time; the converted audio is on disk before finishing.
+    AVAudioPCMBuffer *buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:format frameCapacity:bufferSize];
+    for (AVAudioFrameCount offset = 0; offset < frameCount; offset += bufferSize) {
+        AVAudioFrameCount count = MIN(bufferSize, frameCount - offset);
+        memcpy(buffer.floatChannelData[0], samples + offset, count * sizeof(float));
+        buffer.frameLength = count;
+        [writer appendBuffer:buffer];
+    }
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:outputURL.path]);
+    
+    XCTAssertTrue([writer finishWithError:&error], @"%@", error);
+    XCTAssertTrue(writer.pipeline.trimsSilence);
+    XCTAssertEqualWithAccuracy(writer.pipeline.speechStartTime, 0.35, 0.011);
+    
+    // Buffers after finishing are ignored.
+    [writer appendBuffer:buffer];
+    
+    AVAudioFile *output = [[AVAudioFile alloc] initForReading:outputURL error:&error];
+    XCTAssertNotNil(output, @"%@", error);
+    XCTAssertEqual(output.fileFormat.sampleRate, 16000);
+    XCTAssertEqualWithAccuracy(output.length, 1.3 * 16000, 200);
+    
+    free(samples);
+}
+
+- (void)testContinuousRecordingSession {
+    ORKMockMotionManager *manager = [ORKMockMotionManager new];
+    ORKMockAccelerometerRecorderConfiguration *recorderConfiguration = [[ORKMockAccelerometerRecorderConfiguration alloc] initWithIdentifier:@"accelerometer" frequency:60.0];
+    recorderConfiguration.mockManager = manager;
+    ORKContinuousRecorderConfiguration *configuration = [[ORKContinuousRecorderConfiguration alloc] initWithRecorderConfiguration:recorderConfiguration
+                                                                                                                  stepIdentifiers:@[@"outbound", @"return"]];
+    
+    ORKContinuousRecordingSession *session = [[ORKContinuousRecordingSession alloc] initWithConfigurations:@[configuration]
+                                                                                           outputDirectory:[NSURL fileURLWithPath:_outputPath]];
+    session.delegate = self;
+    _sliceResults = [NSMutableDictionary dictionary];
+    
+    ORKStep *outbound = [[ORKStep alloc] initWithIdentifier:@"outbound"];
+    ORKStep *returnStep = [[ORKStep alloc] initWithIdentifier:@"return"];
+    ORKStep *conclusion = [[ORKStep alloc] initWithIdentifier:@"conclusion"];
+    ORKMockAccelerometerData *data = [ORKMockAccelerometerData new];
+    
+    [session stepWillStart:outbound];
+    ORKRecorder *recorder = session.recorders.firstObject;
+    XCTAssertNotNil(recorder);
+    [manager injectAccelerometerData:data];
+    [manager injectAccelerometerData:data];
+    
+    // The same recorder keeps running across the transition.
+    [session stepDidFinish:outbound];
+    [session stepWillStart:returnStep];
+    XCTAssertEqual(session.recorders.firstObject, recorder);
+    for (NSInteger i = 0; i < 3; i++) {
+        [manager injectAccelerometerData:data];
+    }
+    XCTAssertEqual(_sliceResults.count, 0);
+    
+    [session stepDidFinish:returnStep];
+    [session stepWillStart:conclusion];
+    XCTAssertEqual(session.recorders.count, 0);
+    
+    // The recorder finishes its file in the background; the session reports the slices once it is done.
+    __block BOOL finished = NO;
+    [session finishWithCompletion:^{
+        finished = YES;
+    }];
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (_sliceResults.count < 2 && [timeout timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    XCTAssertEqual(_sliceResults.count, 2);
+    XCTAssertNil(recorder.delegate);
+    while (! finished && [timeout timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    XCTAssertTrue(finished);
+    
+    ORKFileResult *outboundResult = _sliceResults[@"outbound"];
+    ORKFileResult *returnResult = _sliceResults[@"return"];
+    XCTAssertEqualObjects(outboundResult.identifier, @"accelerometer");
+    XCTAssertEqualObjects(outboundResult.fileURL, returnResult.fileURL);
+    XCTAssertEqualObjects(returnResult.userInfo[ORKContinuousRecorderStepIdentifierKey], @"return");
+    XCTAssertLessThanOrEqual([outboundResult.userInfo[ORKContinuousRecorderSliceEndUptimeKey] doubleValue],
+                             [returnResult.userInfo[ORKContinuousRecorderSliceStartUptimeKey] doubleValue]);
+    
+    NSDictionary *dict = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfURL:outboundResult.fileURL] options:(NSJSONReadingOptions)0 error:NULL];
+    NSArray *items = dict[@"items"];
+    NSArray *markers = [items filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"stepBoundary != nil"]];
+    XCTAssertEqual(items.count, kNumberOfSamples + 4);
+    XCTAssertEqual(markers.count, 4);
+    XCTAssertEqualObjects([markers valueForKey:@"stepIdentifier"], (@[@"outbound", @"outbound", @"return", @"return"]));
+}
+
 @end
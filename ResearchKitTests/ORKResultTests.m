@@ -32,6 +32,46 @@
 #import <XCTest/XCTest.h>
 #import <ResearchKit/ResearchKit.h>
 #import "ORKResult_Private.h"
+#import "ORKPackedSampleStore.h"
+#import "ORKTappingStatisticsEngine.h"
+#import "ORKSpatialSpanMemoryGameRecordBuilder.h"
+#import "ORKSpatialSpanGame.h"
+#import "ORKRandomNumberGenerator.h"
+
+
+// Encodes samples the way tapping results were archived before they were packed.
+@interface ORKLegacyTappingIntervalResult : ORKResult
+
+@property (nonatomic, copy) NSArray *samples;
+
+@end
+
+
+@implementation ORKLegacyTappingIntervalResult
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [super encodeWithCoder:aCoder];
+    [aCoder encodeObject:_samples forKey:@"samples"];
+}
+
+@end
+
+
+// Encodes every member, including defaults, the way results were archived before compact coding.
+@interface ORKLegacyTappingSample : ORKTappingSample
+
+@end
+
+
+@implementation ORKLegacyTappingSample
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [aCoder encodeDouble:self.timestamp forKey:@"timestamp"];
+    [aCoder encodeCGPoint:self.location forKey:@"location"];
+    [aCoder encodeInteger:self.buttonIdentifier forKey:@"buttonIdentifier"];
+}
+
+@end
 
 
 @interface ORKResultTests : XCTestCase
@@ -145,6 +185,758 @@
     XCTAssertEqualObjects(taskResult1, taskResult2);
 }
 
+- (ORKTappingIntervalResult *)tappingResultWithSampleCount:(NSUInteger)count {
+    ORKTappingSampleStore *store = [ORKTappingSampleStore new];
+    for (NSUInteger i = 0; i < count; i++) {
+        [store appendSampleWithTimestamp:i * 0.05
+                                location:CGPointMake(i % 320, i % 480)
+                        buttonIdentifier:(i % 2) ? ORKTappingButtonIdentifierRight : ORKTappingButtonIdentifierLeft];
+    }
+    ORKTappingIntervalResult *result = [[ORKTappingIntervalResult alloc] initWithIdentifier:@"tapping"];
+    result.sampleStore = store;
+    return result;
+}
+
+- (id)unarchive:(NSData *)data ofClass:(Class)aClass {
+    NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+    unarchiver.requiresSecureCoding = YES;
+    return [unarchiver decodeObjectOfClass:aClass forKey:NSKeyedArchiveRootObjectKey];
+}
+
+- (void)testTappingResultPackedSamples {
+    ORKTappingIntervalResult *result = [self tappingResultWithSampleCount:3];
+    XCTAssertEqual(result.samples.count, 3);
+    ORKTappingSample *sample = result.samples[1];
+    XCTAssertEqual(sample.timestamp, 0.05);
+    XCTAssertTrue(CGPointEqualToPoint(sample.location, CGPointMake(1, 1)));
+    XCTAssertEqual(sample.buttonIdentifier, ORKTappingButtonIdentifierRight);
+    
+    // Setting sample objects packs them; equality is by value.
+    ORKTappingIntervalResult *fromObjects = [[ORKTappingIntervalResult alloc] initWithIdentifier:@"tapping"];
+    fromObjects.startDate = result.startDate;
+    fromObjects.endDate = result.endDate;
+    fromObjects.samples = result.samples;
+    XCTAssertEqualObjects(fromObjects, result);
+    XCTAssertEqualObjects([result copy], result);
+    
+    ORKTappingIntervalResult *decoded = [self unarchive:[NSKeyedArchiver archivedDataWithRootObject:result] ofClass:[ORKTappingIntervalResult class]];
+    XCTAssertEqualObjects(decoded, result);
+    XCTAssertEqualObjects(decoded.samples, result.samples);
+    
+    // An empty sample array survives a round trip as empty, not nil.
+    result.samples = @[];
+    decoded = [self unarchive:[NSKeyedArchiver archivedDataWithRootObject:result] ofClass:[ORKTappingIntervalResult class]];
+    XCTAssertEqualObjects(decoded.samples, @[]);
+}
+
+- (void)testTappingResultDecodesLegacyArchive {
+    ORKTappingIntervalResult *result = [self tappingResultWithSampleCount:4];
+    
+    ORKLegacyTappingIntervalResult *legacy = [[ORKLegacyTappingIntervalResult alloc] initWithIdentifier:result.identifier];
+    legacy.startDate = result.startDate;
+    legacy.endDate = result.endDate;
+    legacy.samples = result.samples;
+    
+    NSMutableData *data = [NSMutableData data];
+    NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+    [archiver setClassName:@"ORKTappingIntervalResult" forClass:[ORKLegacyTappingIntervalResult class]];
+    [archiver encodeObject:legacy forKey:NSKeyedArchiveRootObjectKey];
+    [archiver finishEncoding];
+    
+    ORKTappingIntervalResult *decoded = [self unarchive:data ofClass:[ORKTappingIntervalResult class]];
+    XCTAssertEqualObjects(decoded.samples, result.samples);
+}
+
+- (void)testSpatialSpanMemoryGameRecordPackedTouchSamples {
+    ORKSpatialSpanMemoryGameTouchSample *touch = [ORKSpatialSpanMemoryGameTouchSample new];
+    touch.timestamp = 1.5;
+    touch.targetIndex = -1;
+    touch.location = CGPointMake(10, 20);
+    touch.correct = YES;
+    
+    ORKSpatialSpanMemoryGameRecord *record = [ORKSpatialSpanMemoryGameRecord new];
+    record.touchSamples = @[touch, touch];
+    
+    ORKSpatialSpanMemoryGameRecord *decoded = [self unarchive:[NSKeyedArchiver archivedDataWithRootObject:record] ofClass:[ORKSpatialSpanMemoryGameRecord class]];
+    XCTAssertEqualObjects(decoded, record);
+    XCTAssertEqualObjects(decoded.touchSamples, (@[touch, touch]));
+}
+
+// 10k taps: the packed form is 28 bytes per tap, and archives as a single data object.
+- (void)testTappingResultArchivePerformance {
+    const NSUInteger sampleCount = 10000;
+    ORKTappingIntervalResult *result = [self tappingResultWithSampleCount:sampleCount];
+    XCTAssertEqual([result.sampleStore packedData].length, 16 + sampleCount * (3 * sizeof(double) + sizeof(int32_t)));
+    
+    [self measureBlock:^{
+        NSData *data = [NSKeyedArchiver archivedDataWithRootObject:result];
+        ORKTappingIntervalResult *decoded = [self unarchive:data ofClass:[ORKTappingIntervalResult class]];
+        XCTAssertEqual(decoded.sampleStore.count, sampleCount);
+    }];
+}
+
+// The packed layout is little-endian on every host, so archives move between devices unchanged.
+- (void)testPackedSampleDataIsLittleEndian {
+    ORKTappingSampleStore *store = [ORKTappingSampleStore new];
+    [store appendSampleWithTimestamp:1.0 location:CGPointMake(2, 3) buttonIdentifier:ORKTappingButtonIdentifierRight];
+    
+    const uint8_t expected[] = {
+        1, 0, 0, 0,   1, 0, 0, 0,   3, 0, 0, 0,   1, 0, 0, 0,   // version, count, column counts
+        0, 0, 0, 0, 0, 0, 0xf0, 0x3f,                           // timestamp 1.0
+        0, 0, 0, 0, 0, 0, 0, 0x40,                              // x 2.0
+        0, 0, 0, 0, 0, 0, 0x08, 0x40,                           // y 3.0
+        ORKTappingButtonIdentifierRight, 0, 0, 0                // button identifier
+    };
+    NSData *expectedData = [NSData dataWithBytes:expected length:sizeof(expected)];
+    XCTAssertEqualObjects([store packedData], expectedData);
+    
+    ORKTappingSampleStore *decoded = [[ORKTappingSampleStore alloc] initWithPackedData:expectedData];
+    XCTAssertEqualObjects(decoded, store);
+}
+
+- (void)testArchiveOmitsDefaultValues {
+    ORKTappingSample *sample = [ORKTappingSample new];
+    ORKLegacyTappingSample *legacy = [ORKLegacyTappingSample new];
+    
+    NSMutableData *legacyData = [NSMutableData data];
+    NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:legacyData];
+    [archiver setClassName:@"ORKTappingSample" forClass:[ORKLegacyTappingSample class]];
+    [archiver encodeObject:legacy forKey:NSKeyedArchiveRootObjectKey];
+    [archiver finishEncoding];
+    
+    NSData *data = [NSKeyedArchiver archivedDataWithRootObject:sample];
+    XCTAssertLessThan(data.length, legacyData.length);
+    
+    // Archives with and without default members decode alike.
+    XCTAssertEqualObjects([self unarchive:data ofClass:[ORKTappingSample class]], sample);
+    XCTAssertEqualObjects([self unarchive:legacyData ofClass:[ORKTappingSample class]], sample);
+    
+    sample.timestamp = 1.5;
+    sample.buttonIdentifier = ORKTappingButtonIdentifierRight;
+    ORKTappingSample *decoded = [self unarchive:[NSKeyedArchiver archivedDataWithRootObject:sample] ofClass:[ORKTappingSample class]];
+    XCTAssertEqualObjects(decoded, sample);
+}
+
+- (ORKTaskResult *)taskResultWithStepCount:(NSUInteger)stepCount {
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:0];
+    NSMutableArray *stepResults = [NSMutableArray arrayWithCapacity:stepCount];
+    for (NSUInteger i = 0; i < stepCount; i++) {
+        NSMutableArray *results = [NSMutableArray array];
+        for (NSUInteger j = 0; j < 5; j++) {
+            ORKTextQuestionResult *text = [[ORKTextQuestionResult alloc] initWithIdentifier:[NSString stringWithFormat:@"text%lu", (unsigned long)j]];
+            text.questionType = ORKQuestionTypeText;
+            text.textAnswer = @"answer";
+            text.startDate = date;
+            text.endDate = date;
+            [results addObject:text];
+            
+            ORKScaleQuestionResult *scale = [[ORKScaleQuestionResult alloc] initWithIdentifier:[NSString stringWithFormat:@"scale%lu", (unsigned long)j]];
+            scale.questionType = ORKQuestionTypeScale;
+            scale.scaleAnswer = @(j);
+            scale.startDate = date;
+            scale.endDate = date;
+            [results addObject:scale];
+        }
+        ORKStepResult *stepResult = [[ORKStepResult alloc] initWithStepIdentifier:[NSString stringWithFormat:@"step%lu", (unsigned long)i] results:results];
+        stepResult.startDate = date;
+        stepResult.endDate = date;
+        [stepResults addObject:stepResult];
+    }
+    ORKTaskResult *taskResult = [[ORKTaskResult alloc] initWithTaskIdentifier:@"task"
+                                                                  taskRunUUID:[NSUUID UUID]
+                                                              outputDirectory:[NSURL fileURLWithPath:NSTemporaryDirectory()]];
+    taskResult.results = stepResults;
+    return taskResult;
+}
+
+// 1000 steps of 10 question results each.
+- (void)testResultTreeArchivePerformance {
+    ORKTaskResult *result = [self taskResultWithStepCount:1000];
+    
+    [self measureBlock:^{
+        NSData *data = [NSKeyedArchiver archivedDataWithRootObject:result];
+        ORKTaskResult *decoded = [self unarchive:data ofClass:[ORKTaskResult class]];
+        XCTAssertEqualObjects(decoded, result);
+    }];
+}
+
+- (NSURL *)temporaryDirectory {
+    return [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]] isDirectory:YES];
+}
+
+// A session of the "trend" task: a scale answer, a text answer and a tapping result, on `date`.
+- (ORKTaskResult *)trendTaskResultWithDate:(NSDate *)date scale:(NSInteger)scale tapCount:(NSInteger)tapCount {
+    ORKScaleQuestionResult *scaleResult = [[ORKScaleQuestionResult alloc] initWithIdentifier:@"mood"];
+    scaleResult.scaleAnswer = @(scale);
+    scaleResult.startDate = date;
+    scaleResult.endDate = date;
+    
+    ORKTextQuestionResult *textResult = [[ORKTextQuestionResult alloc] initWithIdentifier:@"note"];
+    textResult.textAnswer = @"fine";
+    textResult.startDate = date;
+    textResult.endDate = date;
+    
+    ORKTappingIntervalStatistics *statistics = [ORKTappingIntervalStatistics new];
+    statistics.tapCount = tapCount;
+    ORKTappingIntervalResult *tappingResult = [[ORKTappingIntervalResult alloc] initWithIdentifier:@"tapping.right"];
+    tappingResult.statistics = statistics;
+    tappingResult.startDate = date;
+    tappingResult.endDate = date;
+    
+    ORKTaskResult *taskResult = [[ORKTaskResult alloc] initWithTaskIdentifier:@"trend"
+                                                                  taskRunUUID:[NSUUID UUID]
+                                                              outputDirectory:[NSURL fileURLWithPath:NSTemporaryDirectory()]];
+    taskResult.results = @[[[ORKStepResult alloc] initWithStepIdentifier:@"survey" results:@[scaleResult, textResult]],
+                           [[ORKStepResult alloc] initWithStepIdentifier:@"tapping" results:@[tappingResult]]];
+    taskResult.startDate = date;
+    taskResult.endDate = date;
+    return taskResult;
+}
+
+- (void)testResultStore {
+    NSURL *directory = [self temporaryDirectory];
+    ORKResultStore *store = [[ORKResultStore alloc] initWithDirectory:directory];
+    NSCalendar *calendar = [NSCalendar calendarWithIdentifier:NSCalendarIdentifierGregorian];
+    calendar.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+    NSDate *day0 = [NSDate dateWithTimeIntervalSinceReferenceDate:0];
+    
+    // Two sessions on the first day and one on the second, added out of order.
+    ORKTaskResult *late = [self trendTaskResultWithDate:[day0 dateByAddingTimeInterval:86400 + 3600] scale:7 tapCount:40];
+    ORKTaskResult *first = [self trendTaskResultWithDate:[day0 dateByAddingTimeInterval:3600] scale:2 tapCount:30];
+    ORKTaskResult *second = [self trendTaskResultWithDate:[day0 dateByAddingTimeInterval:7200] scale:4 tapCount:50];
+    NSError *error = nil;
+    for (ORKTaskResult *taskResult in @[late, first, second]) {
+        XCTAssertTrue([store addTaskResult:taskResult error:&error], @"%@", error);
+    }
+    XCTAssertEqual(store.taskResultCount, 3);
+    XCTAssertFalse([store addTaskResult:first error:&error]);
+    XCTAssertEqual(error.code, ORKErrorInvalidObject);
+    
+    ORKResultStoreQuery *query = [ORKResultStoreQuery new];
+    query.taskIdentifier = @"trend";
+    query.resultIdentifier = @"mood";
+    NSArray *records = [store recordsMatchingQuery:query];
+    XCTAssertEqualObjects([records valueForKey:@"numericValue"], (@[@2, @4, @7]));
+    ORKResultStoreRecord *record = records.firstObject;
+    XCTAssertEqualObjects(record.taskRunUUID, first.taskRunUUID);
+    XCTAssertEqualObjects(record.stepIdentifier, @"survey");
+    XCTAssertEqualObjects(record.key, @"answer");
+    
+    query.resultIdentifier = @"note";
+    XCTAssertEqualObjects([[store recordsMatchingQuery:query] valueForKey:@"stringValue"], (@[@"fine", @"fine", @"fine"]));
+    
+    // Values of other result classes are found by introspection.
+    query.resultIdentifier = @"tapping.right";
+    query.key = @"statistics.tapCount";
+    query.minimumValue = @(35);
+    XCTAssertEqualObjects([[store recordsMatchingQuery:query] valueForKey:@"numericValue"], (@[@50, @40]));
+    query.minimumValue = nil;
+    
+    query.startDate = [day0 dateByAddingTimeInterval:86400];
+    XCTAssertEqualObjects([[store recordsMatchingQuery:query] valueForKey:@"numericValue"], (@[@40]));
+    query.startDate = nil;
+    
+    NSArray *statistics = [store dailyStatisticsForQuery:query calendar:calendar];
+    XCTAssertEqual(statistics.count, 2);
+    ORKResultStoreStatistics *day = statistics[0];
+    XCTAssertEqualObjects(day.startDate, day0);
+    XCTAssertEqual(day.count, 2);
+    XCTAssertEqual(day.minimum, 30);
+    XCTAssertEqual(day.maximum, 50);
+    XCTAssertEqual(day.mean, 40);
+    XCTAssertEqual([statistics[1] count], 1);
+    
+    query.taskIdentifier = @"missing";
+    XCTAssertEqual([store recordsMatchingQuery:query].count, 0);
+    
+    // A new store on the same directory reads the index and the archived task results back.
+    ORKResultStore *reopened = [[ORKResultStore alloc] initWithDirectory:directory];
+    XCTAssertEqual(reopened.taskResultCount, 3);
+    query.taskIdentifier = @"trend";
+    XCTAssertEqual([reopened dailyStatisticsForQuery:query calendar:calendar].count, 2);
+    XCTAssertEqualObjects([reopened taskResultWithTaskRunUUID:second.taskRunUUID error:&error], second);
+    XCTAssertNil([reopened taskResultWithTaskRunUUID:[NSUUID UUID] error:&error]);
+    
+    [[NSFileManager defaultManager] removeItemAtURL:directory error:NULL];
+}
+
+- (void)testResultStoreRecoversFromTornTail {
+    NSURL *directory = [self temporaryDirectory];
+    NSDate *day0 = [NSDate dateWithTimeIntervalSinceReferenceDate:0];
+    NSError *error = nil;
+    ORKResultStore *store = [[ORKResultStore alloc] initWithDirectory:directory];
+    XCTAssertTrue([store addTaskResult:[self trendTaskResultWithDate:day0 scale:1 tapCount:10] error:&error], @"%@", error);
+    
+    // Simulate writes cut short: a partial string record and a partial index entry.
+    for (NSString *name in @[@"strings", @"index"]) {
+        NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:[directory URLByAppendingPathComponent:name] error:&error];
+        XCTAssertNotNil(fileHandle, @"%@", error);
+        [fileHandle seekToEndOfFile];
+        uint32_t length = 100;
+        [fileHandle writeData:[NSData dataWithBytes:&length length:sizeof(length)]];
+        [fileHandle writeData:[@"torn" dataUsingEncoding:NSUTF8StringEncoding]];
+        [fileHandle closeFile];
+    }
+    
+    // Appending after the torn tail, with new strings, and reloading keeps every record intact.
+    ORKResultStore *reopened = [[ORKResultStore alloc] initWithDirectory:directory];
+    XCTAssertEqual(reopened.taskResultCount, 1);
+    ORKTaskResult *taskResult = [self trendTaskResultWithDate:[day0 dateByAddingTimeInterval:3600] scale:2 tapCount:20];
+    ORKStepResult *surveyResult = (ORKStepResult *)[taskResult resultForIdentifier:@"survey"];
+    ORKTextQuestionResult *textResult = (ORKTextQuestionResult *)[surveyResult resultForIdentifier:@"note"];
+    textResult.textAnswer = @"better";
+    XCTAssertTrue([reopened addTaskResult:taskResult error:&error], @"%@", error);
+    
+    ORKResultStore *reloaded = [[ORKResultStore alloc] initWithDirectory:directory];
+    XCTAssertEqual(reloaded.taskResultCount, 2);
+    ORKResultStoreQuery *query = [ORKResultStoreQuery new];
+    query.taskIdentifier = @"trend";
+    query.resultIdentifier = @"mood";
+    XCTAssertEqualObjects([[reloaded recordsMatchingQuery:query] valueForKey:@"numericValue"], (@[@1, @2]));
+    query.resultIdentifier = @"note";
+    XCTAssertEqualObjects([[reloaded recordsMatchingQuery:query] valueForKey:@"stringValue"], (@[@"fine", @"better"]));
+    NSArray *records = [reloaded recordsMatchingQuery:query];
+    XCTAssertEqualObjects([records.lastObject taskRunUUID], taskResult.taskRunUUID);
+    XCTAssertEqualObjects([records.lastObject stepIdentifier], @"survey");
+    
+    [[NSFileManager defaultManager] removeItemAtURL:directory error:NULL];
+}
+
+// 10k sessions over 90 days; daily statistics over the whole range.
+- (void)testResultStoreQueryPerformance {
+    NSURL *directory = [self temporaryDirectory];
+    ORKResultStore *store = [[ORKResultStore alloc] initWithDirectory:directory];
+    NSDate *day0 = [NSDate dateWithTimeIntervalSinceReferenceDate:0];
+    const NSInteger sessionCount = 10000;
+    for (NSInteger i = 0; i < sessionCount; i++) {
+        NSDate *date = [day0 dateByAddingTimeInterval:i * (90 * 86400.0 / sessionCount)];
+        XCTAssertTrue([store addTaskResult:[self trendTaskResultWithDate:date scale:i % 10 tapCount:i % 100] error:NULL]);
+    }
+    XCTAssertEqual(store.taskResultCount, sessionCount);
+    
+    ORKResultStoreQuery *query = [ORKResultStoreQuery new];
+    query.taskIdentifier = @"trend";
+    query.resultIdentifier = @"tapping.right";
+    query.key = @"statistics.tapCount";
+    NSCalendar *calendar = [NSCalendar calendarWithIdentifier:NSCalendarIdentifierGregorian];
+    
+    [self measureBlock:^{
+        NSArray *statistics = [store dailyStatisticsForQuery:query calendar:calendar];
+        XCTAssertGreaterThanOrEqual(statistics.count, 90);
+        XCTAssertEqual([[statistics valueForKeyPath:@"@sum.count"] integerValue], sessionCount);
+    }];
+    
+    [[NSFileManager defaultManager] removeItemAtURL:directory error:NULL];
+}
+
+// A random question result of one of the types the conditions below compare.
+- (ORKQuestionResult *)randomQuestionResultWithGenerator:(ORKRandomNumberGenerator *)generator {
+    NSArray *moods = @[ @"happy", @"Happy", @"sad", @"ok" ];
+    NSArray *symptoms = @[ @"fever", @"cough", @"rash" ];
+    switch ([generator nextUInt32WithUpperBound:8]) {
+        case 0:
+        case 1: {
+            ORKNumericQuestionResult *result = [[ORKNumericQuestionResult alloc] initWithIdentifier:([generator nextUInt32WithUpperBound:2] ? @"phq.1" : @"phq.2")];
+            result.numericAnswer = @([generator nextUInt32WithUpperBound:28]);
+            return result;
+        }
+        case 2: {
+            ORKScaleQuestionResult *result = [[ORKScaleQuestionResult alloc] initWithIdentifier:@"scale"];
+            result.scaleAnswer = @([generator nextUInt32WithUpperBound:1000] / 100.0);
+            return result;
+        }
+        case 3: {
+            ORKBooleanQuestionResult *result = [[ORKBooleanQuestionResult alloc] initWithIdentifier:@"smoker"];
+            uint32_t answer = [generator nextUInt32WithUpperBound:3];
+            result.booleanAnswer = (answer == 2) ? nil : @(answer == 1);
+            return result;
+        }
+        case 4: {
+            ORKTextQuestionResult *result = [[ORKTextQuestionResult alloc] initWithIdentifier:@"mood"];
+            result.textAnswer = moods[[generator nextUInt32WithUpperBound:(uint32_t)moods.count]];
+            return result;
+        }
+        case 5: {
+            ORKChoiceQuestionResult *result = [[ORKChoiceQuestionResult alloc] initWithIdentifier:@"symptoms"];
+            NSMutableArray *answers = [NSMutableArray array];
+            uint32_t mask = 1 + [generator nextUInt32WithUpperBound:7];
+            for (NSUInteger i = 0; i < symptoms.count; i++) {
+                if (mask & (1 << i)) {
+                    [answers addObject:symptoms[i]];
+                }
+            }
+            result.choiceAnswers = answers;
+            return result;
+        }
+        case 6: {
+            ORKDateQuestionResult *result = [[ORKDateQuestionResult alloc] initWithIdentifier:@"onset"];
+            result.dateAnswer = [NSDate dateWithTimeIntervalSinceReferenceDate:[generator nextUInt32WithUpperBound:30] * 86400.0];
+            return result;
+        }
+        default: {
+            ORKTimeOfDayQuestionResult *result = [[ORKTimeOfDayQuestionResult alloc] initWithIdentifier:@"wake"];
+            NSDateComponents *components = [NSDateComponents new];
+            components.hour = [generator nextUInt32WithUpperBound:24];
+            components.minute = [generator nextUInt32WithUpperBound:60];
+            result.dateComponentsAnswer = components;
+            return result;
+        }
+    }
+}
+
+// `count` groups of one to three task results, each with up to three steps of up to three question results.
+- (NSArray *)randomTaskResultGroupsWithCount:(NSUInteger)count seed:(uint64_t)seed {
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:seed];
+    NSArray *taskIdentifiers = @[ @"task.a", @"task.b", @"survey" ];
+    NSURL *outputDirectory = [NSURL fileURLWithPath:NSTemporaryDirectory()];
+    NSMutableArray *groups = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSMutableArray *taskResults = [NSMutableArray array];
+        uint32_t taskCount = 1 + [generator nextUInt32WithUpperBound:3];
+        for (uint32_t t = 0; t < taskCount; t++) {
+            ORKTaskResult *taskResult = [[ORKTaskResult alloc] initWithTaskIdentifier:taskIdentifiers[[generator nextUInt32WithUpperBound:3]]
+                                                                          taskRunUUID:[NSUUID UUID]
+                                                                      outputDirectory:outputDirectory];
+            NSMutableArray *stepResults = [NSMutableArray array];
+            uint32_t stepCount = 1 + [generator nextUInt32WithUpperBound:3];
+            for (uint32_t s = 0; s < stepCount; s++) {
+                NSMutableArray *questionResults = [NSMutableArray array];
+                uint32_t questionCount = [generator nextUInt32WithUpperBound:4];
+                for (uint32_t q = 0; q < questionCount; q++) {
+                    [questionResults addObject:[self randomQuestionResultWithGenerator:generator]];
+                }
+                [stepResults addObject:[[ORKStepResult alloc] initWithStepIdentifier:[NSString stringWithFormat:@"step%u", s] results:questionResults]];
+            }
+            taskResult.results = stepResults;
+            [taskResults addObject:taskResult];
+        }
+        [groups addObject:taskResults];
+    }
+    return groups;
+}
+
+- (NSArray *)sampleResultConditions {
+    NSDate *day10 = [NSDate dateWithTimeIntervalSinceReferenceDate:10 * 86400.0];
+    NSDate *day20 = [NSDate dateWithTimeIntervalSinceReferenceDate:20 * 86400.0];
+    return @[ [ORKResultCondition conditionForNumericQuestionResultWithTaskIdentifier:@"task.a" resultIdentifier:@"phq.1" minimumExpectedAnswerValue:10 maximumExpectedAnswerValue:ORKIgnoreDoubleValue],
+              [ORKResultCondition conditionForNumericQuestionResultWithTaskIdentifier:nil resultIdentifier:@"phq.?" minimumExpectedAnswerValue:ORKIgnoreDoubleValue maximumExpectedAnswerValue:4],
+              [ORKResultCondition conditionForNumericQuestionResultWithTaskIdentifier:@"task.*" resultIdentifier:@"phq.2" expectedAnswer:7],
+              [ORKResultCondition conditionForNumericQuestionResultWithTaskIdentifier:@"survey" resultIdentifier:@"scale" minimumExpectedAnswerValue:2.5 maximumExpectedAnswerValue:7.25],
+              [ORKResultCondition conditionForBooleanQuestionResultWithTaskIdentifier:nil resultIdentifier:@"smoker" expectedAnswer:YES],
+              [ORKResultCondition conditionForBooleanQuestionResultWithTaskIdentifier:@"*" resultIdentifier:@"smoker" expectedAnswer:NO],
+              [ORKResultCondition conditionForTextQuestionResultWithTaskIdentifier:@"task.b" resultIdentifier:@"mood" expectedString:@"?appy"],
+              [ORKResultCondition conditionForTextQuestionResultWithTaskIdentifier:nil resultIdentifier:@"mood" matchingPattern:@"s.*|ok"],
+              [ORKResultCondition conditionForChoiceQuestionResultWithTaskIdentifier:@"survey" resultIdentifier:@"symptoms" expectedStrings:@[ @"fever" ]],
+              [ORKResultCondition conditionForChoiceQuestionResultWithTaskIdentifier:@"task.?" resultIdentifier:@"symptoms" expectedStrings:@[ @"cough", @"rash" ]],
+              [ORKResultCondition conditionForChoiceQuestionResultWithTaskIdentifier:nil resultIdentifier:@"symptoms" matchingPatterns:@[ @"f.*", @".*h" ]],
+              [ORKResultCondition conditionForDateQuestionResultWithTaskIdentifier:@"task.a" resultIdentifier:@"onset" minimumExpectedAnswerDate:day10 maximumExpectedAnswerDate:day20],
+              [ORKResultCondition conditionForDateQuestionResultWithTaskIdentifier:@"survey" resultIdentifier:@"onset" minimumExpectedAnswerDate:nil maximumExpectedAnswerDate:day10],
+              [ORKResultCondition conditionForTimeOfDayQuestionResultWithTaskIdentifier:nil resultIdentifier:@"wake" minimumExpectedAnswerHour:6 minimumExpectedAnswerMinute:0 maximumExpectedAnswerHour:8 maximumExpectedAnswerMinute:30],
+              [ORKResultCondition conditionForNumericQuestionResultWithTaskIdentifier:@"task.a" resultIdentifier:@"missing" expectedAnswer:1] ];
+}
+
+- (void)testResultConditionEvaluatorMatchesPredicates {
+    NSArray *groups = [self randomTaskResultGroupsWithCount:500 seed:67];
+    NSArray *conditions = [self sampleResultConditions];
+    ORKResultConditionEvaluator *evaluator = [[ORKResultConditionEvaluator alloc] initWithTaskResultGroups:groups];
+    XCTAssertEqual(evaluator.numberOfGroups, groups.count);
+    
+    ORKResultConditionMatrix *matrix = [evaluator evaluateConditions:conditions taskIdentifier:@"task.a"];
+    XCTAssertEqual(matrix.numberOfConditions, conditions.count);
+    XCTAssertEqual(matrix.numberOfGroups, groups.count);
+    
+    NSDictionary *variables = @{ ORKResultPredicateTaskIdentifierVariableName : @"task.a" };
+    for (NSUInteger c = 0; c < conditions.count; c++) {
+        NSPredicate *predicate = [[conditions[c] predicate] predicateWithSubstitutionVariables:variables];
+        NSMutableIndexSet *expectedIndexes = [NSMutableIndexSet indexSet];
+        for (NSUInteger g = 0; g < groups.count; g++) {
+            BOOL expected = [predicate evaluateWithObject:groups[g]];
+            XCTAssertEqual([matrix conditionAtIndex:c matchesGroupAtIndex:g], expected, @"condition %@, group %@", @(c), @(g));
+            if (expected) {
+                [expectedIndexes addIndex:g];
+            }
+        }
+        XCTAssertEqualObjects([matrix groupIndexesMatchingConditionAtIndex:c], expectedIndexes);
+    }
+    // Sanity check that the random corpus exercises both outcomes.
+    XCTAssertGreaterThan([matrix groupIndexesMatchingConditionAtIndex:0].count, 0);
+    XCTAssertLessThan([matrix groupIndexesMatchingConditionAtIndex:0].count, groups.count);
+    XCTAssertEqual([matrix groupIndexesMatchingConditionAtIndex:conditions.count - 1].count, 0);
+    
+    NSMutableIndexSet *bothIndexes = [[matrix groupIndexesMatchingConditionAtIndex:0] mutableCopy];
+    [bothIndexes removeIndexes:[[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, groups.count)] indexesPassingTest:^BOOL(NSUInteger idx, BOOL *stop) {
+        return ![matrix conditionAtIndex:1 matchesGroupAtIndex:idx];
+    }]];
+    ORKResultConditionMatrix *firstTwo = [evaluator evaluateConditions:[conditions subarrayWithRange:NSMakeRange(0, 2)] taskIdentifier:@"task.a"];
+    XCTAssertEqualObjects([firstTwo groupIndexesMatchingAllConditions], bothIndexes);
+    
+    XCTAssertThrows([evaluator evaluateConditions:conditions taskIdentifier:nil]);
+}
+
+// 5000 participants, 15 conditions.
+- (void)testResultConditionEvaluatorPerformance {
+    NSArray *groups = [self randomTaskResultGroupsWithCount:5000 seed:68];
+    NSArray *conditions = [self sampleResultConditions];
+    [self measureBlock:^{
+        ORKResultConditionEvaluator *evaluator = [[ORKResultConditionEvaluator alloc] initWithTaskResultGroups:groups];
+        ORKResultConditionMatrix *matrix = [evaluator evaluateConditions:conditions taskIdentifier:@"task.a"];
+        XCTAssertEqual(matrix.numberOfGroups, groups.count);
+    }];
+}
+
+// The same corpus and conditions, evaluated one predicate and one participant at a time.
+- (void)testResultConditionPredicateBaselinePerformance {
+    NSArray *groups = [self randomTaskResultGroupsWithCount:5000 seed:68];
+    NSMutableArray *predicates = [NSMutableArray array];
+    for (ORKResultCondition *condition in [self sampleResultConditions]) {
+        [predicates addObject:[condition.predicate predicateWithSubstitutionVariables:@{ ORKResultPredicateTaskIdentifierVariableName : @"task.a" }]];
+    }
+    [self measureBlock:^{
+        NSUInteger matchCount = 0;
+        for (NSPredicate *predicate in predicates) {
+            for (NSArray *group in groups) {
+                matchCount += [predicate evaluateWithObject:group] ? 1 : 0;
+            }
+        }
+        XCTAssertGreaterThan(matchCount, 0);
+    }];
+}
+
+// Two-pass reference computations over a whole session.
+static double ORKReferenceMean(NSArray *values) {
+    double sum = 0;
+    for (NSNumber *value in values) {
+        sum += value.doubleValue;
+    }
+    return values.count ? sum / values.count : 0;
+}
+
+static double ORKReferenceStandardDeviation(NSArray *values) {
+    if (values.count < 2) {
+        return 0;
+    }
+    double mean = ORKReferenceMean(values);
+    double sum = 0;
+    for (NSNumber *value in values) {
+        sum += (value.doubleValue - mean) * (value.doubleValue - mean);
+    }
+    return sqrt(sum / (values.count - 1));
+}
+
+- (void)testTappingStatisticsMatchOfflineReference {
+    // A 20 second session at ~5 taps/s that slows down, with jitter, occasional misses and repeated buttons.
+    srand48(42);
+    NSMutableArray *samples = [NSMutableArray array];
+    NSMutableArray *dwellTimes = [NSMutableArray array];
+    NSTimeInterval timestamp = 1000;
+    for (NSInteger i = 0; i < 100; i++) {
+        timestamp += 0.2 + 0.001 * i + 0.03 * (drand48() - 0.5);
+        ORKTappingSample *sample = [ORKTappingSample new];
+        sample.timestamp = timestamp;
+        if (i % 17 == 5) {
+            sample.buttonIdentifier = ORKTappingButtonIdentifierNone;
+        } else {
+            sample.buttonIdentifier = (i % 2 || i % 11 == 0) ? ORKTappingButtonIdentifierRight : ORKTappingButtonIdentifierLeft;
+            [dwellTimes addObject:@(0.08 + 0.04 * drand48())];
+        }
+        [samples addObject:sample];
+    }
+    
+    ORKTappingStatisticsEngine *engine = [ORKTappingStatisticsEngine new];
+    for (ORKTappingSample *sample in samples) {
+        [engine addTapWithTimestamp:sample.timestamp buttonIdentifier:sample.buttonIdentifier];
+    }
+    for (NSNumber *dwellTime in dwellTimes) {
+        [engine addDwellTime:dwellTime.doubleValue];
+    }
+    ORKTappingIntervalStatistics *statistics = [engine statistics];
+    
+    // Offline reference
+    NSArray *hits = [samples filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"buttonIdentifier != %@", @(ORKTappingButtonIdentifierNone)]];
+    NSMutableArray *intervals = [NSMutableArray array];
+    NSMutableArray *intervalTimes = [NSMutableArray array];
+    NSInteger alternations = 0;
+    for (NSUInteger i = 1; i < hits.count; i++) {
+        ORKTappingSample *previous = hits[i - 1];
+        ORKTappingSample *current = hits[i];
+        [intervals addObject:@(current.timestamp - previous.timestamp)];
+        [intervalTimes addObject:@(current.timestamp)];
+        alternations += (current.buttonIdentifier != previous.buttonIdentifier);
+    }
+    double meanInterval = ORKReferenceMean(intervals);
+    double meanTime = ORKReferenceMean(intervalTimes);
+    double covariance = 0;
+    double timeVariance = 0;
+    for (NSUInteger i = 0; i < intervals.count; i++) {
+        double dt = [intervalTimes[i] doubleValue] - meanTime;
+        covariance += dt * ([intervals[i] doubleValue] - meanInterval);
+        timeVariance += dt * dt;
+    }
+    
+    const double accuracy = 1e-9;
+    XCTAssertEqual(statistics.tapCount, (NSInteger)hits.count);
+    XCTAssertEqualWithAccuracy(statistics.meanInterTapInterval, meanInterval, accuracy);
+    XCTAssertEqualWithAccuracy(statistics.interTapIntervalStandardDeviation, ORKReferenceStandardDeviation(intervals), accuracy);
+    XCTAssertEqualWithAccuracy(statistics.interTapIntervalCoefficientOfVariation, ORKReferenceStandardDeviation(intervals) / meanInterval, accuracy);
+    XCTAssertEqualWithAccuracy(statistics.alternationAccuracy, (double)alternations / intervals.count, accuracy);
+    XCTAssertEqualWithAccuracy(statistics.interTapIntervalDrift, covariance / timeVariance, accuracy);
+    XCTAssertGreaterThan(statistics.interTapIntervalDrift, 0);
+    XCTAssertEqualWithAccuracy(statistics.meanDwellTime, ORKReferenceMean(dwellTimes), accuracy);
+    XCTAssertEqualWithAccuracy(statistics.dwellTimeStandardDeviation, ORKReferenceStandardDeviation(dwellTimes), accuracy);
+    
+    [engine reset];
+    XCTAssertEqualObjects([engine statistics], [ORKTappingIntervalStatistics new]);
+}
+
+- (void)testSpatialSpanMemoryGameRecordBuilder {
+    ORKSpatialSpanMemoryGameRecordBuilder *builder = [[ORKSpatialSpanMemoryGameRecordBuilder alloc] initWithSeed:7 gameSize:9 sequence:@[@4, @1, @7]];
+    
+    XCTAssertTrue([builder addTouchWithTimestamp:0.5 location:CGPointZero targetIndex:4]);
+    XCTAssertFalse([builder addTouchWithTimestamp:0.8 location:CGPointZero targetIndex:-1]);
+    XCTAssertTrue([builder addTouchWithTimestamp:1.2 location:CGPointZero targetIndex:1]);
+    XCTAssertFalse([builder addTouchWithTimestamp:1.6 location:CGPointZero targetIndex:4]);
+    builder.gameStatus = ORKSpatialSpanMemoryGameStatusFailure;
+    builder.score = 10;
+    
+    ORKSpatialSpanMemoryGameRecord *record = [builder record];
+    XCTAssertEqual([builder record], record, @"The record is built once until the builder changes");
+    XCTAssertEqual(record.seed, 7);
+    XCTAssertEqualObjects(record.sequence, (@[@4, @1, @7]));
+    XCTAssertEqual(record.touchSamples.count, 4);
+    XCTAssertEqualObjects([record.touchSamples valueForKey:@"correct"], (@[@YES, @NO, @YES, @NO]));
+    XCTAssertEqual(record.correctSequenceLength, 2);
+    XCTAssertEqual(record.numberOfErrors, 2);
+    XCTAssertEqualWithAccuracy(record.meanTimePerTarget, 0.6, 1e-9);
+    XCTAssertEqual(record.gameStatus, ORKSpatialSpanMemoryGameStatusFailure);
+    XCTAssertEqual(record.score, 10);
+    
+    // Touches after the sequence is complete are never correct.
+    XCTAssertTrue([builder addTouchWithTimestamp:2.0 location:CGPointZero targetIndex:7]);
+    XCTAssertFalse([builder addTouchWithTimestamp:2.1 location:CGPointZero targetIndex:7]);
+    XCTAssertNotEqual([builder record], record);
+    XCTAssertEqual(record.touchSamples.count, 4);
+}
+
+- (void)testSpatialSpanMemoryGameRecordBuilderPerformance {
+    const NSInteger sequenceLength = 5000;
+    NSMutableArray *sequence = [NSMutableArray arrayWithCapacity:sequenceLength];
+    for (NSInteger i = 0; i < sequenceLength; i++) {
+        [sequence addObject:@(i)];
+    }
+    
+    [self measureBlock:^{
+        ORKSpatialSpanMemoryGameRecordBuilder *builder = [[ORKSpatialSpanMemoryGameRecordBuilder alloc] initWithSeed:1 gameSize:sequenceLength sequence:sequence];
+        for (NSInteger i = 0; i < sequenceLength; i++) {
+            [builder addTouchWithTimestamp:i * 0.1 location:CGPointMake(i, i) targetIndex:i];
+            [builder addTouchWithTimestamp:i * 0.1 + 0.05 location:CGPointMake(i, i) targetIndex:-1];
+        }
+        XCTAssertEqual([builder record].correctSequenceLength, sequenceLength);
+        XCTAssertEqual([builder record].numberOfErrors, sequenceLength);
+    }];
+}
+
+static double ORKChiSquare(const NSUInteger *counts, NSUInteger bucketCount) {
+    NSUInteger total = 0;
+    for (NSUInteger i = 0; i < bucketCount; i++) {
+        total += counts[i];
+    }
+    double expected = (double)total / bucketCount;
+    double chiSquare = 0;
+    for (NSUInteger i = 0; i < bucketCount; i++) {
+        double delta = counts[i] - expected;
+        chiSquare += delta * delta / expected;
+    }
+    return chiSquare;
+}
+
+- (void)testRandomNumberGeneratorReferenceOutput {
+    // First outputs of the PCG32 reference implementation for seed 42, sequence 54.
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:42 sequence:54];
+    const uint32_t expected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+    for (NSUInteger i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        XCTAssertEqual([generator nextUInt32], expected[i]);
+    }
+    
+    ORKRandomNumberGenerator *a = [[ORKRandomNumberGenerator alloc] initWithSeed:7];
+    ORKRandomNumberGenerator *b = [[ORKRandomNumberGenerator alloc] initWithSeed:7];
+    for (NSUInteger i = 0; i < 1000; i++) {
+        XCTAssertEqual([a nextUInt32WithUpperBound:100], [b nextUInt32WithUpperBound:100]);
+    }
+}
+
+- (void)testRandomNumberGeneratorBoundedDrawIsUniform {
+    // With this bound, a modulo reduction would make the lowest third twice as likely as the others.
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:2015];
+    NSUInteger thirds[3] = { 0 };
+    for (NSUInteger i = 0; i < 3000000; i++) {
+        uint32_t value = [generator nextUInt32WithUpperBound:0xC0000000];
+        XCTAssertLessThan(value, 0xC0000000);
+        thirds[value >> 30]++;
+    }
+    // Critical value for 2 degrees of freedom at p = 0.001.
+    XCTAssertLessThan(ORKChiSquare(thirds, 3), 13.82);
+    
+    generator = [[ORKRandomNumberGenerator alloc] initWithSeed:7];
+    NSUInteger faces[6] = { 0 };
+    for (NSUInteger i = 0; i < 3000000; i++) {
+        faces[[generator nextUInt32WithUpperBound:6]]++;
+    }
+    // Critical value for 5 degrees of freedom at p = 0.001.
+    XCTAssertLessThan(ORKChiSquare(faces, 6), 20.52);
+}
+
+- (void)testRandomNumberGeneratorShuffleIsUniform {
+    ORKRandomNumberGenerator *generator = [[ORKRandomNumberGenerator alloc] initWithSeed:2016];
+    NSUInteger counts[256] = { 0 };
+    for (NSUInteger i = 0; i < 2400000; i++) {
+        NSInteger values[4] = { 0, 1, 2, 3 };
+        [generator shuffleIntegers:values count:4];
+        counts[values[0] * 64 + values[1] * 16 + values[2] * 4 + values[3]]++;
+    }
+    
+    NSUInteger permutationCounts[24];
+    NSUInteger permutationCount = 0;
+    for (NSUInteger i = 0; i < 256; i++) {
+        if (counts[i] > 0) {
+            XCTAssertLessThan(permutationCount, 24);
+            if (permutationCount < 24) {
+                permutationCounts[permutationCount] = counts[i];
+            }
+            permutationCount++;
+        }
+    }
+    XCTAssertEqual(permutationCount, 24);
+    // Critical value for 23 degrees of freedom at p = 0.001.
+    XCTAssertLessThan(ORKChiSquare(permutationCounts, 24), 49.73);
+}
+
+- (void)testSpatialSpanGameSequence {
+    ORKSpatialSpanGame *game = [[ORKSpatialSpanGame alloc] initWithGameSize:9 sequenceLength:5 seed:12345];
+    NSMutableArray *sequence = [NSMutableArray array];
+    __block NSInteger lastStep = -1;
+    [game enumerateSequenceWithHandler:^(NSInteger step, NSInteger tileIndex, BOOL isLastStep, BOOL *stop) {
+        [sequence addObject:@(tileIndex)];
+        if (isLastStep) {
+            lastStep = step;
+        }
+    }];
+    XCTAssertEqualObjects(sequence, (@[@1, @5, @6, @7, @8]));
+    XCTAssertEqual(lastStep, 4);
+    
+    // The sequence depends only on the seed and game size, so longer games extend shorter ones.
+    ORKSpatialSpanGame *longerGame = [[ORKSpatialSpanGame alloc] initWithGameSize:9 sequenceLength:8 seed:12345];
+    for (NSInteger i = 0; i < 5; i++) {
+        XCTAssertEqual([longerGame tileIndexForStep:i], [sequence[i] integerValue]);
+    }
+    
+    // Interleaving games does not disturb either sequence.
+    ORKSpatialSpanGame *other = [[ORKSpatialSpanGame alloc] initWithGameSize:9 sequenceLength:4 seed:1];
+    XCTAssertEqual([other tileIndexForStep:0], 6);
+    XCTAssertEqual([other tileIndexForStep:1], 3);
+    XCTAssertEqual([other tileIndexForStep:2], 1);
+    XCTAssertEqual([other tileIndexForStep:3], 4);
+}
+
 - (void)testCollectionResult {
     ORKCollectionResult *result = [[ORKCollectionResult alloc] initWithIdentifier:@"001"];
     [result setResults:@[ [[ORKResult alloc]initWithIdentifier: @"101"], [[ORKResult alloc]initWithIdentifier: @"007"] ]];
@@ -0,0 +1,212 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import <UIKit/UIKit.h>
+#import "ORKStyleCache.h"
+#import "ORKHelpers.h"
+#import "ORKHeadlineLabel.h"
+#import "ORKSelectionTitleLabel.h"
+#import "ORKSelectionSubTitleLabel.h"
+#import "ORKTintedImageView.h"
+
+
+@interface ORKStyleCacheTests : XCTestCase
+
+@end
+
+
+@implementation ORKStyleCacheTests
+
+- (void)setUp {
+    [super setUp];
+    [[ORKStyleCache sharedCache] invalidate];
+    [[ORKStyleCache sharedCache] resetCounts];
+}
+
+- (UIImage *)imageWithColor:(UIColor *)color {
+    UIGraphicsBeginImageContextWithOptions(CGSizeMake(4, 4), NO, 1);
+    [color setFill];
+    UIRectFill(CGRectMake(0, 0, 4, 4));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    return image;
+}
+
+- (void)testStylesAreResolvedOnce {
+    ORKStyleCache *cache = [ORKStyleCache sharedCache];
+    UIFont *font = ORKCachedDefaultFont([ORKSelectionTitleLabel class]);
+    XCTAssertEqualObjects(font, [ORKSelectionTitleLabel defaultFont]);
+    XCTAssertEqual(ORKCachedDefaultFont([ORKSelectionTitleLabel class]), font);
+    XCTAssertEqual(cache.lookupCount, 2);
+    XCTAssertEqual(cache.resolutionCount, 1);
+    
+    [cache invalidate];
+    XCTAssertEqualObjects(ORKCachedDefaultFont([ORKSelectionTitleLabel class]), font);
+    XCTAssertEqual(cache.resolutionCount, 2);
+    
+    // Survey mode headlines have their own style
+    ORKHeadlineLabel *headlineLabel = [ORKHeadlineLabel new];
+    UIFont *headlineFont = headlineLabel.font;
+    XCTAssertEqualObjects(headlineFont, [ORKHeadlineLabel defaultFont]);
+    NSUInteger resolutionCount = cache.resolutionCount;
+    headlineLabel.useSurveyMode = YES;
+    XCTAssertEqual(cache.resolutionCount, resolutionCount + 1);
+    headlineLabel.useSurveyMode = NO;
+    XCTAssertEqualObjects(headlineLabel.font, headlineFont);
+}
+
+- (void)testTextMeasurement {
+    ORKLabel *label = [[ORKSelectionTitleLabel alloc] initWithFrame:CGRectMake(0, 0, 100, 20)];
+    label.text = @"A fairly long line of text that has to wrap over several lines";
+    CGFloat expectedHeight = [label.text boundingRectWithSize:CGSizeMake(100, CGFLOAT_MAX)
+                                                      options:NSStringDrawingUsesLineFragmentOrigin
+                                                   attributes:@{ NSFontAttributeName : label.font }
+                                                      context:nil].size.height;
+    XCTAssertEqual(ORKExpectedLabelHeight(label), expectedHeight);
+    XCTAssertEqual(ORKExpectedLabelHeight(label), expectedHeight);
+    XCTAssertEqual([ORKStyleCache sharedCache].resolutionCount, 2); // Font and height
+    
+    label.frame = CGRectMake(0, 0, 300, 20);
+    XCTAssertLessThan(ORKExpectedLabelHeight(label), expectedHeight);
+    label.text = nil;
+    XCTAssertEqual(ORKExpectedLabelHeight(label), 0);
+}
+
+- (void)testTintedImages {
+    ORKTintedImageView *imageView = [ORKTintedImageView new];
+    imageView.shouldApplyTint = YES;
+    UIImage *redImage = [self imageWithColor:[UIColor redColor]];
+    UIImage *blueImage = [self imageWithColor:[UIColor blueColor]];
+    
+    imageView.image = redImage;
+    UIImage *tintedRedImage = imageView.image;
+    XCTAssertEqual(tintedRedImage.renderingMode, UIImageRenderingModeAlwaysTemplate);
+    
+    // Each image gets its own tinted image, which is reused on reassignment
+    imageView.image = blueImage;
+    XCTAssertNotEqual(imageView.image, tintedRedImage);
+    imageView.image = redImage;
+    XCTAssertEqual(imageView.image, tintedRedImage);
+    
+    // Animated images are tinted per color
+    UIImage *animatedImage = [UIImage animatedImageWithImages:@[ redImage, blueImage ] duration:1];
+    UIImage *greenImage = [[ORKStyleCache sharedCache] tintedImageForImage:animatedImage tintColor:[UIColor greenColor] scale:2 resolver:^UIImage *{
+        return [self imageWithColor:[UIColor greenColor]];
+    }];
+    UIImage *blackImage = [[ORKStyleCache sharedCache] tintedImageForImage:animatedImage tintColor:[UIColor blackColor] scale:2 resolver:^UIImage *{
+        return [self imageWithColor:[UIColor blackColor]];
+    }];
+    XCTAssertNotEqual(greenImage, blackImage);
+    XCTAssertEqual([[ORKStyleCache sharedCache] tintedImageForImage:animatedImage tintColor:[UIColor greenColor] scale:2 resolver:^UIImage *{
+        XCTFail(@"Should be cached");
+        return nil;
+    }], greenImage);
+}
+
+- (void)testColorCustomizationInvalidates {
+    UIColor *originalColor = ORKColor(ORKCaptionTextColorKey);
+    XCTAssertNotNil(originalColor);
+    ORKColorSetColorForKey(ORKCaptionTextColorKey, [UIColor purpleColor]);
+    XCTAssertEqualObjects(ORKColor(ORKCaptionTextColorKey), [UIColor purpleColor]);
+    
+    // Keys equal to, but not identical with, the constants resolve the same way
+    NSString *key = [NSMutableString stringWithString:ORKCaptionTextColorKey];
+    XCTAssertEqualObjects(ORKColor(key), [UIColor purpleColor]);
+    
+    ORKColorSetColorForKey(ORKCaptionTextColorKey, originalColor);
+    XCTAssertEqualObjects(ORKColor(ORKCaptionTextColorKey), originalColor);
+}
+
+/*
+ Scrolling harness: cells of a long survey are reconfigured as they scroll into view. Only
+ the first screenful should need to resolve styles; after that, every lookup is a hit.
+ */
+- (NSUInteger)resolutionsForScrollingRows:(NSUInteger)rowCount images:(NSArray *)images {
+    static const NSUInteger VisibleCellCount = 10;
+    NSMutableArray *cells = [NSMutableArray array];
+    for (NSUInteger i = 0; i < VisibleCellCount; i++) {
+        ORKHeadlineLabel *headlineLabel = [[ORKHeadlineLabel alloc] initWithFrame:CGRectMake(0, 0, 300, 40)];
+        headlineLabel.useSurveyMode = YES;
+        ORKTintedImageView *imageView = [ORKTintedImageView new];
+        imageView.shouldApplyTint = YES;
+        [cells addObject:@[ headlineLabel,
+                            [[ORKSelectionTitleLabel alloc] initWithFrame:CGRectMake(0, 0, 300, 20)],
+                            [[ORKSelectionSubTitleLabel alloc] initWithFrame:CGRectMake(0, 0, 300, 20)],
+                            imageView ]];
+    }
+    
+    ORKStyleCache *cache = [ORKStyleCache sharedCache];
+    [cache resetCounts];
+    for (NSUInteger row = 0; row < rowCount; row++) {
+        NSArray *cell = cells[row % VisibleCellCount];
+        for (NSUInteger i = 0; i < 3; i++) {
+            ORKLabel *label = cell[i];
+            label.text = [NSString stringWithFormat:@"Question %@", @(row % VisibleCellCount)];
+            [label updateAppearance];
+            ORKAdjustHeightForLabel(label);
+        }
+        [(ORKTintedImageView *)cell[3] setImage:images[row % images.count]];
+    }
+    NSLog(@"Scrolling %@ rows: %@ style lookups, %@ resolutions", @(rowCount), @(cache.lookupCount), @(cache.resolutionCount));
+    return cache.resolutionCount;
+}
+
+- (void)testPurgeableCache {
+    ORKStyleCache *styleCache = [ORKStyleCache sharedCache];
+    XCTAssertEqual(styleCache.cacheCost, 0);
+    
+    [styleCache heightForText:@"Lorem ipsum" font:[UIFont systemFontOfSize:17] width:200];
+    [styleCache tintedImageForImage:[self imageWithColor:[UIColor blackColor]] tintColor:[UIColor redColor] scale:1 resolver:^UIImage *{
+        return [self imageWithColor:[UIColor redColor]];
+    }];
+    XCTAssertGreaterThan(styleCache.cacheCost, 4 * 4 * 4);
+    
+    [styleCache purgeCache];
+    XCTAssertEqual(styleCache.cacheCost, 0);
+}
+
+- (void)testScrollingResolutions {
+    NSArray *images = @[ [self imageWithColor:[UIColor redColor]], [self imageWithColor:[UIColor blueColor]] ];
+    NSUInteger firstScroll = [self resolutionsForScrollingRows:1000 images:images];
+    XCTAssertLessThanOrEqual(firstScroll, 40);
+    XCTAssertEqual([self resolutionsForScrollingRows:1000 images:images], 0);
+    XCTAssertGreaterThan([ORKStyleCache sharedCache].lookupCount, 1000);
+}
+
+- (void)testScrollingPerformance {
+    NSArray *images = @[ [self imageWithColor:[UIColor redColor]], [self imageWithColor:[UIColor blueColor]] ];
+    [self measureBlock:^{
+        [self resolutionsForScrollingRows:1000 images:images];
+    }];
+}
+
+@end
@@ -0,0 +1,366 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import <ResearchKit/ResearchKit.h>
+#import "ORKTaskRunner.h"
+
+
+static NSString *const IntroStepIdentifier = @"intro";
+static NSString *const BranchStepIdentifier = @"branch";
+static NSString *const YesStepIdentifier = @"yes";
+static NSString *const NoStepIdentifier = @"no";
+static NSString *const EndStepIdentifier = @"end";
+
+
+// Answers boolean questions from a fixed answer, or at random, and optionally goes back at random.
+@interface ORKTestAnswerProvider : NSObject <ORKTaskRunnerAnswerProvider>
+
+@property (nonatomic, copy) NSNumber *answer;
+@property (nonatomic) double backwardProbability;
+@property (nonatomic) NSUInteger askedCount;
+
+@end
+
+
+@implementation ORKTestAnswerProvider
+
+- (ORKStepResult *)taskRunner:(ORKTaskRunner *)taskRunner resultForStep:(ORKStep *)step previousResult:(ORKStepResult *)previousResult {
+    _askedCount++;
+    if (! [step isKindOfClass:[ORKQuestionStep class]]) {
+        return nil;
+    }
+    ORKBooleanQuestionResult *questionResult = [[ORKBooleanQuestionResult alloc] initWithIdentifier:step.identifier];
+    questionResult.questionType = ORKQuestionTypeBoolean;
+    questionResult.booleanAnswer = _answer ? : @(arc4random_uniform(2) == 1);
+    return [[ORKStepResult alloc] initWithStepIdentifier:step.identifier results:@[questionResult]];
+}
+
+- (BOOL)taskRunner:(ORKTaskRunner *)taskRunner shouldGoBackwardFromStep:(ORKStep *)step {
+    return (_backwardProbability > 0 && arc4random_uniform(1000) < _backwardProbability * 1000);
+}
+
+@end
+
+
+// Gives a task view controller the same scripted answers as a task runner: each question step view
+// controller is created with the answer the task runner is then given for that visit.
+@interface ORKScriptedTaskViewControllerDelegate : NSObject <ORKTaskViewControllerDelegate>
+
+@property (nonatomic, strong) ORKTaskRunner *taskRunner;
+@property (nonatomic, strong) ORKTestAnswerProvider *answerProvider;
+@property (nonatomic, strong) ORKStepResult *currentAnswer;
+@property (nonatomic) BOOL finished;
+
+@end
+
+
+@implementation ORKScriptedTaskViewControllerDelegate
+
+- (ORKStepViewController *)taskViewController:(ORKTaskViewController *)taskViewController viewControllerForStep:(ORKStep *)step {
+    _currentAnswer = [_answerProvider taskRunner:_taskRunner resultForStep:step previousResult:nil];
+    if (! _currentAnswer) {
+        return nil;
+    }
+    return [[ORKQuestionStepViewController alloc] initWithStep:step result:_currentAnswer];
+}
+
+- (void)taskViewController:(ORKTaskViewController *)taskViewController didFinishWithReason:(ORKTaskViewControllerFinishReason)reason error:(NSError *)error {
+    _finished = (reason == ORKTaskViewControllerFinishReasonCompleted);
+}
+
+@end
+
+
+@interface ORKTaskRunnerTests : XCTestCase
+
+@end
+
+
+@implementation ORKTaskRunnerTests
+
+- (ORKQuestionStep *)booleanQuestionStepWithIdentifier:(NSString *)identifier {
+    return [ORKQuestionStep questionStepWithIdentifier:identifier title:identifier answer:[ORKAnswerFormat booleanAnswerFormat]];
+}
+
+// intro -> branch -> (yes | no) -> end, branching on the answer at the branch step.
+- (ORKNavigableOrderedTask *)branchingTask {
+    ORKInstructionStep *introStep = [[ORKInstructionStep alloc] initWithIdentifier:IntroStepIdentifier];
+    introStep.title = @"Intro";
+    ORKInstructionStep *endStep = [[ORKInstructionStep alloc] initWithIdentifier:EndStepIdentifier];
+    endStep.title = @"End";
+    NSArray *steps = @[introStep,
+                       [self booleanQuestionStepWithIdentifier:BranchStepIdentifier],
+                       [self booleanQuestionStepWithIdentifier:YesStepIdentifier],
+                       [self booleanQuestionStepWithIdentifier:NoStepIdentifier],
+                       endStep];
+    ORKNavigableOrderedTask *task = [[ORKNavigableOrderedTask alloc] initWithIdentifier:@"branching" steps:steps];
+    
+    NSPredicate *predicate = [ORKResultPredicate predicateForBooleanQuestionResultWithResultIdentifier:BranchStepIdentifier expectedAnswer:YES];
+    ORKPredicateStepNavigationRule *predicateRule = [[ORKPredicateStepNavigationRule alloc] initWithResultPredicates:@[predicate]
+                                                                                              matchingStepIdentifiers:@[YesStepIdentifier]
+                                                                                                defaultStepIdentifier:NoStepIdentifier];
+    [task setNavigationRule:predicateRule forTriggerStepIdentifier:BranchStepIdentifier];
+    ORKDirectStepNavigationRule *directRule = [[ORKDirectStepNavigationRule alloc] initWithDestinationStepIdentifier:EndStepIdentifier];
+    [task setNavigationRule:directRule forTriggerStepIdentifier:YesStepIdentifier];
+    return task;
+}
+
+// A long survey of boolean questions in which every fifth question can skip the next four.
+- (ORKNavigableOrderedTask *)longTaskWithStepCount:(NSUInteger)stepCount {
+    NSMutableArray *steps = [NSMutableArray arrayWithCapacity:stepCount];
+    for (NSUInteger index = 0; index < stepCount; index++) {
+        [steps addObject:[self booleanQuestionStepWithIdentifier:[NSString stringWithFormat:@"q%lu", (unsigned long)index]]];
+    }
+    ORKNavigableOrderedTask *task = [[ORKNavigableOrderedTask alloc] initWithIdentifier:@"long" steps:steps];
+    for (NSUInteger index = 0; index + 5 < stepCount; index += 5) {
+        NSString *identifier = [steps[index] identifier];
+        NSPredicate *predicate = [ORKResultPredicate predicateForBooleanQuestionResultWithResultIdentifier:identifier expectedAnswer:NO];
+        ORKPredicateStepNavigationRule *rule = [[ORKPredicateStepNavigationRule alloc] initWithResultPredicates:@[predicate]
+                                                                                         matchingStepIdentifiers:@[[steps[index + 5] identifier]]];
+        [task setNavigationRule:rule forTriggerStepIdentifier:identifier];
+    }
+    return task;
+}
+
+- (NSArray *)stepIdentifiersOfResult:(ORKTaskResult *)result {
+    return [result.results valueForKey:@"identifier"];
+}
+
+- (void)testOrderedTaskRun {
+    ORKOrderedTask *task = [[ORKOrderedTask alloc] initWithIdentifier:@"ordered" steps:@[[self booleanQuestionStepWithIdentifier:@"a"],
+                                                                                         [self booleanQuestionStepWithIdentifier:@"b"],
+                                                                                         [self booleanQuestionStepWithIdentifier:@"c"]]];
+    NSUUID *taskRunUUID = [NSUUID UUID];
+    ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:taskRunUUID];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    answerProvider.answer = @YES;
+    
+    ORKTaskResult *result = [runner runWithAnswerProvider:answerProvider maximumStepCount:100];
+    XCTAssertTrue(runner.finished);
+    XCTAssertNil(runner.currentStep);
+    XCTAssertEqual(answerProvider.askedCount, 3);
+    XCTAssertEqualObjects(result.identifier, @"ordered");
+    XCTAssertEqualObjects(result.taskRunUUID, taskRunUUID);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:result], (@[@"a", @"b", @"c"]));
+    ORKBooleanQuestionResult *questionResult = (ORKBooleanQuestionResult *)[[result stepResultForStepIdentifier:@"b"] firstResult];
+    XCTAssertEqualObjects(questionResult.booleanAnswer, @YES);
+}
+
+- (void)testNavigationRules {
+    ORKNavigableOrderedTask *task = [self branchingTask];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    
+    answerProvider.answer = @YES;
+    ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:nil];
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:[runner runWithAnswerProvider:answerProvider maximumStepCount:100]],
+                          (@[IntroStepIdentifier, BranchStepIdentifier, YesStepIdentifier, EndStepIdentifier]));
+    
+    answerProvider.answer = @NO;
+    runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:nil];
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:[runner runWithAnswerProvider:answerProvider maximumStepCount:100]],
+                          (@[IntroStepIdentifier, BranchStepIdentifier, NoStepIdentifier, EndStepIdentifier]));
+}
+
+- (void)testBackNavigation {
+    ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:[self branchingTask] taskRunUUID:nil];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    answerProvider.answer = @YES;
+    
+    XCTAssertEqualObjects([runner start].identifier, IntroStepIdentifier);
+    XCTAssertFalse(runner.canGoBackward);
+    XCTAssertNil([runner goBackward]);
+    
+    ORKStep *step = [runner goForwardWithResult:nil];
+    XCTAssertEqualObjects(step.identifier, BranchStepIdentifier);
+    ORKStepResult *yesResult = [answerProvider taskRunner:runner resultForStep:step previousResult:nil];
+    step = [runner goForwardWithResult:yesResult];
+    XCTAssertEqualObjects(step.identifier, YesStepIdentifier);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:runner.result], (@[IntroStepIdentifier, BranchStepIdentifier, YesStepIdentifier]));
+    
+    // Going back drops the current step from the result, but keeps the answer given at the branch
+    XCTAssertTrue(runner.canGoBackward);
+    step = [runner goBackward];
+    XCTAssertEqualObjects(step.identifier, BranchStepIdentifier);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:runner.result], (@[IntroStepIdentifier, BranchStepIdentifier]));
+    XCTAssertEqual([runner previousResultForStep:step], yesResult);
+    XCTAssertEqual([runner.result stepResultForStepIdentifier:BranchStepIdentifier], yesResult);
+    
+    // A different answer takes the other branch
+    answerProvider.answer = @NO;
+    step = [runner goForwardWithResult:[answerProvider taskRunner:runner resultForStep:step previousResult:nil]];
+    XCTAssertEqualObjects(step.identifier, NoStepIdentifier);
+    step = [runner goForwardWithResult:[[ORKStepResult alloc] initWithStepIdentifier:NoStepIdentifier results:@[]]];
+    XCTAssertEqualObjects(step.identifier, EndStepIdentifier);
+    XCTAssertNil([runner goForwardWithResult:nil]);
+    XCTAssertTrue(runner.finished);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:runner.result], (@[IntroStepIdentifier, BranchStepIdentifier, NoStepIdentifier, EndStepIdentifier]));
+    XCTAssertEqual(runner.navigationCount, 6);
+}
+
+- (void)testResultIdentifierMustMatchStep {
+    ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:[self branchingTask] taskRunUUID:nil];
+    [runner start];
+    XCTAssertThrows([runner goForwardWithResult:[[ORKStepResult alloc] initWithStepIdentifier:@"other" results:@[]]]);
+    XCTAssertThrows([runner start]);
+}
+
+- (void)testRestoration {
+    ORKNavigableOrderedTask *task = [self branchingTask];
+    ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:nil];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    answerProvider.answer = @NO;
+    
+    [runner start];
+    ORKStep *step = [runner goForwardWithResult:nil];
+    step = [runner goForwardWithResult:[answerProvider taskRunner:runner resultForStep:step previousResult:nil]];
+    XCTAssertEqualObjects(step.identifier, NoStepIdentifier);
+    ORKTaskResult *savedResult = runner.result;
+    
+    ORKTaskRunner *restoredRunner = [[ORKTaskRunner alloc] initWithTask:task restorationData:runner.restorationData];
+    XCTAssertEqualObjects(restoredRunner.taskRunUUID, runner.taskRunUUID);
+    XCTAssertEqualObjects(restoredRunner.currentStep.identifier, NoStepIdentifier);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:restoredRunner.result], [self stepIdentifiersOfResult:savedResult]);
+    XCTAssertEqualObjects([restoredRunner.result stepResultForStepIdentifier:BranchStepIdentifier],
+                          [savedResult stepResultForStepIdentifier:BranchStepIdentifier]);
+    
+    ORKTaskResult *result = [restoredRunner runWithAnswerProvider:answerProvider maximumStepCount:100];
+    XCTAssertTrue(restoredRunner.finished);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:result], (@[IntroStepIdentifier, BranchStepIdentifier, NoStepIdentifier, EndStepIdentifier]));
+    
+    ORKTaskRunner *otherTaskRunner = [[ORKTaskRunner alloc] initWithTask:[[ORKOrderedTask alloc] initWithIdentifier:@"other" steps:task.steps] taskRunUUID:nil];
+    XCTAssertThrows((void)[[ORKTaskRunner alloc] initWithTask:otherTaskRunner.task restorationData:runner.restorationData]);
+}
+
+- (void)testRestorationDataMatchesTaskViewController {
+    ORKNavigableOrderedTask *task = [self branchingTask];
+    ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:nil];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    answerProvider.answer = @YES;
+    [runner start];
+    ORKStep *step = [runner goForwardWithResult:nil];
+    [runner goForwardWithResult:[answerProvider taskRunner:runner resultForStep:step previousResult:nil]];
+    
+    ORKTaskViewController *taskViewController = [[ORKTaskViewController alloc] initWithTask:task restorationData:runner.restorationData];
+    XCTAssertEqualObjects(taskViewController.taskRunUUID, runner.taskRunUUID);
+    XCTAssertEqualObjects(taskViewController.currentStepViewController.step.identifier, YesStepIdentifier);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:taskViewController.result], [self stepIdentifiersOfResult:runner.result]);
+    XCTAssertEqualObjects([taskViewController.result stepResultForStepIdentifier:BranchStepIdentifier],
+                          [runner.result stepResultForStepIdentifier:BranchStepIdentifier]);
+    
+    ORKTaskRunner *restoredRunner = [[ORKTaskRunner alloc] initWithTask:task restorationData:taskViewController.restorationData];
+    XCTAssertEqualObjects(restoredRunner.currentStep.identifier, YesStepIdentifier);
+    XCTAssertEqualObjects([self stepIdentifiersOfResult:restoredRunner.result], [self stepIdentifiersOfResult:runner.result]);
+}
+
+// The step identifiers and boolean answers of a task result, which do not depend on when steps were answered.
+- (NSArray *)answersOfResult:(ORKTaskResult *)result {
+    NSMutableArray *answers = [NSMutableArray array];
+    for (ORKStepResult *stepResult in result.results) {
+        ORKBooleanQuestionResult *questionResult = (ORKBooleanQuestionResult *)stepResult.firstResult;
+        [answers addObject:@[stepResult.identifier, questionResult.booleanAnswer ? : [NSNull null]]];
+    }
+    return answers;
+}
+
+- (void)testRunsMatchTaskViewController {
+    ORKNavigableOrderedTask *task = [self longTaskWithStepCount:60];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    
+    for (NSUInteger run = 0; run < 10; run++) {
+        ORKTaskViewController *taskViewController = [[ORKTaskViewController alloc] initWithTask:task taskRunUUID:nil];
+        ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:taskViewController.taskRunUUID];
+        ORKScriptedTaskViewControllerDelegate *delegate = [ORKScriptedTaskViewControllerDelegate new];
+        delegate.taskRunner = runner;
+        delegate.answerProvider = answerProvider;
+        taskViewController.delegate = delegate;
+        taskViewController.view.frame = CGRectMake(0, 0, 320, 480);
+        [taskViewController viewWillAppear:NO];
+        
+        ORKStep *step = [runner start];
+        NSUInteger navigationCount = 0;
+        while (step && navigationCount++ < 1000) {
+            ORKStepViewController *stepViewController = taskViewController.currentStepViewController;
+            XCTAssertEqualObjects(stepViewController.step.identifier, step.identifier);
+            XCTAssertEqual([taskViewController stepViewControllerHasPreviousStep:stepViewController], runner.canGoBackward);
+            
+            if (runner.canGoBackward && arc4random_uniform(10) == 0) {
+                [taskViewController stepViewController:stepViewController didFinishWithNavigationDirection:ORKStepViewControllerNavigationDirectionReverse];
+                step = [runner goBackward];
+            } else {
+                [taskViewController stepViewController:stepViewController didFinishWithNavigationDirection:ORKStepViewControllerNavigationDirectionForward];
+                step = [runner goForwardWithResult:delegate.currentAnswer];
+            }
+        }
+        XCTAssertTrue(runner.finished);
+        XCTAssertTrue(delegate.finished);
+        XCTAssertEqualObjects([self answersOfResult:taskViewController.result], [self answersOfResult:runner.result]);
+    }
+}
+
+- (void)testRandomizedRuns {
+    ORKNavigableOrderedTask *task = [self longTaskWithStepCount:300];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    answerProvider.backwardProbability = 0.1;
+    
+    for (NSUInteger run = 0; run < 50; run++) {
+        ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:nil];
+        ORKTaskResult *result = [runner runWithAnswerProvider:answerProvider maximumStepCount:10000];
+        XCTAssertTrue(runner.finished);
+        
+        // Each step follows the previous one, or is reached by a skip from the question five before it
+        NSArray *stepResults = result.results;
+        XCTAssertEqualObjects([stepResults.firstObject identifier], @"q0");
+        XCTAssertEqualObjects([stepResults.lastObject identifier], @"q299");
+        for (NSUInteger index = 1; index < stepResults.count; index++) {
+            NSInteger previousIndex = [[[stepResults[index - 1] identifier] substringFromIndex:1] integerValue];
+            NSInteger stepIndex = [[[stepResults[index] identifier] substringFromIndex:1] integerValue];
+            ORKBooleanQuestionResult *previousAnswer = (ORKBooleanQuestionResult *)[stepResults[index - 1] firstResult];
+            BOOL skipped = (previousIndex % 5 == 0 && previousIndex + 5 < 300 && ! previousAnswer.booleanAnswer.boolValue);
+            XCTAssertEqual(stepIndex, previousIndex + (skipped ? 5 : 1));
+        }
+    }
+}
+
+- (void)testRandomizedRunsPerformance {
+    ORKNavigableOrderedTask *task = [self longTaskWithStepCount:300];
+    ORKTestAnswerProvider *answerProvider = [ORKTestAnswerProvider new];
+    answerProvider.backwardProbability = 0.05;
+    
+    [self measureBlock:^{
+        for (NSUInteger run = 0; run < 100; run++) {
+            ORKTaskRunner *runner = [[ORKTaskRunner alloc] initWithTask:task taskRunUUID:nil];
+            [runner runWithAnswerProvider:answerProvider maximumStepCount:10000];
+        }
+    }];
+}
+
+@end
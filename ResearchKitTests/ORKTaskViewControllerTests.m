@@ -0,0 +1,332 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import <ResearchKit/ResearchKit.h>
+#import "ORKTaskViewController_Internal.h"
+#import "ORKStepViewController_Internal.h"
+#import "ORKRecorder_Private.h"
+#import "ORKRecorder_Internal.h"
+
+
+// Stands in for a recorder that takes `stopDelay` to sync and close its file after stopping.
+@interface ORKSlowStoppingRecorder : ORKRecorder
+
+@property (nonatomic) NSTimeInterval stopDelay;
+
+@end
+
+
+@implementation ORKSlowStoppingRecorder
+
+- (void)stopWithCompletion:(ORKRecorderStopCompletion)completion {
+    ORKFileResult *result = [[ORKFileResult alloc] initWithIdentifier:self.identifier];
+    [self finishRecordingWithError:nil];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_stopDelay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        completion(result, nil);
+    });
+}
+
+@end
+
+
+@interface ORKSlowStoppingRecorderConfiguration : ORKRecorderConfiguration
+
+@property (nonatomic) NSTimeInterval stopDelay;
+
+@end
+
+
+@implementation ORKSlowStoppingRecorderConfiguration
+
+- (ORKRecorder *)recorderForStep:(ORKStep *)step outputDirectory:(NSURL *)outputDirectory {
+    ORKSlowStoppingRecorder *recorder = [[ORKSlowStoppingRecorder alloc] initWithIdentifier:self.identifier step:step outputDirectory:outputDirectory];
+    recorder.stopDelay = _stopDelay;
+    return recorder;
+}
+
+@end
+
+
+@interface ORKTestRoutingTask : NSObject <ORKTask>
+
+// Identifier of the step that follows the introduction.
+@property (nonatomic, copy) NSString *branchIdentifier;
+
+@end
+
+
+@implementation ORKTestRoutingTask {
+    NSDictionary *_steps;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        NSMutableDictionary *steps = [NSMutableDictionary dictionary];
+        for (NSString *identifier in @[@"intro", @"a", @"b"]) {
+            ORKInstructionStep *step = [[ORKInstructionStep alloc] initWithIdentifier:identifier];
+            step.title = identifier;
+            steps[identifier] = step;
+        }
+        _steps = [steps copy];
+        _branchIdentifier = @"a";
+    }
+    return self;
+}
+
+- (NSString *)identifier {
+    return @"routing";
+}
+
+- (ORKStep *)stepWithIdentifier:(NSString *)identifier {
+    return _steps[identifier];
+}
+
+- (ORKStep *)stepAfterStep:(ORKStep *)step withResult:(ORKTaskResult *)result {
+    if (step == nil) {
+        return _steps[@"intro"];
+    }
+    if ([step.identifier isEqualToString:@"intro"]) {
+        return _steps[_branchIdentifier];
+    }
+    return nil;
+}
+
+- (ORKStep *)stepBeforeStep:(ORKStep *)step withResult:(ORKTaskResult *)result {
+    if ([step.identifier isEqualToString:@"intro"]) {
+        return nil;
+    }
+    return _steps[@"intro"];
+}
+
+@end
+
+
+@interface ORKTaskViewControllerTests : XCTestCase
+
+@end
+
+
+@implementation ORKTaskViewControllerTests {
+    ORKTestRoutingTask *_task;
+    ORKTaskViewController *_taskViewController;
+}
+
+- (void)setUp {
+    [super setUp];
+    _task = [ORKTestRoutingTask new];
+    _taskViewController = [[ORKTaskViewController alloc] initWithTask:_task taskRunUUID:nil];
+    _taskViewController.view.frame = CGRectMake(0, 0, 320, 480);
+    [_taskViewController viewWillAppear:NO];
+}
+
+- (void)testPreparedViewControllerIsUsedForNextStep {
+    XCTAssertEqualObjects(_taskViewController.currentStepViewController.step.identifier, @"intro");
+    XCTAssertTrue(_taskViewController.preparesNextStepViewController);
+    
+    [_taskViewController prepareViewControllerForNextStep];
+    ORKStepViewController *preparedViewController = _taskViewController.preparedStepViewController;
+    XCTAssertEqualObjects(preparedViewController.step.identifier, @"a");
+    XCTAssertTrue(preparedViewController.isViewLoaded);
+    XCTAssertTrue(preparedViewController.preparedAheadOfPresentation);
+    // Configured as it would be for presentation, before its view was loaded.
+    XCTAssertEqual(preparedViewController.delegate, _taskViewController);
+    XCTAssertNotNil(preparedViewController.cancelButtonItem);
+    
+    [_taskViewController stepViewController:_taskViewController.currentStepViewController didFinishWithNavigationDirection:ORKStepViewControllerNavigationDirectionForward];
+    XCTAssertEqual(_taskViewController.currentStepViewController, preparedViewController);
+    XCTAssertFalse(preparedViewController.preparedAheadOfPresentation);
+    XCTAssertTrue(_taskViewController.lastTransitionUsedPreparedStepViewController);
+    XCTAssertNil(_taskViewController.preparedStepViewController);
+}
+
+- (void)testPreparedViewControllerFollowsRoute {
+    [_taskViewController prepareViewControllerForNextStep];
+    ORKStepViewController *preparedViewController = _taskViewController.preparedStepViewController;
+    XCTAssertEqualObjects(preparedViewController.step.identifier, @"a");
+    
+    // Unchanged route keeps the prepared view controller
+    [_taskViewController prepareViewControllerForNextStep];
+    XCTAssertEqual(_taskViewController.preparedStepViewController, preparedViewController);
+    
+    _task.branchIdentifier = @"b";
+    [_taskViewController prepareViewControllerForNextStep];
+    XCTAssertEqualObjects(_taskViewController.preparedStepViewController.step.identifier, @"b");
+    
+    [_taskViewController stepViewController:_taskViewController.currentStepViewController didFinishWithNavigationDirection:ORKStepViewControllerNavigationDirectionForward];
+    XCTAssertEqualObjects(_taskViewController.currentStepViewController.step.identifier, @"b");
+    XCTAssertTrue(_taskViewController.lastTransitionUsedPreparedStepViewController);
+    
+    // Nothing follows the last step
+    [_taskViewController prepareViewControllerForNextStep];
+    XCTAssertNil(_taskViewController.preparedStepViewController);
+}
+
+- (void)testStalePreparedViewControllerIsNotUsed {
+    [_taskViewController prepareViewControllerForNextStep];
+    ORKStepViewController *preparedViewController = _taskViewController.preparedStepViewController;
+    XCTAssertNotNil(preparedViewController);
+    
+    // The route changed after preparation, without a chance to prepare again
+    _task.branchIdentifier = @"b";
+    [_taskViewController stepViewController:_taskViewController.currentStepViewController didFinishWithNavigationDirection:ORKStepViewControllerNavigationDirectionForward];
+    XCTAssertEqualObjects(_taskViewController.currentStepViewController.step.identifier, @"b");
+    XCTAssertNotEqual(_taskViewController.currentStepViewController, preparedViewController);
+    XCTAssertFalse(_taskViewController.lastTransitionUsedPreparedStepViewController);
+}
+
+- (void)testPreparationCanBeDisabled {
+    _taskViewController.preparesNextStepViewController = NO;
+    [_taskViewController prepareViewControllerForNextStep];
+    XCTAssertNil(_taskViewController.preparedStepViewController);
+}
+
+- (void)testMemoryWarningDiscardsPreparation {
+    [_taskViewController prepareViewControllerForNextStep];
+    XCTAssertNotNil(_taskViewController.preparedStepViewController);
+    
+    [_taskViewController didReceiveMemoryWarning];
+    XCTAssertNil(_taskViewController.preparedStepViewController);
+    
+    [_taskViewController prepareViewControllerForNextStep];
+    XCTAssertNil(_taskViewController.preparedStepViewController);
+}
+
+- (void)testPreparedViewControllerIsPurgedOnlyUnderMemoryPressure {
+    ORKCacheManager *cacheManager = [ORKCacheManager sharedManager];
+    NSUInteger totalCostLimit = cacheManager.totalCostLimit;
+    cacheManager.totalCostLimit = 1;
+    
+    // Well over the budget, yet kept.
+    [_taskViewController prepareViewControllerForNextStep];
+    ORKStepViewController *preparedViewController = _taskViewController.preparedStepViewController;
+    XCTAssertNotNil(preparedViewController);
+    XCTAssertGreaterThan(cacheManager.totalCost, cacheManager.totalCostLimit);
+    [cacheManager cacheCostDidChange:(id<ORKPurgeableCache>)_taskViewController];
+    XCTAssertEqual(_taskViewController.preparedStepViewController, preparedViewController);
+    
+    [cacheManager handleMemoryPressure:ORKMemoryPressureLevelWarning];
+    XCTAssertNil(_taskViewController.preparedStepViewController);
+    
+    cacheManager.totalCostLimit = totalCostLimit;
+}
+
+- (void)testActiveStepViewControllerIsPreparedWithoutRecorders {
+    ORKInstructionStep *introStep = [[ORKInstructionStep alloc] initWithIdentifier:@"intro"];
+    introStep.title = @"intro";
+    ORKActiveStep *activeStep = [[ORKActiveStep alloc] initWithIdentifier:@"active"];
+    activeStep.recorderConfigurations = @[[[ORKSlowStoppingRecorderConfiguration alloc] initWithIdentifier:@"recorder"]];
+    ORKOrderedTask *task = [[ORKOrderedTask alloc] initWithIdentifier:@"task" steps:@[introStep, activeStep]];
+    
+    ORKTaskViewController *taskViewController = [[ORKTaskViewController alloc] initWithTask:task taskRunUUID:nil];
+    NSURL *outputDirectory = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString] isDirectory:YES];
+    taskViewController.outputDirectory = outputDirectory;
+    taskViewController.view.frame = CGRectMake(0, 0, 320, 480);
+    [taskViewController viewWillAppear:NO];
+    
+    // The view is loaded and laid out ahead of the step, but no recorders are made for it yet.
+    [taskViewController prepareViewControllerForNextStep];
+    ORKActiveStepViewController *preparedViewController = (ORKActiveStepViewController *)taskViewController.preparedStepViewController;
+    XCTAssertTrue([preparedViewController isKindOfClass:[ORKActiveStepViewController class]]);
+    XCTAssertTrue(preparedViewController.isViewLoaded);
+    XCTAssertEqualObjects(preparedViewController.outputDirectory, outputDirectory);
+    XCTAssertEqual(preparedViewController.recorders.count, 0);
+    
+    [taskViewController stepViewController:taskViewController.currentStepViewController didFinishWithNavigationDirection:ORKStepViewControllerNavigationDirectionForward];
+    XCTAssertEqual(taskViewController.currentStepViewController, preparedViewController);
+    XCTAssertTrue(taskViewController.lastTransitionUsedPreparedStepViewController);
+    XCTAssertEqual(preparedViewController.recorders.count, 1);
+    
+    [[NSFileManager defaultManager] removeItemAtURL:outputDirectory error:NULL];
+}
+
+// Runs an active step with `recorderCount` recorders that each take `stopDelay` to deliver their results,
+// then returns the transition duration recorded for the step that follows it.
+- (NSTimeInterval)transitionDurationAfterActiveStepInTaskOfClass:(Class)taskClass recorderCount:(NSUInteger)recorderCount stopDelay:(NSTimeInterval)stopDelay {
+    NSMutableArray *recorderConfigurations = [NSMutableArray array];
+    for (NSUInteger i = 0; i < recorderCount; i++) {
+        ORKSlowStoppingRecorderConfiguration *configuration = [[ORKSlowStoppingRecorderConfiguration alloc] initWithIdentifier:[NSString stringWithFormat:@"recorder%lu", (unsigned long)i]];
+        configuration.stopDelay = stopDelay;
+        [recorderConfigurations addObject:configuration];
+    }
+    ORKActiveStep *activeStep = [[ORKActiveStep alloc] initWithIdentifier:@"active"];
+    activeStep.recorderConfigurations = recorderConfigurations;
+    activeStep.shouldContinueOnFinish = YES;
+    ORKInstructionStep *nextStep = [[ORKInstructionStep alloc] initWithIdentifier:@"next"];
+    nextStep.title = @"next";
+    ORKOrderedTask *task = [[taskClass alloc] initWithIdentifier:@"task" steps:@[activeStep, nextStep]];
+    
+    ORKTaskViewController *taskViewController = [[ORKTaskViewController alloc] initWithTask:task taskRunUUID:nil];
+    taskViewController.collectsPerformanceMetrics = YES;
+    taskViewController.view.frame = CGRectMake(0, 0, 320, 480);
+    [taskViewController viewWillAppear:NO];
+    
+    ORKActiveStepViewController *activeStepViewController = (ORKActiveStepViewController *)taskViewController.currentStepViewController;
+    XCTAssertEqualObjects(activeStepViewController.step.identifier, @"active");
+    [activeStepViewController start];
+    [activeStepViewController finish];
+    
+    // Either way, the recorder results end up in the active step's result.
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    ORKStepResult *nextResult = nil;
+    ORKStepResult *activeResult = nil;
+    while ([timeout timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+        ORKTaskResult *taskResult = taskViewController.result;
+        activeResult = (ORKStepResult *)[taskResult resultForIdentifier:@"active"];
+        nextResult = (ORKStepResult *)[taskResult resultForIdentifier:@"next"];
+        if (activeResult.results.count == recorderCount && nextResult.userInfo[ORKResultPerformanceMetricsKey][ORKPerformanceMetricTransitionDurationKey]) {
+            break;
+        }
+    }
+    XCTAssertEqual(activeResult.results.count, recorderCount);
+    XCTAssertEqualObjects(taskViewController.currentStepViewController.step.identifier, @"next");
+    
+    NSNumber *transitionDuration = nextResult.userInfo[ORKResultPerformanceMetricsKey][ORKPerformanceMetricTransitionDurationKey];
+    XCTAssertNotNil(transitionDuration);
+    return transitionDuration.doubleValue;
+}
+
+- (void)testTransitionDoesNotWaitForRecorderResults {
+    const NSUInteger recorderCount = 8;
+    const NSTimeInterval stopDelay = 0.5;
+    
+    // A navigable task may branch on the recorder results, so it still waits for them, as all tasks used to.
+    NSTimeInterval waiting = [self transitionDurationAfterActiveStepInTaskOfClass:[ORKNavigableOrderedTask class] recorderCount:recorderCount stopDelay:stopDelay];
+    NSTimeInterval immediate = [self transitionDurationAfterActiveStepInTaskOfClass:[ORKOrderedTask class] recorderCount:recorderCount stopDelay:stopDelay];
+    NSLog(@"Transition after %lu recorders: %.1f ms waiting for results, %.1f ms without", (unsigned long)recorderCount, waiting * 1000.0, immediate * 1000.0);
+    
+    XCTAssertGreaterThanOrEqual(waiting, stopDelay);
+    XCTAssertLessThan(immediate, stopDelay);
+}
+
+@end
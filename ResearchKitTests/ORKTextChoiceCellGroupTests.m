@@ -272,4 +272,43 @@
     }
 }
 
+- (void)testPurgeKeepsSelectionAndLiveCells {
+    ORKTextChoiceAnswerFormat *answerFormat = [ORKTextChoiceAnswerFormat choiceAnswerFormatWithStyle:ORKChoiceAnswerStyleMultipleChoice textChoices:[self textChoices]];
+    
+    ORKTextChoiceCellGroup *group = [[ORKTextChoiceCellGroup alloc] initWithTextChoiceAnswerFormat:answerFormat
+                                                                                            answer:@[@"c2"]
+                                                                                beginningIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]
+                                                                               immediateNavigation:NO];
+    
+    ORKChoiceViewCell *retainedCell = nil;
+    @autoreleasepool {
+        for (NSUInteger index = 0; index < group.size; index++) {
+            ORKChoiceViewCell *cell = [group cellAtIndexPath:[NSIndexPath indexPathForRow:index inSection:0] withReuseIdentifier:@"abc"];
+            if (index == 0) {
+                // Stands in for a table view holding on to the cell.
+                retainedCell = cell;
+            }
+        }
+    }
+    NSUInteger fullCost = group.cacheCost;
+    XCTAssertGreaterThan(fullCost, 0, @"");
+    
+    [group purgeCache];
+    
+    // Only the selected cell is still held strongly.
+    XCTAssertEqual(group.cacheCost, fullCost / 4, @"");
+    XCTAssertEqualObjects(group.answer, @[@"c2"], @"");
+    
+    // A purged cell that is still alive is reused rather than replaced.
+    XCTAssertEqual([group cellAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0] withReuseIdentifier:@"abc"], retainedCell, @"");
+    XCTAssertEqual(group.cacheCost, fullCost / 2, @"");
+    
+    // Selection still works across purged cells.
+    [group didSelectCellAtIndexPath:[NSIndexPath indexPathForRow:3 inSection:0]];
+    NSArray *expectedAnswer = @[@"c2", @"c4"];
+    XCTAssertEqualObjects(group.answer, expectedAnswer, @"");
+    XCTAssertTrue([group cellAtIndexPath:[NSIndexPath indexPathForRow:3 inSection:0] withReuseIdentifier:@"abc"].selectedItem, @"");
+    XCTAssertFalse(retainedCell.selectedItem, @"");
+}
+
 @end
@@ -0,0 +1,201 @@
+/*
+ Copyright (c) 2015, Apple Inc. All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+ 
+ 1.  Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 
+ 2.  Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+ 
+ 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission. No license is granted to the trademarks of
+ the copyright holders even if such marks are included in this software.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#import <XCTest/XCTest.h>
+#import <ResearchKit/ResearchKit.h>
+#import "ORKTraceBuffer_Internal.h"
+#import "ORKDataLogger.h"
+
+
+static const NSInteger ORKTraceBenchmarkAppendCount = 2000;
+
+
+@interface ORKTraceBufferTests : XCTestCase <ORKDataLoggerDelegate> {
+    NSURL *_directory;
+}
+
+@end
+
+
+@implementation ORKTraceBufferTests
+
+- (void)setUp {
+    [super setUp];
+    
+    _directory = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]] isDirectory:YES];
+    XCTAssertTrue([[NSFileManager defaultManager] createDirectoryAtURL:_directory withIntermediateDirectories:YES attributes:nil error:nil]);
+}
+
+- (void)tearDown {
+    ORKTraceBuffer *sharedBuffer = [ORKTraceBuffer sharedBuffer];
+    sharedBuffer.enabled = NO;
+    [sharedBuffer removeAllEvents];
+    
+    [[NSFileManager defaultManager] removeItemAtURL:_directory error:nil];
+    _directory = nil;
+    
+    [super tearDown];
+}
+
+- (void)dataLogger:(ORKDataLogger *)dataLogger finishedLogFile:(NSURL *)fileUrl {
+}
+
+- (NSArray *)traceEventsFromBuffer:(ORKTraceBuffer *)buffer {
+    NSError *error = nil;
+    NSData *data = [buffer chromeTraceDataWithError:&error];
+    XCTAssertNotNil(data, @"%@", error);
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:&error];
+    XCTAssertNotNil(trace, @"%@", error);
+    
+    // Drop the process and thread name metadata.
+    return [trace[@"traceEvents"] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"ph != 'M'"]];
+}
+
+- (void)testDisabledBufferRecordsNothing {
+    ORKTraceBuffer *buffer = [[ORKTraceBuffer alloc] initWithCapacity:8];
+    [buffer recordEventWithPhase:ORKTraceEventPhaseInstant category:"test" name:"event" value:0];
+    XCTAssertEqual(buffer.eventCount, 0);
+    XCTAssertEqual([self traceEventsFromBuffer:buffer].count, 0);
+}
+
+- (void)testRingBufferOverwritesOldestEvents {
+    ORKTraceBuffer *buffer = [[ORKTraceBuffer alloc] initWithCapacity:4];
+    buffer.enabled = YES;
+    [buffer recordEventWithPhase:ORKTraceEventPhaseInstant category:"test" name:"first" value:0];
+    for (NSInteger i = 0; i < 5; i++) {
+        [buffer recordEventWithPhase:ORKTraceEventPhaseInstant category:"test" name:"later" value:i + 1];
+    }
+    XCTAssertEqual(buffer.eventCount, 4);
+    XCTAssertEqual(buffer.overwrittenEventCount, 2);
+    
+    NSArray *events = [self traceEventsFromBuffer:buffer];
+    XCTAssertEqualObjects([events valueForKeyPath:@"args.value"], (@[@2, @3, @4, @5]));
+    XCTAssertEqualObjects([[NSSet setWithArray:[events valueForKey:@"name"]] allObjects], @[@"later"]);
+    
+    [buffer removeAllEvents];
+    XCTAssertEqual(buffer.eventCount, 0);
+    XCTAssertEqual(buffer.overwrittenEventCount, 0);
+}
+
+- (void)testChromeTraceFormat {
+    ORKTraceBuffer *buffer = [ORKTraceBuffer new];
+    buffer.enabled = YES;
+    [buffer recordEventWithPhase:ORKTraceEventPhaseBegin category:"test" name:"span" value:0];
+    [buffer recordEventWithPhase:ORKTraceEventPhaseInstant category:"test" name:"mark" value:0];
+    [buffer recordEventWithPhase:ORKTraceEventPhaseEnd category:"test" name:"span" value:42];
+    
+    NSArray *events = [self traceEventsFromBuffer:buffer];
+    XCTAssertEqualObjects([events valueForKey:@"ph"], (@[@"B", @"i", @"E"]));
+    XCTAssertEqualObjects([events valueForKey:@"name"], (@[@"span", @"mark", @"span"]));
+    XCTAssertEqualObjects(events[0][@"cat"], @"test");
+    XCTAssertEqualObjects(events[1][@"s"], @"t");
+    XCTAssertEqualObjects(events[2][@"args"][@"value"], @42);
+    XCTAssertNil(events[0][@"args"]);
+    
+    // Timestamps are uptimes in microseconds.
+    double beginTimestamp = [events[0][@"ts"] doubleValue];
+    XCTAssertLessThanOrEqual(beginTimestamp, [events[2][@"ts"] doubleValue]);
+    XCTAssertEqualWithAccuracy(beginTimestamp / 1e6, [NSProcessInfo processInfo].systemUptime, 5.0);
+    XCTAssertEqualObjects(events[0][@"tid"], events[2][@"tid"]);
+    
+    NSURL *url = [_directory URLByAppendingPathComponent:@"trace.json"];
+    NSError *error = nil;
+    XCTAssertTrue([buffer writeChromeTraceToURL:url error:&error], @"%@", error);
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:url.path]);
+}
+
+- (void)testDataLoggerEventsInSharedBuffer {
+    ORKTraceBuffer *sharedBuffer = [ORKTraceBuffer sharedBuffer];
+    [sharedBuffer removeAllEvents];
+    sharedBuffer.enabled = YES;
+    
+    ORKDataLogger *logger = [ORKDataLogger JSONDataLoggerWithDirectory:_directory logName:@"trace" delegate:self];
+    XCTAssertTrue([logger append:@{@"value": @1} error:NULL]);
+    [logger finishCurrentLog];
+    
+    sharedBuffer.enabled = NO;
+    NSArray *names = [[self traceEventsFromBuffer:sharedBuffer] valueForKey:@"name"];
+    XCTAssertTrue([names containsObject:@"append"]);
+    XCTAssertTrue([names containsObject:@"serialize"]);
+    XCTAssertTrue([names containsObject:@"rollover"]);
+    XCTAssertTrue([names containsObject:@"sync"]);
+    
+    // Nothing is recorded once disabled.
+    NSUInteger eventCount = sharedBuffer.eventCount;
+    XCTAssertTrue([logger append:@{@"value": @2} error:NULL]);
+    [logger finishCurrentLog];
+    XCTAssertEqual(sharedBuffer.eventCount, eventCount);
+}
+
+#pragma mark - overhead
+
+- (void)measureDataLoggerAppendsWithTracingEnabled:(BOOL)enabled {
+    ORKTraceBuffer *sharedBuffer = [ORKTraceBuffer sharedBuffer];
+    sharedBuffer.enabled = enabled;
+    ORKDataLogger *logger = [ORKDataLogger JSONDataLoggerWithDirectory:_directory logName:@"benchmark" delegate:self];
+    NSDictionary *sample = @{@"timestamp": @1000.0, @"x": @0.1, @"y": @0.12, @"z": @0.123};
+    
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < ORKTraceBenchmarkAppendCount; i++) {
+            [logger append:sample error:NULL];
+        }
+        [logger finishCurrentLog];
+    }];
+    [logger removeAllFilesWithError:NULL];
+}
+
+- (void)testDataLoggerAppendPerformanceTracingDisabled {
+    [self measureDataLoggerAppendsWithTracingEnabled:NO];
+}
+
+- (void)testDataLoggerAppendPerformanceTracingEnabled {
+    [self measureDataLoggerAppendsWithTracingEnabled:YES];
+}
+
+- (void)testTraceEventPerformanceTracingDisabled {
+    [ORKTraceBuffer sharedBuffer].enabled = NO;
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 1000000; i++) {
+            ORK_TRACE_INSTANT("benchmark", "event");
+        }
+    }];
+}
+
+- (void)testTraceEventPerformanceTracingEnabled {
+    [ORKTraceBuffer sharedBuffer].enabled = YES;
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 1000000; i++) {
+            ORK_TRACE_INSTANT("benchmark", "event");
+        }
+    }];
+}
+
+@end
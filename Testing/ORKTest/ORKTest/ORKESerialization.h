@@ -38,6 +38,7 @@ typedef id (^ORKESerializationPropertyGetter)(NSDictionary *dict, NSString *prop
 typedef id (^ORKESerializationInitBlock)(NSDictionary *dict, ORKESerializationPropertyGetter getter);
 typedef id (^ORKESerializationObjectToJSONBlock)(id object);
 typedef id (^ORKESerializationJSONToObjectBlock)(id jsonObject);
+typedef void (^ORKESerializationProgressHandler)(int64_t bytesRead, int64_t totalBytes);
 
 
 @interface ORKESerializer : NSObject
@@ -50,6 +51,32 @@ typedef id (^ORKESerializationJSONToObjectBlock)(id jsonObject);
 
 + (id)objectFromJSONData:(NSData *)data error:(NSError *__autoreleasing *)error;
 
+/*
+ Compact binary (CBOR) form of the JSON encoding, built from the same property tables. Dates,
+ URLs, binary data and floating point arrays are stored natively, and repeated strings are
+ stored once. Decoding either form produces the same objects.
+ */
++ (NSData *)binaryDataForObject:(id)object error:(NSError *__autoreleasing *)error;
+
++ (id)objectFromBinaryData:(NSData *)data error:(NSError *__autoreleasing *)error;
+
+/*
+ Builds objects directly while parsing, without materializing the whole JSON document, so
+ transient memory grows with nesting depth rather than document size. Values of properties
+ named in `skippedProperties` (for example, raw `samples`) are skipped without being decoded,
+ wherever they appear. The progress handler is called as input is read; `totalBytes` is -1
+ when the length of a stream is unknown.
+ */
++ (id)objectFromJSONStream:(NSInputStream *)stream
+         skippedProperties:(NSSet *)skippedProperties
+           progressHandler:(ORKESerializationProgressHandler)progressHandler
+                     error:(NSError *__autoreleasing *)error;
+
++ (id)objectFromJSONFileAtURL:(NSURL *)url
+            skippedProperties:(NSSet *)skippedProperties
+              progressHandler:(ORKESerializationProgressHandler)progressHandler
+                        error:(NSError *__autoreleasing *)error;
+
 + (NSArray *)serializableClasses;
 
 @end
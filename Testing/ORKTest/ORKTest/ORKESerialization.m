@@ -30,6 +30,8 @@
 
 
 #import "ORKESerialization.h"
+#import <libkern/OSByteOrder.h>
+#import <errno.h>
 
 
 static NSString *ORKEStringFromDateISO8601(NSDate *date) {
@@ -108,6 +110,13 @@ static UIEdgeInsets edgeInsetsFromDictionary(NSDictionary *dict) {
     return (UIEdgeInsets){.top = [dict[@"top"] doubleValue], .left = [dict[@"left"] doubleValue], .bottom = [dict[@"bottom"] doubleValue], .right = [dict[@"right"] doubleValue]};
 }
 
+static NSData *dataFromBase64StringOrData(id value) {
+    if ([value isKindOfClass:[NSData class]]) {
+        return value;
+    }
+    return [[NSData alloc] initWithBase64EncodedString:value options:0];
+}
+
 static ORKNumericAnswerStyle ORKNumericAnswerStyleFromString(NSString *s) {
     return tableMapReverse(s, ORKNumericAnswerStyleTable());
 }
@@ -120,6 +129,8 @@ static NSMutableDictionary *ORKESerializationEncodingTable();
 static id propFromDict(NSDictionary *dict, NSString *propName);
 static NSArray *classEncodingsForClass(Class c) ;
 static id objectForJsonObject(id input, Class expectedClass, ORKESerializationJSONToObjectBlock converterBlock) ;
+static id objectForJsonDictionary(NSDictionary *dict, Class expectedClass);
+static BOOL isNativeValue(id object);
 
 #define ESTRINGIFY2( x) #x
 #define ESTRINGIFY(x) ESTRINGIFY2(x)
@@ -204,6 +215,510 @@ static id objectForJsonObject(id input, Class expectedClass, ORKESerializationJS
 @end
 
 
+/*
+ Binary encoding: CBOR (RFC 7049) of the same tree as the JSON encoding, except that dates,
+ URLs and binary data are stored natively, floating point arrays are stored as typed arrays
+ (RFC 8746), and repeated strings, such as keys and class names, are replaced by references
+ to their first occurrence (the stringref extension, tags 256 and 25).
+ */
+
+enum {
+    ORKECBORMajorTypeUnsigned = 0,
+    ORKECBORMajorTypeNegative = 1,
+    ORKECBORMajorTypeByteString = 2,
+    ORKECBORMajorTypeTextString = 3,
+    ORKECBORMajorTypeArray = 4,
+    ORKECBORMajorTypeMap = 5,
+    ORKECBORMajorTypeTag = 6,
+    ORKECBORMajorTypeSimple = 7
+};
+
+enum {
+    ORKECBORTagEpochDate = 1,
+    ORKECBORTagStringReference = 25,
+    ORKECBORTagURI = 32,
+    ORKECBORTagFloat64LittleEndianArray = 86,
+    ORKECBORTagStringReferenceNamespace = 256
+};
+
+static const NSUInteger ORKECBORMaximumDepth = 512;
+
+// From the stringref specification: only strings longer than a reference to them enter the table.
+static BOOL ORKECBORIsReferenceable(NSUInteger length, NSUInteger index) {
+    if (index < 24) {
+        return length >= 3;
+    } else if (index < 256) {
+        return length >= 4;
+    } else if (index < 65536) {
+        return length >= 5;
+    } else if (index < 4294967296ULL) {
+        return length >= 7;
+    }
+    return length >= 11;
+}
+
+static BOOL ORKECBORIsBoolean(NSNumber *number) {
+    return CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID();
+}
+
+static BOOL ORKECBORIsFloatingPoint(NSNumber *number) {
+    const char *type = number.objCType;
+    return type[0] == 'f' || type[0] == 'd';
+}
+
+
+@interface ORKECBORWriter : NSObject
+
+- (BOOL)writeRootValue:(id)value error:(NSError * __autoreleasing *)error;
+
+@property (nonatomic, readonly) NSData *data;
+
+@end
+
+
+@implementation ORKECBORWriter {
+    NSMutableData *_data;
+    NSMutableDictionary *_stringIndexes;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _data = [NSMutableData data];
+        _stringIndexes = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSData *)data {
+    return _data;
+}
+
+- (void)writeMajorType:(uint8_t)majorType value:(uint64_t)value {
+    uint8_t bytes[9];
+    NSUInteger length = 1;
+    if (value < 24) {
+        bytes[0] = (uint8_t)(majorType << 5 | value);
+    } else if (value <= UINT8_MAX) {
+        bytes[0] = (uint8_t)(majorType << 5 | 24);
+        bytes[1] = (uint8_t)value;
+        length = 2;
+    } else if (value <= UINT16_MAX) {
+        bytes[0] = (uint8_t)(majorType << 5 | 25);
+        OSWriteBigInt16(bytes, 1, (uint16_t)value);
+        length = 3;
+    } else if (value <= UINT32_MAX) {
+        bytes[0] = (uint8_t)(majorType << 5 | 26);
+        OSWriteBigInt32(bytes, 1, (uint32_t)value);
+        length = 5;
+    } else {
+        bytes[0] = (uint8_t)(majorType << 5 | 27);
+        OSWriteBigInt64(bytes, 1, value);
+        length = 9;
+    }
+    [_data appendBytes:bytes length:length];
+}
+
+- (void)writeDouble:(double)value {
+    uint8_t bytes[9];
+    float single = (float)value;
+    if ((double)single == value || isnan(value)) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        bytes[0] = (ORKECBORMajorTypeSimple << 5 | 26);
+        OSWriteBigInt32(bytes, 1, bits);
+        [_data appendBytes:bytes length:5];
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        bytes[0] = (ORKECBORMajorTypeSimple << 5 | 27);
+        OSWriteBigInt64(bytes, 1, bits);
+        [_data appendBytes:bytes length:9];
+    }
+}
+
+// Writes a reference if the string was seen before; otherwise writes it, and adds it to the table if eligible.
+- (BOOL)writeReferenceForString:(id)string length:(NSUInteger)length {
+    NSNumber *index = _stringIndexes[string];
+    if (index) {
+        [self writeMajorType:ORKECBORMajorTypeTag value:ORKECBORTagStringReference];
+        [self writeMajorType:ORKECBORMajorTypeUnsigned value:index.unsignedLongLongValue];
+        return YES;
+    }
+    if (ORKECBORIsReferenceable(length, _stringIndexes.count)) {
+        _stringIndexes[string] = @(_stringIndexes.count);
+    }
+    return NO;
+}
+
+- (void)writeString:(NSString *)string {
+    uint8_t buffer[256];
+    NSUInteger length = 0;
+    NSRange range = NSMakeRange(0, string.length);
+    BOOL fits = [string getBytes:buffer maxLength:sizeof(buffer) usedLength:&length encoding:NSUTF8StringEncoding options:0 range:range remainingRange:&range] && range.length == 0;
+    NSData *utf8 = nil;
+    if (!fits) {
+        utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+        length = utf8.length;
+    }
+    if ([self writeReferenceForString:string length:length]) {
+        return;
+    }
+    [self writeMajorType:ORKECBORMajorTypeTextString value:length];
+    if (utf8) {
+        [_data appendData:utf8];
+    } else {
+        [_data appendBytes:buffer length:length];
+    }
+}
+
+- (void)writeByteString:(NSData *)data {
+    if ([self writeReferenceForString:data length:data.length]) {
+        return;
+    }
+    [self writeMajorType:ORKECBORMajorTypeByteString value:data.length];
+    [_data appendData:data];
+}
+
+- (void)writeNumber:(NSNumber *)number {
+    if (ORKECBORIsBoolean(number)) {
+        [self writeMajorType:ORKECBORMajorTypeSimple value:(number.boolValue ? 21 : 20)];
+    } else if (ORKECBORIsFloatingPoint(number)) {
+        [self writeDouble:number.doubleValue];
+    } else if (number.objCType[0] == 'Q') {
+        [self writeMajorType:ORKECBORMajorTypeUnsigned value:number.unsignedLongLongValue];
+    } else {
+        long long value = number.longLongValue;
+        if (value >= 0) {
+            [self writeMajorType:ORKECBORMajorTypeUnsigned value:(uint64_t)value];
+        } else {
+            [self writeMajorType:ORKECBORMajorTypeNegative value:(uint64_t)(-1 - value)];
+        }
+    }
+}
+
+// Arrays of two or more numbers that include floating point values, all exactly representable as doubles.
+static BOOL ORKECBORIsFloatingPointArray(NSArray *array) {
+    if (array.count < 2) {
+        return NO;
+    }
+    BOOL hasFloatingPoint = NO;
+    for (id item in array) {
+        if (![item isKindOfClass:[NSNumber class]] || ORKECBORIsBoolean(item)) {
+            return NO;
+        }
+        if (ORKECBORIsFloatingPoint(item)) {
+            hasFloatingPoint = YES;
+        } else if (llabs([item longLongValue]) > (1LL << 53) || [item objCType][0] == 'Q') {
+            return NO;
+        }
+    }
+    return hasFloatingPoint;
+}
+
+- (BOOL)writeValue:(id)value depth:(NSUInteger)depth {
+    if (depth > ORKECBORMaximumDepth) {
+        return NO;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        [self writeString:value];
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        [self writeNumber:value];
+    } else if ([value isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dictionary = value;
+        [self writeMajorType:ORKECBORMajorTypeMap value:dictionary.count];
+        __block BOOL success = YES;
+        [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+            success = [key isKindOfClass:[NSString class]] && [self writeValue:key depth:depth + 1] && [self writeValue:object depth:depth + 1];
+            *stop = !success;
+        }];
+        return success;
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        NSArray *array = value;
+        if (ORKECBORIsFloatingPointArray(array)) {
+            NSMutableData *elements = [NSMutableData dataWithLength:array.count * sizeof(uint64_t)];
+            uint8_t *bytes = elements.mutableBytes;
+            NSUInteger offset = 0;
+            for (NSNumber *number in array) {
+                double element = number.doubleValue;
+                uint64_t bits;
+                memcpy(&bits, &element, sizeof(bits));
+                OSWriteLittleInt64(bytes, offset, bits);
+                offset += sizeof(bits);
+            }
+            [self writeMajorType:ORKECBORMajorTypeTag value:ORKECBORTagFloat64LittleEndianArray];
+            [self writeByteString:elements];
+        } else {
+            [self writeMajorType:ORKECBORMajorTypeArray value:array.count];
+            for (id item in array) {
+                if (![self writeValue:item depth:depth + 1]) {
+                    return NO;
+                }
+            }
+        }
+    } else if ([value isKindOfClass:[NSDate class]]) {
+        [self writeMajorType:ORKECBORMajorTypeTag value:ORKECBORTagEpochDate];
+        NSTimeInterval interval = [value timeIntervalSince1970];
+        if (interval == floor(interval) && fabs(interval) < (double)(1LL << 53)) {
+            [self writeNumber:@((long long)interval)];
+        } else {
+            [self writeDouble:interval];
+        }
+    } else if ([value isKindOfClass:[NSURL class]]) {
+        [self writeMajorType:ORKECBORMajorTypeTag value:ORKECBORTagURI];
+        [self writeString:[value absoluteString]];
+    } else if ([value isKindOfClass:[NSData class]]) {
+        [self writeByteString:value];
+    } else if (value == [NSNull null]) {
+        [self writeMajorType:ORKECBORMajorTypeSimple value:22];
+    } else {
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)writeRootValue:(id)value error:(NSError * __autoreleasing *)error {
+    [self writeMajorType:ORKECBORMajorTypeTag value:ORKECBORTagStringReferenceNamespace];
+    if (![self writeValue:value depth:0]) {
+        if (error) {
+            *error = [NSError errorWithDomain:ORKErrorDomain code:ORKErrorInvalidObject userInfo:@{NSLocalizedFailureReasonErrorKey: @"Object can not be encoded."}];
+        }
+        return NO;
+    }
+    return YES;
+}
+
+@end
+
+
+@interface ORKECBORReader : NSObject
+
+- (instancetype)initWithData:(NSData *)data;
+
+- (id)readRootValueWithError:(NSError * __autoreleasing *)error;
+
+@end
+
+
+@implementation ORKECBORReader {
+    NSData *_data;
+    const uint8_t *_bytes;
+    NSUInteger _length;
+    NSUInteger _offset;
+    // Table of the innermost stringref namespace, or nil outside any namespace.
+    NSMutableArray *_strings;
+}
+
+- (instancetype)initWithData:(NSData *)data {
+    self = [super init];
+    if (self) {
+        _data = data;
+        _bytes = data.bytes;
+        _length = data.length;
+    }
+    return self;
+}
+
+- (BOOL)readMajorType:(uint8_t *)majorType value:(uint64_t *)value {
+    if (_offset >= _length) {
+        return NO;
+    }
+    uint8_t initial = _bytes[_offset++];
+    *majorType = initial >> 5;
+    uint8_t info = initial & 0x1f;
+    NSUInteger size = 0;
+    if (info < 24) {
+        *value = info;
+        return YES;
+    } else if (info == 24) {
+        size = 1;
+    } else if (info == 25) {
+        size = 2;
+    } else if (info == 26) {
+        size = 4;
+    } else if (info == 27) {
+        size = 8;
+    } else {
+        // Reserved values and indefinite lengths are not produced by the writer.
+        return NO;
+    }
+    if (_length - _offset < size) {
+        return NO;
+    }
+    uint64_t result = 0;
+    for (NSUInteger i = 0; i < size; i++) {
+        result = (result << 8) | _bytes[_offset++];
+    }
+    *value = result;
+    return YES;
+}
+
+- (const uint8_t *)readBytesWithLength:(uint64_t)length {
+    if (_length - _offset < length) {
+        return NULL;
+    }
+    const uint8_t *bytes = _bytes + _offset;
+    _offset += (NSUInteger)length;
+    return bytes;
+}
+
+- (void)addStringIfReferenceable:(id)string length:(NSUInteger)length {
+    if (_strings && ORKECBORIsReferenceable(length, _strings.count)) {
+        [_strings addObject:string];
+    }
+}
+
+- (id)readValueWithDepth:(NSUInteger)depth {
+    uint8_t majorType;
+    uint64_t value;
+    NSUInteger start = _offset;
+    if (depth > ORKECBORMaximumDepth || ![self readMajorType:&majorType value:&value]) {
+        return nil;
+    }
+    switch (majorType) {
+        case ORKECBORMajorTypeUnsigned:
+            return (value > INT64_MAX) ? @((unsigned long long)value) : @((long long)value);
+        case ORKECBORMajorTypeNegative:
+            return (value > INT64_MAX) ? nil : @(-1 - (long long)value);
+        case ORKECBORMajorTypeByteString: {
+            const uint8_t *bytes = [self readBytesWithLength:value];
+            if (!bytes) {
+                return nil;
+            }
+            NSData *data = [NSData dataWithBytes:bytes length:(NSUInteger)value];
+            [self addStringIfReferenceable:data length:data.length];
+            return data;
+        }
+        case ORKECBORMajorTypeTextString: {
+            const uint8_t *bytes = [self readBytesWithLength:value];
+            NSString *string = bytes ? [[NSString alloc] initWithBytes:bytes length:(NSUInteger)value encoding:NSUTF8StringEncoding] : nil;
+            if (string) {
+                [self addStringIfReferenceable:string length:(NSUInteger)value];
+            }
+            return string;
+        }
+        case ORKECBORMajorTypeArray: {
+            // Every item takes at least one byte.
+            if (value > _length - _offset) {
+                return nil;
+            }
+            NSMutableArray *array = [NSMutableArray arrayWithCapacity:(NSUInteger)value];
+            for (uint64_t i = 0; i < value; i++) {
+                id item = [self readValueWithDepth:depth + 1];
+                if (!item) {
+                    return nil;
+                }
+                [array addObject:item];
+            }
+            return array;
+        }
+        case ORKECBORMajorTypeMap: {
+            if (value > (_length - _offset) / 2) {
+                return nil;
+            }
+            NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)value];
+            for (uint64_t i = 0; i < value; i++) {
+                NSString *key = [self readValueWithDepth:depth + 1];
+                id object = [key isKindOfClass:[NSString class]] ? [self readValueWithDepth:depth + 1] : nil;
+                if (!object) {
+                    return nil;
+                }
+                dictionary[key] = object;
+            }
+            return dictionary;
+        }
+        case ORKECBORMajorTypeTag:
+            return [self readTaggedValue:value depth:depth];
+        case ORKECBORMajorTypeSimple:
+            return [self readSimpleValue:value additionalInformation:(_bytes[start] & 0x1f)];
+    }
+    return nil;
+}
+
+- (id)readTaggedValue:(uint64_t)tag depth:(NSUInteger)depth {
+    switch (tag) {
+        case ORKECBORTagEpochDate: {
+            id interval = [self readValueWithDepth:depth + 1];
+            return [interval isKindOfClass:[NSNumber class]] ? [NSDate dateWithTimeIntervalSince1970:[interval doubleValue]] : nil;
+        }
+        case ORKECBORTagURI: {
+            id string = [self readValueWithDepth:depth + 1];
+            return [string isKindOfClass:[NSString class]] ? [NSURL URLWithString:string] : nil;
+        }
+        case ORKECBORTagStringReference: {
+            uint8_t majorType;
+            uint64_t index;
+            if (![self readMajorType:&majorType value:&index] || majorType != ORKECBORMajorTypeUnsigned || index >= _strings.count) {
+                return nil;
+            }
+            return _strings[(NSUInteger)index];
+        }
+        case ORKECBORTagStringReferenceNamespace: {
+            NSMutableArray *enclosingStrings = _strings;
+            _strings = [NSMutableArray array];
+            id result = [self readValueWithDepth:depth + 1];
+            _strings = enclosingStrings;
+            return result;
+        }
+        case ORKECBORTagFloat64LittleEndianArray: {
+            NSData *elements = [self readValueWithDepth:depth + 1];
+            if (![elements isKindOfClass:[NSData class]] || elements.length % sizeof(uint64_t) != 0) {
+                return nil;
+            }
+            const uint8_t *bytes = elements.bytes;
+            NSUInteger count = elements.length / sizeof(uint64_t);
+            NSMutableArray *array = [NSMutableArray arrayWithCapacity:count];
+            for (NSUInteger i = 0; i < count; i++) {
+                uint64_t bits = OSReadLittleInt64(bytes, i * sizeof(uint64_t));
+                double element;
+                memcpy(&element, &bits, sizeof(element));
+                [array addObject:@(element)];
+            }
+            return array;
+        }
+    }
+    return nil;
+}
+
+// For floating point values, `value` holds the bits of the number.
+- (id)readSimpleValue:(uint64_t)value additionalInformation:(uint8_t)additionalInformation {
+    if (additionalInformation == 26) {
+        uint32_t bits = (uint32_t)value;
+        float single;
+        memcpy(&single, &bits, sizeof(single));
+        return @((double)single);
+    } else if (additionalInformation == 27) {
+        double element;
+        memcpy(&element, &value, sizeof(element));
+        return @(element);
+    } else if (additionalInformation < 24) {
+        switch (value) {
+            case 20:
+                return @NO;
+            case 21:
+                return @YES;
+            case 22:
+                return [NSNull null];
+        }
+    }
+    // Half precision floats and other simple values are not produced by the writer.
+    return nil;
+}
+
+- (id)readRootValueWithError:(NSError * __autoreleasing *)error {
+    id value = [self readValueWithDepth:0];
+    if (!value || _offset != _length) {
+        if (error) {
+            *error = [NSError errorWithDomain:ORKErrorDomain code:ORKErrorInvalidObject userInfo:@{NSLocalizedFailureReasonErrorKey: @"Data is not a valid binary encoding."}];
+        }
+        return nil;
+    }
+    return value;
+}
+
+@end
+
+
 static NSString *_ClassKey = @"_class";
 
 static id propFromDict(NSDictionary *dict, NSString *propName) {
@@ -252,6 +767,454 @@ static id propFromDict(NSDictionary *dict, NSString *propName) {
 }
 
 
+/*
+ Pull parser that builds objects straight from a JSON token stream.
+ 
+ Input is read in fixed size chunks, and each object is constructed as soon as its closing
+ brace is read, so the only transient state is one partially read container per nesting
+ level. Values of skipped properties are scanned for syntax but never decoded.
+ */
+static const NSUInteger ORKEJSONStreamChunkLength = 64 * 1024;
+static const NSUInteger ORKEJSONStreamMaximumDepth = 512;
+static const NSUInteger ORKEJSONStreamMaximumNumberLength = 64;
+
+@interface ORKEJSONStreamReader : NSObject
+
+- (instancetype)initWithInputStream:(NSInputStream *)stream totalLength:(int64_t)totalLength;
+
+@property (nonatomic, copy) NSSet *skippedProperties;
+
+@property (nonatomic, copy) ORKESerializationProgressHandler progressHandler;
+
+- (id)readRootObjectWithError:(NSError * __autoreleasing *)error;
+
+@end
+
+
+@implementation ORKEJSONStreamReader {
+    NSInputStream *_stream;
+    int64_t _totalLength;
+    NSMutableData *_chunk;
+    const uint8_t *_bytes;
+    NSUInteger _position;
+    NSUInteger _length;
+    int64_t _chunkOffset;
+    BOOL _endOfStream;
+    NSMutableData *_scratch;
+    NSString *_failureReason;
+    NSError *_streamError;
+}
+
+- (instancetype)initWithInputStream:(NSInputStream *)stream totalLength:(int64_t)totalLength {
+    self = [super init];
+    if (self) {
+        _stream = stream;
+        _totalLength = totalLength;
+        _chunk = [NSMutableData dataWithLength:ORKEJSONStreamChunkLength];
+        _bytes = _chunk.bytes;
+        _scratch = [NSMutableData data];
+    }
+    return self;
+}
+
+- (id)failWithReason:(NSString *)reason {
+    if (!_failureReason) {
+        _failureReason = [NSString stringWithFormat:@"%@ at offset %lld.", reason, _chunkOffset + (int64_t)_position];
+    }
+    return nil;
+}
+
+// Returns NO at the end of the input.
+- (BOOL)fill {
+    if (_position < _length) {
+        return YES;
+    }
+    if (_endOfStream) {
+        return NO;
+    }
+    _chunkOffset += _length;
+    _position = 0;
+    _length = 0;
+    NSInteger count = [_stream read:_chunk.mutableBytes maxLength:ORKEJSONStreamChunkLength];
+    if (count <= 0) {
+        if (count < 0) {
+            _streamError = _stream.streamError;
+            [self failWithReason:@"Read error"];
+        }
+        _endOfStream = YES;
+        return NO;
+    }
+    _length = count;
+    if (_progressHandler) {
+        _progressHandler(_chunkOffset + _length, _totalLength);
+    }
+    return YES;
+}
+
+// Returns -1 at the end of the input.
+- (int)peekByte {
+    return [self fill] ? _bytes[_position] : -1;
+}
+
+- (int)nextByte {
+    return [self fill] ? _bytes[_position++] : -1;
+}
+
+- (int)peekByteSkippingWhitespace {
+    while ([self fill]) {
+        uint8_t c = _bytes[_position];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return c;
+        }
+        _position++;
+    }
+    return -1;
+}
+
+- (BOOL)readLiteral:(const char *)literal {
+    for (const char *p = literal; *p != '\0'; p++) {
+        if ([self nextByte] != *p) {
+            [self failWithReason:@"Invalid literal"];
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static int ORKEJSONHexDigitValue(int c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+- (BOOL)readCodeUnit:(uint32_t *)codeUnit {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = ORKEJSONHexDigitValue([self nextByte]);
+        if (digit < 0) {
+            [self failWithReason:@"Invalid unicode escape"];
+            return NO;
+        }
+        value = (value << 4) | (uint32_t)digit;
+    }
+    *codeUnit = value;
+    return YES;
+}
+
+- (BOOL)appendEscapedCharacter {
+    uint8_t c = 0;
+    switch ([self nextByte]) {
+        case '"': c = '"'; break;
+        case '\\': c = '\\'; break;
+        case '/': c = '/'; break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': {
+            uint32_t codePoint = 0;
+            if (![self readCodeUnit:&codePoint]) {
+                return NO;
+            }
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                uint32_t low = 0;
+                if ([self nextByte] != '\\' || [self nextByte] != 'u' || ![self readCodeUnit:&low] || low < 0xDC00 || low > 0xDFFF) {
+                    [self failWithReason:@"Invalid surrogate pair"];
+                    return NO;
+                }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                [self failWithReason:@"Invalid surrogate pair"];
+                return NO;
+            }
+            uint8_t utf8[4];
+            NSUInteger length = 0;
+            if (codePoint < 0x80) {
+                utf8[length++] = codePoint;
+            } else if (codePoint < 0x800) {
+                utf8[length++] = 0xC0 | (codePoint >> 6);
+                utf8[length++] = 0x80 | (codePoint & 0x3F);
+            } else if (codePoint < 0x10000) {
+                utf8[length++] = 0xE0 | (codePoint >> 12);
+                utf8[length++] = 0x80 | ((codePoint >> 6) & 0x3F);
+                utf8[length++] = 0x80 | (codePoint & 0x3F);
+            } else {
+                utf8[length++] = 0xF0 | (codePoint >> 18);
+                utf8[length++] = 0x80 | ((codePoint >> 12) & 0x3F);
+                utf8[length++] = 0x80 | ((codePoint >> 6) & 0x3F);
+                utf8[length++] = 0x80 | (codePoint & 0x3F);
+            }
+            [_scratch appendBytes:utf8 length:length];
+            return YES;
+        }
+        default:
+            [self failWithReason:@"Invalid escape"];
+            return NO;
+    }
+    [_scratch appendBytes:&c length:1];
+    return YES;
+}
+
+// Reads a string after its opening quote. When skipping, returns NSNull instead of the string.
+- (id)readStringSkip:(BOOL)skip {
+    _scratch.length = 0;
+    for (;;) {
+        if (![self fill]) {
+            return [self failWithReason:@"Unterminated string"];
+        }
+        // Copy the run of plain characters in one go
+        NSUInteger start = _position;
+        while (_position < _length && _bytes[_position] != '"' && _bytes[_position] != '\\' && _bytes[_position] >= 0x20) {
+            _position++;
+        }
+        if (!skip) {
+            [_scratch appendBytes:_bytes + start length:_position - start];
+        }
+        if (_position == _length) {
+            continue;
+        }
+        uint8_t c = _bytes[_position++];
+        if (c == '"') {
+            break;
+        } else if (c == '\\') {
+            if (![self appendEscapedCharacter]) {
+                return nil;
+            }
+        } else {
+            _position--;
+            return [self failWithReason:@"Control character in string"];
+        }
+    }
+    if (skip) {
+        return [NSNull null];
+    }
+    NSString *string = [[NSString alloc] initWithBytes:_scratch.bytes length:_scratch.length encoding:NSUTF8StringEncoding];
+    if (!string) {
+        return [self failWithReason:@"Invalid UTF-8 in string"];
+    }
+    return string;
+}
+
+static BOOL ORKEJSONIsDigit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+// Checks the JSON number grammar, which is stricter than strtod.
+static BOOL ORKEJSONIsValidNumber(const char *s, BOOL *isInteger) {
+    *isInteger = YES;
+    if (*s == '-') {
+        s++;
+    }
+    if (*s == '0') {
+        s++;
+    } else if (ORKEJSONIsDigit(*s)) {
+        while (ORKEJSONIsDigit(*s)) {
+            s++;
+        }
+    } else {
+        return NO;
+    }
+    if (*s == '.') {
+        *isInteger = NO;
+        s++;
+        if (!ORKEJSONIsDigit(*s)) {
+            return NO;
+        }
+        while (ORKEJSONIsDigit(*s)) {
+            s++;
+        }
+    }
+    if (*s == 'e' || *s == 'E') {
+        *isInteger = NO;
+        s++;
+        if (*s == '+' || *s == '-') {
+            s++;
+        }
+        if (!ORKEJSONIsDigit(*s)) {
+            return NO;
+        }
+        while (ORKEJSONIsDigit(*s)) {
+            s++;
+        }
+    }
+    return *s == '\0';
+}
+
+- (NSNumber *)readNumber {
+    char buffer[ORKEJSONStreamMaximumNumberLength + 1];
+    NSUInteger length = 0;
+    for (int c = [self peekByte]; ORKEJSONIsDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; c = [self peekByte]) {
+        if (length == ORKEJSONStreamMaximumNumberLength) {
+            return [self failWithReason:@"Number too long"];
+        }
+        buffer[length++] = (char)c;
+        _position++;
+    }
+    buffer[length] = '\0';
+    
+    BOOL isInteger = NO;
+    if (!ORKEJSONIsValidNumber(buffer, &isInteger)) {
+        return [self failWithReason:@"Invalid number"];
+    }
+    if (isInteger) {
+        errno = 0;
+        long long value = strtoll(buffer, NULL, 10);
+        if (errno != ERANGE) {
+            return @(value);
+        }
+    }
+    return @(strtod(buffer, NULL));
+}
+
+- (id)readObjectWithDepth:(NSUInteger)depth skip:(BOOL)skip {
+    _position++;
+    NSMutableDictionary *dictionary = skip ? nil : [NSMutableDictionary dictionary];
+    if ([self peekByteSkippingWhitespace] == '}') {
+        _position++;
+    } else {
+        for (;;) {
+            if ([self peekByteSkippingWhitespace] != '"') {
+                return [self failWithReason:@"Expected string key"];
+            }
+            _position++;
+            NSString *key = [self readStringSkip:skip];
+            if (!key) {
+                return nil;
+            }
+            if ([self peekByteSkippingWhitespace] != ':') {
+                return [self failWithReason:@"Expected ':'"];
+            }
+            _position++;
+            
+            BOOL skipValue = skip || [_skippedProperties containsObject:key];
+            id value = nil;
+            @autoreleasepool {
+                value = [self readValueWithDepth:depth + 1 skip:skipValue];
+            }
+            if (!value) {
+                return nil;
+            }
+            if (!skipValue) {
+                dictionary[key] = value;
+            }
+            
+            int c = [self peekByteSkippingWhitespace];
+            _position++;
+            if (c == '}') {
+                break;
+            } else if (c != ',') {
+                _position--;
+                return [self failWithReason:@"Expected ',' or '}'"];
+            }
+        }
+    }
+    if (skip) {
+        return [NSNull null];
+    }
+    
+    // Build serializable objects now, so their members can be released
+    NSString *className = DYNAMICCAST(dictionary[_ClassKey], NSString);
+    if (className && [classEncodingsForClass(NSClassFromString(className)) count] > 0) {
+        return objectForJsonDictionary(dictionary, nil);
+    }
+    return dictionary;
+}
+
+- (id)readArrayWithDepth:(NSUInteger)depth skip:(BOOL)skip {
+    _position++;
+    NSMutableArray *array = skip ? nil : [NSMutableArray array];
+    if ([self peekByteSkippingWhitespace] == ']') {
+        _position++;
+    } else {
+        for (;;) {
+            id value = nil;
+            @autoreleasepool {
+                value = [self readValueWithDepth:depth + 1 skip:skip];
+            }
+            if (!value) {
+                return nil;
+            }
+            [array addObject:value];
+            
+            int c = [self peekByteSkippingWhitespace];
+            _position++;
+            if (c == ']') {
+                break;
+            } else if (c != ',') {
+                _position--;
+                return [self failWithReason:@"Expected ',' or ']'"];
+            }
+        }
+    }
+    return skip ? [NSNull null] : array;
+}
+
+// Returns nil on failure. Skipped values are returned as NSNull.
+- (id)readValueWithDepth:(NSUInteger)depth skip:(BOOL)skip {
+    if (depth > ORKEJSONStreamMaximumDepth) {
+        return [self failWithReason:@"Nesting too deep"];
+    }
+    int c = [self peekByteSkippingWhitespace];
+    switch (c) {
+        case '{':
+            return [self readObjectWithDepth:depth skip:skip];
+        case '[':
+            return [self readArrayWithDepth:depth skip:skip];
+        case '"':
+            _position++;
+            return [self readStringSkip:skip];
+        case 't':
+            return [self readLiteral:"true"] ? @YES : nil;
+        case 'f':
+            return [self readLiteral:"false"] ? @NO : nil;
+        case 'n':
+            return [self readLiteral:"null"] ? [NSNull null] : nil;
+        default:
+            if (c == '-' || ORKEJSONIsDigit(c)) {
+                return [self readNumber];
+            }
+            return [self failWithReason:(c < 0 ? @"Unexpected end of input" : @"Unexpected character")];
+    }
+}
+
+- (id)readRootObjectWithError:(NSError * __autoreleasing *)error {
+    BOOL shouldClose = NO;
+    if (_stream.streamStatus == NSStreamStatusNotOpen) {
+        [_stream open];
+        shouldClose = YES;
+    }
+    
+    id value = [self readValueWithDepth:0 skip:NO];
+    if (value && [self peekByteSkippingWhitespace] >= 0) {
+        value = [self failWithReason:@"Unexpected data after the root value"];
+    }
+    if (value && _failureReason) {
+        // Read error at the end of the input
+        value = nil;
+    }
+    
+    if (shouldClose) {
+        [_stream close];
+    }
+    if (!value && error) {
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:_failureReason ? : @"Invalid JSON." forKey:NSLocalizedFailureReasonErrorKey];
+        if (_streamError) {
+            userInfo[NSUnderlyingErrorKey] = _streamError;
+        }
+        *error = [NSError errorWithDomain:ORKErrorDomain code:ORKErrorInvalidObject userInfo:userInfo];
+    }
+    return value;
+}
+
+@end
+
+
 #define NUMTOSTRINGBLOCK(table) ^id(id num) { return table[[num integerValue]]; }
 #define STRINGTONUMBLOCK(table) ^id(id string) { NSUInteger index = [table indexOfObject:string]; \
     NSCAssert(index != NSNotFound, @"Expected valid entry from table %@", table); \
@@ -340,7 +1303,8 @@ ret =
              return task;
          },(@{
               PROPERTY(identifier, NSString, NSObject, NO, nil, nil),
-              PROPERTY(steps, ORKStep, NSArray, NO, nil, nil)
+              PROPERTY(steps, ORKStep, NSArray, NO, nil, nil),
+              PROPERTY(continuousRecorderConfigurations, ORKContinuousRecorderConfiguration, NSArray, YES, nil, nil)
               })),
    ENTRY(ORKNavigableOrderedTask,
          ^id(NSDictionary *dict, ORKESerializationPropertyGetter getter) {
@@ -480,12 +1444,22 @@ ret =
         (@{
           PROPERTY(frequency, NSNumber, NSObject, NO, nil, nil),
           })),
+  ENTRY(ORKContinuousRecorderConfiguration,
+        ^id(NSDictionary *dict, ORKESerializationPropertyGetter getter) {
+            return [[ORKContinuousRecorderConfiguration alloc] initWithRecorderConfiguration:GETPROP(dict, recorderConfiguration) stepIdentifiers:GETPROP(dict, stepIdentifiers)];
+        },
+        (@{
+          PROPERTY(recorderConfiguration, ORKRecorderConfiguration, NSObject, NO, nil, nil),
+          PROPERTY(stepIdentifiers, NSString, NSArray, NO, nil, nil),
+          })),
   ENTRY(ORKAudioRecorderConfiguration,
         ^id(NSDictionary *dict, ORKESerializationPropertyGetter getter) {
             return [[ORKAudioRecorderConfiguration alloc] initWithIdentifier:GETPROP(dict, identifier) recorderSettings:GETPROP(dict, recorderSettings)];
         },
         (@{
           PROPERTY(recorderSettings, NSDictionary, NSObject, NO, nil, nil),
+          PROPERTY(processingOptions, NSNumber, NSObject, YES, nil, nil),
+          PROPERTY(processedSampleRate, NSNumber, NSObject, YES, nil, nil),
           })),
   ENTRY(ORKConsentDocument,
         nil,
@@ -540,6 +1514,9 @@ ret =
           PROPERTY(requiresName, NSNumber, NSObject, YES, nil, nil),
           PROPERTY(requiresSignatureImage, NSNumber, NSObject, YES, nil, nil),
           PROPERTY(signatureDateFormatString, NSString, NSObject, YES, nil, nil),
+          PROPERTY(signatureImage, UIImage, NSObject, YES,
+                   ^id(id image) { return UIImagePNGRepresentation(image); },
+                   ^id(id data) { return [UIImage imageWithData:dataFromBase64StringOrData(data)]; }),
           })),
   ENTRY(ORKDeviceMotionRecorderConfiguration,
         ^id(NSDictionary *dict, ORKESerializationPropertyGetter getter) {
@@ -765,10 +1742,23 @@ ret =
                     ^id(id value) { return value?dictionaryFromCGPoint([value CGPointValue]):nil; },
                     ^id(id dict) { return [NSValue valueWithCGPoint:pointFromDictionary(dict)]; })
            })),
+  ENTRY(ORKTappingIntervalStatistics,
+        nil,
+        (@{
+           PROPERTY(tapCount, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(meanInterTapInterval, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(interTapIntervalStandardDeviation, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(interTapIntervalCoefficientOfVariation, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(alternationAccuracy, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(interTapIntervalDrift, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(meanDwellTime, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(dwellTimeStandardDeviation, NSNumber, NSObject, NO, nil, nil)
+           })),
   ENTRY(ORKTappingIntervalResult,
         nil,
         (@{
            PROPERTY(samples, ORKTappingSample, NSArray, NO, nil, nil),
+           PROPERTY(statistics, ORKTappingIntervalStatistics, NSObject, NO, nil, nil),
            PROPERTY(stepViewSize, NSValue, NSObject, NO,
                     ^id(id value) { return value?dictionaryFromCGSize([value CGSizeValue]):nil; },
                     ^id(id dict) { return [NSValue valueWithCGSize:sizeFromDictionary(dict)]; }),
@@ -802,7 +1792,11 @@ ret =
                     ^id(id string) { return @(tableMapReverse(string, memoryGameStatusTable())); }),
            PROPERTY(targetRects, NSValue, NSArray, NO,
                     ^id(id value) { return value?dictionaryFromCGRect([value CGRectValue]):nil; },
-                    ^id(id dict) { return [NSValue valueWithCGRect:rectFromDictionary(dict)]; })
+                    ^id(id dict) { return [NSValue valueWithCGRect:rectFromDictionary(dict)]; }),
+           PROPERTY(correctSequenceLength, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(numberOfErrors, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(meanTimePerTarget, NSNumber, NSObject, NO, nil, nil),
+           PROPERTY(stimulusOnsetTimestamps, NSNumber, NSArray, NO, nil, nil)
            })),
   ENTRY(ORKSpatialSpanMemoryResult,
         nil,
@@ -940,7 +1934,8 @@ static NSArray *classEncodingsForClass(Class c) {
 
 static id objectForJsonObject(id input, Class expectedClass, ORKESerializationJSONToObjectBlock converterBlock) {
     id output = nil;
-    if (converterBlock != nil) {
+    // Dates and URLs decoded from binary data are already in their final form
+    if (converterBlock != nil && !(isNativeValue(input) && expectedClass != nil && [input isKindOfClass:expectedClass])) {
         input = converterBlock(input);
     }
     
@@ -948,58 +1943,75 @@ static id objectForJsonObject(id input, Class expectedClass, ORKESerializationJS
         // Input is already of the expected class, do nothing
         output = input;
     } else if ([input isKindOfClass:[NSDictionary class]]) {
-        NSDictionary *dict = (NSDictionary *)input;
-        NSString *className = input[_ClassKey];
-        if (expectedClass != nil) {
-            NSCAssert([NSClassFromString(className) isSubclassOfClass:expectedClass], @"Expected subclass of %@ but got %@", expectedClass, className);
-        }
-        NSArray *classEncodings = classEncodingsForClass(NSClassFromString(className));
-        NSCAssert([classEncodings count] > 0, @"Expected serializable class but got %@", className);
-        
-        ORKESerializableTableEntry *leafClassEncoding = [classEncodings firstObject];
-        ORKESerializationInitBlock initBlock = leafClassEncoding.initBlock;
-        BOOL writeAllProperties = YES;
-        if (initBlock != nil) {
-            output = initBlock(dict,
-                               ^id(NSDictionary *dict, NSString *param) {
-                                   return propFromDict(dict, param); });
-            writeAllProperties = NO;
-        } else {
-            output = [[NSClassFromString(className) alloc] init];
+        output = objectForJsonDictionary((NSDictionary *)input, expectedClass);
+    } else {
+        NSCAssert(0, @"Unexpected input of class %@ for %@", [input class], expectedClass);
+    }
+    return output;
+}
+
+static id objectForJsonDictionary(NSDictionary *dict, Class expectedClass) {
+    id output = nil;
+    NSString *className = dict[_ClassKey];
+    if (expectedClass != nil) {
+        NSCAssert([NSClassFromString(className) isSubclassOfClass:expectedClass], @"Expected subclass of %@ but got %@", expectedClass, className);
+    }
+    NSArray *classEncodings = classEncodingsForClass(NSClassFromString(className));
+    NSCAssert([classEncodings count] > 0, @"Expected serializable class but got %@", className);
+    
+    ORKESerializableTableEntry *leafClassEncoding = [classEncodings firstObject];
+    ORKESerializationInitBlock initBlock = leafClassEncoding.initBlock;
+    BOOL writeAllProperties = YES;
+    if (initBlock != nil) {
+        output = initBlock(dict,
+                           ^id(NSDictionary *dict, NSString *param) {
+                               return propFromDict(dict, param); });
+        writeAllProperties = NO;
+    } else {
+        output = [[NSClassFromString(className) alloc] init];
+    }
+    
+    for (NSString *key in [dict allKeys]) {
+        if ([key isEqualToString:_ClassKey]) {
+            continue;
         }
         
-        for (NSString *key in [dict allKeys]) {
-            if ([key isEqualToString:_ClassKey]) {
-                continue;
-            }
-            
-            BOOL haveSetProp = NO;
-            for (ORKESerializableTableEntry *encoding in classEncodings) {
-                NSDictionary *propertyTable = encoding.properties;
-                ORKESerializableProperty *propertyEntry = propertyTable[key];
-                if (propertyEntry != nil) {
-                    // Only write the property if it has not already been set during init
-                    if (writeAllProperties || propertyEntry.writeAfterInit) {
-                        [output setValue:propFromDict(dict,key) forKey:key];
-                    }
-                    haveSetProp = YES;
-                    break;
+        BOOL haveSetProp = NO;
+        for (ORKESerializableTableEntry *encoding in classEncodings) {
+            NSDictionary *propertyTable = encoding.properties;
+            ORKESerializableProperty *propertyEntry = propertyTable[key];
+            if (propertyEntry != nil) {
+                // Only write the property if it has not already been set during init
+                if (writeAllProperties || propertyEntry.writeAfterInit) {
+                    [output setValue:propFromDict(dict,key) forKey:key];
                 }
+                haveSetProp = YES;
+                break;
             }
-            NSCAssert(haveSetProp, @"Unexpected property on %@: %@", className, key);
         }
-        
-    } else {
-        NSCAssert(0, @"Unexpected input of class %@ for %@", [input class], expectedClass);
+        NSCAssert(haveSetProp, @"Unexpected property on %@: %@", className, key);
     }
     return output;
 }
 
+// Values the binary encoding represents natively, and JSON as strings
+static BOOL isNativeValue(id object) {
+    return [object isKindOfClass:[NSDate class]] || [object isKindOfClass:[NSURL class]] || [object isKindOfClass:[NSData class]];
+}
+
+// Converters may return binary data, which JSON carries as a base64 string
+static id encodedValueForValue(id value, BOOL nativeValues) {
+    if (!nativeValues && [value isKindOfClass:[NSData class]]) {
+        return [(NSData *)value base64EncodedStringWithOptions:0];
+    }
+    return value;
+}
+
 static BOOL isValid(id object) {
     return [NSJSONSerialization isValidJSONObject:object] || [object isKindOfClass:[NSNumber class]] || [object isKindOfClass:[NSString class]] || [object isKindOfClass:[NSNull class]];
 }
 
-static id jsonObjectForObject(id object) {
+static id encodedObjectForObject(id object, BOOL nativeValues) {
     if (object == nil) {
         // Leaf: nil
         return nil;
@@ -1026,23 +2038,23 @@ static id jsonObjectForObject(id object) {
                         NSMutableArray *a = [NSMutableArray array];
                         for (id valueItem in valueForKey) {
                             id outputItem;
-                            if (converter != nil) {
-                                outputItem = converter(valueItem);
+                            if (converter != nil && !(nativeValues && isNativeValue(valueItem))) {
+                                outputItem = encodedValueForValue(converter(valueItem), nativeValues);
                                 NSCAssert(isValid(valueItem), @"Expected valid JSON object");
                             } else {
                                 // Recurse for each property
-                                outputItem = jsonObjectForObject(valueItem);
+                                outputItem = encodedObjectForObject(valueItem, nativeValues);
                             }
                             [a addObject:outputItem];
                         }
                         valueForKey = a;
                     } else {
-                        if (converter != nil) {
-                            valueForKey = converter(valueForKey);
-                            NSCAssert((valueForKey == nil) || isValid(valueForKey), @"Expected valid JSON object");
+                        if (converter != nil && !(nativeValues && isNativeValue(valueForKey))) {
+                            valueForKey = encodedValueForValue(converter(valueForKey), nativeValues);
+                            NSCAssert((valueForKey == nil) || isValid(valueForKey) || nativeValues, @"Expected valid JSON object");
                         } else {
                             // Recurse for each property
-                            valueForKey = jsonObjectForObject(valueForKey);
+                            valueForKey = encodedObjectForObject(valueForKey, nativeValues);
                         }
                     }
                 }
@@ -1059,7 +2071,7 @@ static id jsonObjectForObject(id object) {
         NSMutableArray *encodedArray = [NSMutableArray arrayWithCapacity:[inputArray count]];
         for (id input in inputArray) {
             // Recurse for each array element
-            [encodedArray addObject:jsonObjectForObject(input)];
+            [encodedArray addObject:encodedObjectForObject(input, nativeValues)];
         }
         jsonOutput = encodedArray;
     } else if ([c isSubclassOfClass:[NSDictionary class]]) {
@@ -1067,11 +2079,11 @@ static id jsonObjectForObject(id object) {
         NSMutableDictionary *encodedDictionary = [NSMutableDictionary dictionaryWithCapacity:[inputDict count]];
         for (NSString *key in [inputDict allKeys] ) {
             // Recurse for each dictionary value
-            encodedDictionary[key] = jsonObjectForObject(inputDict[key]);
+            encodedDictionary[key] = encodedObjectForObject(inputDict[key], nativeValues);
         }
         jsonOutput = encodedDictionary;
     } else {
-        NSCAssert(isValid(object), @"Expected valid JSON object");
+        NSCAssert(isValid(object) || (nativeValues && isNativeValue(object)), @"Expected valid JSON object");
         
         // Leaf: native JSON object
         jsonOutput = object;
@@ -1080,6 +2092,10 @@ static id jsonObjectForObject(id object) {
     return jsonOutput;
 }
 
+static id jsonObjectForObject(id object) {
+    return encodedObjectForObject(object, NO);
+}
+
 + (NSDictionary *)JSONObjectForObject:(id)object error:(NSError * __autoreleasing *)error {
     id json = jsonObjectForObject(object);
     return json;
@@ -1103,6 +2119,50 @@ static id jsonObjectForObject(id object) {
     return ret;
 }
 
++ (NSData *)binaryDataForObject:(id)object error:(NSError *__autoreleasing *)error {
+    id encodedObject = encodedObjectForObject(object, YES);
+    ORKECBORWriter *writer = [ORKECBORWriter new];
+    if (![writer writeRootValue:encodedObject error:error]) {
+        return nil;
+    }
+    return writer.data;
+}
+
++ (id)objectFromBinaryData:(NSData *)data error:(NSError *__autoreleasing *)error {
+    ORKECBORReader *reader = [[ORKECBORReader alloc] initWithData:data];
+    id encodedObject = [reader readRootValueWithError:error];
+    id ret = nil;
+    if (encodedObject != nil) {
+        ret = objectForJsonObject(encodedObject, nil, nil);
+    }
+    return ret;
+}
+
++ (id)objectFromJSONStream:(NSInputStream *)stream
+         skippedProperties:(NSSet *)skippedProperties
+           progressHandler:(ORKESerializationProgressHandler)progressHandler
+                     error:(NSError *__autoreleasing *)error {
+    ORKEJSONStreamReader *reader = [[ORKEJSONStreamReader alloc] initWithInputStream:stream totalLength:-1];
+    reader.skippedProperties = skippedProperties;
+    reader.progressHandler = progressHandler;
+    return [reader readRootObjectWithError:error];
+}
+
++ (id)objectFromJSONFileAtURL:(NSURL *)url
+            skippedProperties:(NSSet *)skippedProperties
+              progressHandler:(ORKESerializationProgressHandler)progressHandler
+                        error:(NSError *__autoreleasing *)error {
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:url.path error:error];
+    NSInputStream *stream = [NSInputStream inputStreamWithURL:url];
+    if (attributes == nil || stream == nil) {
+        return nil;
+    }
+    ORKEJSONStreamReader *reader = [[ORKEJSONStreamReader alloc] initWithInputStream:stream totalLength:(int64_t)[attributes fileSize]];
+    reader.skippedProperties = skippedProperties;
+    reader.progressHandler = progressHandler;
+    return [reader readRootObjectWithError:error];
+}
+
 + (NSArray *)serializableClasses {
     NSMutableArray *a = [NSMutableArray array];
     NSDictionary *table = ORKESerializationEncodingTable();
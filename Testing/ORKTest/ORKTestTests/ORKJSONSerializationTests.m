@@ -37,6 +37,7 @@
 #import <stdio.h>
 #import <stdlib.h>
 #import <HealthKit/HealthKit.h>
+#import <mach/mach.h>
 
 #import <ResearchKit/ORKResult_Private.h>
 #import "ORKESerialization.h"
@@ -411,6 +412,17 @@
         {
             XCTAssertTrue(isMatch, @"Should be equal for class: %@", NSStringFromClass(aClass));
         }
+        
+        // Decoding the binary encoding should produce the same object
+        id instance3 = [ORKESerializer objectFromBinaryData:[ORKESerializer binaryDataForObject:instance error:NULL] error:NULL];
+        NSDictionary *dictionary3 = [ORKESerializer JSONObjectForObject:instance3 error:NULL];
+        XCTAssertEqualObjects(dictionary3, dictionary2, @"Binary encoding should round trip for class: %@", NSStringFromClass(aClass));
+        
+        // As should the streaming importer
+        NSData *jsonData = [ORKESerializer JSONDataForObject:instance error:NULL];
+        id instance4 = [ORKESerializer objectFromJSONStream:[NSInputStream inputStreamWithData:jsonData] skippedProperties:nil progressHandler:nil error:NULL];
+        NSDictionary *dictionary4 = [ORKESerializer JSONObjectForObject:instance4 error:NULL];
+        XCTAssertEqualObjects(dictionary4, dictionary2, @"Streaming import should match for class: %@", NSStringFromClass(aClass));
     }
 
 }
@@ -670,6 +682,227 @@
     }
 }
 
+- (ORKTaskResult *)sampleTaskResultWithStepCount:(NSUInteger)stepCount {
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:465000000.125];
+    NSMutableArray *stepResults = [NSMutableArray array];
+    for (NSUInteger i = 0; i < stepCount; i++) {
+        NSString *identifier = [NSString stringWithFormat:@"step.%@", @(i)];
+        
+        ORKScaleQuestionResult *scaleResult = [[ORKScaleQuestionResult alloc] initWithIdentifier:identifier];
+        scaleResult.scaleAnswer = @(i % 10);
+        ORKTextQuestionResult *textResult = [[ORKTextQuestionResult alloc] initWithIdentifier:[identifier stringByAppendingString:@".text"]];
+        textResult.textAnswer = @"Feeling fine today";
+        ORKDateQuestionResult *dateResult = [[ORKDateQuestionResult alloc] initWithIdentifier:[identifier stringByAppendingString:@".date"]];
+        dateResult.dateAnswer = [date dateByAddingTimeInterval:-86400.5 * i];
+        
+        ORKFileResult *fileResult = [[ORKFileResult alloc] initWithIdentifier:[identifier stringByAppendingString:@".audio"]];
+        fileResult.contentType = @"audio/x-caf";
+        fileResult.fileURL = [NSURL fileURLWithPath:[NSString stringWithFormat:@"/tmp/recordings/%@.caf", identifier]];
+        
+        ORKSpatialSpanMemoryGameRecord *gameRecord = [ORKSpatialSpanMemoryGameRecord new];
+        gameRecord.seed = (uint32_t)i;
+        gameRecord.sequence = @[ @3, @1, @4, @1, @5, @9, @2, @6 ];
+        gameRecord.gameSize = 9;
+        gameRecord.score = 40;
+        NSMutableArray *onsets = [NSMutableArray array];
+        for (NSUInteger j = 0; j < 8; j++) {
+            [onsets addObject:@(1.0 / 3.0 + j * 0.75 + i)];
+        }
+        gameRecord.stimulusOnsetTimestamps = onsets;
+        ORKSpatialSpanMemoryResult *memoryResult = [[ORKSpatialSpanMemoryResult alloc] initWithIdentifier:[identifier stringByAppendingString:@".memory"]];
+        memoryResult.score = 40;
+        memoryResult.numberOfGames = 1;
+        memoryResult.gameRecords = @[ gameRecord ];
+        
+        NSArray *results = @[ scaleResult, textResult, dateResult, fileResult, memoryResult ];
+        for (ORKResult *result in results) {
+            result.startDate = [date dateByAddingTimeInterval:i * 10.25];
+            result.endDate = [date dateByAddingTimeInterval:i * 10.25 + 5.5];
+        }
+        ORKStepResult *stepResult = [[ORKStepResult alloc] initWithStepIdentifier:identifier results:results];
+        stepResult.startDate = [date dateByAddingTimeInterval:i * 10.25];
+        stepResult.endDate = [date dateByAddingTimeInterval:i * 10.25 + 6];
+        [stepResults addObject:stepResult];
+    }
+    ORKTaskResult *taskResult = [[ORKTaskResult alloc] initWithTaskIdentifier:@"sample" taskRunUUID:[NSUUID UUID] outputDirectory:[NSURL fileURLWithPath:NSTemporaryDirectory()]];
+    taskResult.results = stepResults;
+    taskResult.startDate = date;
+    taskResult.endDate = [date dateByAddingTimeInterval:stepCount * 10.25];
+    return taskResult;
+}
+
+- (void)testBinarySerialization {
+    ORKTaskResult *taskResult = [self sampleTaskResultWithStepCount:20];
+    
+    NSData *jsonData = [ORKESerializer JSONDataForObject:taskResult error:NULL];
+    NSData *binaryData = [ORKESerializer binaryDataForObject:taskResult error:NULL];
+    XCTAssertNotNil(binaryData);
+    NSLog(@"Task result: %@ bytes as JSON, %@ bytes binary", @(jsonData.length), @(binaryData.length));
+    XCTAssertLessThan(binaryData.length, jsonData.length);
+    
+    // Lossless with respect to the JSON form, and dates keep sub-second precision
+    ORKTaskResult *decoded = [ORKESerializer objectFromBinaryData:binaryData error:NULL];
+    XCTAssertEqualObjects([ORKESerializer JSONObjectForObject:decoded error:NULL], [ORKESerializer JSONObjectForObject:taskResult error:NULL]);
+    XCTAssertEqualObjects(decoded.startDate, taskResult.startDate);
+    ORKStepResult *stepResult = (ORKStepResult *)decoded.results[3];
+    XCTAssertEqualObjects([(ORKDateQuestionResult *)stepResult.results[2] dateAnswer], [(ORKDateQuestionResult *)[(ORKStepResult *)taskResult.results[3] results][2] dateAnswer]);
+    XCTAssertEqualObjects([(ORKFileResult *)stepResult.results[3] fileURL], [(ORKFileResult *)[(ORKStepResult *)taskResult.results[3] results][3] fileURL]);
+    ORKSpatialSpanMemoryGameRecord *gameRecord = [(ORKSpatialSpanMemoryResult *)stepResult.results[4] gameRecords][0];
+    XCTAssertEqualObjects(gameRecord.stimulusOnsetTimestamps, [[(ORKSpatialSpanMemoryResult *)[(ORKStepResult *)taskResult.results[3] results][4] gameRecords][0] stimulusOnsetTimestamps]);
+    
+    // The task model fixture
+    ORKOrderedTask *task = [[ORKOrderedTask alloc] initWithIdentifier:@"id" steps:@[[ORKQuestionStep questionStepWithIdentifier:@"id" title:@"question" answer:[ORKNumericAnswerFormat decimalAnswerFormatWithUnit:@"kg"]],
+                                                                              [ORKQuestionStep questionStepWithIdentifier:@"id2" title:@"question" answer:[ORKAnswerFormat dateAnswerFormat]]]];
+    ORKOrderedTask *decodedTask = [ORKESerializer objectFromBinaryData:[ORKESerializer binaryDataForObject:task error:NULL] error:NULL];
+    XCTAssertEqualObjects([ORKESerializer JSONObjectForObject:decodedTask error:NULL], [ORKESerializer JSONObjectForObject:task error:NULL]);
+    
+    // Signature images are carried as PNG data: binary data natively, base64 in JSON
+    UIGraphicsBeginImageContextWithOptions(CGSizeMake(8, 4), YES, 1);
+    [[UIColor blackColor] setFill];
+    UIRectFill(CGRectMake(0, 0, 4, 4));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    ORKConsentSignature *signature = [ORKConsentSignature signatureForPersonWithTitle:nil dateFormatString:nil identifier:@"participant" givenName:@"Jo" familyName:@"Doe" signatureImage:image dateString:@"1/1/16"];
+    ORKConsentSignature *fromBinary = [ORKESerializer objectFromBinaryData:[ORKESerializer binaryDataForObject:signature error:NULL] error:NULL];
+    ORKConsentSignature *fromJSON = [ORKESerializer objectFromJSONData:[ORKESerializer JSONDataForObject:signature error:NULL] error:NULL];
+    XCTAssertTrue(CGSizeEqualToSize(fromBinary.signatureImage.size, image.size));
+    XCTAssertTrue(CGSizeEqualToSize(fromJSON.signatureImage.size, image.size));
+    
+    // Truncated and malformed data are rejected
+    NSError *error = nil;
+    XCTAssertNil([ORKESerializer objectFromBinaryData:[binaryData subdataWithRange:NSMakeRange(0, binaryData.length - 1)] error:&error]);
+    XCTAssertEqualObjects(error.domain, ORKErrorDomain);
+    XCTAssertNil([ORKESerializer objectFromBinaryData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding] error:NULL]);
+}
+
+- (void)testJSONSerializationPerformance {
+    ORKTaskResult *taskResult = [self sampleTaskResultWithStepCount:200];
+    [self measureBlock:^{
+        NSData *data = [ORKESerializer JSONDataForObject:taskResult error:NULL];
+        XCTAssertNotNil([ORKESerializer objectFromJSONData:data error:NULL]);
+    }];
+}
+
+- (void)testBinarySerializationPerformance {
+    ORKTaskResult *taskResult = [self sampleTaskResultWithStepCount:200];
+    [self measureBlock:^{
+        NSData *data = [ORKESerializer binaryDataForObject:taskResult error:NULL];
+        XCTAssertNotNil([ORKESerializer objectFromBinaryData:data error:NULL]);
+    }];
+}
+
+- (ORKTaskResult *)tappingTaskResultWithStepCount:(NSUInteger)stepCount sampleCount:(NSUInteger)sampleCount {
+    NSMutableArray *stepResults = [NSMutableArray array];
+    for (NSUInteger i = 0; i < stepCount; i++) {
+        ORKTappingIntervalResult *tappingResult = [[ORKTappingIntervalResult alloc] initWithIdentifier:@"tapping"];
+        tappingResult.stepViewSize = CGSizeMake(320, 480);
+        tappingResult.buttonRect1 = CGRectMake(10, 400, 100, 60);
+        tappingResult.buttonRect2 = CGRectMake(210, 400, 100, 60);
+        if (sampleCount > 0) {
+            NSMutableArray *samples = [NSMutableArray arrayWithCapacity:sampleCount];
+            for (NSUInteger j = 0; j < sampleCount; j++) {
+                ORKTappingSample *sample = [ORKTappingSample new];
+                sample.timestamp = j * 0.125;
+                sample.buttonIdentifier = (j % 2) ? ORKTappingButtonIdentifierLeft : ORKTappingButtonIdentifierRight;
+                sample.location = CGPointMake(j % 100, j % 60);
+                [samples addObject:sample];
+            }
+            tappingResult.samples = samples;
+        }
+        ORKStepResult *stepResult = [[ORKStepResult alloc] initWithStepIdentifier:[NSString stringWithFormat:@"tapping.%@", @(i)] results:@[ tappingResult ]];
+        [stepResults addObject:stepResult];
+    }
+    ORKTaskResult *taskResult = [[ORKTaskResult alloc] initWithTaskIdentifier:@"tapping" taskRunUUID:[[NSUUID alloc] initWithUUIDString:@"8D7A9E8C-5F4B-4D63-9C1B-3B0E9E0C2F11"] outputDirectory:nil];
+    taskResult.results = stepResults;
+    return taskResult;
+}
+
+- (NSURL *)writeJSONForObject:(id)object {
+    NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    @autoreleasepool {
+        [[ORKESerializer JSONDataForObject:object error:NULL] writeToURL:url atomically:YES];
+    }
+    return url;
+}
+
+static uint64_t residentMemorySize() {
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+}
+
+- (void)testStreamingImport {
+    ORKTaskResult *taskResult = [self sampleTaskResultWithStepCount:20];
+    NSData *jsonData = [ORKESerializer JSONDataForObject:taskResult error:NULL];
+    ORKTaskResult *imported = [ORKESerializer objectFromJSONStream:[NSInputStream inputStreamWithData:jsonData] skippedProperties:nil progressHandler:nil error:NULL];
+    XCTAssertEqualObjects([ORKESerializer JSONObjectForObject:imported error:NULL], [ORKESerializer JSONObjectForObject:[ORKESerializer objectFromJSONData:jsonData error:NULL] error:NULL]);
+    
+    // Skipped subtrees are left out, and the rest of the document is unchanged
+    NSURL *url = [self writeJSONForObject:[self tappingTaskResultWithStepCount:50 sampleCount:100]];
+    int64_t fileSize = (int64_t)[[[NSFileManager defaultManager] attributesOfItemAtPath:url.path error:NULL] fileSize];
+    NSMutableArray *progress = [NSMutableArray array];
+    imported = [ORKESerializer objectFromJSONFileAtURL:url skippedProperties:[NSSet setWithObject:@"samples"] progressHandler:^(int64_t bytesRead, int64_t totalBytes) {
+        XCTAssertEqual(totalBytes, fileSize);
+        [progress addObject:@(bytesRead)];
+    } error:NULL];
+    [[NSFileManager defaultManager] removeItemAtURL:url error:NULL];
+    XCTAssertEqualObjects([ORKESerializer JSONObjectForObject:imported error:NULL],
+                          [ORKESerializer JSONObjectForObject:[self tappingTaskResultWithStepCount:50 sampleCount:0] error:NULL]);
+    XCTAssertGreaterThan(progress.count, 1);
+    XCTAssertEqualObjects([progress sortedArrayUsingSelector:@selector(compare:)], progress);
+    XCTAssertEqual([progress.lastObject longLongValue], fileSize);
+    
+    // Malformed documents are reported as errors
+    NSArray *malformed = @[ @"", @"{", @"{\"_class\":", @"[1,]", @"{\"a\" 1}", @"\"\\x\"", @"[01]", @"[\"\\ud800\"]", @"{} {}", @"[true false]" ];
+    for (NSString *document in malformed) {
+        NSError *error = nil;
+        id object = [ORKESerializer objectFromJSONStream:[NSInputStream inputStreamWithData:[document dataUsingEncoding:NSUTF8StringEncoding]] skippedProperties:nil progressHandler:nil error:&error];
+        XCTAssertNil(object, @"%@", document);
+        XCTAssertEqualObjects(error.domain, ORKErrorDomain, @"%@", document);
+    }
+    XCTAssertEqualObjects([ORKESerializer objectFromJSONStream:[NSInputStream inputStreamWithData:[@" [1, -2.5e1, \"\\u00e9\\ud83d\\ude00\", null, {\"k\": [true]}] " dataUsingEncoding:NSUTF8StringEncoding]] skippedProperties:nil progressHandler:nil error:NULL],
+                          (@[ @1, @(-25), @"\u00e9\U0001F600", [NSNull null], @{ @"k": @[ @YES ] } ]));
+}
+
+- (void)testStreamingImportMemory {
+    // A large archive whose bulk is raw samples
+    NSURL *url = [self writeJSONForObject:[self tappingTaskResultWithStepCount:1000 sampleCount:200]];
+    int64_t fileSize = (int64_t)[[[NSFileManager defaultManager] attributesOfItemAtPath:url.path error:NULL] fileSize];
+    
+    uint64_t baseline = residentMemorySize();
+    __block uint64_t peak = baseline;
+    ORKTaskResult *imported = nil;
+    @autoreleasepool {
+        imported = [ORKESerializer objectFromJSONFileAtURL:url skippedProperties:[NSSet setWithObject:@"samples"] progressHandler:^(int64_t bytesRead, int64_t totalBytes) {
+            peak = MAX(peak, residentMemorySize());
+        } error:NULL];
+    }
+    [[NSFileManager defaultManager] removeItemAtURL:url error:NULL];
+    
+    XCTAssertEqual(imported.results.count, 1000);
+    NSLog(@"Streaming import of %lld bytes grew resident memory by %llu bytes", fileSize, peak - baseline);
+    XCTAssertLessThan(peak - baseline, (uint64_t)fileSize / 2);
+}
+
+- (void)testJSONImportPerformance {
+    NSURL *url = [self writeJSONForObject:[self tappingTaskResultWithStepCount:200 sampleCount:200]];
+    [self measureBlock:^{
+        XCTAssertNotNil([ORKESerializer objectFromJSONData:[NSData dataWithContentsOfURL:url] error:NULL]);
+    }];
+    [[NSFileManager defaultManager] removeItemAtURL:url error:NULL];
+}
+
+- (void)testStreamingImportPerformance {
+    NSURL *url = [self writeJSONForObject:[self tappingTaskResultWithStepCount:200 sampleCount:200]];
+    [self measureBlock:^{
+        XCTAssertNotNil([ORKESerializer objectFromJSONFileAtURL:url skippedProperties:nil progressHandler:nil error:NULL]);
+    }];
+    [[NSFileManager defaultManager] removeItemAtURL:url error:NULL];
+}
+
 - (void)testDateComponentsSerialization {
     
     // Trying to get NSDateComponents to change when you serialize / deserialize twice. But the test passes here.